@@ -7,16 +7,32 @@
  * **程序目标:**
  * 本程序实现左轮的速度闭环控制:
  *   1. 使用PI控制器进行速度控制
- *   2. 阶跃设定点测试: 0 -> 2.5 rad/s -> -2.5 rad/s -> 0 (每5000ms)
- *   3. 通过串口发送数据: 设定点、测量速度、控制信号 (TSV格式)
+ *   2. 阶跃设定点测试: 0 -> 2.5 rad/s -> -2.5 rad/s -> 0 (每5000ms)，
+ *      PI控制器的参考速度以受限的加速度与加加速度到达设定点 (setpoint_profile.h)，
+ *      遥测中的设定点仍是阶跃本身，host/中的step_analyze按它计算调节时间
+ *   3. 通过串口发送数据: 设定点、测量速度、控制信号、积分项 (TSV格式)
+ *
+ * 控制任务只把定长的二进制样本放入无锁环形缓冲区 (telemetry_ring.h)，
+ * 格式化和写串口由低优先级的记录任务完成，控制周期不再等待UART。
+ * 结束时打印控制周期的抖动统计 (唤醒间隔与标称周期之差、每周期的执行时间)
+ * 以及被丢弃的样本数，TELEMETRY_MODE可切换为原来的直接输出或不输出以作对比。
+ * 记录任务默认输出带CRC的二进制帧 (telemetry_frame.h)，用host/中的telemetry_decode
+ * 还原为CSV; TELEMETRY_FORMAT设为TELEMETRY_TEXT时输出原来的TSV文本。
  */
 
 #include <stdio.h>
+#include <atomic>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "sdkconfig.h"
 
+#include "quadrature_decoder.h"
+#include "setpoint_profile.h"
+#include "pi_design.h"
+#include "telemetry_frame.h"
+#include "telemetry_ring.h"
+
 // ==============================================================================
 // 用户可修改参数
 // ==============================================================================
@@ -30,14 +46,51 @@
 #define PULSES_PER_REV (ENCODER_PPR * GEAR_RATIO * 4)  // 四倍频
 
 // --- 控制参数 ---
-#define CONTROL_PERIOD_MS 100   // 控制周期 (毫秒)
+#ifndef CONTROL_PERIOD_MS
+#define CONTROL_PERIOD_MS 100   // 控制周期 (毫秒)，可用-D覆盖以测量更短周期下的抖动
+#endif
 #define STEP_PERIOD_MS 5000     // 阶跃变化周期 (毫秒)
 
+// --- 遥测输出 ---
+#define TELEMETRY_OFF 0         // 不输出 (测量没有日志时的抖动)
+#define TELEMETRY_INLINE 1      // 控制任务中直接Serial.print (原实现)
+#define TELEMETRY_RING 2        // 放入环形缓冲区，由记录任务输出
+#ifndef TELEMETRY_MODE
+#define TELEMETRY_MODE TELEMETRY_RING
+#endif
+#define TELEMETRY_RING_SIZE 64  // 环形缓冲区容量 (样本数，2的幂)
+#define LOGGER_PERIOD_MS 20     // 记录任务的轮询周期 (毫秒)
+#define TELEMETRY_TEXT 0        // 记录任务输出TSV文本
+#define TELEMETRY_BINARY 1      // 记录任务输出二进制帧
+#ifndef TELEMETRY_FORMAT
+#define TELEMETRY_FORMAT TELEMETRY_BINARY
+#endif
+#define TELEMETRY_FRAME_MAX_AGE_MS 1000  // 未满的帧最长等待时间 (毫秒)
+
 // --- PI控制器参数 ---
+#ifndef PI_DESIGN
+#define PI_DESIGN 1  // 1: 由被控对象模型与期望闭环时间常数在编译期设计PI系数 (pi_design.h)
+                     // 0: 手工整定的KP、KI (原行为，用于对比; 100 ms周期时在仿真模型上不稳定)
+#endif
+#define TAU 30.20f       // 被控对象时间常数 (毫秒)，与基础草图的辨识结果相同
+#define G 50.01f         // 被控对象静态增益 (rad/s，满量程占空比)
+#define TAU_DEZ 100.0f   // 期望闭环时间常数 (毫秒)，M法测速有半个周期的滞后，不宜小于控制周期
+#define PI_DISCRETIZATION PiDiscretization::ZeroOrderHold // 离散化方法: BackwardEuler / Tustin / ZeroOrderHold
+#define MAX_STEP_SPEED 5.0f  // 最大的设定点阶跃 (rad/s，+2.5 -> -2.5)
+#if !PI_DESIGN
 // Kp和Ki需要根据实际情况调整
 #define KP 6000.0f  // 比例增益 (可调整)
 #define KI 8000.0f  // 积分增益 (可调整)
 #define INTEGRAL_MAX 15000.0f  // 积分限幅，防止积分饱和
+#endif
+
+// --- 设定点轨迹 ---
+#ifndef SETPOINT_PROFILE
+#define SETPOINT_PROFILE 1      // 1: 阶跃设定点经过加速度/加加速度限制后送给PI控制器，不再清零积分
+                                // 0: 设定点直接阶跃，变化时清零积分 (原行为，用于对比)
+#endif
+#define PROFILE_MAX_ACCEL 10.0f // 参考速度的最大变化率 (rad/s²)
+#define PROFILE_MAX_JERK 100.0f // 变化率的最大变化率 (rad/s³)，100 ms周期时0 -> 2.5 rad/s约需0.3秒
 
 // --- 编码器引脚定义 ---
 // 左侧编码器
@@ -62,11 +115,23 @@ const uint8_t MRB = 32;
 // PWM最大值
 const uint32_t PWM_MAX = (1 << PWM_RESOLUTION) - 1;
 
-// --- 编码器计数器 (使用volatile因为会在中断中修改) ---
-volatile int32_t leftEncoderCount = 0;
-
-// --- 编码器上一次状态 (用于四倍频解码) ---
-volatile uint8_t lastLeftState = 0;
+#if PI_DESIGN
+// PI系数在编译期由TAU、G、TAU_DEZ与控制周期算出
+constexpr PiCoeffs PI_COEFFS = pi_design(TAU * 1e-3, G, TAU_DEZ * 1e-3, CONTROL_PERIOD_MS * 1e-3, PWM_MAX,
+                                         PI_DISCRETIZATION);
+static_assert(pi_design_ok(TAU * 1e-3, G, TAU_DEZ * 1e-3, CONTROL_PERIOD_MS * 1e-3, PWM_MAX),
+              "TAU、G、TAU_DEZ应为正数");
+static_assert(pi_design_stable(PI_COEFFS, TAU * 1e-3, G, CONTROL_PERIOD_MS * 1e-3, PWM_MAX),
+              "闭环不稳定，请增大TAU_DEZ或改用ZeroOrderHold");
+static_assert(pi_design_fits_pwm(PI_COEFFS, G, MAX_STEP_SPEED, PWM_MAX),
+              "MAX_STEP_SPEED的阶跃使控制量超出PWM范围，请增大TAU_DEZ");
+constexpr float KP = PI_COEFFS.kp;  // 比例增益
+constexpr float KI = PI_COEFFS.ki;  // 积分增益
+constexpr float INTEGRAL_MAX = PWM_MAX / PI_COEFFS.ki;  // 积分限幅: 积分项单独不超过满量程
+#endif
+
+// --- 编码器解码状态 (由quadratureISR在中断中修改) ---
+QuadratureCounter leftEncoder;
 
 // --- 控制相关变量 ---
 float desiredSpeedLeft = 0.0f;  // 左轮期望速度 (rad/s)
@@ -77,74 +142,25 @@ float integralLeft = 0.0f;      // 左轮积分项
 // 临界区保护用的自旋锁
 portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
 
-// ==============================================================================
-// 中断服务程序
-// ==============================================================================
+// --- 遥测 (TelemetrySample见telemetry_frame.h) ---
+TelemetryRing<TelemetrySample, TELEMETRY_RING_SIZE> telemetryRing;
+TelemetryFrameEncoder frameEncoder;                 // 只由记录任务使用
+uint8_t frameBuffer[TELEMETRY_FRAME_MAX_ENCODED];
 
 /**
- * @brief 左编码器A相中断处理函数
- * 使用四倍频解码方式
+ * @struct LoopTiming
+ * @brief 控制周期的抖动统计 (只由控制任务修改，结束后由输出者读取)。
  */
-void IRAM_ATTR leftEncoderISR_A() {
-  uint8_t A = digitalRead(SLA);
-  uint8_t B = digitalRead(SLB);
-  uint8_t currentState = (A << 1) | B;
-  
-  int8_t direction = 0;
-  switch (lastLeftState) {
-    case 0b00:
-      if (currentState == 0b01) direction = 1;
-      else if (currentState == 0b10) direction = -1;
-      break;
-    case 0b01:
-      if (currentState == 0b11) direction = 1;
-      else if (currentState == 0b00) direction = -1;
-      break;
-    case 0b11:
-      if (currentState == 0b10) direction = 1;
-      else if (currentState == 0b01) direction = -1;
-      break;
-    case 0b10:
-      if (currentState == 0b00) direction = 1;
-      else if (currentState == 0b11) direction = -1;
-      break;
-  }
-  
-  leftEncoderCount += direction;
-  lastLeftState = currentState;
-}
+struct LoopTiming {
+  uint32_t cycles;      // 统计的周期数
+  uint32_t jitterMaxUs; // |唤醒间隔 - 标称周期| 的最大值
+  uint64_t jitterSumUs;
+  uint32_t busyMaxUs;   // 唤醒到本周期工作结束的最长时间
+  uint64_t busySumUs;
+};
 
-/**
- * @brief 左编码器B相中断处理函数
- */
-void IRAM_ATTR leftEncoderISR_B() {
-  uint8_t A = digitalRead(SLA);
-  uint8_t B = digitalRead(SLB);
-  uint8_t currentState = (A << 1) | B;
-  
-  int8_t direction = 0;
-  switch (lastLeftState) {
-    case 0b00:
-      if (currentState == 0b01) direction = 1;
-      else if (currentState == 0b10) direction = -1;
-      break;
-    case 0b01:
-      if (currentState == 0b11) direction = 1;
-      else if (currentState == 0b00) direction = -1;
-      break;
-    case 0b11:
-      if (currentState == 0b10) direction = 1;
-      else if (currentState == 0b01) direction = -1;
-      break;
-    case 0b10:
-      if (currentState == 0b00) direction = 1;
-      else if (currentState == 0b11) direction = -1;
-      break;
-  }
-  
-  leftEncoderCount += direction;
-  lastLeftState = currentState;
-}
+LoopTiming loopTiming;
+std::atomic<bool> controlDone(false);  // 控制任务已结束，记录任务输出剩余样本后退出
 
 // ==============================================================================
 // 电机控制函数
@@ -188,8 +204,8 @@ void setLeftMotorPWM(int32_t pwmValue) {
  */
 int32_t getAndResetLeftEncoder() {
   portENTER_CRITICAL(&spinlock);
-  int32_t count = leftEncoderCount;
-  leftEncoderCount = 0;
+  int32_t count = leftEncoder.count;
+  leftEncoder.count = 0;
   portEXIT_CRITICAL(&spinlock);
   return count;
 }
@@ -239,6 +255,62 @@ void resetIntegral() {
   integralLeft = 0.0f;
 }
 
+// ==============================================================================
+// 遥测函数
+// ==============================================================================
+
+/**
+ * @brief 输出一个样本 (TSV格式: 时间 设定点 测量值 控制信号 积分项)
+ */
+void print_sample(const TelemetrySample &sample) {
+  Serial.print(sample.timeMs);
+  Serial.print("\t");
+  Serial.print(sample.setpoint, 3);
+  Serial.print("\t");
+  Serial.print(sample.measured, 3);
+  Serial.print("\t");
+  Serial.print(sample.command, 1);
+  Serial.print("\t");
+  Serial.println(sample.integral, 4);
+}
+
+/**
+ * @brief 记录一个周期的抖动与执行时间 (在周期的工作全部完成后调用)
+ * @param wakeUs 本周期的唤醒时刻
+ * @param lastWakeUs 上一周期的唤醒时刻 (第一个周期没有间隔可比较)
+ */
+void record_loop_timing(uint32_t wakeUs, uint32_t lastWakeUs) {
+  uint32_t busyUs = micros() - wakeUs;
+  if (busyUs > loopTiming.busyMaxUs) loopTiming.busyMaxUs = busyUs;
+  loopTiming.busySumUs += busyUs;
+  if (loopTiming.cycles > 0) {
+    int32_t deviation = (int32_t)(wakeUs - lastWakeUs) - CONTROL_PERIOD_MS * 1000;
+    uint32_t jitterUs = (uint32_t)(deviation < 0 ? -deviation : deviation);
+    if (jitterUs > loopTiming.jitterMaxUs) loopTiming.jitterMaxUs = jitterUs;
+    loopTiming.jitterSumUs += jitterUs;
+  }
+  loopTiming.cycles++;
+}
+
+/**
+ * @brief 控制结束后输出统计
+ */
+void print_summary() {
+  Serial.println("Speed control completed");
+  // 非法跳变 (两相同时变化) 说明中断响应不及时而丢失了边沿
+  Serial.print("Illegal transitions: ");
+  Serial.println(leftEncoder.illegal);
+
+  uint32_t n = loopTiming.cycles;
+  Serial.printf("Loop timing (mode %d, period %d ms, %u cycles): jitter mean=%u us max=%u us, "
+                "busy mean=%u us max=%u us\n",
+                TELEMETRY_MODE, CONTROL_PERIOD_MS, (unsigned)n,
+                (unsigned)(n > 1 ? loopTiming.jitterSumUs / (n - 1) : 0), (unsigned)loopTiming.jitterMaxUs,
+                (unsigned)(n > 0 ? loopTiming.busySumUs / n : 0), (unsigned)loopTiming.busyMaxUs);
+  Serial.print("Telemetry samples dropped: ");
+  Serial.println(telemetryRing.dropped());
+}
+
 // ==============================================================================
 // 任务函数
 // ==============================================================================
@@ -249,9 +321,10 @@ void resetIntegral() {
  */
 void speedControlTask(void *pvParameters) {
   Serial.println("Speed control task started (Left wheel only, PI controller)");
-  Serial.println("Time(ms)\tSetpoint(rad/s)\tMeasured(rad/s)\tControl");
+  Serial.println("Time(ms)\tSetpoint(rad/s)\tMeasured(rad/s)\tControl\tIntegral");
   
   TickType_t xLastWakeTime = xTaskGetTickCount();
+  uint32_t lastWakeUs = 0;
   uint32_t elapsedTime = 0;
   
   // 阶跃设定点序列: 0 -> 2.5 -> -2.5 -> 0 (每5000ms变化)
@@ -259,7 +332,11 @@ void speedControlTask(void *pvParameters) {
   const int numSetpoints = 4;
   int currentSetpointIndex = 0;
   uint32_t setpointChangeTime = 0;
+#if SETPOINT_PROFILE
+  JerkLimitedProfile profile(PROFILE_MAX_ACCEL, PROFILE_MAX_JERK);
+#else
   float lastSetpoint = 0.0f;
+#endif
   
   // 控制周期 (秒)
   const float dt = CONTROL_PERIOD_MS / 1000.0f;
@@ -270,6 +347,7 @@ void speedControlTask(void *pvParameters) {
   while (elapsedTime < totalTimeMs) {
     // 等待下一个控制周期
     vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(CONTROL_PERIOD_MS));
+    uint32_t wakeUs = micros();
     elapsedTime += CONTROL_PERIOD_MS;
     
     // 检查是否需要更新设定点
@@ -280,40 +358,90 @@ void speedControlTask(void *pvParameters) {
     }
     desiredSpeedLeft = setpoints[currentSetpointIndex];
     
+#if SETPOINT_PROFILE
+    // 参考速度平滑地到达设定点，积分项保留 (它正是维持当前速度所需的控制量)
+    float reference = profile.update(desiredSpeedLeft, dt);
+#else
     // 如果设定点发生变化，重置积分项
     if (desiredSpeedLeft != lastSetpoint) {
       resetIntegral();
       lastSetpoint = desiredSpeedLeft;
     }
+    float reference = desiredSpeedLeft;
+#endif
     
     // 获取编码器计数并计算速度
     int32_t leftCount = getAndResetLeftEncoder();
     measuredSpeedLeft = calculateAngularVelocity(leftCount, CONTROL_PERIOD_MS);
     
     // PI控制器计算控制信号
-    controlSignalLeft = piController(desiredSpeedLeft, measuredSpeedLeft, &integralLeft, dt);
+    controlSignalLeft = piController(reference, measuredSpeedLeft, &integralLeft, dt);
     
     // 应用控制信号到电机
     setLeftMotorPWM((int32_t)controlSignalLeft);
     
-    // 通过串口发送数据 (TSV格式: 时间 设定点 测量值 控制信号)
-    Serial.print(elapsedTime);
-    Serial.print("\t");
-    Serial.print(desiredSpeedLeft, 3);
-    Serial.print("\t");
-    Serial.print(measuredSpeedLeft, 3);
-    Serial.print("\t");
-    Serial.println(controlSignalLeft, 1);
+#if TELEMETRY_MODE != TELEMETRY_OFF
+    TelemetrySample sample = {elapsedTime, desiredSpeedLeft, measuredSpeedLeft,
+                              controlSignalLeft, integralLeft};
+#if TELEMETRY_MODE == TELEMETRY_RING
+    // 不阻塞: 记录任务跟不上时样本被丢弃并计数
+    telemetryRing.push(sample);
+#else
+    print_sample(sample);
+#endif
+#endif
+
+    record_loop_timing(wakeUs, lastWakeUs);
+    lastWakeUs = wakeUs;
   }
   
   // 停止电机
   stopLeftMotor();
-  Serial.println("Speed control completed");
+#if TELEMETRY_MODE == TELEMETRY_RING
+  // 剩余样本与统计由记录任务输出
+  controlDone.store(true, std::memory_order_release);
+#else
+  print_summary();
+#endif
   
   // 任务完成后删除自己
   vTaskDelete(NULL);
 }
 
+/**
+ * @brief 遥测记录任务 (低优先级)
+ * 每LOGGER_PERIOD_MS取出环形缓冲区中的全部样本并输出，控制任务结束后输出统计并退出。
+ */
+void telemetryLoggerTask(void *pvParameters) {
+  TelemetrySample sample;
+#if TELEMETRY_FORMAT == TELEMETRY_BINARY
+  uint32_t frameStartMs = 0;  // 当前帧第一个样本的时间
+#endif
+  for (;;) {
+    // 先读取结束标志再取样本，结束前放入的样本都会被输出
+    bool done = controlDone.load(std::memory_order_acquire);
+    while (telemetryRing.pop(&sample)) {
+#if TELEMETRY_FORMAT == TELEMETRY_BINARY
+      size_t n = frameEncoder.add(sample, frameBuffer);
+      if (n > 0) Serial.write(frameBuffer, n);
+      if (frameEncoder.pending() == 1) frameStartMs = millis();
+#else
+      print_sample(sample);
+#endif
+    }
+#if TELEMETRY_FORMAT == TELEMETRY_BINARY
+    // 低速率时不让样本在未满的帧中等待太久
+    if (frameEncoder.pending() > 0 && (done || millis() - frameStartMs >= TELEMETRY_FRAME_MAX_AGE_MS)) {
+      Serial.write(frameBuffer, frameEncoder.flush(frameBuffer));
+    }
+#endif
+    if (done) break;
+    vTaskDelay(pdMS_TO_TICKS(LOGGER_PERIOD_MS));
+  }
+  print_summary();
+  vTaskDelete(NULL);
+}
+
 // ==============================================================================
 // 支持函数
 // ==============================================================================
@@ -326,23 +454,6 @@ void init_motor_pwm(uint8_t pin) {
   analogWrite(pin, 0);
 }
 
-/**
- * @brief 初始化编码器引脚并配置中断
- */
-void init_encoder_with_interrupt(uint8_t pinA, uint8_t pinB, 
-                                  void (*isrA)(), void (*isrB)(),
-                                  volatile uint8_t *lastState) {
-  pinMode(pinA, INPUT_PULLUP);
-  pinMode(pinB, INPUT_PULLUP);
-  
-  // 读取初始状态
-  *lastState = (digitalRead(pinA) << 1) | digitalRead(pinB);
-  
-  // 配置中断 (双边沿触发)
-  attachInterrupt(digitalPinToInterrupt(pinA), isrA, CHANGE);
-  attachInterrupt(digitalPinToInterrupt(pinB), isrB, CHANGE);
-}
-
 // ==============================================================================
 // Arduino核心函数
 // ==============================================================================
@@ -361,7 +472,7 @@ void setup() {
   init_motor_pwm(MRB);
 
   // 初始化左编码器并配置中断
-  init_encoder_with_interrupt(SLA, SLB, leftEncoderISR_A, leftEncoderISR_B, &lastLeftState);
+  quadrature_attach<SLA, SLB, leftEncoder>();
 
   // 等待1秒让系统稳定
   delay(1000);
@@ -376,6 +487,18 @@ void setup() {
     NULL
   );
 
+#if TELEMETRY_MODE == TELEMETRY_RING
+  // 创建遥测记录任务 (低优先级，只在控制任务空闲时输出)
+  xTaskCreate(
+    telemetryLoggerTask,
+    "TelemetryLogger",
+    4096,
+    NULL,
+    1,
+    NULL
+  );
+#endif
+
   Serial.println("Setup complete, control task created");
   
   // 挂起setup/loop任务
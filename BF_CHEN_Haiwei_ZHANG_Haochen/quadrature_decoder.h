@@ -0,0 +1,91 @@
+/*
+ * quadrature_decoder.h - 查表法四倍频正交解码中断
+ *
+ * **中文注释:**
+ * 一个模板中断处理函数同时挂在A、B两相引脚上 (CHANGE)，代替每个引脚一份的
+ * digitalRead + switch实现:
+ *   - 两相电平从同一次GPIO输入寄存器读取中取出 (GPIO.in: GPIO0-31,
+ *     GPIO.in1: GPIO32-39)，两次digitalRead之间另一相翻转导致的撕裂不会再出现;
+ *   - (上一状态<<2 | 当前状态) 作为下标查16项跳变表，得到 +1 / -1 / 0;
+ *   - 两相同时变化 (中间丢失了一个边沿，无法判断方向) 不计数，计入illegal。
+ * 正方向与原实现相同: 00 -> 01 -> 11 -> 10 -> 00 (状态 = A<<1 | B)。
+ * 引脚与计数器都是模板参数，每个编码器实例化出一个独立的中断函数，
+ * 中断中没有函数指针、没有引脚号的运行时计算。
+ */
+
+#ifndef QUADRATURE_DECODER_H_
+#define QUADRATURE_DECODER_H_
+
+#include <Arduino.h>
+
+#include "soc/gpio_struct.h"
+
+/**
+ * @struct QuadratureCounter
+ * @brief 一个编码器的解码状态 (由中断修改)。
+ */
+struct QuadratureCounter {
+  volatile int32_t count;     // 累计计数 (四倍频)
+  volatile uint32_t illegal;  // 非法跳变次数 (两相同时变化)
+  volatile uint8_t state;     // 上一次的相位状态 (A<<1 | B)
+};
+
+// 跳变表中表示非法跳变的值
+#define QUAD_ILLEGAL 2
+
+// 下标: (上一状态<<2) | 当前状态; 放在DRAM中，Flash缓存关闭时中断仍可访问
+static const DRAM_ATTR int8_t QUAD_TRANSITION[16] = {
+  //  00            01            10            11      <- 当前状态
+   0,           +1,           -1,           QUAD_ILLEGAL, // 上一状态 00
+  -1,            0,           QUAD_ILLEGAL, +1,           // 上一状态 01
+  +1,           QUAD_ILLEGAL,  0,           -1,           // 上一状态 10
+  QUAD_ILLEGAL, -1,           +1,            0,           // 上一状态 11
+};
+
+/**
+ * @brief 一次寄存器读取得到两相的状态 (A<<1 | B)。
+ */
+template <uint8_t PIN_A, uint8_t PIN_B>
+static inline uint8_t IRAM_ATTR quadrature_read_state() {
+  static_assert((PIN_A < 32) == (PIN_B < 32), "A/B phase pins must be in the same GPIO input register");
+  uint32_t in;
+  if constexpr (PIN_A < 32) {
+    in = GPIO.in;
+  } else {
+    in = GPIO.in1.val;
+  }
+  return (uint8_t)((((in >> (PIN_A & 31)) & 1) << 1) | ((in >> (PIN_B & 31)) & 1));
+}
+
+/**
+ * @brief A、B两相共用的中断处理函数。
+ */
+template <uint8_t PIN_A, uint8_t PIN_B, QuadratureCounter &C>
+void IRAM_ATTR quadratureISR() {
+  uint8_t current = quadrature_read_state<PIN_A, PIN_B>();
+  int8_t step = QUAD_TRANSITION[(C.state << 2) | current];
+  C.state = current;
+  if (step == QUAD_ILLEGAL) {
+    C.illegal = C.illegal + 1;
+  } else {
+    C.count = C.count + step;
+  }
+}
+
+/**
+ * @brief 初始化编码器引脚，读取初始状态并在两相上挂接中断 (双边沿触发)。
+ */
+template <uint8_t PIN_A, uint8_t PIN_B, QuadratureCounter &C>
+void quadrature_attach() {
+  pinMode(PIN_A, INPUT_PULLUP);
+  pinMode(PIN_B, INPUT_PULLUP);
+
+  C.count = 0;
+  C.illegal = 0;
+  C.state = quadrature_read_state<PIN_A, PIN_B>();
+
+  attachInterrupt(digitalPinToInterrupt(PIN_A), quadratureISR<PIN_A, PIN_B, C>, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(PIN_B), quadratureISR<PIN_A, PIN_B, C>, CHANGE);
+}
+
+#endif /* QUADRATURE_DECODER_H_ */
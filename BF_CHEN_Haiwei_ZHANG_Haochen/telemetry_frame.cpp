@@ -0,0 +1,298 @@
+/*
+ * telemetry_frame.cpp - 二进制遥测帧的编码与解码
+ *
+ * **中文注释:**
+ * 差值按32位回绕计算，解码时同样回绕相加，因此时间计数回绕不影响还原。
+ * 分隔符之间的一段超过一帧的最大长度时不可能是帧: 全是文本则分块交给文本回调
+ * (TSV文本输出中没有0x00，整个记录就是一段)，否则按损坏帧计数并丢弃到下一个分隔符。
+ */
+
+#include "telemetry_frame.h"
+
+#include <math.h>
+
+namespace {
+
+// 各字段的量化倍数 (字段0为时间，不量化)
+const float FIELD_SCALE[TELEMETRY_FIELDS] = {1.0f, 1000.0f, 1000.0f, 1.0f, 10000.0f};
+
+int32_t quantize(float v, float scale) {
+  float x = roundf(v * scale);
+  if (!(x > -2147483520.0f)) return INT32_MIN + 1;  // 同时处理NaN
+  if (x > 2147483520.0f) return INT32_MAX;
+  return (int32_t)x;
+}
+
+void to_fields(const TelemetrySample &s, int32_t q[TELEMETRY_FIELDS]) {
+  q[0] = (int32_t)s.timeMs;
+  q[1] = quantize(s.setpoint, FIELD_SCALE[1]);
+  q[2] = quantize(s.measured, FIELD_SCALE[2]);
+  q[3] = quantize(s.command, FIELD_SCALE[3]);
+  q[4] = quantize(s.integral, FIELD_SCALE[4]);
+}
+
+void from_fields(const int32_t q[TELEMETRY_FIELDS], TelemetrySample *s) {
+  s->timeMs = (uint32_t)q[0];
+  s->setpoint = q[1] / FIELD_SCALE[1];
+  s->measured = q[2] / FIELD_SCALE[2];
+  s->command = q[3] / FIELD_SCALE[3];
+  s->integral = q[4] / FIELD_SCALE[4];
+}
+
+size_t put_varint(uint8_t *p, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+size_t put_zvarint(uint8_t *p, int32_t v) {
+  return put_varint(p, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+bool get_varint(const uint8_t **p, const uint8_t *end, uint32_t *v) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (*p >= end) return false;
+    uint8_t b = *(*p)++;
+    result |= (uint32_t)(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) {
+      *v = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool get_zvarint(const uint8_t **p, const uint8_t *end, int32_t *v) {
+  uint32_t u;
+  if (!get_varint(p, end, &u)) return false;
+  *v = (int32_t)((u >> 1) ^ (0u - (u & 1)));
+  return true;
+}
+
+uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xffff;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief COBS编码，并在首尾加0x00分隔符。
+ */
+size_t cobs_frame(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t o = 0;
+  out[o++] = 0x00;
+  size_t codePos = o++;
+  uint8_t code = 1;
+  for (size_t i = 0; i < len; i++) {
+    if (in[i] == 0) {
+      out[codePos] = code;
+      codePos = o++;
+      code = 1;
+    } else {
+      out[o++] = in[i];
+      if (++code == 0xff) {
+        out[codePos] = code;
+        codePos = o++;
+        code = 1;
+      }
+    }
+  }
+  out[codePos] = code;
+  out[o++] = 0x00;
+  return o;
+}
+
+/**
+ * @brief COBS解码 (输入不含分隔符)。
+ * @return 解码后的长度，格式错误时返回0。
+ */
+size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t i = 0, o = 0;
+  while (i < len) {
+    uint8_t code = in[i++];
+    if (code == 0 || i + code - 1 > len) return 0;
+    for (uint8_t k = 1; k < code; k++) out[o++] = in[i++];
+    if (code != 0xff && i < len) out[o++] = 0;
+  }
+  return o;
+}
+
+bool is_text(const uint8_t *p, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t c = p[i];
+    if ((c < 0x20 || c > 0x7e) && c != '\t' && c != '\r' && c != '\n') return false;
+  }
+  return true;
+}
+
+} // namespace
+
+//- 编码 ----------------------------
+
+TelemetryFrameEncoder::TelemetryFrameEncoder() {
+  reset();
+}
+
+void TelemetryFrameEncoder::reset() {
+  rawLen_ = 2;
+  count_ = 0;
+  prevDt_ = 0;
+  for (int i = 0; i < TELEMETRY_FIELDS; i++) prev_[i] = 0;
+}
+
+size_t TelemetryFrameEncoder::add(const TelemetrySample &sample, uint8_t *out) {
+  int32_t q[TELEMETRY_FIELDS];
+  to_fields(sample, q);
+
+  if (count_ == 0) {
+    rawLen_ += put_varint(raw_ + rawLen_, (uint32_t)q[0]);
+    for (int i = 1; i < TELEMETRY_FIELDS; i++) rawLen_ += put_zvarint(raw_ + rawLen_, q[i]);
+    prevDt_ = 0;
+  } else {
+    size_t maskPos = rawLen_++;
+    uint8_t mask = 0;
+    int32_t dt = (int32_t)((uint32_t)q[0] - (uint32_t)prev_[0]);
+    int32_t d[TELEMETRY_FIELDS];
+    d[0] = (int32_t)((uint32_t)dt - (uint32_t)prevDt_);
+    prevDt_ = dt;
+    for (int i = 1; i < TELEMETRY_FIELDS; i++) d[i] = (int32_t)((uint32_t)q[i] - (uint32_t)prev_[i]);
+    for (int i = 0; i < TELEMETRY_FIELDS; i++) {
+      if (d[i] != 0) {
+        mask |= (uint8_t)(1u << i);
+        rawLen_ += put_zvarint(raw_ + rawLen_, d[i]);
+      }
+    }
+    raw_[maskPos] = mask;
+  }
+  for (int i = 0; i < TELEMETRY_FIELDS; i++) prev_[i] = q[i];
+  count_++;
+
+  return count_ >= TELEMETRY_FRAME_SAMPLES ? flush(out) : 0;
+}
+
+size_t TelemetryFrameEncoder::flush(uint8_t *out) {
+  if (count_ == 0) return 0;
+  raw_[0] = TELEMETRY_FRAME_TYPE;
+  raw_[1] = (uint8_t)count_;
+  uint16_t crc = crc16_ccitt(raw_, rawLen_);
+  raw_[rawLen_++] = (uint8_t)crc;
+  raw_[rawLen_++] = (uint8_t)(crc >> 8);
+  size_t n = cobs_frame(raw_, rawLen_, out);
+  reset();
+  return n;
+}
+
+//- 解码 ----------------------------
+
+TelemetryFrameDecoder::TelemetryFrameDecoder(SampleFn onSample, TextFn onText, void *ctx)
+  : onSample_(onSample), onText_(onText), ctx_(ctx), segLen_(0), overflow_(false), spilled_(false),
+    frames_(0), samples_(0), badFrames_(0), textBytes_(0) {}
+
+void TelemetryFrameDecoder::feed(const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t b = data[i];
+    if (b == 0x00) {
+      segment();
+    } else {
+      if (segLen_ == sizeof(seg_)) spill();
+      if (!overflow_) seg_[segLen_++] = b;
+    }
+  }
+}
+
+/**
+ * @brief 缓冲区满: 已缓存的文本交给回调后继续接收，否则丢弃这一段。
+ */
+void TelemetryFrameDecoder::spill() {
+  if (!overflow_ && is_text(seg_, segLen_)) {
+    textBytes_ += (uint32_t)segLen_;
+    if (onText_ != nullptr) onText_((const char *)seg_, segLen_, ctx_);
+    spilled_ = true;
+  } else {
+    if (!overflow_) badFrames_++;
+    overflow_ = true;
+  }
+  segLen_ = 0;
+}
+
+void TelemetryFrameDecoder::finish() {
+  segment();
+}
+
+/**
+ * @brief 处理两个分隔符之间的一段: 先尝试按帧解码，失败时判断是否为文本。
+ */
+void TelemetryFrameDecoder::segment() {
+  size_t len = segLen_;
+  bool overflow = overflow_;
+  bool spilled = spilled_;
+  segLen_ = 0;
+  overflow_ = false;
+  spilled_ = false;
+  if (overflow || len == 0) return;
+
+  if (!spilled) {
+    uint8_t raw[TELEMETRY_FRAME_MAX_ENCODED];
+    size_t rawLen = cobs_decode(seg_, len, raw);
+    if (rawLen > 0 && decodeFrame(raw, rawLen)) return;
+  }
+  if (is_text(seg_, len)) {
+    textBytes_ += (uint32_t)len;
+    if (onText_ != nullptr) onText_((const char *)seg_, len, ctx_);
+    return;
+  }
+  badFrames_++;
+}
+
+bool TelemetryFrameDecoder::decodeFrame(const uint8_t *raw, size_t len) {
+  if (len < 4 || raw[0] != TELEMETRY_FRAME_TYPE) return false;
+  uint16_t crc = (uint16_t)(raw[len - 2] | (raw[len - 1] << 8));
+  if (crc16_ccitt(raw, len - 2) != crc) return false;
+
+  uint32_t n = raw[1];
+  if (n == 0 || n > TELEMETRY_FRAME_SAMPLES) return false;
+  const uint8_t *p = raw + 2;
+  const uint8_t *end = raw + len - 2;
+
+  // 先完整解析到临时数组，帧内任何错误都不会输出半帧样本
+  TelemetrySample samples[TELEMETRY_FRAME_SAMPLES];
+  int32_t q[TELEMETRY_FIELDS];
+  int32_t dt = 0;
+  uint32_t t;
+  if (!get_varint(&p, end, &t)) return false;
+  q[0] = (int32_t)t;
+  for (int i = 1; i < TELEMETRY_FIELDS; i++) {
+    if (!get_zvarint(&p, end, &q[i])) return false;
+  }
+  from_fields(q, &samples[0]);
+
+  for (uint32_t k = 1; k < n; k++) {
+    if (p >= end) return false;
+    uint8_t mask = *p++;
+    if (mask >> TELEMETRY_FIELDS) return false;
+    int32_t d[TELEMETRY_FIELDS] = {0, 0, 0, 0, 0};
+    for (int i = 0; i < TELEMETRY_FIELDS; i++) {
+      if ((mask & (1u << i)) && !get_zvarint(&p, end, &d[i])) return false;
+    }
+    dt = (int32_t)((uint32_t)dt + (uint32_t)d[0]);
+    q[0] = (int32_t)((uint32_t)q[0] + (uint32_t)dt);
+    for (int i = 1; i < TELEMETRY_FIELDS; i++) q[i] = (int32_t)((uint32_t)q[i] + (uint32_t)d[i]);
+    from_fields(q, &samples[k]);
+  }
+  if (p != end) return false;
+
+  frames_++;
+  samples_ += n;
+  for (uint32_t k = 0; k < n; k++) onSample_(samples[k], ctx_);
+  return true;
+}
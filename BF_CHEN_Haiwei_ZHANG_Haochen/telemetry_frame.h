@@ -0,0 +1,139 @@
+/*
+ * telemetry_frame.h - 带CRC校验的二进制遥测帧
+ *
+ * **中文注释:**
+ * 文本遥测 ("5100\t2.500\t2.808\t-97.1\r\n") 每个样本约25字节，115200波特下
+ * 每秒最多约450个样本。二进制帧把最多TELEMETRY_FRAME_SAMPLES个样本打包在一起:
+ *   - 各字段先量化为整数 (速度与设定点 1e-3 rad/s，控制信号 1个PWM计数，积分项 1e-4)，
+ *     与原文本输出的精度相同;
+ *   - 帧内第一个样本写绝对值，之后的样本只写与前一个样本的差值 (zigzag + varint)，
+ *     时间字段写二阶差分 (周期恒定时为0); 每个样本前有一个字节的掩码，
+ *     差值为0的字段不占字节;
+ *   - 帧尾是CRC-16/CCITT-FALSE，整帧经COBS编码后前后各加一个0x00分隔符。
+ * 每帧都从绝对值开始，丢失或损坏一帧只影响这一帧; 串口上混杂的文本行
+ * (Serial.println) 被分隔符隔开，解码器原样交给文本回调。
+ *
+ * 帧格式 (COBS编码前):
+ *   uint8  TELEMETRY_FRAME_TYPE
+ *   uint8  样本数 n (1..TELEMETRY_FRAME_SAMPLES)
+ *   样本0: varint 时间(ms), zvarint 设定点, zvarint 测量值, zvarint 控制信号, zvarint 积分项
+ *   样本1..n-1: uint8 掩码 (bit i: 字段i有差值)，随后是各个非零差值 (zvarint)
+ *   uint16 CRC (小端序，覆盖前面全部字节)
+ */
+
+#ifndef TELEMETRY_FRAME_H_
+#define TELEMETRY_FRAME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEMETRY_FRAME_TYPE 0x54        // 帧类型 ('T')，格式变化时修改
+#define TELEMETRY_FRAME_SAMPLES 32       // 每帧最多样本数
+#define TELEMETRY_FIELDS 5               // 时间、设定点、测量值、控制信号、积分项
+// 未编码帧的最大长度: 类型 + 样本数 + 每个样本(掩码 + 5个最长5字节的varint) + CRC
+#define TELEMETRY_FRAME_MAX_RAW (2 + TELEMETRY_FRAME_SAMPLES * (1 + TELEMETRY_FIELDS * 5) + 2)
+// 编码后的最大长度: COBS每254字节多1字节，再加首尾两个分隔符
+#define TELEMETRY_FRAME_MAX_ENCODED (TELEMETRY_FRAME_MAX_RAW + TELEMETRY_FRAME_MAX_RAW / 254 + 1 + 2)
+
+/**
+ * @struct TelemetrySample
+ * @brief 一个控制周期的记录 (20字节)。
+ */
+struct TelemetrySample {
+  uint32_t timeMs;   // 控制时间 (毫秒)
+  float setpoint;    // 设定点 (rad/s)
+  float measured;    // 测量速度 (rad/s)
+  float command;     // 控制信号
+  float integral;    // 积分项
+};
+
+/**
+ * @class TelemetryFrameEncoder
+ * @brief 把样本逐个加入当前帧，帧满时输出编码后的字节。
+ */
+class TelemetryFrameEncoder {
+public:
+  TelemetryFrameEncoder();
+
+  /**
+   * @brief 丢弃当前帧中的样本。
+   */
+  void reset();
+
+  /**
+   * @brief 加入一个样本。
+   * @param out 帧满时写入编码后的帧，至少TELEMETRY_FRAME_MAX_ENCODED字节。
+   * @return 写入out的字节数 (帧未满时为0)。
+   */
+  size_t add(const TelemetrySample &sample, uint8_t *out);
+
+  /**
+   * @brief 输出未满的帧。
+   * @return 写入out的字节数 (帧中没有样本时为0)。
+   */
+  size_t flush(uint8_t *out);
+
+  /**
+   * @brief 当前帧中的样本数。
+   */
+  uint32_t pending() const { return count_; }
+
+private:
+  uint8_t raw_[TELEMETRY_FRAME_MAX_RAW];
+  size_t rawLen_;
+  uint32_t count_;
+  int32_t prev_[TELEMETRY_FIELDS];  // 前一个样本的量化值
+  int32_t prevDt_;                  // 前一个时间差
+};
+
+/**
+ * @class TelemetryFrameDecoder
+ * @brief 流式解码: 输入任意切分的字节流，每解出一个样本或一段文本调用一次回调。
+ */
+class TelemetryFrameDecoder {
+public:
+  typedef void (*SampleFn)(const TelemetrySample &sample, void *ctx);
+  typedef void (*TextFn)(const char *text, size_t len, void *ctx);
+
+  /**
+   * @param onSample 每个样本的回调。
+   * @param onText 分隔符之间的纯文本 (可打印ASCII与\t\r\n) 的回调，可以为NULL。
+   * @param ctx 传给回调的参数。
+   */
+  TelemetryFrameDecoder(SampleFn onSample, TextFn onText, void *ctx);
+
+  /**
+   * @brief 输入一段字节流。
+   */
+  void feed(const uint8_t *data, size_t len);
+
+  /**
+   * @brief 输入结束，处理最后一段没有分隔符结尾的数据。
+   */
+  void finish();
+
+  // 统计计数
+  uint32_t frames() const { return frames_; }
+  uint32_t samples() const { return samples_; }
+  uint32_t badFrames() const { return badFrames_; }   // CRC错误、格式错误或过长
+  uint32_t textBytes() const { return textBytes_; }
+
+private:
+  void segment();
+  void spill();
+  bool decodeFrame(const uint8_t *raw, size_t len);
+
+  SampleFn onSample_;
+  TextFn onText_;
+  void *ctx_;
+  uint8_t seg_[TELEMETRY_FRAME_MAX_ENCODED];
+  size_t segLen_;
+  bool overflow_;   // 当前段超过缓冲区且不是文本，丢弃到下一个分隔符
+  bool spilled_;    // 当前段的前一部分已作为文本输出
+  uint32_t frames_;
+  uint32_t samples_;
+  uint32_t badFrames_;
+  uint32_t textBytes_;
+};
+
+#endif /* TELEMETRY_FRAME_H_ */
@@ -13,6 +13,9 @@
  *   4. 使机器人后退 500 毫秒。
  *   5. 最终停止机器人。
  * (注意: 上述核心逻辑需由用户在后续实现中添加,此文件仅为初始化框架)
+ *
+ * FILTER_BENCH设为1时，setup()先在目标板上测量Filter0_step() (double，软件浮点)
+ * 与biquad.h中float/Q15/Q31实现、biquad_cascade.h的两通道级联每次两通道滤波的CPU周期数。
  */
 
 #include <stdio.h> // 标准输入输出库,用于打印调试信息等
@@ -20,6 +23,13 @@
 #include "freertos/task.h"     // FreeRTOS任务管理库
 #include "sdkconfig.h"         // ESP-IDF SDK配置头文件
 
+#include "biquad.h"            // Filter0的单精度/定点实现
+#include "biquad_cascade.h"    // 多通道可重入级联
+#include "biquad_design.h"     // 编译期滤波器设计
+extern "C" {
+#include "Filter0.h"           // Simulink生成的C代码
+}
+
 // ==============================================================================
 // 用户可修改参数
 // ==============================================================================
@@ -27,6 +37,22 @@
 // A MODIFIER >>>>>>>>>>>>>>>>>>>>>>>>>>
 #define PWM_FREQ 1000
 #define PWM_RESOLUTION 15
+
+// --- 滤波器性能测试 ---
+#ifndef FILTER_BENCH
+#define FILTER_BENCH 0         // 1: setup()中测量各滤波器实现的周期数
+#endif
+#define FILTER_BENCH_STEPS 1000 // 每种实现的滤波次数
+
+// --- 速度滤波器 (系数在编译期由biquad_design.h算出) ---
+#ifndef CONTROL_PERIOD_MS
+#define CONTROL_PERIOD_MS 10        // 闭环控制周期 (毫秒)，即滤波器的采样周期
+#endif
+#define SPEED_FILTER_CUTOFF_HZ 10.0 // 二阶Butterworth低通的截止频率 (赫兹)，默认值与Filter0相同
+
+constexpr BiquadCoeffs SPEED_FILTER_COEFFS = biquad_lowpass(SPEED_FILTER_CUTOFF_HZ, 1000.0 / CONTROL_PERIOD_MS);
+static_assert(biquad_design_ok(SPEED_FILTER_CUTOFF_HZ, 1000.0 / CONTROL_PERIOD_MS),
+              "SPEED_FILTER_CUTOFF_HZ must be below half the control rate");
  
 
 // --- 编码器引脚定义 ---
@@ -137,6 +163,86 @@ void motorControlTask(void *pvParameters) {
   vTaskDelete(NULL);
 }
 
+// ==============================================================================
+// 滤波器性能测试
+// ==============================================================================
+#if FILTER_BENCH
+
+volatile float filterSink; // 防止编译器删除滤波计算
+
+/**
+ * @brief 测量每次两通道滤波的平均周期数 (ESP.getCycleCount()，240 MHz时每周期4.17 ns)。
+ *
+ * 各实现处理同一段预先转换好的输入 (缓慢变化的正弦)，计时循环中没有类型转换。
+ * biquad.h的实现使用SPEED_FILTER_COEFFS; 默认参数下与Filter0的系数相同。
+ */
+void run_filter_bench() {
+  const int N = 64;
+  static double inD[N];
+  static float inF[N];
+  static int16_t in15[N];
+  static int32_t in31[N];
+  for (int i = 0; i < N; i++) {
+    float v = 0.8f * sinf(6.2831853f * i / N);
+    inD[i] = v;
+    inF[i] = v;
+    in15[i] = (int16_t)(v * 32767.0f);
+    in31[i] = (int32_t)(v * 2147483647.0f);
+  }
+
+  BiquadF32 f1(SPEED_FILTER_COEFFS), f2(SPEED_FILTER_COEFFS);
+  BiquadQ15 q1(SPEED_FILTER_COEFFS), q2(SPEED_FILTER_COEFFS);
+  BiquadQ31 r1(SPEED_FILTER_COEFFS), r2(SPEED_FILTER_COEFFS);
+  BiquadCascade<2, 1, float> cascade({SPEED_FILTER_COEFFS});
+  uint32_t cycles[5];
+  uint32_t t0;
+
+  Filter0_initialize();
+  t0 = ESP.getCycleCount();
+  for (int i = 0; i < FILTER_BENCH_STEPS; i++) {
+    Filter0_U.u1 = inD[i % N];
+    Filter0_U.u2 = inD[(i + N / 2) % N];
+    Filter0_step();
+    filterSink = (float)Filter0_Y.y1;
+  }
+  cycles[0] = ESP.getCycleCount() - t0;
+
+  t0 = ESP.getCycleCount();
+  for (int i = 0; i < FILTER_BENCH_STEPS; i++) {
+    filterSink = f1.step(inF[i % N]) + f2.step(inF[(i + N / 2) % N]);
+  }
+  cycles[1] = ESP.getCycleCount() - t0;
+
+  t0 = ESP.getCycleCount();
+  for (int i = 0; i < FILTER_BENCH_STEPS; i++) {
+    filterSink = q1.step(in15[i % N]) + q2.step(in15[(i + N / 2) % N]);
+  }
+  cycles[2] = ESP.getCycleCount() - t0;
+
+  t0 = ESP.getCycleCount();
+  for (int i = 0; i < FILTER_BENCH_STEPS; i++) {
+    filterSink = (float)(r1.step(in31[i % N]) + r2.step(in31[(i + N / 2) % N]));
+  }
+  cycles[3] = ESP.getCycleCount() - t0;
+
+  t0 = ESP.getCycleCount();
+  for (int i = 0; i < FILTER_BENCH_STEPS; i++) {
+    float in[2] = {inF[i % N], inF[(i + N / 2) % N]}, out[2];
+    cascade.step(in, out);
+    filterSink = out[0] + out[1];
+  }
+  cycles[4] = ESP.getCycleCount() - t0;
+
+  const char *names[5] = {"Filter0_step (double)", "BiquadF32", "BiquadQ15", "BiquadQ31", "BiquadCascade<2,1,f>"};
+  Serial.println("Filter bench: cycles per two-channel step");
+  for (int k = 0; k < 5; k++) {
+    Serial.printf("  %-22s %6.1f  (x%.1f)\n", names[k], (float)cycles[k] / FILTER_BENCH_STEPS,
+                  (float)cycles[0] / cycles[k]);
+  }
+}
+
+#endif
+
 // ==============================================================================
 // 支持函数
 // ==============================================================================
@@ -189,6 +295,10 @@ void setup() {
   while (!Serial);      // 等待串行端口连接 (仅在某些板卡和IDE设置下需要)
   Serial.println("Setup start : openloop"); // 打印启动信息,指示进入开环设置
 
+#if FILTER_BENCH
+  run_filter_bench();
+#endif
+
   // 初始化两个电机的驱动器输出 (PWM引脚)
   init_motor_pwm(MLF); // 初始化左侧电机前进引脚
   init_motor_pwm(MLB); // 初始化左侧电机后退引脚
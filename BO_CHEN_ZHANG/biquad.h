@@ -0,0 +1,166 @@
+/*
+ * biquad.h - 单精度与定点的二阶节 (biquad) 滤波器
+ *
+ * **中文注释:**
+ * Filter0.c (Simulink为Intel x86-64生成) 用real_T (double) 计算两个通道的二阶低通滤波器。
+ * ESP32的FPU只支持单精度，double的每次乘加都调用libgcc的软件浮点函数
+ * (__muldf3/__adddf3/__subdf3)。这里用相同的系数提供三种实现，每个对象是一个通道:
+ *   - BiquadF32: float，转置直接II型 (DF2T)，只有2个状态，全部在硬件FPU上计算;
+ *   - BiquadQ15: int16_t样本，系数为Q2.14，直接I型 (DF1)，32位累加，输出舍入后饱和;
+ *   - BiquadQ31: int32_t样本，系数为Q2.30，DF1，64位累加 (ESP32上每次乘法是mull + mulsh)。
+ * 定点实现用DF1: 状态就是过去的输入和输出，数值范围与信号相同，不会像DF2的中间量
+ * 那样被极点放大后溢出。定点版本的信号缩放由调用者决定 (例如PWM计数、编码器计数，
+ * 或按满量程缩放的速度)，滤波器本身不改变直流增益。
+ *
+ * 用法 (代替Filter0_U/Filter0_step()/Filter0_Y):
+ *   BiquadF32 leftFilter(FILTER0_COEFFS), rightFilter(FILTER0_COEFFS);
+ *   float y1 = leftFilter.step(u1);
+ *   float y2 = rightFilter.step(u2);
+ */
+
+#ifndef BIQUAD_H_
+#define BIQUAD_H_
+
+#include <stdint.h>
+
+/**
+ * @struct BiquadCoeffs
+ * @brief 归一化的二阶节系数 (a0 = 1):
+ *        y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ */
+struct BiquadCoeffs {
+  double b0, b1, b2;  // 分子
+  double a1, a2;      // 分母
+};
+
+// Filter0.c的系数: 增益0.0674552738890719乘以分子 (1, 2, 1)，分母 (1, -1.1429805, 0.4128016)
+constexpr BiquadCoeffs FILTER0_COEFFS = {
+  0.0674552738890719, 2.0 * 0.0674552738890719, 0.0674552738890719,
+  -1.1429805025399011, 0.41280159809618877,
+};
+
+/**
+ * @brief 系数能否用Q2.x表示，且满量程输入下累加器不溢出 (各系数绝对值之和小于4)。
+ */
+constexpr bool biquad_fixed_point_ok(const BiquadCoeffs &c) {
+  return c.b0 > -2.0 && c.b0 < 2.0 && c.b1 > -2.0 && c.b1 < 2.0 && c.b2 > -2.0 && c.b2 < 2.0 &&
+         c.a1 > -2.0 && c.a1 < 2.0 && c.a2 > -2.0 && c.a2 < 2.0 &&
+         (c.b0 < 0 ? -c.b0 : c.b0) + (c.b1 < 0 ? -c.b1 : c.b1) + (c.b2 < 0 ? -c.b2 : c.b2) +
+         (c.a1 < 0 ? -c.a1 : c.a1) + (c.a2 < 0 ? -c.a2 : c.a2) < 4.0;
+}
+
+static_assert(biquad_fixed_point_ok(FILTER0_COEFFS), "Filter0 coefficients do not fit Q2.14/Q2.30");
+
+constexpr int32_t biquad_round(double v) {
+  return (int32_t)(v + (v < 0 ? -0.5 : 0.5));
+}
+
+/**
+ * @brief 把系数转换为frac位小数的定点数 (四舍五入)。
+ */
+constexpr int32_t biquad_to_fixed(double c, int frac) {
+  return biquad_round(c * (double)(1LL << frac));
+}
+
+/**
+ * @brief 定点的b1: 不单独舍入，而是取使量化后的直流增益与原系数相同的值。
+ *
+ * 各系数分别舍入时，分子之和与 (1 + a1 + a2) 的比值会偏离原来的直流增益;
+ * 低通滤波器的分母之和很小 (Filter0为0.27)，Q2.30下这个偏差在满量程输出上相当于十几个LSB。
+ */
+constexpr int32_t biquad_fixed_b1(const BiquadCoeffs &c, int frac) {
+  return 1.0 + c.a1 + c.a2 == 0.0
+             ? biquad_to_fixed(c.b1, frac)
+             : biquad_round((c.b0 + c.b1 + c.b2) / (1.0 + c.a1 + c.a2) *
+                            (double)((1LL << frac) + biquad_to_fixed(c.a1, frac) + biquad_to_fixed(c.a2, frac))) -
+                   biquad_to_fixed(c.b0, frac) - biquad_to_fixed(c.b2, frac);
+}
+
+/**
+ * @class BiquadF32
+ * @brief 单精度DF2T二阶节。
+ */
+class BiquadF32 {
+public:
+  explicit constexpr BiquadF32(const BiquadCoeffs &c)
+    : b0_((float)c.b0), b1_((float)c.b1), b2_((float)c.b2), a1_((float)c.a1), a2_((float)c.a2),
+      s1_(0.0f), s2_(0.0f) {}
+
+  void reset() { s1_ = s2_ = 0.0f; }
+
+  float step(float x) {
+    float y = b0_ * x + s1_;
+    s1_ = b1_ * x - a1_ * y + s2_;
+    s2_ = b2_ * x - a2_ * y;
+    return y;
+  }
+
+private:
+  float b0_, b1_, b2_, a1_, a2_;
+  float s1_, s2_;
+};
+
+/**
+ * @class BiquadQ15
+ * @brief 16位定点DF1二阶节 (系数Q2.14)。
+ *
+ * 乘积为16×16位，Xtensa的MUL16S一条指令完成; biquad_fixed_point_ok()保证
+ * 五个乘积之和不超过32位。系数分辨率为6e-5，极点位置的偏差使阶跃的过渡过程
+ * 与double版本相差约万分之二满量程; 需要更高精度时用BiquadQ31。
+ */
+class BiquadQ15 {
+public:
+  explicit constexpr BiquadQ15(const BiquadCoeffs &c)
+    : b0_((int16_t)biquad_to_fixed(c.b0, 14)), b1_((int16_t)biquad_fixed_b1(c, 14)),
+      b2_((int16_t)biquad_to_fixed(c.b2, 14)), a1_((int16_t)biquad_to_fixed(c.a1, 14)),
+      a2_((int16_t)biquad_to_fixed(c.a2, 14)), x1_(0), x2_(0), y1_(0), y2_(0) {}
+
+  void reset() { x1_ = x2_ = y1_ = y2_ = 0; }
+
+  int16_t step(int16_t x) {
+    int32_t acc = (int32_t)b0_ * x + (int32_t)b1_ * x1_ + (int32_t)b2_ * x2_ -
+                  (int32_t)a1_ * y1_ - (int32_t)a2_ * y2_;
+    acc = (acc + (1 << 13)) >> 14;
+    int16_t y = acc > INT16_MAX ? INT16_MAX : acc < -INT16_MAX ? -INT16_MAX : (int16_t)acc;
+    x2_ = x1_;
+    x1_ = x;
+    y2_ = y1_;
+    y1_ = y;
+    return y;
+  }
+
+private:
+  int16_t b0_, b1_, b2_, a1_, a2_;
+  int16_t x1_, x2_, y1_, y2_;
+};
+
+/**
+ * @class BiquadQ31
+ * @brief 32位定点DF1二阶节 (系数Q2.30，64位累加)。
+ */
+class BiquadQ31 {
+public:
+  explicit constexpr BiquadQ31(const BiquadCoeffs &c)
+    : b0_(biquad_to_fixed(c.b0, 30)), b1_(biquad_fixed_b1(c, 30)), b2_(biquad_to_fixed(c.b2, 30)),
+      a1_(biquad_to_fixed(c.a1, 30)), a2_(biquad_to_fixed(c.a2, 30)), x1_(0), x2_(0), y1_(0), y2_(0) {}
+
+  void reset() { x1_ = x2_ = y1_ = y2_ = 0; }
+
+  int32_t step(int32_t x) {
+    int64_t acc = (int64_t)b0_ * x + (int64_t)b1_ * x1_ + (int64_t)b2_ * x2_ -
+                  (int64_t)a1_ * y1_ - (int64_t)a2_ * y2_;
+    acc = (acc + (1LL << 29)) >> 30;
+    int32_t y = acc > INT32_MAX ? INT32_MAX : acc < -INT32_MAX ? -INT32_MAX : (int32_t)acc;
+    x2_ = x1_;
+    x1_ = x;
+    y2_ = y1_;
+    y1_ = y;
+    return y;
+  }
+
+private:
+  int32_t b0_, b1_, b2_, a1_, a2_;
+  int32_t x1_, x2_, y1_, y2_;
+};
+
+#endif /* BIQUAD_H_ */
@@ -0,0 +1,173 @@
+/*
+ * biquad_cascade.h - 多通道、多节的可重入二阶节级联滤波器
+ *
+ * **中文注释:**
+ * Filter0_step()只能处理全局变量Filter0_U/Filter0_Y/Filter0_DW中写死的两个通道，
+ * 不能实例化两次，也不能在两个任务中调用。BiquadCascade<Channels, Sections, Sample>
+ * 的所有状态都在对象内，不同任务各用一个对象即可:
+ *   - 所有通道使用相同的各节系数 (例如左右两个车轮、以后更多的传感器);
+ *   - 状态按结构体数组 (SoA) 存放: 每一节的每个状态是一个长度为Channels的连续数组，
+ *     内层循环沿通道方向，没有跨通道的依赖，编译器可以直接向量化;
+ *   - step()一次处理所有通道的一个样本，process()处理交错存放的一段样本
+ *     (in[帧 * Channels + 通道])，两者结果完全相同;
+ *   - Sample为float时每节是DF2T，为int16_t/int32_t时是Q2.14/Q2.30系数的DF1，
+ *     数值与biquad.h中的BiquadF32/BiquadQ15/BiquadQ31逐位相同。
+ * 同一个对象不能同时被两个任务调用。
+ *
+ * 用法 (代替Filter0的两个通道):
+ *   BiquadCascade<2, 1, float> wheelFilter({FILTER0_COEFFS});
+ *   float in[2] = {omegaLeft, omegaRight}, out[2];
+ *   wheelFilter.step(in, out);
+ */
+
+#ifndef BIQUAD_CASCADE_H_
+#define BIQUAD_CASCADE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+#include "biquad.h"
+
+/**
+ * @brief 各样本类型的参数: 系数与累加器的类型，定点系数的小数位数与饱和值。
+ */
+template <typename Sample>
+struct BiquadSampleTraits;
+
+template <>
+struct BiquadSampleTraits<float> {
+  typedef float Coeff;
+  typedef float Acc;
+};
+
+template <>
+struct BiquadSampleTraits<int16_t> {
+  typedef int16_t Coeff;
+  typedef int32_t Acc;
+  static constexpr int FRAC = 14;
+  static constexpr int32_t MAX = INT16_MAX;
+};
+
+template <>
+struct BiquadSampleTraits<int32_t> {
+  typedef int32_t Coeff;
+  typedef int64_t Acc;
+  static constexpr int FRAC = 30;
+  static constexpr int64_t MAX = INT32_MAX;
+};
+
+/**
+ * @class BiquadCascade
+ * @tparam Channels 通道数。
+ * @tparam Sections 二阶节数 (滤波器阶数 = 2 × Sections)。
+ * @tparam Sample float、int16_t (Q15) 或 int32_t (Q31)。
+ */
+template <size_t Channels, size_t Sections, typename Sample>
+class BiquadCascade {
+  static_assert(Channels > 0 && Sections > 0, "BiquadCascade needs at least one channel and one section");
+
+  static constexpr bool FLOAT = std::is_same<Sample, float>::value;
+  typedef typename BiquadSampleTraits<Sample>::Coeff Coeff;
+  typedef typename BiquadSampleTraits<Sample>::Acc Acc;
+
+public:
+  /**
+   * @param sections 各节的系数 (定点版本要求每节满足biquad_fixed_point_ok())。
+   */
+  explicit BiquadCascade(const BiquadCoeffs (&sections)[Sections]) {
+    for (size_t s = 0; s < Sections; s++) {
+      const BiquadCoeffs &c = sections[s];
+      if constexpr (FLOAT) {
+        coeff_[s][0] = (float)c.b0;
+        coeff_[s][1] = (float)c.b1;
+        coeff_[s][2] = (float)c.b2;
+        coeff_[s][3] = (float)c.a1;
+        coeff_[s][4] = (float)c.a2;
+      } else {
+        const int frac = BiquadSampleTraits<Sample>::FRAC;
+        coeff_[s][0] = (Coeff)biquad_to_fixed(c.b0, frac);
+        coeff_[s][1] = (Coeff)biquad_fixed_b1(c, frac);
+        coeff_[s][2] = (Coeff)biquad_to_fixed(c.b2, frac);
+        coeff_[s][3] = (Coeff)biquad_to_fixed(c.a1, frac);
+        coeff_[s][4] = (Coeff)biquad_to_fixed(c.a2, frac);
+      }
+    }
+    reset();
+  }
+
+  void reset() {
+    for (size_t s = 0; s < Sections; s++) {
+      for (size_t k = 0; k < STATES; k++) {
+        for (size_t ch = 0; ch < Channels; ch++) state_[s][k][ch] = 0;
+      }
+    }
+  }
+
+  /**
+   * @brief 所有通道各输入一个样本。in与out可以是同一个数组。
+   */
+  void step(const Sample *in, Sample *out) {
+    Sample buf[Channels];
+    for (size_t ch = 0; ch < Channels; ch++) buf[ch] = in[ch];
+    for (size_t s = 0; s < Sections; s++) section(s, buf);
+    for (size_t ch = 0; ch < Channels; ch++) out[ch] = buf[ch];
+  }
+
+  /**
+   * @brief 处理frames帧交错存放的样本 (in[f * Channels + ch])。in与out可以是同一个数组。
+   */
+  void process(const Sample *in, Sample *out, size_t frames) {
+    for (size_t f = 0; f < frames; f++) step(in + f * Channels, out + f * Channels);
+  }
+
+  static constexpr size_t channels() { return Channels; }
+  static constexpr size_t sections() { return Sections; }
+
+private:
+  // 每节的状态数: DF2T为2个 (s1, s2)，DF1为4个 (x1, x2, y1, y2)
+  static constexpr size_t STATES = FLOAT ? 2 : 4;
+
+  /**
+   * @brief 一节对所有通道的计算，buf就地从输入变为输出。
+   */
+  void section(size_t s, Sample *__restrict buf) {
+    const Coeff b0 = coeff_[s][0], b1 = coeff_[s][1], b2 = coeff_[s][2];
+    const Coeff a1 = coeff_[s][3], a2 = coeff_[s][4];
+    if constexpr (FLOAT) {
+      float *__restrict s1 = state_[s][0];
+      float *__restrict s2 = state_[s][1];
+      for (size_t ch = 0; ch < Channels; ch++) {
+        float x = buf[ch];
+        float y = b0 * x + s1[ch];
+        s1[ch] = b1 * x - a1 * y + s2[ch];
+        s2[ch] = b2 * x - a2 * y;
+        buf[ch] = y;
+      }
+    } else {
+      const int frac = BiquadSampleTraits<Sample>::FRAC;
+      const Acc max = BiquadSampleTraits<Sample>::MAX;
+      Sample *__restrict x1 = state_[s][0];
+      Sample *__restrict x2 = state_[s][1];
+      Sample *__restrict y1 = state_[s][2];
+      Sample *__restrict y2 = state_[s][3];
+      for (size_t ch = 0; ch < Channels; ch++) {
+        Sample x = buf[ch];
+        Acc acc = (Acc)b0 * x + (Acc)b1 * x1[ch] + (Acc)b2 * x2[ch] - (Acc)a1 * y1[ch] - (Acc)a2 * y2[ch];
+        acc = (acc + ((Acc)1 << (frac - 1))) >> frac;
+        Sample y = (Sample)(acc > max ? max : acc < -max ? -max : acc);
+        x2[ch] = x1[ch];
+        x1[ch] = x;
+        y2[ch] = y1[ch];
+        y1[ch] = y;
+        buf[ch] = y;
+      }
+    }
+  }
+
+  Coeff coeff_[Sections][5];                // b0, b1, b2, a1, a2
+  Sample state_[Sections][STATES][Channels]; // SoA: 每个状态一个通道数组
+};
+
+#endif /* BIQUAD_CASCADE_H_ */
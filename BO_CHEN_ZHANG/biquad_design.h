@@ -0,0 +1,134 @@
+/*
+ * biquad_design.h - 编译期设计二阶节滤波器系数 (双线性变换)
+ *
+ * **中文注释:**
+ * FILTER0_COEFFS是Simulink一次性生成的数值，改截止频率或控制周期就要回到MATLAB。
+ * 这里用constexpr函数从截止频率和采样频率直接算出BiquadCoeffs:
+ *   - biquad_lowpass / biquad_highpass: 二阶低通/高通，品质因数q默认1/√2 (Butterworth);
+ *   - biquad_notch: 二阶陷波，f0处增益为0，-3 dB带宽为f0/q;
+ *   - biquad_butterworth_lowpass<阶数> / biquad_butterworth_highpass<阶数>:
+ *     偶数阶Butterworth，拆成阶数/2个二阶节，可直接传给BiquadCascade。
+ * 模拟原型经频率预畸变 (K = tan(π f / fs)) 后做双线性变换，截止频率在数字域准确。
+ * tan/cos/sqrt用级数和牛顿迭代实现 (标准库的数学函数不是constexpr)，精度约1e-15。
+ * 结果赋给constexpr变量时全部在编译期计算，目标板上不执行任何设计代码。
+ *
+ * Filter0就是fc = fs / 10的二阶Butterworth低通 (例如10 ms周期、10 Hz截止):
+ *   constexpr BiquadCoeffs c = biquad_lowpass(10.0, 1000.0 / CONTROL_PERIOD_MS);
+ *   static_assert(biquad_design_ok(10.0, 1000.0 / CONTROL_PERIOD_MS), "cutoff above Nyquist");
+ *   BiquadF32 filter(c);
+ */
+
+#ifndef BIQUAD_DESIGN_H_
+#define BIQUAD_DESIGN_H_
+
+#include <stddef.h>
+
+#include "biquad.h"
+
+constexpr double BIQUAD_PI = 3.14159265358979323846;
+constexpr double BUTTERWORTH_Q = 0.70710678118654752440;
+
+// 泰勒级数，|x| <= π/2时30项后的余项远小于double的舍入误差
+constexpr double biquad_sin(double x) {
+  double term = x, sum = x;
+  for (int n = 1; n < 30; n++) {
+    term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double biquad_cos(double x) {
+  double term = 1.0, sum = 1.0;
+  for (int n = 1; n < 30; n++) {
+    term *= -x * x / ((2.0 * n - 1.0) * (2.0 * n));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double biquad_tan(double x) {
+  return biquad_sin(x) / biquad_cos(x);
+}
+
+constexpr double biquad_sqrt(double x) {
+  if (x <= 0.0) return 0.0;
+  double r = x > 1.0 ? x : 1.0;
+  for (int i = 0; i < 100; i++) {
+    double next = 0.5 * (r + x / r);
+    if (next == r) break;
+    r = next;
+  }
+  return r;
+}
+
+/**
+ * @brief 频率f能否在采样频率fs下设计 (0 < f < fs / 2)。
+ */
+constexpr bool biquad_design_ok(double f, double fs) {
+  return fs > 0.0 && f > 0.0 && f < 0.5 * fs;
+}
+
+/**
+ * @brief 二阶低通: H(s) = 1 / (s² + s/q + 1)，直流增益为1。
+ */
+constexpr BiquadCoeffs biquad_lowpass(double fc, double fs, double q = BUTTERWORTH_Q) {
+  double k = biquad_tan(BIQUAD_PI * fc / fs);
+  double norm = 1.0 / (1.0 + k / q + k * k);
+  double b0 = k * k * norm;
+  return {b0, 2.0 * b0, b0, 2.0 * (k * k - 1.0) * norm, (1.0 - k / q + k * k) * norm};
+}
+
+/**
+ * @brief 二阶高通: H(s) = s² / (s² + s/q + 1)，奈奎斯特频率处增益为1。
+ */
+constexpr BiquadCoeffs biquad_highpass(double fc, double fs, double q = BUTTERWORTH_Q) {
+  double k = biquad_tan(BIQUAD_PI * fc / fs);
+  double norm = 1.0 / (1.0 + k / q + k * k);
+  return {norm, -2.0 * norm, norm, 2.0 * (k * k - 1.0) * norm, (1.0 - k / q + k * k) * norm};
+}
+
+/**
+ * @brief 二阶陷波: H(s) = (s² + 1) / (s² + s/q + 1)，直流与奈奎斯特频率处增益为1。
+ */
+constexpr BiquadCoeffs biquad_notch(double f0, double fs, double q) {
+  double k = biquad_tan(BIQUAD_PI * f0 / fs);
+  double norm = 1.0 / (1.0 + k / q + k * k);
+  double b0 = (1.0 + k * k) * norm;
+  double b1 = 2.0 * (k * k - 1.0) * norm;
+  return {b0, b1, b0, b1, (1.0 - k / q + k * k) * norm};
+}
+
+/**
+ * @struct BiquadDesign
+ * @brief 多个二阶节的设计结果，section可直接传给BiquadCascade的构造函数。
+ */
+template <size_t Sections>
+struct BiquadDesign {
+  BiquadCoeffs section[Sections];
+};
+
+/**
+ * @brief 第k个二阶节 (k从0开始) 的Butterworth品质因数: 1 / (2 cos((2k + 1) π / (2 × 阶数)))。
+ */
+constexpr double butterworth_q(size_t order, size_t k) {
+  return 1.0 / (2.0 * biquad_cos((2.0 * k + 1.0) * BIQUAD_PI / (2.0 * order)));
+}
+
+template <size_t Order>
+constexpr BiquadDesign<Order / 2> biquad_butterworth_lowpass(double fc, double fs) {
+  static_assert(Order >= 2 && Order % 2 == 0, "Butterworth order must be even");
+  BiquadDesign<Order / 2> d = {};
+  for (size_t k = 0; k < Order / 2; k++) d.section[k] = biquad_lowpass(fc, fs, butterworth_q(Order, k));
+  return d;
+}
+
+template <size_t Order>
+constexpr BiquadDesign<Order / 2> biquad_butterworth_highpass(double fc, double fs) {
+  static_assert(Order >= 2 && Order % 2 == 0, "Butterworth order must be even");
+  BiquadDesign<Order / 2> d = {};
+  for (size_t k = 0; k < Order / 2; k++) d.section[k] = biquad_highpass(fc, fs, butterworth_q(Order, k));
+  return d;
+}
+
+#endif /* BIQUAD_DESIGN_H_ */
@@ -19,6 +19,8 @@
 #include "freertos/semphr.h"
 #include "sdkconfig.h"
 
+#include "quadrature_decoder.h"
+
 // ==============================================================================
 // 用户可修改参数
 // ==============================================================================
@@ -62,13 +64,9 @@ const uint32_t PWM_MAX = (1 << PWM_RESOLUTION) - 1;
 // 电机速度设置 (占空比百分比，0-100)
 const uint8_t MOTOR_SPEED = 50;
 
-// --- 编码器计数器 (使用volatile因为会在中断中修改) ---
-volatile int32_t leftEncoderCount = 0;   // 左轮编码器计数
-volatile int32_t rightEncoderCount = 0;  // 右轮编码器计数
-
-// --- 编码器上一次状态 (用于四倍频解码) ---
-volatile uint8_t lastLeftState = 0;
-volatile uint8_t lastRightState = 0;
+// --- 编码器解码状态 (由quadratureISR在中断中修改) ---
+QuadratureCounter leftEncoder;   // 左轮编码器
+QuadratureCounter rightEncoder;  // 右轮编码器
 
 // --- 互斥锁 (用于保护共享资源) ---
 SemaphoreHandle_t encoderMutex;
@@ -76,142 +74,6 @@ SemaphoreHandle_t encoderMutex;
 // 临界区保护用的自旋锁
 portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
 
-// ==============================================================================
-// 中断服务程序
-// ==============================================================================
-
-/**
- * @brief 左编码器A相中断处理函数
- * 使用四倍频解码方式
- */
-void IRAM_ATTR leftEncoderISR_A() {
-  uint8_t A = digitalRead(SLA);
-  uint8_t B = digitalRead(SLB);
-  uint8_t currentState = (A << 1) | B;
-  
-  // 根据状态转换判断方向
-  // 正转: 00->01->11->10->00
-  // 反转: 00->10->11->01->00
-  int8_t direction = 0;
-  switch (lastLeftState) {
-    case 0b00:
-      if (currentState == 0b01) direction = 1;
-      else if (currentState == 0b10) direction = -1;
-      break;
-    case 0b01:
-      if (currentState == 0b11) direction = 1;
-      else if (currentState == 0b00) direction = -1;
-      break;
-    case 0b11:
-      if (currentState == 0b10) direction = 1;
-      else if (currentState == 0b01) direction = -1;
-      break;
-    case 0b10:
-      if (currentState == 0b00) direction = 1;
-      else if (currentState == 0b11) direction = -1;
-      break;
-  }
-  
-  leftEncoderCount += direction;
-  lastLeftState = currentState;
-}
-
-/**
- * @brief 左编码器B相中断处理函数
- */
-void IRAM_ATTR leftEncoderISR_B() {
-  uint8_t A = digitalRead(SLA);
-  uint8_t B = digitalRead(SLB);
-  uint8_t currentState = (A << 1) | B;
-  
-  int8_t direction = 0;
-  switch (lastLeftState) {
-    case 0b00:
-      if (currentState == 0b01) direction = 1;
-      else if (currentState == 0b10) direction = -1;
-      break;
-    case 0b01:
-      if (currentState == 0b11) direction = 1;
-      else if (currentState == 0b00) direction = -1;
-      break;
-    case 0b11:
-      if (currentState == 0b10) direction = 1;
-      else if (currentState == 0b01) direction = -1;
-      break;
-    case 0b10:
-      if (currentState == 0b00) direction = 1;
-      else if (currentState == 0b11) direction = -1;
-      break;
-  }
-  
-  leftEncoderCount += direction;
-  lastLeftState = currentState;
-}
-
-/**
- * @brief 右编码器A相中断处理函数
- */
-void IRAM_ATTR rightEncoderISR_A() {
-  uint8_t A = digitalRead(SRA);
-  uint8_t B = digitalRead(SRB);
-  uint8_t currentState = (A << 1) | B;
-  
-  int8_t direction = 0;
-  switch (lastRightState) {
-    case 0b00:
-      if (currentState == 0b01) direction = 1;
-      else if (currentState == 0b10) direction = -1;
-      break;
-    case 0b01:
-      if (currentState == 0b11) direction = 1;
-      else if (currentState == 0b00) direction = -1;
-      break;
-    case 0b11:
-      if (currentState == 0b10) direction = 1;
-      else if (currentState == 0b01) direction = -1;
-      break;
-    case 0b10:
-      if (currentState == 0b00) direction = 1;
-      else if (currentState == 0b11) direction = -1;
-      break;
-  }
-  
-  rightEncoderCount += direction;
-  lastRightState = currentState;
-}
-
-/**
- * @brief 右编码器B相中断处理函数
- */
-void IRAM_ATTR rightEncoderISR_B() {
-  uint8_t A = digitalRead(SRA);
-  uint8_t B = digitalRead(SRB);
-  uint8_t currentState = (A << 1) | B;
-  
-  int8_t direction = 0;
-  switch (lastRightState) {
-    case 0b00:
-      if (currentState == 0b01) direction = 1;
-      else if (currentState == 0b10) direction = -1;
-      break;
-    case 0b01:
-      if (currentState == 0b11) direction = 1;
-      else if (currentState == 0b00) direction = -1;
-      break;
-    case 0b11:
-      if (currentState == 0b10) direction = 1;
-      else if (currentState == 0b01) direction = -1;
-      break;
-    case 0b10:
-      if (currentState == 0b00) direction = 1;
-      else if (currentState == 0b11) direction = -1;
-      break;
-  }
-  
-  rightEncoderCount += direction;
-  lastRightState = currentState;
-}
-
 // ==============================================================================
 // 电机控制函数
 // ==============================================================================
@@ -249,8 +111,8 @@ void moveBackward(uint8_t speed) {
  */
 int32_t getAndResetLeftEncoder() {
   portENTER_CRITICAL(&spinlock);
-  int32_t count = leftEncoderCount;
-  leftEncoderCount = 0;
+  int32_t count = leftEncoder.count;
+  leftEncoder.count = 0;
   portEXIT_CRITICAL(&spinlock);
   return count;
 }
@@ -261,8 +123,8 @@ int32_t getAndResetLeftEncoder() {
  */
 int32_t getAndResetRightEncoder() {
   portENTER_CRITICAL(&spinlock);
-  int32_t count = rightEncoderCount;
-  rightEncoderCount = 0;
+  int32_t count = rightEncoder.count;
+  rightEncoder.count = 0;
   portEXIT_CRITICAL(&spinlock);
   return count;
 }
@@ -319,6 +181,11 @@ void speedMeasureTask(void *pvParameters) {
   }
   
   Serial.println("Speed measurement completed");
+  // 非法跳变 (两相同时变化) 说明中断响应不及时而丢失了边沿
+  Serial.print("Illegal transitions (left/right): ");
+  Serial.print(leftEncoder.illegal);
+  Serial.print("/");
+  Serial.println(rightEncoder.illegal);
   
   // 任务完成后删除自己
   vTaskDelete(NULL);
@@ -361,23 +228,6 @@ void init_motor_pwm(uint8_t pin) {
   analogWrite(pin, 0);
 }
 
-/**
- * @brief 初始化编码器引脚并配置中断
- */
-void init_encoder_with_interrupt(uint8_t pinA, uint8_t pinB, 
-                                  void (*isrA)(), void (*isrB)(),
-                                  volatile uint8_t *lastState) {
-  pinMode(pinA, INPUT_PULLUP);
-  pinMode(pinB, INPUT_PULLUP);
-  
-  // 读取初始状态
-  *lastState = (digitalRead(pinA) << 1) | digitalRead(pinB);
-  
-  // 配置中断 (双边沿触发)
-  attachInterrupt(digitalPinToInterrupt(pinA), isrA, CHANGE);
-  attachInterrupt(digitalPinToInterrupt(pinB), isrB, CHANGE);
-}
-
 // ==============================================================================
 // Arduino核心函数
 // ==============================================================================
@@ -394,8 +244,8 @@ void setup() {
   init_motor_pwm(MRB);
 
   // 初始化编码器并配置中断
-  init_encoder_with_interrupt(SLA, SLB, leftEncoderISR_A, leftEncoderISR_B, &lastLeftState);
-  init_encoder_with_interrupt(SRA, SRB, rightEncoderISR_A, rightEncoderISR_B, &lastRightState);
+  quadrature_attach<SLA, SLB, leftEncoder>();
+  quadrature_attach<SRA, SRB, rightEncoder>();
 
   // 创建速度测量任务 (较高优先级)
   xTaskCreate(
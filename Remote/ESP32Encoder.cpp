@@ -12,6 +12,12 @@
 #include "ESP32Encoder.h"
 #include "soc/pcnt_struct.h" // 包含PCNT硬件寄存器的底层结构体定义
 
+// 一致快照读取路径中每一步之后调用的钩子。默认为空;
+// 主机上的模糊测试(host/bench/fuzz_encoder_snapshot.cpp)用它在每个位置注入溢出与中断。
+#ifndef ESP32_ENCODER_READ_HOOK
+#define ESP32_ENCODER_READ_HOOK()
+#endif
+
 // --- 静态成员变量初始化 ---
 enum puType ESP32Encoder::useInternalWeakPullResistors = DOWN; // 默认使用内部下拉电阻
 // 用于存储所有编码器实例指针的静态数组，初始化为NULL
@@ -67,6 +73,7 @@ static void IRAM_ATTR pcnt_example_intr_handler(void *arg) {
 	for (i = 0; i < PCNT_UNIT_MAX; i++) { // 遍历所有PCNT单元
 		if (intr_status & (BIT(i))) { // 检查第i个单元是否触发了中断
 			ptr = ESP32Encoder::encoders[i]; // 获取与该单元关联的编码器对象指针
+			ptr->generation++; // 变为奇数: 读者在此期间读到的快照无效
 			
 			// 确定是上溢出还是下溢出，并将对应的极限值累加到64位软件计数器中
 			int64_t status = 0;
@@ -78,10 +85,33 @@ static void IRAM_ATTR pcnt_example_intr_handler(void *arg) {
 			}
 			PCNT.int_clr.val = BIT(i); // 清除该单元的中断标志位，以便下次能再次触发
 			ptr->count = status + ptr->count; // 累加到64位软件计数器
+			ptr->count32 = (int32_t)status + ptr->count32;
+			ptr->generation++; // 恢复为偶数
 		}
 	}
 }
 
+/**
+ * @brief 编码器引脚的GPIO边沿中断: 记录最后一个被计数的边沿的计数值与时刻。
+ *
+ * PCNT在边沿到来时立即计数，中断在几微秒后执行，此时读到的计数已经包含这个边沿
+ * (最高转速时相邻边沿相隔约95微秒)。计数值没有变化的边沿 (毛刺被PCNT滤波器滤掉) 不记录。
+ * @param arg 对应的ESP32Encoder对象。
+ */
+static void IRAM_ATTR encoder_edge_isr(void *arg) {
+	ESP32Encoder *ptr = (ESP32Encoder *) arg;
+	uint32_t now = micros();
+	int32_t c = ptr->getCount32();
+	if (ptr->edgeSeen && c == ptr->edgeCount) {
+		return;
+	}
+	ptr->edgeGeneration++;
+	ptr->edgeCount = c;
+	ptr->edgeTimeUs = now;
+	ptr->edgeSeen = true;
+	ptr->edgeGeneration++;
+}
+
 /**
  * @brief 核心的私有附加函数，用于配置和启动一个编码器。
  * @param a 编码器A相引脚。
@@ -210,7 +240,12 @@ void ESP32Encoder::attachFullQuad(int a, int b) {
  */
 void ESP32Encoder::setCount(int64_t value) {
 	// 通过调整64位软件计数器的值来实现
+	generation++;
 	count = value - getCountRaw();
+	count32 = (int32_t)count;
+	generation++;
+	lastDeltaCount = (uint32_t)value; // 设置的值不算作运动
+	clearEdge();
 }
 
 /**
@@ -223,12 +258,91 @@ int64_t ESP32Encoder::getCountRaw() {
 	return c;
 }
 
+/**
+ * @brief 硬件计数器到达极限后会立即回零，但中断处理函数可能还没有执行
+ * (中断延迟，或正在另一个核心上排队)。此时软件计数器还缺一个极限值。
+ * @return 锁存的上溢/下溢极限值，没有待处理的溢出时返回0。
+ */
+int32_t IRAM_ATTR ESP32Encoder::pendingLimit() {
+	if (!(PCNT.int_st.val & BIT(unit))) {
+		return 0;
+	}
+	if (PCNT.status_unit[unit].h_lim_lat) {
+		return r_enc_config.counter_h_lim;
+	}
+	if (PCNT.status_unit[unit].l_lim_lat) {
+		return r_enc_config.counter_l_lim;
+	}
+	return 0;
+}
+
 /**
  * @brief 获取完整的64位计数值。
+ *
+ * 在两次读取generation之间依次读取软件计数器、待处理溢出、硬件计数器、待处理溢出:
+ *   - generation改变或为奇数: 中断处理函数修改过软件计数器 (或在32位核心上拆开的
+ *     64位读取被打断)，重读;
+ *   - 硬件计数器前后的待处理溢出不同: 溢出恰好发生在读硬件计数器前后，无法判断
+ *     读到的是回零前还是回零后的值，重读;
+ *   - 否则 软件计数器 + 待处理溢出 + 硬件计数器 就是某一时刻的一致值。
  * @return 返回 64位软件计数器值 + 16位硬件计数器值。
  */
 int64_t ESP32Encoder::getCount() {
-	return getCountRaw() + count;
+	for (;;) {
+		uint32_t gen = generation;
+		ESP32_ENCODER_READ_HOOK();
+		if (gen & 1) {
+			continue; // 中断处理函数正在另一个核心上修改count
+		}
+		int64_t accum = count;
+		ESP32_ENCODER_READ_HOOK();
+		int32_t pendingBefore = pendingLimit();
+		ESP32_ENCODER_READ_HOOK();
+		int64_t raw = getCountRaw();
+		ESP32_ENCODER_READ_HOOK();
+		int32_t pendingAfter = pendingLimit();
+		ESP32_ENCODER_READ_HOOK();
+		if (pendingBefore == pendingAfter && generation == gen) {
+			return accum + pendingBefore + raw;
+		}
+	}
+}
+
+/**
+ * @brief 与getCount()相同的一致快照，但只使用32位软件计数器副本。
+ *
+ * 直接读取PCNT计数寄存器而不经过驱动函数，因此可以在IRAM中的中断处理函数里调用。
+ * @return 计数值的低32位。
+ */
+int32_t IRAM_ATTR ESP32Encoder::getCount32() {
+	for (;;) {
+		uint32_t gen = generation;
+		ESP32_ENCODER_READ_HOOK();
+		if (gen & 1) {
+			continue;
+		}
+		int32_t accum = count32;
+		ESP32_ENCODER_READ_HOOK();
+		int32_t pendingBefore = pendingLimit();
+		ESP32_ENCODER_READ_HOOK();
+		int32_t raw = (int16_t)PCNT.cnt_unit[unit].cnt_val;
+		ESP32_ENCODER_READ_HOOK();
+		int32_t pendingAfter = pendingLimit();
+		ESP32_ENCODER_READ_HOOK();
+		if (pendingBefore == pendingAfter && generation == gen) {
+			return (int32_t)((uint32_t)accum + (uint32_t)pendingBefore + (uint32_t)raw);
+		}
+	}
+}
+
+/**
+ * @brief 获取自上次调用以来的计数变化量 (32位)。
+ */
+int32_t ESP32Encoder::getCountDelta() {
+	uint32_t now = (uint32_t)getCount32();
+	int32_t delta = (int32_t)(now - lastDeltaCount);
+	lastDeltaCount = now;
+	return delta;
 }
 
 /**
@@ -240,13 +354,60 @@ int64_t ESP32Encoder::getDt() {
   return actualCount - oldCount;
 }
 
+/**
+ * @brief 启用边沿时间戳 (在A、B两相引脚上附加GPIO中断)。
+ */
+void ESP32Encoder::enableEdgeTimestamps() {
+	if (!attached) {
+		Serial.println("Encoder not attached, edge timestamps FAIL!");
+		return;
+	}
+	attachInterruptArg(digitalPinToInterrupt(aPinNumber), encoder_edge_isr, this, CHANGE);
+	if (fullQuad) {
+		attachInterruptArg(digitalPinToInterrupt(bPinNumber), encoder_edge_isr, this, CHANGE);
+	}
+}
+
+/**
+ * @brief 计数值被改写后，之前记录的边沿不再对应当前计数，丢弃它。
+ */
+void ESP32Encoder::clearEdge() {
+	edgeGeneration++;
+	edgeSeen = false;
+	edgeGeneration++;
+}
+
+/**
+ * @brief 读取最后一个边沿的计数值与时刻 (generation不变时两者属于同一个边沿)。
+ */
+bool ESP32Encoder::getLastEdge(int32_t *c, uint32_t *timeUs) {
+	for (;;) {
+		uint32_t gen = edgeGeneration;
+		if (gen & 1) {
+			continue;
+		}
+		bool seen = edgeSeen;
+		*c = seen ? edgeCount : getCount32();
+		*timeUs = edgeTimeUs;
+		if (edgeGeneration == gen) {
+			return seen;
+		}
+	}
+}
+
 /**
  * @brief 清零计数器。
  * 同时清零64位软件计数器和16位硬件计数器。
  */
 int64_t ESP32Encoder::clearCount() {
+	generation++;
 	count = 0;
-	return pcnt_counter_clear(unit);
+	count32 = 0;
+	esp_err_t err = pcnt_counter_clear(unit);
+	generation++;
+	lastDeltaCount = 0;
+	clearEdge();
+	return err;
 }
 
 /**
@@ -46,6 +46,10 @@ private:
 
 	static bool attachedInterrupt; // 标记中断是否已附加
 	int64_t getCountRaw(); // 获取原始计数值 (未使用)
+	int32_t pendingLimit(); // 硬件计数器已回零、但中断尚未处理时应补上的极限值
+	void clearEdge();       // 丢弃已记录的边沿 (计数值被改写时调用)
+
+	uint32_t lastDeltaCount = 0; // getCountDelta()上次读到的32位计数
 
     int64_t oldCount; // 上一次的计数值
     int64_t actualCount; // 当前的计数值
@@ -86,10 +90,49 @@ public:
 
 	/**
 	 * @brief 获取当前编码器的计数值。
+	 *
+	 * 硬件计数器与64位软件计数器分开读取，溢出中断可能发生在两次读取之间。
+	 * 这里用generation检测读取期间中断处理函数是否修改过软件计数器(是则重读)，
+	 * 并用中断状态位补上"硬件已回零、中断还没执行"窗口内的极限值，
+	 * 因此不会出现±32766的跳变。
 	 * @return 返回一个64位有符号整数表示的计数值。
 	 */
     int64_t getCount();
 
+	/**
+	 * @brief 获取自上次调用(或clearCount()/setCount())以来的计数变化量。
+	 *
+	 * 与getCount()使用同样的一致性检查，但只读取32位的软件计数器副本，
+	 * 在32位的Xtensa核心上比64位读取更便宜，适合在控制循环中每个周期调用。
+	 * 两次调用之间的变化量必须小于2^31个边沿。
+	 * @return 计数变化量。
+	 */
+	int32_t getCountDelta();
+
+	/**
+	 * @brief 获取计数值的低32位 (与getCount()相同的一致快照，可在中断中调用)。
+	 * @return 32位计数值，约±2^31个边沿后回绕。
+	 */
+	int32_t getCount32();
+
+	/**
+	 * @brief 启用边沿时间戳。
+	 *
+	 * 在A、B两相引脚上附加GPIO中断 (CHANGE)，每个被PCNT计数的边沿到来时
+	 * 记录当时的计数值和时刻 (micros())，供M/T法测速使用。必须在attach*()之后调用。
+	 * 全正交模式下每转1320个边沿，最高转速 (约50 rad/s) 时每个车轮约每秒10500次中断，
+	 * 两个车轮合计约每秒21000次。
+	 */
+	void enableEdgeTimestamps();
+
+	/**
+	 * @brief 读取最后一个被计数的边沿的计数值与时刻 (一致快照)。
+	 * @param edgeCount 边沿之后的32位计数值; 尚未记录到边沿时为当前计数值。
+	 * @param edgeTimeUs 边沿时刻 (micros())。
+	 * @return 尚未记录到任何边沿时返回false。
+	 */
+	bool getLastEdge(int32_t *edgeCount, uint32_t *edgeTimeUs);
+
     /**
      * @brief 获取自上次调用以来的计数值变化量 (未完全实现或使用)。
      */
@@ -141,6 +184,12 @@ public:
 	bool fullQuad = false;   // 标记是否为全正交模式
 	int countsMode = 2;      // 计数模式 (2=半正交, 4=全正交)
 	volatile int64_t count = 0; // 存储编码器计数值的变量 (volatile确保线程安全)
+	volatile int32_t count32 = 0; // count的低32位副本 (32位读写在Xtensa上是原子的)
+	volatile uint32_t generation = 0; // 中断处理函数修改count前后各加1 (奇数表示正在修改)
+	volatile int32_t edgeCount = 0;   // 最后一个边沿之后的计数值 (边沿中断写入)
+	volatile uint32_t edgeTimeUs = 0; // 最后一个边沿的时刻
+	volatile uint32_t edgeGeneration = 0; // 修改edgeCount/edgeTimeUs/edgeSeen前后各加1
+	volatile bool edgeSeen = false;   // 是否已经记录到边沿
 	pcnt_config_t r_enc_config; // PCNT外设的配置结构体
 	static enum puType useInternalWeakPullResistors; // 控制是否使用内部上下拉电阻的静态变量
 };
@@ -6,7 +6,8 @@
  * **程序目标:**
  * 本程序实现了通过WiFi远程控制机器人的功能:
  *   1. 使用PI控制器对两个轮子进行闭环速度控制
- *   2. 通过WiFi接收手机浏览器的控制指令 (前进/后退/左转/右转/停止)
+ *   2. 通过WiFi接收手机浏览器的控制指令 (前进/后退/左转/右转/停止)，
+ *      或通过UDP接收带序号的两轮目标速度
  *   3. 根据接收的指令更新两个轮子的期望速度
  */
 
@@ -15,9 +16,20 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "sdkconfig.h"
+#include "esp_timer.h"
 
 #include "ESP32Encoder.h"
 #include "http_server.hpp"
+#include "triple_buffer.hpp"
+#include "speed_estimator.hpp"
+#include "loop_timing.hpp"
+#include "motor_pwm.hpp"
+#include "diff_drive.hpp"
+#include "odometry.hpp"
+#include "setpoint_profile.h"
+#include "pi_design.h"
+#include "plant_identifier.hpp"
+#include "telemetry_ring.h"
 
 // ==============================================================================
 // 用户可修改参数
@@ -28,25 +40,103 @@
 #define WIFI_MOT_DE_PASSE "12345678" // WiFi热点的密码 (仅支持数字)
 
 // --- PWM参数 ---
-#define PWM_FREQ 1000              // PWM频率
-#define PWM_RESOLUTION 15          // PWM分辨率 (位)
+#define PWM_RESOLUTION 15          // 控制信号满量程 (位)，LEDC输出时也是PWM分辨率
+#define MOTOR_PWM_SYNC 1           // 1: 四路PWM由MCPWM输出，两个电机在同一个载波周期边界一起更新
+                                   // 0: 每个引脚分别analogWrite() (原行为，LEDC，用于对比)
+#define MOTOR_PWM_FREQ_HZ 20000    // MCPWM载波频率 (Hz)，高于听觉范围
+#define MOTOR_PWM_TIMER_HZ 80000000 // MCPWM计数频率 (Hz)，80 MHz组时钟的整数分频
+#define MOTOR_PWM_MIN_BITS 10      // 载波周期内占空比至少要有的分辨率 (位)
+#define PWM_FREQ 1000              // LEDC PWM频率 (MOTOR_PWM_SYNC为0时)
+#ifndef MOTOR_PWM_BENCH
+#define MOTOR_PWM_BENCH 0          // 1: setup()中比较analogWrite()与MCPWM更新两个电机的CPU周期数
+#endif
+#define MOTOR_PWM_BENCH_UPDATES 1000 // 每种方式测量的更新次数
 
 // --- 编码器参数 ---
 #define ENCODER_PPR 11             // 编码器每转脉冲数 (Pulses Per Revolution)
 #define GEAR_RATIO 30              // 减速比
 #define PULSES_PER_REV (ENCODER_PPR * GEAR_RATIO * 4)  // 四倍频
+#define SPEED_ESTIMATOR_MT 1       // 1: M/T法测速 (边沿时间戳)，0: 每周期数边沿 (ΔN/T)
+#define SPEED_TIMEOUT_US 200000    // M/T法: 超过此时间没有边沿则速度为0 (微秒)
 
 // --- 控制参数 ---
-#define CONTROL_PERIOD_MS 50       // 控制周期 (毫秒)
+#ifndef CONTROL_PERIOD_US
+#define CONTROL_PERIOD_US 1000     // 控制周期 (微秒)，1000 (1 kHz) ~ 50000 (20 Hz)，可用-D覆盖
+#endif
+#define CONTROL_BUDGET_PERCENT 20  // 每个周期从唤醒到PWM更新允许占用的CPU比例 (%)，超出的周期计入/metrics
+#ifndef CONTROL_BUDGET_BENCH
+#define CONTROL_BUDGET_BENCH 0     // 1: setup()中测量一个控制周期的CPU周期数，打印各控制频率下的CPU占用率
+#endif
+#define CONTROL_BUDGET_BENCH_CYCLES 1000 // 测量的控制周期数
+#define SETPOINT_NOTIFY 1          // 1: 新的期望速度通过任务通知立即唤醒控制任务并更新PWM
+                                   // 0: 等到下一个控制周期才生效 (原行为，用于对比延迟)
+#define WIFI_POLL_PERIOD_MS 10     // WiFi任务检查手机请求的周期 (毫秒)
+#define WIFI_POLL_PERIOD_WS_MS 1   // 有WebSocket遥控连接时的轮询周期 (毫秒)，指令帧最多等待一个周期
+#define LATENCY_REPORT_PERIOD_MS 5000 // 指令到PWM延迟与两轮速度的打印周期 (毫秒)，0表示不打印
+#define LOOP_TIMING 1              // 1: 记录控制周期的唤醒抖动与各阶段耗时 (http://192.168.4.1/metrics)
+#define CONTROL_TIMER_DRIVEN 1     // 1: 控制任务固定在CONTROL_CORE上，由硬件定时器中断按周期唤醒
+                                   // 0: 所有任务不指定核心，控制任务按tick延时 (原行为，用于对比抖动)
+#define CONTROL_CORE 1             // 控制任务所在核心 (CONTROL_TIMER_DRIVEN为1时)
+#define NETWORK_CORE 0             // WiFi协议栈所在核心，WiFi与UDP任务也放在这里
+#define CONTROL_TIMER_FREQ_HZ 1000000 // 控制周期定时器的计数频率 (1 MHz，每个计数1微秒)
+
+static_assert(CONTROL_PERIOD_US >= 1000 && CONTROL_PERIOD_US <= 50000, "CONTROL_PERIOD_US应在1000 (1 kHz) 到50000 (20 Hz) 之间");
+static_assert(CONTROL_TIMER_DRIVEN || CONTROL_PERIOD_US % 1000 == 0, "按tick延时时控制周期必须是整数毫秒");
+#if MOTOR_PWM_SYNC
+static_assert(motor_pwm_timer_hz_valid(MOTOR_PWM_TIMER_HZ), "MCPWM计数频率必须是80 MHz的1~256分频");
+static_assert(MOTOR_PWM_TIMER_HZ % MOTOR_PWM_FREQ_HZ == 0, "载波周期必须是整数个计数");
+static_assert(motor_pwm_period_ticks(MOTOR_PWM_TIMER_HZ, MOTOR_PWM_FREQ_HZ) <= MOTOR_PWM_MAX_PERIOD_TICKS,
+              "载波频率太低，周期计数值超出16位计数器，请提高MOTOR_PWM_FREQ_HZ或降低MOTOR_PWM_TIMER_HZ");
+static_assert(motor_pwm_resolution_bits(motor_pwm_period_ticks(MOTOR_PWM_TIMER_HZ, MOTOR_PWM_FREQ_HZ)) >=
+              MOTOR_PWM_MIN_BITS, "载波频率太高，占空比分辨率低于MOTOR_PWM_MIN_BITS位");
+#endif
+
+// --- UDP遥控参数 ---
+#define UDP_POLL_PERIOD_MS 2       // UDP任务检查新数据报的周期 (毫秒)
+#define UDP_COMMAND_TIMEOUT_MS 500 // 超过此时间没有收到UDP指令则停车 (毫秒)
 
 // --- PI控制器参数 ---
+#ifndef PI_DESIGN
+#define PI_DESIGN 1                // 1: 由被控对象模型与期望闭环时间常数在编译期设计PI系数 (pi_design.h)
+                                   // 0: 手工整定的KP、KI (原行为，用于对比)
+#endif
+#define TAU 30.20f                 // 被控对象时间常数 (毫秒)，与基础草图的辨识结果相同
+#define G 50.01f                   // 被控对象静态增益 (rad/s，满量程占空比)
+#define TAU_DEZ 10.0f              // 期望闭环时间常数 (毫秒)
+#define PI_DISCRETIZATION PiDiscretization::ZeroOrderHold // 离散化方法: BackwardEuler / Tustin / ZeroOrderHold
+#if !PI_DESIGN
 #define KP 6000.0f                 // 比例增益
 #define KI 8000.0f                 // 积分增益
 #define INTEGRAL_MAX 15000.0f      // 积分限幅
+#endif
+
+// --- 设定点轨迹 (期望速度与PI控制器之间) ---
+#ifndef SETPOINT_PROFILE
+#define SETPOINT_PROFILE 1         // 1: 期望速度经过加速度/加加速度限制后送给PI控制器
+                                   // 0: 期望速度直接作为PI的设定点 (原行为，用于对比)
+                                   // 停车指令 (STOP、掉线保护、UDP超时) 总是立即把参考速度归零
+#endif
+#define PROFILE_MAX_ACCEL 50.0f    // 车轮参考速度的最大变化率 (rad/s²)
+#define PROFILE_MAX_JERK 1000.0f   // 变化率的最大变化率 (rad/s³)，0 -> 2.5 rad/s约需0.1秒
 
 // --- 运动速度参数 ---
-#define FORWARD_SPEED 2.5f         // 前进/后退速度 (rad/s)
-#define TURN_SPEED 1.5f            // 转向速度 (rad/s)
+#define FORWARD_SPEED 2.5f         // 前进/后退时的车轮速度 (rad/s)
+#define TURN_SPEED 1.5f            // 原地转向时的车轮速度 (rad/s)
+#define MAX_WHEEL_SPEED 10.0f      // 车轮速度上限 (rad/s)，超出时两轮按比例缩小，转弯半径不变
+
+// --- 在线辨识TAU与G (结果见http://192.168.4.1/metrics) ---
+#ifndef PLANT_IDENT
+#define PLANT_IDENT 1              // 1: 控制任务把(占空比, 速度)样本交给低优先级任务，用RLS在线辨识两轮的TAU与G
+#endif
+#define PLANT_IDENT_PERIOD_MS 20   // 辨识任务取出样本的周期 (毫秒)
+#define PLANT_IDENT_INTERVAL_US 10000 // 回归间隔 (微秒)，占空比取这段时间内的平均值
+#define PLANT_IDENT_FORGETTING 0.995f // 遗忘因子 (每次回归)，10 ms回归时约记忆2秒
+#define PLANT_IDENT_CONVERGED_PCT 10.0f // τ与G的相对不确定度都低于此值时认为已收敛 (%)
+#define PLANT_IDENT_QUEUE 128      // 样本队列长度 (2的幂)，至少容纳一个辨识周期的样本
+
+// --- 车体几何参数 (请在实物上测量) ---
+#define WHEEL_RADIUS_M 0.0325f     // 车轮半径 (m)
+#define TRACK_WIDTH_M 0.15f        // 两轮接地点之间的距离 (m)
 
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<< 结束修改区域 <<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -73,17 +163,53 @@ const char* ssid     = WIFI_NOM_ROBOT;
 const char* password = WIFI_MOT_DE_PASSE;
 const uint32_t PWM_MAX = (1 << PWM_RESOLUTION) - 1;
 
+#if PI_DESIGN
+// PI系数在编译期由TAU、G、TAU_DEZ与控制周期算出，目标板上只是常数
+constexpr PiCoeffs PI_COEFFS = pi_design(TAU * 1e-3, G, TAU_DEZ * 1e-3, CONTROL_PERIOD_US * 1e-6, PWM_MAX,
+                                         PI_DISCRETIZATION);
+static_assert(pi_design_ok(TAU * 1e-3, G, TAU_DEZ * 1e-3, CONTROL_PERIOD_US * 1e-6, PWM_MAX),
+              "TAU、G、TAU_DEZ应为正数");
+static_assert(pi_design_stable(PI_COEFFS, TAU * 1e-3, G, CONTROL_PERIOD_US * 1e-6, PWM_MAX),
+              "闭环不稳定，请增大TAU_DEZ或改用ZeroOrderHold");
+static_assert(pi_design_fits_pwm(PI_COEFFS, G, MAX_WHEEL_SPEED, PWM_MAX),
+              "从静止阶跃到MAX_WHEEL_SPEED时控制量超出PWM范围，请增大TAU_DEZ");
+constexpr float KP = PI_COEFFS.kp;                 // 比例增益
+constexpr float KI = PI_COEFFS.ki;                 // 积分增益
+constexpr float INTEGRAL_MAX = PWM_MAX / PI_COEFFS.ki; // 积分限幅: 积分项单独不超过满量程
+#endif
+
+#if PLANT_IDENT
+static_assert(PLANT_IDENT_QUEUE * CONTROL_PERIOD_US >= 2 * PLANT_IDENT_PERIOD_MS * 1000,
+              "辨识样本队列应至少容纳两个辨识周期的样本");
+// 每多少个控制周期回归一次 (控制周期长于回归间隔时每个周期都回归)
+constexpr uint32_t PLANT_IDENT_DECIMATION =
+    PLANT_IDENT_INTERVAL_US > CONTROL_PERIOD_US ? PLANT_IDENT_INTERVAL_US / CONTROL_PERIOD_US : 1;
+#endif
+
 // ==============================================================================
 // 全局变量
 // ==============================================================================
 
+// --- 电机输出 (仅由速度控制任务写入) ---
+#if MOTOR_PWM_SYNC
+MotorPwm motorPwm(MOTOR_PWM_TIMER_HZ, MOTOR_PWM_FREQ_HZ, PWM_MAX);
+#endif
+
+// 车体速度与两轮速度的换算及按比例限幅
+DiffDriveKinematics kinematics(WHEEL_RADIUS_M, TRACK_WIDTH_M, MAX_WHEEL_SPEED);
+
+// 里程计 (仅由速度控制任务更新，其他任务读取poseBuffer中的快照)
+Odometry odometry(PULSES_PER_REV, WHEEL_RADIUS_M, TRACK_WIDTH_M);
+
 // --- 编码器对象 ---
 ESP32Encoder encodeur_gauche;
 ESP32Encoder encodeur_droit;
 
-// --- 速度控制变量 ---
-volatile float desiredSpeedLeft = 0.0f;    // 左轮期望速度 (rad/s)
-volatile float desiredSpeedRight = 0.0f;   // 右轮期望速度 (rad/s)
+// --- M/T法速度估计 ---
+MTSpeedEstimator estimateur_gauche(PULSES_PER_REV, SPEED_TIMEOUT_US);
+MTSpeedEstimator estimateur_droit(PULSES_PER_REV, SPEED_TIMEOUT_US);
+
+// --- 速度控制变量 (仅由速度控制任务使用) ---
 float measuredSpeedLeft = 0.0f;            // 左轮测量速度
 float measuredSpeedRight = 0.0f;           // 右轮测量速度
 float controlSignalLeft = 0.0f;            // 左轮控制信号
@@ -91,11 +217,106 @@ float controlSignalRight = 0.0f;           // 右轮控制信号
 float integralLeft = 0.0f;                 // 左轮积分项
 float integralRight = 0.0f;                // 右轮积分项
 
+// --- 设定点轨迹 (仅由速度控制任务使用) ---
+JerkLimitedProfile profileLeft(PROFILE_MAX_ACCEL, PROFILE_MAX_JERK);
+JerkLimitedProfile profileRight(PROFILE_MAX_ACCEL, PROFILE_MAX_JERK);
+
 // --- 当前指令 ---
 volatile int currentOrder = ORDER_ROBOT_STOP;
 
-// --- 互斥锁 ---
-portMUX_TYPE speedMutex = portMUX_INITIALIZER_UNLOCKED;
+// --- 任务间共享的快照 ---
+
+/**
+ * @struct SpeedSetpoint
+ * @brief 期望速度 (由WiFi/UDP任务写入，速度控制任务读取)
+ */
+struct SpeedSetpoint {
+  float left;         // 左轮期望速度 (rad/s)
+  float right;        // 右轮期望速度 (rad/s)
+  uint32_t stampUs;   // 设置时刻 (用于统计指令到PWM的延迟)
+  bool stop;          // 停车指令 (STOP、掉线保护、指令超时): 参考速度不经过轨迹，立即归零
+};
+
+/**
+ * @struct ControlSnapshot
+ * @brief 速度控制任务每次更新PWM后发布的状态 (供其他任务读取)
+ */
+struct ControlSnapshot {
+  float targetLeft;       // 左轮期望速度 (rad/s)
+  float targetRight;      // 右轮期望速度 (rad/s)
+  float measuredLeft;     // 左轮测量速度 (rad/s)
+  float measuredRight;    // 右轮测量速度 (rad/s)
+  float controlLeft;      // 左轮控制信号
+  float controlRight;     // 右轮控制信号
+  uint32_t latencyCount;  // 累计统计的指令数
+  uint32_t latencyMaxUs;  // 指令到PWM的最大延迟 (微秒)
+  uint64_t latencySumUs;  // 指令到PWM的延迟总和 (微秒)
+};
+
+// 无锁快照: 控制任务读写它们时不关中断、不等待其他任务
+TripleBuffer<SpeedSetpoint> setpointBuffer;
+TripleBuffer<ControlSnapshot> controlSnapshotBuffer;
+TripleBuffer<OdometryPose> poseBuffer;
+
+#if PLANT_IDENT
+/**
+ * @struct IdentSample
+ * @brief 在线辨识的样本 (控制任务每个周期放入identQueue，辨识任务取出)
+ */
+struct IdentSample {
+  uint32_t seq;       // 控制周期序号，不连续 (队列满丢弃) 时辨识器重新开始
+  float dutyLeft;     // 上一周期施加的归一化占空比 (-1..1)
+  float dutyRight;
+  float speedLeft;    // 本周期的测量速度 (rad/s)
+  float speedRight;
+};
+
+/**
+ * @struct PlantEstimates
+ * @brief 辨识任务发布的两轮估计值
+ */
+struct PlantEstimates {
+  PlantEstimate left;
+  PlantEstimate right;
+};
+
+TelemetryRing<IdentSample, PLANT_IDENT_QUEUE> identQueue;  // 控制任务入队 (满时丢弃，不等待)
+TripleBuffer<PlantEstimates> plantEstimateBuffer;
+#endif
+
+// 期望速度有两个写者 (WiFi任务与UDP任务)，写者之间用互斥量串行化; 控制任务不使用它
+SemaphoreHandle_t setpointWriteMutex = NULL;
+
+/**
+ * @enum SetpointSource
+ * @brief 期望速度的写者
+ */
+enum SetpointSource {
+  SETPOINT_SOURCE_PHONE,  // 手机 (HTTP页面或WebSocket)
+  SETPOINT_SOURCE_UDP     // UDP遥控指令
+};
+SetpointSource setpointSource = SETPOINT_SOURCE_PHONE;  // 最后写入期望速度的来源 (由setpointWriteMutex保护)
+
+// --- 控制周期计时 (控制任务写，WiFi任务的/metrics读) ---
+LoopTimingRecorder loopTiming(CONTROL_PERIOD_US);
+
+// --- 控制任务句柄 (用于任务通知) ---
+TaskHandle_t speedControlTaskHandle = NULL;
+
+#if CONTROL_TIMER_DRIVEN
+// --- 控制周期定时器 (中断只写到期次数，控制任务只读) ---
+hw_timer_t *controlTimer = NULL;
+volatile uint32_t controlTimerTicks = 0;
+
+// 网络任务与WiFi协议栈共用一个核心，控制任务独占另一个核心，优先级高于同核心的其他应用任务
+#define NETWORK_TASK_CORE NETWORK_CORE
+#define CONTROL_TASK_CORE CONTROL_CORE
+#define CONTROL_TASK_PRIORITY 10
+#else
+#define NETWORK_TASK_CORE tskNO_AFFINITY
+#define CONTROL_TASK_CORE tskNO_AFFINITY
+#define CONTROL_TASK_PRIORITY 2
+#endif
 
 // ==============================================================================
 // 电机控制函数
@@ -147,10 +368,76 @@ void setRightMotorPWM(int32_t pwmValue) {
  * @brief 停止所有电机
  */
 void stopAllMotors() {
+#if MOTOR_PWM_SYNC
+  motorPwm.stop();
+#else
   analogWrite(MLF, 0);
   analogWrite(MLB, 0);
   analogWrite(MRF, 0);
   analogWrite(MRB, 0);
+#endif
+}
+
+#if MOTOR_PWM_BENCH
+/**
+ * @brief 测量更新两个电机PWM的CPU周期数 (占空比为0，电机保持停止)
+ */
+template <typename Update>
+void measure_motor_update(const char *name, Update update) {
+  uint64_t sumCycles = 0;
+  uint32_t maxCycles = 0;
+  for (int i = 0; i < MOTOR_PWM_BENCH_UPDATES; i++) {
+    uint32_t t0 = ESP.getCycleCount();
+    update(0, 0);
+    uint32_t cycles = ESP.getCycleCount() - t0;
+    sumCycles += cycles;
+    if (cycles > maxCycles) maxCycles = cycles;
+  }
+  float mean = (float)sumCycles / MOTOR_PWM_BENCH_UPDATES;
+  Serial.printf("  %-26s mean %8.1f cycles (%.2f us), max %u cycles\n", name, mean,
+                mean / ESP.getCpuFreqMHz(), (unsigned)maxCycles);
+}
+#endif
+
+/**
+ * @brief 初始化四路电机输出 (MOTOR_PWM_BENCH为1时先在同样的引脚上测量analogWrite())
+ */
+void init_motor_outputs() {
+#if MOTOR_PWM_BENCH
+  Serial.printf("Motor PWM bench: %d updates of both wheels\n", MOTOR_PWM_BENCH_UPDATES);
+  init_motor_pwm(MLF);
+  init_motor_pwm(MLB);
+  init_motor_pwm(MRF);
+  init_motor_pwm(MRB);
+  measure_motor_update("analogWrite x4 (LEDC)", [](int32_t left, int32_t right) {
+    setLeftMotorPWM(left);
+    setRightMotorPWM(right);
+  });
+  // 把引脚交给下面的MCPWM (或重新绑定LEDC)
+  ledcDetach(MLF);
+  ledcDetach(MLB);
+  ledcDetach(MRF);
+  ledcDetach(MRB);
+#endif
+
+#if MOTOR_PWM_SYNC
+  if (!motorPwm.begin(MLF, MLB, MRF, MRB)) {
+    Serial.println("[ERROR] MCPWM init failed");
+    return;
+  }
+  Serial.printf("[INFO] MCPWM carrier %d Hz, %u steps (%u bits)\n", MOTOR_PWM_FREQ_HZ,
+                (unsigned)motorPwm.periodTicks(), motor_pwm_resolution_bits(motorPwm.periodTicks()));
+#if MOTOR_PWM_BENCH
+  measure_motor_update("MotorPwm::write (MCPWM)", [](int32_t left, int32_t right) {
+    motorPwm.write(left, right);
+  });
+#endif
+#else
+  init_motor_pwm(MLF);
+  init_motor_pwm(MLB);
+  init_motor_pwm(MRF);
+  init_motor_pwm(MRB);
+#endif
 }
 
 // ==============================================================================
@@ -160,12 +447,12 @@ void stopAllMotors() {
 /**
  * @brief 计算角速度 (rad/s)
  * @param pulseCount 脉冲数
- * @param periodMs 测量周期 (毫秒)
+ * @param periodUs 测量周期 (微秒)
  * @return 角速度 (rad/s)
  */
-float calculateAngularVelocity(int64_t pulseCount, uint32_t periodMs) {
+float calculateAngularVelocity(int64_t pulseCount, uint32_t periodUs) {
   float revolutions = (float)pulseCount / PULSES_PER_REV;
-  float timeSeconds = (float)periodMs / 1000.0f;
+  float timeSeconds = (float)periodUs * 1e-6f;
   return (revolutions * 2.0f * PI) / timeSeconds;
 }
 
@@ -175,6 +462,10 @@ float calculateAngularVelocity(int64_t pulseCount, uint32_t periodMs) {
 
 /**
  * @brief PI控制器
+ *
+ * 积分按dt累加，等价于基础草图的离散PI u[k] = u[k-1] + R0·e[k] + R1·e[k-1]，
+ * 其中R0 = KP + KI·dt、R1 = -KP。PI_DESIGN为1时KP、KI由pi_design()按CONTROL_PERIOD_US设计。
+ *
  * @param setpoint 设定值
  * @param measured 测量值
  * @param integral 积分项指针
@@ -203,61 +494,449 @@ float piController(float setpoint, float measured, float *integral, float dt) {
 // WiFi指令处理函数
 // ==============================================================================
 
+/**
+ * @brief 唤醒控制任务，新的期望速度立即作用到PWM (SETPOINT_NOTIFY为0时为空)
+ */
+inline void notify_setpoint() {
+#if SETPOINT_NOTIFY
+  if (speedControlTaskHandle != NULL) {
+    xTaskNotifyGive(speedControlTaskHandle);
+  }
+#endif
+}
+
+/**
+ * @brief 设置两个轮子的期望速度 (供速度控制任务读取)
+ * @param leftSpeed 左轮期望速度 (rad/s)
+ * @param rightSpeed 右轮期望速度 (rad/s)
+ * @param source 写者 (记录下来供stop_if_last_writer()判断)
+ */
+void set_desired_speeds(float leftSpeed, float rightSpeed, SetpointSource source) {
+  // 所有来源的轮速都经过按比例限幅，超速时保持两轮速度之比 (即行驶路径)
+  WheelSpeeds wheels = kinematics.saturate({leftSpeed, rightSpeed});
+  SpeedSetpoint setpoint = {wheels.left, wheels.right, (uint32_t)micros(), false};
+
+  // 发布新的期望速度 (互斥量只在写者之间竞争)
+  xSemaphoreTake(setpointWriteMutex, portMAX_DELAY);
+  setpointBuffer.write(setpoint);
+  setpointSource = source;
+  xSemaphoreGive(setpointWriteMutex);
+
+  notify_setpoint();
+}
+
+/**
+ * @brief 按车体速度设置两个轮子的期望速度
+ * @param linear 线速度 (m/s，前进为正)
+ * @param angular 角速度 (rad/s，左转为正)
+ * @param source 写者
+ */
+void set_desired_twist(float linear, float angular, SetpointSource source) {
+  WheelSpeeds wheels = kinematics.toWheels({linear, angular});
+  set_desired_speeds(wheels.left, wheels.right, source);
+}
+
+/**
+ * @brief 停车: 期望速度设为0，控制任务复位轨迹，不按加速度限制减速
+ * @param source 写者
+ */
+void stop_desired_speeds(SetpointSource source) {
+  SpeedSetpoint setpoint = {0.0f, 0.0f, (uint32_t)micros(), true};
+  xSemaphoreTake(setpointWriteMutex, portMAX_DELAY);
+  setpointBuffer.write(setpoint);
+  setpointSource = source;
+  xSemaphoreGive(setpointWriteMutex);
+
+  notify_setpoint();
+}
+
+/**
+ * @brief 指令超时的自动停车: 只有期望速度最后由source写入时才停车 (同stop_desired_speeds())
+ * @param source 超时的写者
+ * @return 是否停车 (之后其他写者设置过期望速度时保留它的指令)
+ */
+bool stop_if_last_writer(SetpointSource source) {
+  SpeedSetpoint setpoint = {0.0f, 0.0f, (uint32_t)micros(), true};
+  xSemaphoreTake(setpointWriteMutex, portMAX_DELAY);
+  bool stop = setpointSource == source;
+  if (stop) setpointBuffer.write(setpoint);
+  xSemaphoreGive(setpointWriteMutex);
+
+  if (stop) notify_setpoint();
+  return stop;
+}
+
+/**
+ * @brief 打印指令到PWM延迟统计与两轮速度 (在WiFi任务中调用，避免串口输出阻塞控制任务)
+ */
+void report_control_status() {
+  static uint32_t lastCount = 0;
+  static uint64_t lastSumUs = 0;
+
+  ControlSnapshot snapshot;
+  controlSnapshotBuffer.read(&snapshot);
+  uint32_t count = snapshot.latencyCount - lastCount;
+  uint64_t sumUs = snapshot.latencySumUs - lastSumUs;
+  lastCount = snapshot.latencyCount;
+  lastSumUs = snapshot.latencySumUs;
+
+  if (count > 0) {
+    Serial.printf("[LATENCY] command->PWM n=%u mean=%u us max=%u us\n",
+                  (unsigned)count, (unsigned)(sumUs / count), (unsigned)snapshot.latencyMaxUs);
+    Serial.printf("[SPEED] L: %.2f/%.2f, R: %.2f/%.2f\n",
+                  snapshot.targetLeft, snapshot.measuredLeft,
+                  snapshot.targetRight, snapshot.measuredRight);
+  }
+  OdometryPose pose;
+  poseBuffer.read(&pose);
+  Serial.printf("[POSE] x=%.3f m y=%.3f m theta=%.1f deg, distance %.2f m\n",
+                pose.x, pose.y, pose.theta * (180.0f / PI), pose.distance);
+#if PLANT_IDENT
+  PlantEstimates plant;
+  plantEstimateBuffer.read(&plant);
+  // 还没有估计值时tau与G为NaN (打印为nan)
+  Serial.printf("[PLANT] L: tau %.1f ms G %.2f%s, R: tau %.1f ms G %.2f%s (model tau %.1f ms G %.2f)\n",
+                plant.left.tauMs, plant.left.gain, plant.left.converged ? "" : " (not converged)",
+                plant.right.tauMs, plant.right.gain, plant.right.converged ? "" : " (not converged)", TAU, G);
+#endif
+#if LOOP_TIMING
+  static LatencyHistogram::Snapshot jitter, busy, cycle;  // 每个约800字节，不放在WiFi任务的栈上
+  loopTiming.wakeJitterUs().snapshot(&jitter);
+  loopTiming.busyUs().snapshot(&busy);
+  loopTiming.cycleCycles().snapshot(&cycle);
+  float cyclesPerUs = (float)ESP.getCpuFreqMHz();
+  Serial.printf("[LOOP] n=%u overruns=%u jitter p99=%u max=%u us, busy p99=%u max=%u us\n",
+                (unsigned)loopTiming.iterations(), (unsigned)loopTiming.overruns(),
+                (unsigned)jitter.percentile(0.99), (unsigned)jitter.max,
+                (unsigned)busy.percentile(0.99), (unsigned)busy.max);
+  Serial.printf("[LOOP] cycle p99=%.1f max=%.1f us (%.2f%% of %u us), budget misses=%u\n",
+                cycle.percentile(0.99) / cyclesPerUs, cycle.max / cyclesPerUs,
+                100.0f * cycle.percentile(0.99) / cyclesPerUs / CONTROL_PERIOD_US,
+                (unsigned)CONTROL_PERIOD_US, (unsigned)loopTiming.budgetMisses());
+#endif
+}
+
+#if PLANT_IDENT
+/**
+ * @brief 追加一个辨识结果的类型声明与两轮数值; 还没有估计值 (NaN) 时按Prometheus文本格式写作NaN
+ */
+void append_plant_gauge(char *buf, size_t size, size_t *len, const char *name, float left, float right,
+                        int decimals) {
+  int n = snprintf(buf + *len, size - *len, "# TYPE %s gauge\n", name);
+  if (n > 0 && (size_t)n < size - *len) *len += n;
+  else if (*len < size) buf[*len] = '\0';
+  const struct {
+    const char *wheel;
+    float value;
+  } wheels[] = {{"left", left}, {"right", right}};
+  for (const auto &w : wheels) {
+    int n = isnan(w.value)
+                ? snprintf(buf + *len, size - *len, "%s{wheel=\"%s\"} NaN\n", name, w.wheel)
+                : snprintf(buf + *len, size - *len, "%s{wheel=\"%s\"} %.*f\n", name, w.wheel, decimals, w.value);
+    if (n > 0 && (size_t)n < size - *len) *len += n;  // 放不下时省略这一行
+    else if (*len < size) buf[*len] = '\0';
+  }
+}
+#endif
+
+/**
+ * @brief 生成/metrics的正文 (在WiFi任务中由HTTP服务器调用): 控制周期计时、里程计位姿与在线辨识结果。
+ */
+size_t format_metrics(char *buf, size_t size, void *ctx) {
+  size_t len = 0;
+#if LOOP_TIMING
+  const LoopTimingRecorder *timing = (const LoopTimingRecorder *)ctx;
+  len = timing->format("speed_loop", ESP.getCpuFreqMHz(), buf, size);
+#endif
+  OdometryPose pose;
+  poseBuffer.read(&pose);
+  int n = snprintf(buf + len, size - len,
+                   "# TYPE odometry_x_m gauge\nodometry_x_m %.4f\n"
+                   "# TYPE odometry_y_m gauge\nodometry_y_m %.4f\n"
+                   "# TYPE odometry_theta_rad gauge\nodometry_theta_rad %.4f\n"
+                   "# TYPE odometry_distance_m gauge\nodometry_distance_m %.3f\n"
+                   "# TYPE odometry_updates_total counter\nodometry_updates_total %u\n",
+                   pose.x, pose.y, pose.theta, pose.distance, (unsigned)pose.updates);
+  if (n > 0 && (size_t)n < size - len) len += n;  // 放不下时整段省略
+  else if (len < size) buf[len] = '\0';
+#if PLANT_IDENT
+  PlantEstimates plant;
+  plantEstimateBuffer.read(&plant);
+  append_plant_gauge(buf, size, &len, "plant_tau_ms", plant.left.tauMs, plant.right.tauMs, 2);
+  append_plant_gauge(buf, size, &len, "plant_tau_uncertainty_pct", plant.left.tauErrPct, plant.right.tauErrPct, 2);
+  append_plant_gauge(buf, size, &len, "plant_gain", plant.left.gain, plant.right.gain, 3);
+  append_plant_gauge(buf, size, &len, "plant_gain_uncertainty_pct", plant.left.gainErrPct, plant.right.gainErrPct, 2);
+  append_plant_gauge(buf, size, &len, "plant_residual_rms", plant.left.residualRms, plant.right.residualRms, 4);
+  n = snprintf(buf + len, size - len,
+               "# TYPE plant_converged gauge\n"
+               "plant_converged{wheel=\"left\"} %d\nplant_converged{wheel=\"right\"} %d\n"
+               "# TYPE plant_updates_total counter\n"
+               "plant_updates_total{wheel=\"left\"} %u\nplant_updates_total{wheel=\"right\"} %u\n",
+               plant.left.converged ? 1 : 0, plant.right.converged ? 1 : 0, (unsigned)plant.left.updates,
+               (unsigned)plant.right.updates);
+  if (n > 0 && (size_t)n < size - len) len += n;
+  else if (len < size) buf[len] = '\0';
+  n = snprintf(buf + len, size - len,
+               "# TYPE plant_model_tau_ms gauge\nplant_model_tau_ms %.2f\n"
+               "# TYPE plant_model_gain gauge\nplant_model_gain %.3f\n"
+               "# TYPE plant_samples_dropped_total counter\nplant_samples_dropped_total %u\n",
+               TAU, G, (unsigned)identQueue.dropped());
+  if (n > 0 && (size_t)n < size - len) len += n;
+  else if (len < size) buf[len] = '\0';
+#endif
+  return len;
+}
+
+/**
+ * @brief 离散指令对应的车体速度 (线速度m/s，角速度rad/s)
+ *
+ * 由车轮速度换算，与原来直接设置两轮速度的动作完全相同:
+ * 前进/后退两轮同为±FORWARD_SPEED，转向两轮为∓TURN_SPEED。
+ */
+struct OrderPreset {
+  int order;
+  float linear;
+  float angular;
+  const char *name;
+};
+
+const OrderPreset ORDER_PRESETS[] = {
+  {ORDER_ROBOT_FORWARD, FORWARD_SPEED * WHEEL_RADIUS_M, 0.0f, "Forward"},
+  {ORDER_ROBOT_BACKWARD, -FORWARD_SPEED * WHEEL_RADIUS_M, 0.0f, "Backward"},
+  {ORDER_ROBOT_LEFT, 0.0f, 2.0f * TURN_SPEED * WHEEL_RADIUS_M / TRACK_WIDTH_M, "Turn Left"},
+  {ORDER_ROBOT_RIGHT, 0.0f, -2.0f * TURN_SPEED * WHEEL_RADIUS_M / TRACK_WIDTH_M, "Turn Right"},
+};
+
 /**
  * @brief 根据WiFi接收的指令更新两个轮子的期望速度
  * @param order 从communicate_with_phone()接收到的指令
  * 
  * 指令与动作对应关系:
- *   - ORDER_ROBOT_FORWARD:  两轮同向正转 -> 前进
- *   - ORDER_ROBOT_BACKWARD: 两轮同向反转 -> 后退
- *   - ORDER_ROBOT_LEFT:     左轮减速/反转，右轮正转 -> 左转
- *   - ORDER_ROBOT_RIGHT:    左轮正转，右轮减速/反转 -> 右转
- *   - ORDER_ROBOT_STOP:     两轮停止
+ *   - ORDER_ROBOT_FORWARD/BACKWARD/LEFT/RIGHT: ORDER_PRESETS中的车体速度
+ *   - ORDER_ROBOT_STOP:     两轮停止 (参考速度立即归零，不经过加速度限制)
+ *   - ORDER_ROBOT_SPEEDS:   两轮速度直接取自手机 (WebSocket)
+ *   - ORDER_ROBOT_TWIST:    线速度与角速度取自手机摇杆 (WebSocket)
  */
 void update_desired_speeds(int order) {
-  float leftSpeed = 0.0f;
-  float rightSpeed = 0.0f;
-  
+  float linear = 0.0f;
+  float angular = 0.0f;
+
   switch (order) {
-    case ORDER_ROBOT_FORWARD:
-      leftSpeed = FORWARD_SPEED;
-      rightSpeed = FORWARD_SPEED;
-      Serial.println("[CMD] Forward");
-      break;
-      
-    case ORDER_ROBOT_BACKWARD:
-      leftSpeed = -FORWARD_SPEED;
-      rightSpeed = -FORWARD_SPEED;
-      Serial.println("[CMD] Backward");
-      break;
-      
-    case ORDER_ROBOT_LEFT:
-      leftSpeed = -TURN_SPEED;
-      rightSpeed = TURN_SPEED;
-      Serial.println("[CMD] Turn Left");
-      break;
-      
-    case ORDER_ROBOT_RIGHT:
-      leftSpeed = TURN_SPEED;
-      rightSpeed = -TURN_SPEED;
-      Serial.println("[CMD] Turn Right");
+    case ORDER_ROBOT_SPEEDS: {
+      // 摇杆每秒发送几十次，这里不打印以免串口阻塞WiFi任务
+      float leftSpeed, rightSpeed;
+      get_phone_wheel_speeds(&leftSpeed, &rightSpeed);
+      set_desired_speeds(leftSpeed, rightSpeed, SETPOINT_SOURCE_PHONE);
+      return;
+    }
+
+    case ORDER_ROBOT_TWIST:
+      get_phone_twist(&linear, &angular);
       break;
-      
-    case ORDER_ROBOT_STOP:
-    default:
-      leftSpeed = 0.0f;
-      rightSpeed = 0.0f;
-      Serial.println("[CMD] Stop");
+
+    default: {
+      const OrderPreset *preset = NULL;
+      for (const OrderPreset &candidate : ORDER_PRESETS) {
+        if (candidate.order == order) preset = &candidate;
+      }
+      if (preset != NULL) {
+        linear = preset->linear;
+        angular = preset->angular;
+        Serial.printf("[CMD] %s\n", preset->name);
+      } else {
+        Serial.println("[CMD] Stop");  // ORDER_ROBOT_STOP (包括WebSocket掉线保护) 以及未知指令
+        stop_desired_speeds(SETPOINT_SOURCE_PHONE);
+        return;
+      }
       break;
+    }
   }
-  
-  // 使用临界区保护共享变量
-  portENTER_CRITICAL(&speedMutex);
-  desiredSpeedLeft = leftSpeed;
-  desiredSpeedRight = rightSpeed;
-  portEXIT_CRITICAL(&speedMutex);
+
+  set_desired_twist(linear, angular, SETPOINT_SOURCE_PHONE);
+}
+
+// ==============================================================================
+// 控制周期计时
+// ==============================================================================
+
+/**
+ * @brief 周期开始 (只在按周期唤醒时调用; LOOP_TIMING为0时为空)
+ */
+inline void loop_timing_wake() {
+#if LOOP_TIMING
+  loopTiming.wake(esp_timer_get_time(), ESP.getCycleCount());
+#endif
+}
+
+/**
+ * @brief 一个阶段完成 (LOOP_TIMING为0时为空)
+ */
+inline void loop_timing_mark(LoopPhase phase) {
+#if LOOP_TIMING
+  loopTiming.phaseDone(phase, esp_timer_get_time(), ESP.getCycleCount());
+#else
+  (void)phase;
+#endif
+}
+
+#if CONTROL_TIMER_DRIVEN
+/**
+ * @brief 控制周期定时器中断: 记录到期次数并唤醒控制任务
+ */
+void IRAM_ATTR onControlTimer() {
+  controlTimerTicks = controlTimerTicks + 1;
+  BaseType_t higherPriorityTaskWoken = pdFALSE;
+  vTaskNotifyGiveFromISR(speedControlTaskHandle, &higherPriorityTaskWoken);
+  if (higherPriorityTaskWoken) {
+    portYIELD_FROM_ISR();
+  }
+}
+#endif
+
+// ==============================================================================
+// 控制周期的各阶段
+// ==============================================================================
+
+/**
+ * @brief 测量阶段: 读取编码器并更新两轮的测量速度
+ */
+void sense_wheel_speeds() {
+#if SPEED_ESTIMATOR_MT
+  // 由两个周期各自最后一个边沿的计数值与时刻计算测量速度
+  int32_t edgeCount;
+  uint32_t edgeTimeUs;
+  uint32_t nowUs = micros();
+  bool hasEdge = encodeur_gauche.getLastEdge(&edgeCount, &edgeTimeUs);
+  measuredSpeedLeft = estimateur_gauche.update(hasEdge, edgeCount, edgeTimeUs, nowUs);
+  hasEdge = encodeur_droit.getLastEdge(&edgeCount, &edgeTimeUs);
+  measuredSpeedRight = estimateur_droit.update(hasEdge, edgeCount, edgeTimeUs, nowUs);
+#else
+  // 读取上一周期以来的编码器增量 (一致快照，不受溢出中断影响)
+  // 注意: 周期越短，每个周期的边沿数越少，ΔN/T的量化误差越大 (1 kHz时一个边沿约4.8 rad/s)
+  int32_t deltaLeft = encodeur_gauche.getCountDelta();
+  int32_t deltaRight = encodeur_droit.getCountDelta();
+
+  // 计算测量速度
+  measuredSpeedLeft = calculateAngularVelocity(deltaLeft, CONTROL_PERIOD_US);
+  measuredSpeedRight = calculateAngularVelocity(deltaRight, CONTROL_PERIOD_US);
+#endif
+
+  // 由64位计数值积分位姿 (快照在本周期结束时发布)
+  odometry.update(encodeur_gauche.getCount(), encodeur_droit.getCount());
+}
+
+/**
+ * @brief 计算阶段: PI控制器计算两轮的控制信号
+ * @param setpoint 期望速度
+ * @param dt 积分步长 (秒)，提前唤醒时为0
+ * @param profileDt 轨迹推进的时间 (秒): 按周期唤醒时为本周期剩余的时间，提前唤醒时为距上次推进的时间
+ * @return PI的设定点是否已经朝新的期望速度变化 (或已经等于它)，即本次PWM是否反映了期望速度
+ *
+ * SETPOINT_PROFILE为1时PI的设定点是受限的参考速度。提前唤醒时轨迹按实际经过的时间推进，
+ * 新的期望速度立即开始按轨迹生效; 一个周期内轨迹推进的总时间仍然是一个控制周期。
+ */
+bool compute_wheel_controls(const SpeedSetpoint &setpoint, float dt, float profileDt) {
+#if SETPOINT_PROFILE
+  float referenceLeft = profileLeft.update(setpoint.left, profileDt);
+  float referenceRight = profileRight.update(setpoint.right, profileDt);
+  bool applied = profileDt > 0.0f || (referenceLeft == setpoint.left && referenceRight == setpoint.right);
+#else
+  (void)profileDt;
+  float referenceLeft = setpoint.left;
+  float referenceRight = setpoint.right;
+  bool applied = true;
+#endif
+  controlSignalLeft = piController(referenceLeft, measuredSpeedLeft, &integralLeft, dt);
+  controlSignalRight = piController(referenceRight, measuredSpeedRight, &integralRight, dt);
+  return applied;
+}
+
+/**
+ * @brief 输出阶段: 把控制信号写到两个电机的PWM
+ */
+void apply_wheel_controls() {
+#if MOTOR_PWM_SYNC
+  motorPwm.write((int32_t)controlSignalLeft, (int32_t)controlSignalRight);
+#else
+  setLeftMotorPWM((int32_t)controlSignalLeft);
+  setRightMotorPWM((int32_t)controlSignalRight);
+#endif
 }
 
+#if PLANT_IDENT
+/**
+ * @brief 归一化占空比 (-1..1): 控制信号按PWM输出时的限幅
+ */
+inline float wheel_duty(float control) {
+  if (control > (float)PWM_MAX) control = (float)PWM_MAX;
+  if (control < -(float)PWM_MAX) control = -(float)PWM_MAX;
+  return control / PWM_MAX;
+}
+
+/**
+ * @brief 记录辨识样本 (PWM更新之后调用，不在测量到输出的路径上)
+ * @param periodic 是否按周期唤醒 (只有这时才有新的测量速度)
+ *
+ * M/T法的速度是上一周期内的平均值，相对本周期的占空比滞后约一个周期，所以与上一周期最后施加的
+ * 占空比配对 (与本周期的配对时τ偏大约5%)。队列满时样本被丢弃，控制任务从不等待辨识任务。
+ */
+void record_ident_sample(bool periodic) {
+  static uint32_t seq = 0;
+  static float dutyLeft = 0.0f, dutyRight = 0.0f;  // 上一次施加的占空比
+  if (periodic) {
+    identQueue.push({seq++, dutyLeft, dutyRight, measuredSpeedLeft, measuredSpeedRight});
+  }
+  dutyLeft = wheel_duty(controlSignalLeft);
+  dutyRight = wheel_duty(controlSignalRight);
+}
+#endif
+
+#if CONTROL_BUDGET_BENCH
+/**
+ * @brief 测量一个完整控制周期 (测量、计算、输出) 的CPU周期数，打印各控制频率下的CPU占用率。
+ *
+ * 在setup()中、创建任务之前运行 (与控制任务在同一个核心上)，期望速度为0，电机保持停止。
+ * 结果与CONTROL_BUDGET_PERCENT比较: 最坏情况超出预算的频率不应作为CONTROL_PERIOD_US。
+ */
+void run_control_budget_bench() {
+  static const uint32_t RATES_HZ[] = {20, 50, 100, 200, 500, 1000};
+  const SpeedSetpoint stop = {0.0f, 0.0f, 0, false};
+  const float dt = CONTROL_PERIOD_US * 1e-6f;
+  uint64_t sumCycles = 0;
+  uint32_t maxCycles = 0;
+
+  for (int i = 0; i < CONTROL_BUDGET_BENCH_CYCLES; i++) {
+    uint32_t t0 = ESP.getCycleCount();
+    sense_wheel_speeds();
+    compute_wheel_controls(stop, dt, dt);
+    apply_wheel_controls();
+    uint32_t cycles = ESP.getCycleCount() - t0;
+    sumCycles += cycles;
+    if (cycles > maxCycles) maxCycles = cycles;
+  }
+  estimateur_gauche.reset();
+  estimateur_droit.reset();
+  odometry.reset(encodeur_gauche.getCount(), encodeur_droit.getCount());
+  profileLeft.reset(0.0f);
+  profileRight.reset(0.0f);
+
+  float cyclesPerUs = (float)ESP.getCpuFreqMHz();
+  float meanUs = (float)sumCycles / CONTROL_BUDGET_BENCH_CYCLES / cyclesPerUs;
+  float maxUs = maxCycles / cyclesPerUs;
+  Serial.printf("Control cycle bench: %d cycles, mean %.2f us, max %.2f us (%u MHz)\n",
+                CONTROL_BUDGET_BENCH_CYCLES, meanUs, maxUs, (unsigned)ESP.getCpuFreqMHz());
+  Serial.printf("  %7s %9s %9s %9s  budget %d%%\n", "rate Hz", "period us", "CPU mean", "CPU max",
+                CONTROL_BUDGET_PERCENT);
+  for (uint32_t rate : RATES_HZ) {
+    float periodUs = 1e6f / rate;
+    float maxPercent = 100.0f * maxUs / periodUs;
+    Serial.printf("  %7u %9.0f %8.3f%% %8.3f%%  %s%s\n", (unsigned)rate, periodUs, 100.0f * meanUs / periodUs,
+                  maxPercent, maxPercent <= CONTROL_BUDGET_PERCENT ? "ok" : "OVER",
+                  (uint32_t)periodUs == CONTROL_PERIOD_US ? "  <- CONTROL_PERIOD_US" : "");
+  }
+}
+#endif
+
 // ==============================================================================
 // FreeRTOS任务
 // ==============================================================================
@@ -269,81 +948,223 @@ void update_desired_speeds(int order) {
 void wifiCommunicationTask(void *pvParameters) {
   Serial.println("[TASK] WiFi communication task started");
   
-  int lastOrder = ORDER_ROBOT_STOP;
+  uint32_t lastReportMs = millis();
   
   while (true) {
     // 调用WiFi通信函数
     int order = communicate_with_phone();
     
-    // 如果接收到有效指令且与上次不同，则更新速度
+    // 每个有效指令都重新写入期望速度: UDP任务可能在两次相同的手机指令之间改写过它
     if (order != 0 && order != 1) {  // 0表示无客户端，1表示有活动但无有效指令
-      if (order != lastOrder) {
-        update_desired_speeds(order);
-        lastOrder = order;
-        currentOrder = order;
-      }
+      update_desired_speeds(order);
+      currentOrder = order;
     }
     
-    // 短暂延时，避免占用过多CPU
-    vTaskDelay(pdMS_TO_TICKS(10));
+    if (LATENCY_REPORT_PERIOD_MS > 0 && millis() - lastReportMs >= LATENCY_REPORT_PERIOD_MS) {
+      report_control_status();
+      lastReportMs = millis();
+    }
+
+    // 短暂延时，避免占用过多CPU; 有WebSocket遥控连接时缩短周期以降低指令延迟
+    vTaskDelay(pdMS_TO_TICKS(http_websocket_connected() ? WIFI_POLL_PERIOD_WS_MS : WIFI_POLL_PERIOD_MS));
+  }
+}
+
+/**
+ * @brief UDP指令任务
+ * 取出最新的有效UDP指令，直接更新速度控制任务读取的期望速度。
+ * 乱序、重复和过时的数据报已被udp_command_receive()丢弃;
+ * 一段时间没有收到指令 (客户端断开或信号丢失) 时自动停车。
+ */
+void udpCommandTask(void *pvParameters) {
+  Serial.println("[TASK] UDP command task started");
+
+  UdpCommand cmd;
+  bool driving = false;          // UDP指令是否在驱动机器人 (超时后自动停车)
+  uint32_t lastCommandMs = 0;
+
+  while (true) {
+    // 处理所有已到达的数据报，只有最新的一个生效
+    bool received = false;
+    while (udp_command_receive(&cmd)) {
+      received = true;
+    }
+
+    if (received) {
+      if (cmd.kind == UDP_CMD_TWIST) {
+        set_desired_twist(cmd.linearMmS / 1000.0f, cmd.angularMrad / 1000.0f, SETPOINT_SOURCE_UDP);
+      } else {
+        set_desired_speeds(cmd.leftMrad / 1000.0f, cmd.rightMrad / 1000.0f, SETPOINT_SOURCE_UDP);
+      }
+      driving = true;
+      lastCommandMs = millis();
+    } else if (driving && millis() - lastCommandMs > UDP_COMMAND_TIMEOUT_MS) {
+      // 期间手机发送过指令时不停车
+      if (stop_if_last_writer(SETPOINT_SOURCE_UDP)) {
+        Serial.println("[UDP] Command timeout, stop");
+      }
+      driving = false;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(UDP_POLL_PERIOD_MS));
+  }
+}
+
+#if PLANT_IDENT
+/**
+ * @brief 在线辨识任务
+ * 每PLANT_IDENT_PERIOD_MS取出控制任务放入的全部样本，更新两轮的RLS辨识器 (以TAU、G为初始值)，
+ * 结果发布到plantEstimateBuffer。优先级最低，与控制任务在同一个核心上，只使用控制周期之间的空闲时间。
+ */
+void plantIdentTask(void *pvParameters) {
+  Serial.println("[TASK] Plant identification task started");
+
+  PlantIdentifier identLeft(CONTROL_PERIOD_US * 1e-6f, PLANT_IDENT_DECIMATION, PLANT_IDENT_FORGETTING,
+                            PLANT_IDENT_CONVERGED_PCT);
+  PlantIdentifier identRight(CONTROL_PERIOD_US * 1e-6f, PLANT_IDENT_DECIMATION, PLANT_IDENT_FORGETTING,
+                             PLANT_IDENT_CONVERGED_PCT);
+  identLeft.reset(TAU * 1e-3f, G);
+  identRight.reset(TAU * 1e-3f, G);
+  plantEstimateBuffer.write({identLeft.estimate(), identRight.estimate()});
+
+  uint32_t expectedSeq = 0;
+  IdentSample sample;
+  TickType_t xLastWakeTime = xTaskGetTickCount();
+  while (true) {
+    vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(PLANT_IDENT_PERIOD_MS));
+    while (identQueue.pop(&sample)) {
+      // 样本被丢弃过: 前后两个样本不相邻，不能组成一个方程
+      if (sample.seq != expectedSeq) {
+        identLeft.restart();
+        identRight.restart();
+      }
+      expectedSeq = sample.seq + 1;
+      identLeft.update(sample.dutyLeft, sample.speedLeft);
+      identRight.update(sample.dutyRight, sample.speedRight);
+    }
+    plantEstimateBuffer.write({identLeft.estimate(), identRight.estimate()});
   }
 }
+#endif
 
 /**
  * @brief 速度控制任务 (两个轮子)
- * 实现PI控制器的闭环速度控制
+ * 实现PI控制器的闭环速度控制。
+ * 每个控制周期测量速度并更新PI控制器; SETPOINT_NOTIFY为1时，期望速度改变会通过
+ * 任务通知提前唤醒本任务，用上一周期的测量速度立即重新计算PWM (不推进积分项，
+ * 设定点轨迹推进到当前时刻)，指令生效不必再等待下一个控制周期。
+ * 指令到PWM的延迟在PI的设定点第一次朝新的期望速度变化的那次PWM更新时记录。
+ * LOOP_TIMING为1时，按周期唤醒的每个周期记录唤醒、测量、计算、输出四个时间点
+ * (提前唤醒的周期不计入)，统计结果见/metrics。
+ * CONTROL_TIMER_DRIVEN为1时，周期由硬件定时器中断产生，不受tick和WiFi任务调度的影响;
+ * 定时器中断与期望速度都通过任务通知唤醒本任务，用定时器到期次数区分两者。
  */
 void speedControlTask(void *pvParameters) {
   Serial.println("[TASK] Speed control task started");
   
+  const float dt = CONTROL_PERIOD_US * 1e-6f;
+#if CONTROL_TIMER_DRIVEN
+  // 在本任务中创建定时器: 中断分配在调用者所在的核心 (CONTROL_CORE) 上
+  controlTimer = timerBegin(CONTROL_TIMER_FREQ_HZ);
+  timerAttachInterrupt(controlTimer, onControlTimer);
+  timerAlarm(controlTimer, (uint64_t)CONTROL_PERIOD_US * CONTROL_TIMER_FREQ_HZ / 1000000, true, 0);
+  uint32_t lastTimerTicks = controlTimerTicks;
+#else
   TickType_t xLastWakeTime = xTaskGetTickCount();
-  const float dt = CONTROL_PERIOD_MS / 1000.0f;
+#endif
   
-  // 清除编码器计数
+  // 清除编码器计数，里程计从当前位置开始
   encodeur_gauche.clearCount();
   encodeur_droit.clearCount();
+  odometry.reset(encodeur_gauche.getCount(), encodeur_droit.getCount());
   
-  int64_t lastLeftCount = 0;
-  int64_t lastRightCount = 0;
+  SpeedSetpoint setpoint = {0.0f, 0.0f, 0, false};
+  ControlSnapshot snapshot = {};
+  uint32_t lastPeriodicUs = micros();   // 上一次按周期唤醒的时刻
+  float profileAdvanced = 0.0f;         // 本周期内提前唤醒已推进轨迹的时间 (秒)
+  bool latencyPending = false;          // 新的期望速度还没有作用到PWM
   
   while (true) {
+    bool periodic = true;  // false表示由新的期望速度提前唤醒
+#if CONTROL_TIMER_DRIVEN
+    // 等待定时器中断或新的期望速度
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint32_t timerTicks = controlTimerTicks;
+    periodic = timerTicks != lastTimerTicks;
+    lastTimerTicks = timerTicks;
+#elif SETPOINT_NOTIFY
+    // 等待下一个控制周期，期间收到任务通知则提前返回
+    TickType_t nextWakeTime = xLastWakeTime + pdMS_TO_TICKS(CONTROL_PERIOD_US / 1000);
+    TickType_t remaining = nextWakeTime - xTaskGetTickCount();
+    if ((int32_t)remaining > 0 && ulTaskNotifyTake(pdTRUE, remaining) > 0) {
+      periodic = false;
+    } else {
+      xLastWakeTime = nextWakeTime;
+    }
+#else
     // 等待下一个控制周期
-    vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(CONTROL_PERIOD_MS));
-    
-    // 读取编码器当前值
-    int64_t currentLeftCount = encodeur_gauche.getCount();
-    int64_t currentRightCount = encodeur_droit.getCount();
+    vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(CONTROL_PERIOD_US / 1000));
+#endif
     
-    // 计算增量
-    int64_t deltaLeft = currentLeftCount - lastLeftCount;
-    int64_t deltaRight = currentRightCount - lastRightCount;
-    
-    lastLeftCount = currentLeftCount;
-    lastRightCount = currentRightCount;
+    if (periodic) {
+      loop_timing_wake();
+      sense_wheel_speeds();
+    }
+    loop_timing_mark(LOOP_PHASE_SENSE);
     
-    // 计算测量速度
-    measuredSpeedLeft = calculateAngularVelocity(deltaLeft, CONTROL_PERIOD_MS);
-    measuredSpeedRight = calculateAngularVelocity(deltaRight, CONTROL_PERIOD_MS);
+    // 获取最新的期望速度 (无锁，不会等待写者)
+    bool newSetpoint = setpointBuffer.read(&setpoint);
+#if SETPOINT_PROFILE
+    // 停车指令不按加速度限制减速: 参考速度立即归零
+    if (newSetpoint && setpoint.stop) {
+      profileLeft.reset(0.0f);
+      profileRight.reset(0.0f);
+    }
+#endif
     
-    // 获取期望速度 (临界区保护)
-    float targetLeft, targetRight;
-    portENTER_CRITICAL(&speedMutex);
-    targetLeft = desiredSpeedLeft;
-    targetRight = desiredSpeedRight;
-    portEXIT_CRITICAL(&speedMutex);
+    // 轨迹推进的时间: 一个周期内的各次唤醒合计一个控制周期
+    float profileDt;
+    if (periodic) {
+      lastPeriodicUs = micros();
+      profileDt = dt - profileAdvanced;
+      profileAdvanced = 0.0f;
+    } else {
+      float elapsed = (micros() - lastPeriodicUs) * 1e-6f;
+      if (elapsed > dt) elapsed = dt;
+      profileDt = elapsed > profileAdvanced ? elapsed - profileAdvanced : 0.0f;
+      profileAdvanced += profileDt;
+    }
     
-    // PI控制器计算控制信号
-    controlSignalLeft = piController(targetLeft, measuredSpeedLeft, &integralLeft, dt);
-    controlSignalRight = piController(targetRight, measuredSpeedRight, &integralRight, dt);
+    // PI控制器计算控制信号 (提前唤醒时dt为0，只更新比例项)
+    bool applied = compute_wheel_controls(setpoint, periodic ? dt : 0.0f, profileDt);
+    loop_timing_mark(LOOP_PHASE_COMPUTE);
     
     // 应用控制信号到电机
-    setLeftMotorPWM((int32_t)controlSignalLeft);
-    setRightMotorPWM((int32_t)controlSignalRight);
+    apply_wheel_controls();
+    loop_timing_mark(LOOP_PHASE_ACTUATE);
+#if PLANT_IDENT
+    record_ident_sample(periodic);
+#endif
+    
+    // 新的期望速度第一次作用到PWM时记录延迟 (被更新的期望速度取代时按最新的计算)
+    latencyPending |= newSetpoint;
+    if (latencyPending && applied) {
+      latencyPending = false;
+      uint32_t latency = micros() - setpoint.stampUs;
+      snapshot.latencyCount++;
+      snapshot.latencySumUs += latency;
+      if (latency > snapshot.latencyMaxUs) snapshot.latencyMaxUs = latency;
+    }
     
-    // 调试输出 (可选，注释掉以减少串口输出)
-    // Serial.printf("L: %.2f/%.2f, R: %.2f/%.2f\n", 
-    //               targetLeft, measuredSpeedLeft, 
-    //               targetRight, measuredSpeedRight);
+    // 发布本周期的状态 (调试输出由WiFi任务中的report_control_status()打印)
+    snapshot.targetLeft = setpoint.left;
+    snapshot.targetRight = setpoint.right;
+    snapshot.measuredLeft = measuredSpeedLeft;
+    snapshot.measuredRight = measuredSpeedRight;
+    snapshot.controlLeft = controlSignalLeft;
+    snapshot.controlRight = controlSignalRight;
+    controlSnapshotBuffer.write(snapshot);
+    if (periodic) poseBuffer.write(odometry.pose());
   }
 }
 
@@ -367,42 +1188,87 @@ void setup() {
   Serial.println("[INFO] Password: " + String(password));
   Serial.println("[INFO] Connect to WiFi and open http://192.168.4.1 in browser");
 
+#if LOOP_TIMING
+  // 控制周期的抖动直方图: http://192.168.4.1/metrics
+  loopTiming.setCycleBudget((uint32_t)((uint64_t)CONTROL_PERIOD_US * ESP.getCpuFreqMHz() * CONTROL_BUDGET_PERCENT / 100));
+#endif
+  // 里程计位姿也在/metrics中 (不依赖LOOP_TIMING)
+  http_set_metrics_handler(format_metrics, &loopTiming);
+
+  // 在WiFi热点上启动UDP指令监听
+  udp_command_start(UDP_CMD_PORT);
+
   // 初始化所有电机PWM
-  init_motor_pwm(MLF);
-  init_motor_pwm(MLB);
-  init_motor_pwm(MRF);
-  init_motor_pwm(MRB);
+  init_motor_outputs();
   Serial.println("[INFO] Motors initialized");
 
   // 配置编码器
   encodeur_gauche.attachFullQuad(SLA, SLB);
   encodeur_droit.attachFullQuad(SRA, SRB);
+#if SPEED_ESTIMATOR_MT
+  encodeur_gauche.enableEdgeTimestamps();
+  encodeur_droit.enableEdgeTimestamps();
+#endif
   encodeur_gauche.clearCount();
   encodeur_droit.clearCount();
   Serial.println("[INFO] Encoders initialized");
+  Serial.printf("[INFO] PI KP %.1f KI %.1f (integral limit %.4f)\n", KP, KI, INTEGRAL_MAX);
+
+#if CONTROL_BUDGET_BENCH
+  run_control_budget_bench();
+#endif
 
   // 等待1秒让系统稳定
   delay(1000);
 
+  // 期望速度写者之间的互斥量 (必须在创建任务之前)
+  setpointWriteMutex = xSemaphoreCreateMutex();
+
   // 创建WiFi通信任务
-  xTaskCreate(
+  xTaskCreatePinnedToCore(
     wifiCommunicationTask,
     "WiFiComm",
     4096,
     NULL,
     1,  // 较低优先级
-    NULL
+    NULL,
+    NETWORK_TASK_CORE
+  );
+
+  // 创建UDP指令任务
+  xTaskCreatePinnedToCore(
+    udpCommandTask,
+    "UdpCmd",
+    4096,
+    NULL,
+    1,  // 与WiFi任务相同的优先级
+    NULL,
+    NETWORK_TASK_CORE
   );
 
   // 创建速度控制任务
-  xTaskCreate(
+  xTaskCreatePinnedToCore(
     speedControlTask,
     "SpeedCtrl",
     4096,
     NULL,
-    2,  // 较高优先级 (控制任务需要实时性)
-    NULL
+    CONTROL_TASK_PRIORITY,  // 较高优先级 (控制任务需要实时性)
+    &speedControlTaskHandle,  // 供set_desired_speeds()和定时器中断发送任务通知
+    CONTROL_TASK_CORE
+  );
+
+#if PLANT_IDENT
+  // 创建在线辨识任务 (与控制任务同一个核心，只在控制周期之间运行)
+  xTaskCreatePinnedToCore(
+    plantIdentTask,
+    "PlantIdent",
+    4096,
+    NULL,
+    1,  // 最低的应用优先级
+    NULL,
+    CONTROL_TASK_CORE
   );
+#endif
 
   Serial.println("[INFO] All tasks created");
   Serial.println("[INFO] Setup complete");
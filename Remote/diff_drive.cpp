@@ -0,0 +1,35 @@
+#include "diff_drive.hpp"
+
+#include <math.h>
+
+/**
+ * **中文注释:**
+ * 差速驱动运动学的实现 (公式见diff_drive.hpp)。
+ */
+
+DiffDriveKinematics::DiffDriveKinematics(float wheelRadiusM, float trackWidthM, float maxWheelSpeed)
+    : wheelRadius_(wheelRadiusM), trackWidth_(trackWidthM), maxWheelSpeed_(maxWheelSpeed) {}
+
+WheelSpeeds DiffDriveKinematics::toWheels(const BodyTwist &twist) const {
+  float halfTrack = 0.5f * trackWidth_ * twist.angular;
+  WheelSpeeds wheels = {(twist.linear - halfTrack) / wheelRadius_, (twist.linear + halfTrack) / wheelRadius_};
+  return saturate(wheels);
+}
+
+BodyTwist DiffDriveKinematics::toBody(const WheelSpeeds &wheels) const {
+  BodyTwist twist = {0.5f * wheelRadius_ * (wheels.left + wheels.right),
+                     wheelRadius_ * (wheels.right - wheels.left) / trackWidth_};
+  return twist;
+}
+
+WheelSpeeds DiffDriveKinematics::saturate(const WheelSpeeds &wheels) const {
+  if (!isfinite(wheels.left) || !isfinite(wheels.right)) {
+    WheelSpeeds stop = {0.0f, 0.0f};
+    return stop;
+  }
+  float peak = fmaxf(fabsf(wheels.left), fabsf(wheels.right));
+  if (peak <= maxWheelSpeed_) return wheels;
+  float scale = maxWheelSpeed_ / peak;
+  WheelSpeeds scaled = {wheels.left * scale, wheels.right * scale};
+  return scaled;
+}
@@ -0,0 +1,83 @@
+/*
+ * diff_drive.hpp - 差速驱动运动学: 车体线速度/角速度与两轮角速度的换算
+ *
+ * **中文注释:**
+ * 两轮差速驱动 (车轮半径r，两轮间距L)，v为前进方向的线速度 (m/s)，
+ * ω为绕竖直轴的角速度 (rad/s，左转为正):
+ *   左轮 ωl = (v - ω·L/2) / r,   右轮 ωr = (v + ω·L/2) / r
+ *   v = r·(ωl + ωr) / 2,          ω = r·(ωr - ωl) / L
+ *
+ * 任一车轮超出速度上限时，两轮按同一比例缩小: 两轮速度之比不变，即转弯半径v/ω不变，
+ * 机器人沿原来的路径行驶，只是变慢 (分别限幅会改变路径，例如高速转弯变成直行)。
+ */
+
+#ifndef DIFF_DRIVE_HPP_
+#define DIFF_DRIVE_HPP_
+
+/**
+ * @struct WheelSpeeds
+ * @brief 两轮角速度 (rad/s，正值使机器人前进)。
+ */
+struct WheelSpeeds {
+  float left;
+  float right;
+};
+
+/**
+ * @struct BodyTwist
+ * @brief 车体速度。
+ */
+struct BodyTwist {
+  float linear;   // 线速度 (m/s)
+  float angular;  // 角速度 (rad/s，左转为正)
+};
+
+/**
+ * @class DiffDriveKinematics
+ * @brief 差速驱动的正/逆运动学与按比例限幅。
+ */
+class DiffDriveKinematics {
+public:
+  /**
+   * @param wheelRadiusM 车轮半径 (m)
+   * @param trackWidthM 两轮间距 (m)
+   * @param maxWheelSpeed 车轮速度上限 (rad/s)
+   */
+  DiffDriveKinematics(float wheelRadiusM, float trackWidthM, float maxWheelSpeed);
+
+  /**
+   * @brief 逆运动学: 车体速度 -> 两轮速度，超出上限时按比例缩小。
+   */
+  WheelSpeeds toWheels(const BodyTwist &twist) const;
+
+  /**
+   * @brief 正运动学: 两轮速度 -> 车体速度 (不限幅)。
+   */
+  BodyTwist toBody(const WheelSpeeds &wheels) const;
+
+  /**
+   * @brief 两轮速度按同一比例缩小到上限以内; 非有限值 (NaN/无穷) 返回停止。
+   */
+  WheelSpeeds saturate(const WheelSpeeds &wheels) const;
+
+  /**
+   * @brief 直行时能达到的最大线速度 (m/s)。
+   */
+  float maxLinear() const { return wheelRadius_ * maxWheelSpeed_; }
+
+  /**
+   * @brief 原地转向时能达到的最大角速度 (rad/s)。
+   */
+  float maxAngular() const { return 2.0f * wheelRadius_ * maxWheelSpeed_ / trackWidth_; }
+
+  float wheelRadius() const { return wheelRadius_; }
+  float trackWidth() const { return trackWidth_; }
+  float maxWheelSpeed() const { return maxWheelSpeed_; }
+
+private:
+  float wheelRadius_;
+  float trackWidth_;
+  float maxWheelSpeed_;
+};
+
+#endif /* DIFF_DRIVE_HPP_ */
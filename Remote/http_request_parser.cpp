@@ -0,0 +1,196 @@
+/*
+ * http_request_parser.cpp - 增量式HTTP请求解析器的实现
+ *
+ * **中文注释:**
+ * 状态机每次只处理一个字节，只有请求行中的方法和路径(以及WebSocket握手的
+ * 两个请求头)被复制到固定缓冲区，其余请求头的内容逐字节跳过。与原先把整个请求头追加到String再多次indexOf()
+ * 的做法相比，没有堆分配，每个字节的处理代价是常数。
+ */
+
+#include "http_request_parser.hpp"
+#include "http_server.hpp"
+
+#include <string.h>
+#include <strings.h>
+
+HttpRequestParser::HttpRequestParser() {
+  reset();
+}
+
+void HttpRequestParser::reset() {
+  state_ = ST_METHOD;
+  status_ = HTTP_PARSE_INCOMPLETE;
+  header_ = HDR_OTHER;
+  methodLen_ = 0;
+  pathLen_ = 0;
+  nameLen_ = 0;
+  valueLen_ = 0;
+  method_[0] = '\0';
+  path_[0] = '\0';
+  name_[0] = '\0';
+  upgrade_[0] = '\0';
+  wsKey_[0] = '\0';
+}
+
+void HttpRequestParser::beginHeaderName(char c) {
+  state_ = ST_HEADER_NAME;
+  name_[0] = c;
+  name_[1] = '\0';
+  nameLen_ = 1;
+}
+
+void HttpRequestParser::endHeaderName() {
+  // 请求头名称不区分大小写
+  if (strcasecmp(name_, "Upgrade") == 0) {
+    header_ = HDR_UPGRADE;
+    upgrade_[0] = '\0';
+  } else if (strcasecmp(name_, "Sec-WebSocket-Key") == 0) {
+    header_ = HDR_WS_KEY;
+    wsKey_[0] = '\0';
+  } else {
+    header_ = HDR_OTHER;
+  }
+  valueLen_ = 0;
+  state_ = (header_ == HDR_OTHER) ? ST_HEADER : ST_HEADER_VALUE;
+}
+
+HttpParseStatus HttpRequestParser::fail() {
+  status_ = HTTP_PARSE_ERROR;
+  return status_;
+}
+
+HttpParseStatus HttpRequestParser::feed(char c) {
+  if (status_ != HTTP_PARSE_INCOMPLETE) return status_;
+
+  switch (state_) {
+    case ST_METHOD:
+      if (c == ' ') {
+        if (methodLen_ == 0) return fail();
+        state_ = ST_PATH;
+      } else if (c == '\r' || c == '\n') {
+        // 请求行之前的空行按RFC 7230可以忽略
+        if (methodLen_ != 0) return fail();
+      } else {
+        if (methodLen_ >= HTTP_METHOD_MAX_LEN) return fail();
+        method_[methodLen_++] = c;
+        method_[methodLen_] = '\0';
+      }
+      break;
+
+    case ST_PATH:
+      if (c == ' ') {
+        if (pathLen_ == 0) return fail();
+        state_ = ST_VERSION;
+      } else if (c == '\r' || c == '\n') {
+        // 没有版本号的请求行 (HTTP/0.9风格)
+        if (pathLen_ == 0) return fail();
+        state_ = (c == '\n') ? ST_LINE_START : ST_VERSION;
+      } else {
+        if (pathLen_ >= HTTP_PATH_MAX_LEN) return fail();
+        path_[pathLen_++] = c;
+        path_[pathLen_] = '\0';
+      }
+      break;
+
+    case ST_VERSION:
+      if (c == '\n') state_ = ST_LINE_START;
+      break;
+
+    case ST_LINE_START:
+      if (c == '\n') {
+        status_ = HTTP_PARSE_DONE; // 连续两个换行: 请求头结束
+      } else if (c == '\r') {
+        state_ = ST_END_CR;
+      } else {
+        beginHeaderName(c);
+      }
+      break;
+
+    case ST_HEADER_NAME:
+      if (c == ':') {
+        endHeaderName();
+      } else if (c == '\n') {
+        state_ = ST_LINE_START; // 没有冒号的行，忽略
+      } else if (nameLen_ >= HTTP_HEADER_NAME_MAX_LEN) {
+        state_ = ST_HEADER;     // 名称过长，不可能是需要的请求头
+      } else {
+        name_[nameLen_++] = c;
+        name_[nameLen_] = '\0';
+      }
+      break;
+
+    case ST_HEADER_VALUE: {
+      char *value = (header_ == HDR_UPGRADE) ? upgrade_ : wsKey_;
+      size_t maxLen = (header_ == HDR_UPGRADE) ? HTTP_UPGRADE_MAX_LEN : HTTP_WS_KEY_MAX_LEN;
+      if (c == '\n') {
+        state_ = ST_LINE_START;
+      } else if (c == '\r') {
+        state_ = ST_HEADER;
+      } else if ((c == ' ' || c == '\t') && valueLen_ == 0) {
+        // 跳过值前面的空白
+      } else if (c == ' ' || c == '\t') {
+        state_ = ST_HEADER;     // 值中的空白之后的内容不需要
+      } else if (valueLen_ >= maxLen) {
+        value[0] = '\0';        // 值过长，视为无效
+        state_ = ST_HEADER;
+      } else {
+        value[valueLen_++] = c;
+        value[valueLen_] = '\0';
+      }
+      break;
+    }
+
+    case ST_HEADER:
+      if (c == '\n') state_ = ST_LINE_START;
+      break;
+
+    case ST_END_CR:
+      if (c == '\n') {
+        status_ = HTTP_PARSE_DONE;
+      } else if (c != '\r') {
+        beginHeaderName(c);
+      }
+      break;
+  }
+  return status_;
+}
+
+HttpParseStatus HttpRequestParser::feed(const char *data, size_t len, size_t *consumed) {
+  size_t i = 0;
+  while (i < len && status_ == HTTP_PARSE_INCOMPLETE) {
+    feed(data[i++]);
+  }
+  if (consumed != NULL) *consumed = i;
+  return status_;
+}
+
+bool HttpRequestParser::isGet() const {
+  return strcmp(method_, "GET") == 0;
+}
+
+bool HttpRequestParser::isWebSocketUpgrade() const {
+  return strcasecmp(upgrade_, "websocket") == 0 && wsKey_[0] != '\0';
+}
+
+int http_path_to_order(const char *path) {
+  // 期望格式: "/2X/on" 或 "/2X/off"，X为6..9，可以带查询字符串
+  if (path[0] != '/' || path[1] != '2' || path[2] == '\0' || path[3] != '/') return 0;
+
+  bool on;
+  const char *rest = path + 4;
+  if (strncmp(rest, "on", 2) == 0 && (rest[2] == '\0' || rest[2] == '?')) {
+    on = true;
+  } else if (strncmp(rest, "off", 3) == 0 && (rest[3] == '\0' || rest[3] == '?')) {
+    on = false;
+  } else {
+    return 0;
+  }
+
+  switch (path[2]) {
+    case '6': return on ? ORDER_ROBOT_FORWARD : ORDER_ROBOT_STOP;
+    case '7': return on ? ORDER_ROBOT_LEFT : ORDER_ROBOT_STOP;
+    case '8': return on ? ORDER_ROBOT_RIGHT : ORDER_ROBOT_STOP;
+    case '9': return on ? ORDER_ROBOT_BACKWARD : ORDER_ROBOT_STOP;
+    default:  return 0;
+  }
+}
@@ -0,0 +1,132 @@
+/*
+ * http_request_parser.hpp - 增量式HTTP请求解析器
+ *
+ * **中文注释:**
+ * 这个头文件定义了一个逐字节解析HTTP请求的状态机。它只保存请求行中的
+ * 方法(method)和路径(path)，以及WebSocket握手需要的Upgrade和Sec-WebSocket-Key
+ * 两个请求头，其余请求头被直接跳过而不存储。
+ * 所有数据都存放在对象内部的固定大小缓冲区中，解析过程不进行任何堆内存分配，
+ * 因此可以在与控制任务共享CPU核心的WiFi任务中安全地反复使用。
+ */
+
+#ifndef HTTP_REQUEST_PARSER_HPP_
+#define HTTP_REQUEST_PARSER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HTTP_METHOD_MAX_LEN 8   // 方法最大长度 (GET, POST, ...)
+#define HTTP_PATH_MAX_LEN 64    // 路径最大长度，超出时返回错误
+#define HTTP_HEADER_NAME_MAX_LEN 20 // 需要识别的请求头名称的最大长度，更长的名称直接跳过
+#define HTTP_UPGRADE_MAX_LEN 16 // Upgrade请求头值的最大长度
+#define HTTP_WS_KEY_MAX_LEN 32  // Sec-WebSocket-Key的最大长度 (标准长度为24)
+
+/**
+ * @enum HttpParseStatus
+ * @brief feed()的返回值。
+ */
+enum HttpParseStatus {
+  HTTP_PARSE_INCOMPLETE = 0, // 需要更多数据
+  HTTP_PARSE_DONE,           // 已收到完整的请求头 (空行)
+  HTTP_PARSE_ERROR           // 请求格式错误或字段过长
+};
+
+/**
+ * @class HttpRequestParser
+ * @brief 零分配的HTTP请求头状态机解析器。
+ *
+ * 用法: 每个连接调用一次reset()，然后把收到的字节依次传给feed()，
+ * 直到返回HTTP_PARSE_DONE，再通过method()/path()读取结果。
+ */
+class HttpRequestParser {
+public:
+  HttpRequestParser();
+
+  /**
+   * @brief 清空解析状态，准备解析新的请求。
+   */
+  void reset();
+
+  /**
+   * @brief 输入一个字节。
+   * @param c 从客户端读取的字节。
+   * @return 当前解析状态。DONE或ERROR之后的字节会被忽略，直到reset()。
+   */
+  HttpParseStatus feed(char c);
+
+  /**
+   * @brief 输入一段字节。
+   * @param data 数据指针。
+   * @param len 数据长度。
+   * @param consumed 可选，返回实际消耗的字节数 (在DONE或ERROR处停止)。
+   * @return 当前解析状态。
+   */
+  HttpParseStatus feed(const char *data, size_t len, size_t *consumed = NULL);
+
+  HttpParseStatus status() const { return status_; }
+  const char *method() const { return method_; }
+  const char *path() const { return path_; }
+
+  /**
+   * @brief 判断方法是否为GET。
+   */
+  bool isGet() const;
+
+  /**
+   * @brief 判断是否为WebSocket握手请求 (Upgrade: websocket 且带有Sec-WebSocket-Key)。
+   */
+  bool isWebSocketUpgrade() const;
+
+  /**
+   * @brief 客户端的Sec-WebSocket-Key，没有时为空字符串。
+   */
+  const char *webSocketKey() const { return wsKey_; }
+
+private:
+  enum State {
+    ST_METHOD,       // 读取方法
+    ST_PATH,         // 读取路径
+    ST_VERSION,      // 跳过HTTP版本直到行尾
+    ST_LINE_START,   // 请求头行首 (空行表示结束)
+    ST_HEADER_NAME,  // 读取请求头名称
+    ST_HEADER_VALUE, // 读取需要保存的请求头的值
+    ST_HEADER,       // 跳过请求头行的内容
+    ST_END_CR        // 空行中的'\r'之后等待'\n'
+  };
+
+  enum HeaderId {
+    HDR_OTHER,       // 不需要的请求头
+    HDR_UPGRADE,     // Upgrade
+    HDR_WS_KEY       // Sec-WebSocket-Key
+  };
+
+  HttpParseStatus fail();
+  void beginHeaderName(char c);
+  void endHeaderName();
+
+  State state_;
+  HttpParseStatus status_;
+  HeaderId header_;
+  uint8_t methodLen_;
+  uint8_t pathLen_;
+  uint8_t nameLen_;
+  uint8_t valueLen_;
+  char method_[HTTP_METHOD_MAX_LEN + 1];
+  char path_[HTTP_PATH_MAX_LEN + 1];
+  char name_[HTTP_HEADER_NAME_MAX_LEN + 1];
+  char upgrade_[HTTP_UPGRADE_MAX_LEN + 1];
+  char wsKey_[HTTP_WS_KEY_MAX_LEN + 1];
+};
+
+/**
+ * @brief 将请求路径转换为机器人指令。
+ *
+ * 识别网页按钮使用的路径: /26 前进、/27 左转、/28 右转、/29 后退，
+ * 后缀 /on 表示执行该动作，/off 表示停止。
+ *
+ * @param path 请求路径 (可以带查询字符串)。
+ * @return `_ORDER`枚举中的指令，无法识别时返回0。
+ */
+int http_path_to_order(const char *path);
+
+#endif /* HTTP_REQUEST_PARSER_HPP_ */
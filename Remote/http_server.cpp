@@ -1,6 +1,11 @@
 
 #include "http_server.hpp"
+#include "http_request_parser.hpp"
+#include "websocket.hpp"
 #include <WiFi.h>
+#include <WiFiUdp.h>
+#include <stdio.h>
+#include <string.h>
 
 /**
  * **中文注释:**
@@ -14,18 +19,49 @@
 // 创建一个WiFi服务器对象，监听80端口 (HTTP默认端口)
 WiFiServer wifiServer(80);
 
-// 创建一个WiFi客户端对象，用于处理连接
-WiFiClient client;
+/**
+ * @struct HttpConnection
+ * @brief 一个正在处理中的客户端连接。
+ *
+ * 每个连接有自己的增量式解析器 (固定缓冲区，不在每个请求上分配堆内存)，
+ * 因此多个手机可以同时发送请求，某个连接数据不完整时不会阻塞其他连接。
+ * 完成WebSocket握手的连接保持打开，之后的数据交给帧解析器。
+ */
+struct HttpConnection {
+  WiFiClient client;          // 客户端连接
+  HttpRequestParser parser;   // 该连接的请求解析器
+  WebSocketFrameParser frame; // WebSocket帧解析器 (升级后使用)
+  uint32_t acceptedAtMs;      // 接受连接的时刻，用于超时判断
+  uint32_t lastFrameMs;       // 最近一次收到WebSocket帧的时刻
+  bool active;                // 该槽位是否正在使用
+  bool webSocket;             // 是否已升级为WebSocket
+  bool driving;               // 该WebSocket连接是否发送过运动指令
+};
+
+// 连接表 (固定大小，不动态分配)
+HttpConnection connections[HTTP_MAX_CLIENTS];
+
+// 轮询起点，保证各连接被公平地服务
+uint8_t nextConnection = 0;
 
-// --- 全局变量 ---
-// 用于存储从WiFi接收到的指令
-unsigned short reponse = ORDER_ROBOT_STOP;
+// 响应页面缓冲区，整个响应通过一次write()发送
+char pageBuffer[HTTP_PAGE_BUFFER_SIZE];
 
-// 标记是否有客户端已连接
-bool clientConnected = false;
+// 最近一次通过WebSocket收到的两轮速度指令 (mrad/s)，只在WiFi任务中读写
+int16_t phoneSpeedLeft = 0;
+int16_t phoneSpeedRight = 0;
 
-// 用于存储从客户端接收到的完整HTTP请求头
-String header;
+// 最近一次通过WebSocket收到的车体速度指令 (mm/s, mrad/s)，只在WiFi任务中读写
+int16_t phoneLinear = 0;
+int16_t phoneAngular = 0;
+
+// /metrics的响应生成函数
+HttpMetricsHandler metricsHandler = NULL;
+void *metricsContext = NULL;
+
+// UDP遥控指令的套接字与过滤器
+WiFiUDP commandUdp;
+UdpCommandFilter udpFilter;
 
 
 /**
@@ -50,129 +86,497 @@ void wifi_start(const char * ssid, const char * password) {
 }
 
 /**
- * @brief 处理与手机的通信。
+ * @brief 向页面缓冲区追加一行文本 (对应原来的client.println)。
+ * @param len 当前已写入的长度，追加后更新。
+ * @param line 要追加的文本，自动加上"\r\n"。
+ */
+static void page_append(size_t *len, const char *line) {
+  size_t n = strlen(line);
+  if (*len + n + 2 >= HTTP_PAGE_BUFFER_SIZE) return; // 缓冲区不足时截断
+  memcpy(pageBuffer + *len, line, n);
+  *len += n;
+  pageBuffer[(*len)++] = '\r';
+  pageBuffer[(*len)++] = '\n';
+}
+
+/**
+ * @brief 生成并发送包含控制按钮和摇杆的HTML页面。
  *
- * 此函数应被循环调用。它会检查是否有新的客户端连接，
- * 如果有，则读取HTTP请求，解析指令，并返回一个包含控制按钮的HTML页面。
+ * 按钮部分与原实现逐行调用client.println()时完全相同，但先在固定缓冲区中
+ * 拼接好，再一次性写出，减少了每个请求的网络调用次数。页面末尾的摇杆通过
+ * WebSocket连续发送两轮速度，不再重新加载页面。
  *
- * @return 返回从HTTP请求中解析出的指令代码 (来自`_ORDER`枚举)。
- *         如果没有新的有效指令，则可能返回上一次的指令或默认值。
+ * @param client 客户端连接。
+ * @param reponse 本次请求解析出的指令，对应的按钮显示为"OFF"。
+ */
+static void send_page(WiFiClient &client, int reponse) {
+  size_t len = 0;
+
+  // --- HTTP响应头 ---
+  page_append(&len, "HTTP/1.1 200 OK"); // 状态码: 200 OK
+  page_append(&len, "Content-type:text/html"); // 内容类型: HTML
+  page_append(&len, "Connection: close"); // 完成后关闭连接
+  page_append(&len, ""); // 响应头和内容之间的空行
+
+  // --- HTML网页内容 ---
+  page_append(&len, "<!DOCTYPE html><html>");
+  page_append(&len, "<head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">");
+  page_append(&len, "<link rel=\"icon\" href=\"data:,\">");
+  // CSS样式，用于美化按钮
+  page_append(&len, "<style>html { font-family: Helvetica; display: inline-block; margin: 0px auto; text-align: center;}");
+  page_append(&len, ".button { background-color: #4CAF50; border: none; color: white; padding: 16px 40px;");
+  page_append(&len, "text-decoration: none; font-size: 30px; margin: 2px; cursor: pointer;}");
+  page_append(&len, ".button2 {background-color: #555555;}"); // "OFF"按钮的样式
+  page_append(&len, ".marge {margin-left: 10em;}");
+  page_append(&len, ".marge2 {margin-left: 2em;}");
+  page_append(&len, "</style></head>");
+
+  // 网页标题
+  page_append(&len, "<body><h1><p>ESP32Robot</p> <p>DC motor drive over Wi-Fi</p></h1>");
+
+  // --- 根据当前指令动态生成按钮 ---
+  // 这种逻辑使得按下的按钮会变成"OFF"状态，其他按钮为"ON"
+  page_append(&len, "<p>Forward</p>");
+  if (reponse != ORDER_ROBOT_FORWARD) {
+    page_append(&len, "<p><a href=\"/26/on\"><button class=\"button\">ON</button></a></p>");
+  } else {
+    page_append(&len, "<p><a href=\"/26/off\"><button class=\"button button2\">OFF</button></a></p>");
+  }
+  page_append(&len, "<p>Left <span class=\"marge\">Right</span></p>");
+  if (reponse != ORDER_ROBOT_LEFT) {
+    page_append(&len, "<p><a href=\"/27/on\"><button class=\"button\">ON</button></a><span class=\"marge2\">");
+  } else {
+    page_append(&len, "<p><a href=\"/27/off\"><button class=\"button button2\">OFF</button></a><span class=\"marge2\">");
+  }
+  if (reponse != ORDER_ROBOT_RIGHT) {
+    page_append(&len, "<a href=\"/28/on\"><button class=\"button\">ON</button></a></span></p></p>");
+  } else {
+    page_append(&len, "<a href=\"/28/off\"><button class=\"button button2\">OFF</button></a></span></p></p>");
+  }
+
+  page_append(&len, "<p>Backward</p>");
+  if (reponse != ORDER_ROBOT_BACKWARD) {
+    page_append(&len, "<p><a href=\"/29/on\"><button class=\"button\">ON</button></a></p>");
+  } else {
+    page_append(&len, "<p><a href=\"/29/off\"><button class=\"button button2\">OFF</button></a></p>");
+  }
+
+  // --- WebSocket摇杆: 按住拖动连续发送线速度 (上下) 与角速度 (左右)，松开即停止 ---
+  char line[64];
+  page_append(&len, "<p>Joystick</p>");
+  page_append(&len, "<div id=\"pad\" style=\"width:240px;height:240px;margin:auto;border-radius:50%;background:#ddd;touch-action:none\"></div>");
+  snprintf(line, sizeof(line), "<script>var V=%d,W=%d,P='%s';", WS_MAX_LINEAR_SPEED_MM, WS_MAX_ANGULAR_SPEED_MRAD,
+           WS_PATH);
+  page_append(&len, line);
+  page_append(&len, "var s=0,t=0,w=new WebSocket('ws://'+location.host+P),p=document.getElementById('pad');");
+  page_append(&len, "function c(v){return Math.max(-1,Math.min(1,v));}");
+  page_append(&len, "function tx(v,o){if(w.readyState!=1)return;var d=new DataView(new ArrayBuffer(6));");
+  page_append(&len, "d.setUint8(0,4);d.setUint8(1,s++&255);d.setInt16(2,v,true);d.setInt16(4,o,true);w.send(d.buffer);}");
+  page_append(&len, "function mv(e){var n=performance.now();if(n-t<20)return;t=n;var b=p.getBoundingClientRect();");
+  page_append(&len, "var x=c((e.clientX-b.left)/b.width*2-1),y=c(1-(e.clientY-b.top)/b.height*2);");
+  page_append(&len, "tx(Math.round(V*y),Math.round(-W*x));}");
+  page_append(&len, "p.onpointerdown=function(e){p.setPointerCapture(e.pointerId);t=0;mv(e);};");
+  page_append(&len, "p.onpointermove=function(e){if(e.buttons)mv(e);};");
+  page_append(&len, "p.onpointerup=p.onpointercancel=function(){tx(0,0);};");
+  page_append(&len, "setInterval(function(){if(w.readyState==1)w.send(new Uint8Array([3,s++&255]));},1000);</script>");
+
+  page_append(&len, "</body></html>");
+
+  // HTTP响应以另一个空行结束
+  page_append(&len, "");
+
+  client.write((const uint8_t *)pageBuffer, len);
+}
+
+/**
+ * @brief 发送HTTP_METRICS_PATH的响应 (text/plain，正文由注册的回调生成)。
+ */
+static void send_metrics(WiFiClient &client) {
+  if (metricsHandler == NULL) {
+    client.print("HTTP/1.1 404 Not Found\r\nConnection: close\r\n\r\n");
+    return;
+  }
+  size_t len = 0;
+  page_append(&len, "HTTP/1.1 200 OK");
+  page_append(&len, "Content-type:text/plain; version=0.0.4");
+  page_append(&len, "Connection: close");
+  page_append(&len, "");
+  len += metricsHandler(pageBuffer + len, HTTP_PAGE_BUFFER_SIZE - len, metricsContext);
+  client.write((const uint8_t *)pageBuffer, len);
+}
+
+/**
+ * @brief 合并两个处理结果: 有效指令覆盖之前的结果，1只在还没有结果时记录。
+ */
+static int merge_result(int current, int result) {
+  if (result > 1) return result; // 有效指令: 以最后一个为准
+  if (result == 1 && current == 0) return 1; // 仅有活动
+  return current;
+}
+
+/**
+ * @brief 关闭连接并释放槽位。
+ * @return 如果该连接是正在驾驶机器人的WebSocket连接，返回ORDER_ROBOT_STOP
+ *         (掉线保护); 否则返回1。
+ */
+static int close_connection(HttpConnection &conn) {
+  bool wasDriving = conn.webSocket && conn.driving;
+  conn.client.stop();
+  conn.active = false;
+  conn.webSocket = false;
+  conn.driving = false;
+  return wasDriving ? ORDER_ROBOT_STOP : 1;
+}
+
+/**
+ * @brief 接受等待中的新连接，直到连接表已满。
+ * @return 如果接受了新连接返回true。
+ */
+static bool accept_connections() {
+  bool accepted = false;
+  for (uint8_t i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    if (connections[i].active) continue;
+    WiFiClient newClient = wifiServer.available();
+    if (!newClient) break; // 没有等待中的连接
+    newClient.setNoDelay(true); // 指令应答很小，不等待Nagle合并
+    connections[i].client = newClient;
+    connections[i].parser.reset();
+    connections[i].acceptedAtMs = millis();
+    connections[i].active = true;
+    connections[i].webSocket = false;
+    connections[i].driving = false;
+    accepted = true;
+  }
+  return accepted;
+}
+
+/**
+ * @brief 发送一个WebSocket帧 (帧头与负载通过一次write()发送)。
+ */
+static void ws_send(HttpConnection &conn, uint8_t opcode, const uint8_t *payload, size_t len) {
+  uint8_t frame[WS_MAX_HEADER_LEN + WS_MAX_PAYLOAD];
+  if (len > WS_MAX_PAYLOAD) len = WS_MAX_PAYLOAD;
+  size_t n = ws_frame_header(frame, opcode, len);
+  memcpy(frame + n, payload, len);
+  conn.client.write(frame, n + len);
+}
+
+/**
+ * @brief 把WebSocket速度参数限幅到±limit。
+ */
+static int16_t clamp_speed(int16_t v, int16_t limit) {
+  if (v > limit) return limit;
+  if (v < -limit) return -limit;
+  return v;
+}
+
+/**
+ * @brief 处理一个二进制指令帧 (`_WS_COMMAND`)，并回复WS_CMD_ACK。
+ * @return 解析出的指令，无效指令返回1。
+ */
+static int handle_ws_command(HttpConnection &conn, const uint8_t *p, size_t len) {
+  if (len < 2) return 1;
+
+  int order = 1;
+  switch (p[0]) {
+    case WS_CMD_ORDER:
+      if (len >= 3 && (p[2] == ORDER_ROBOT_FORWARD || p[2] == ORDER_ROBOT_BACKWARD ||
+                       p[2] == ORDER_ROBOT_LEFT || p[2] == ORDER_ROBOT_RIGHT ||
+                       p[2] == ORDER_ROBOT_STOP)) {
+        order = p[2];
+      }
+      break;
+
+    case WS_CMD_WHEEL_SPEEDS:
+      if (len >= 6) {
+        phoneSpeedLeft = clamp_speed((int16_t)(p[2] | (p[3] << 8)), WS_MAX_WHEEL_SPEED_MRAD);
+        phoneSpeedRight = clamp_speed((int16_t)(p[4] | (p[5] << 8)), WS_MAX_WHEEL_SPEED_MRAD);
+        order = ORDER_ROBOT_SPEEDS;
+      }
+      break;
+
+    case WS_CMD_TWIST:
+      if (len >= 6) {
+        phoneLinear = clamp_speed((int16_t)(p[2] | (p[3] << 8)), WS_MAX_LINEAR_SPEED_MM);
+        phoneAngular = clamp_speed((int16_t)(p[4] | (p[5] << 8)), WS_MAX_ANGULAR_SPEED_MRAD);
+        order = ORDER_ROBOT_TWIST;
+      }
+      break;
+
+    case WS_CMD_HEARTBEAT:
+    default:
+      break;
+  }
+  if (order > 1) conn.driving = true;
+
+  uint8_t ack[2] = {WS_CMD_ACK, p[1]};
+  ws_send(conn, WS_OPCODE_BINARY, ack, sizeof(ack));
+  return order;
+}
+
+/**
+ * @brief 处理一个完整的WebSocket帧。
+ * @return 解析出的指令; 1表示没有有效指令。
+ */
+static int handle_ws_frame(HttpConnection &conn) {
+  const WebSocketFrameParser &f = conn.frame;
+  switch (f.opcode()) {
+    case WS_OPCODE_BINARY:
+      return handle_ws_command(conn, f.payload(), f.payloadLength());
+
+    case WS_OPCODE_PING:
+      ws_send(conn, WS_OPCODE_PONG, f.payload(), f.payloadLength());
+      return 1;
+
+    case WS_OPCODE_CLOSE:
+      ws_send(conn, WS_OPCODE_CLOSE, f.payload(), f.payloadLength() >= 2 ? 2 : 0);
+      return close_connection(conn);
+
+    default: // 文本帧与PONG被忽略
+      return 1;
+  }
+}
+
+/**
+ * @brief 完成WebSocket握手，把连接升级为遥控通道。
+ */
+static void upgrade_connection(HttpConnection &conn) {
+  char accept[WS_ACCEPT_KEY_LEN + 1];
+  ws_compute_accept_key(conn.parser.webSocketKey(), accept);
+
+  size_t len = 0;
+  page_append(&len, "HTTP/1.1 101 Switching Protocols");
+  page_append(&len, "Upgrade: websocket");
+  page_append(&len, "Connection: Upgrade");
+  memcpy(pageBuffer + len, "Sec-WebSocket-Accept: ", 22);
+  len += 22;
+  page_append(&len, accept);
+  page_append(&len, "");
+  conn.client.write((const uint8_t *)pageBuffer, len);
+
+  conn.webSocket = true;
+  conn.driving = false;
+  conn.frame.reset();
+  conn.lastFrameMs = millis();
+  Serial.println("[WS] Teleoperation channel open");
+}
+
+/**
+ * @brief 把一段数据交给HTTP请求解析器，请求头完整后响应。
+ * @param used 返回消耗的字节数 (升级为WebSocket后剩余的字节属于第一个帧)。
+ * @return 解析出的指令; 1表示有活动但没有有效指令; 0表示请求尚未完整。
+ */
+static int service_http_bytes(HttpConnection &conn, const uint8_t *data, size_t len, size_t *used) {
+  switch (conn.parser.feed((const char *)data, len, used)) {
+    case HTTP_PARSE_DONE: {
+      Serial.print(conn.parser.method());
+      Serial.print(" ");
+      Serial.println(conn.parser.path());
+      if (conn.parser.isGet() && conn.parser.isWebSocketUpgrade() &&
+          strcmp(conn.parser.path(), WS_PATH) == 0) {
+        upgrade_connection(conn);
+        return 1;
+      }
+
+      if (conn.parser.isGet() && strcmp(conn.parser.path(), HTTP_METRICS_PATH) == 0) {
+        send_metrics(conn.client);
+        close_connection(conn);
+        return 1;
+      }
+
+      int order = 0;
+      if (conn.parser.isGet()) {
+        order = http_path_to_order(conn.parser.path());
+      }
+      send_page(conn.client, order != 0 ? order : 1);
+      close_connection(conn);
+      return order != 0 ? order : 1;
+    }
+
+    case HTTP_PARSE_ERROR: // 请求格式错误或路径过长
+      conn.client.print("HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+      close_connection(conn);
+      return 1;
+
+    case HTTP_PARSE_INCOMPLETE:
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief 把一段数据交给WebSocket帧解析器，处理其中完整的帧。
+ * @param used 返回消耗的字节数。
+ * @return 解析出的指令; 1表示没有有效指令; 0表示帧尚未完整。
+ */
+static int service_ws_bytes(HttpConnection &conn, const uint8_t *data, size_t len, size_t *used) {
+  switch (conn.frame.feed(data, len, used)) {
+    case WS_FRAME_DONE: {
+      conn.lastFrameMs = millis();
+      int result = handle_ws_frame(conn);
+      conn.frame.reset();
+      return result;
+    }
+
+    case WS_FRAME_ERROR: { // 协议错误: 发送1002关闭帧
+      uint8_t frame[WS_CLOSE_FRAME_LEN];
+      conn.client.write(frame, ws_close_frame(frame, WS_CLOSE_PROTOCOL_ERROR));
+      return close_connection(conn);
+    }
+
+    case WS_FRAME_INCOMPLETE:
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief 处理一个连接上已到达的数据，不等待新数据。
+ *
+ * 每次最多读取HTTP_MAX_BYTES_PER_POLL个字节。普通HTTP请求在请求头接收完整后
+ * 立即响应并关闭连接; WebSocket连接保持打开，逐帧处理指令。
+ *
+ * @return 解析出的指令; 1表示连接有活动但没有有效指令; 0表示本次没有完成任何请求。
+ */
+static int service_connection(HttpConnection &conn) {
+  uint8_t buf[HTTP_READ_CHUNK];
+  size_t budget = HTTP_MAX_BYTES_PER_POLL;
+  int reponse = 0;
+
+  while (budget > 0 && conn.active) {
+    int avail = conn.client.available();
+    if (avail <= 0) break;
+    size_t want = (size_t)avail;
+    if (want > sizeof(buf)) want = sizeof(buf);
+    if (want > budget) want = budget;
+    int n = conn.client.read(buf, want);
+    if (n <= 0) break;
+    budget -= (size_t)n;
+
+    // 一次读取的数据可能包含多个WebSocket帧，或者请求头之后紧跟的第一个帧
+    size_t offset = 0;
+    while (offset < (size_t)n && conn.active) {
+      size_t used = 0;
+      int result = conn.webSocket
+                   ? service_ws_bytes(conn, buf + offset, (size_t)n - offset, &used)
+                   : service_http_bytes(conn, buf + offset, (size_t)n - offset, &used);
+      offset += used;
+      reponse = merge_result(reponse, result);
+    }
+  }
+  if (!conn.active) return reponse;
+
+  // 对端已断开或超时则释放槽位，避免停滞的连接长期占用
+  if (!conn.client.connected()) {
+    return merge_result(reponse, close_connection(conn));
+  }
+  if (conn.webSocket) {
+    if (millis() - conn.lastFrameMs > WS_IDLE_TIMEOUT_MS) {
+      Serial.println("[WS] Teleoperation channel timeout.");
+      return merge_result(reponse, close_connection(conn));
+    }
+  } else if (millis() - conn.acceptedAtMs > HTTP_CLIENT_TIMEOUT_MS) {
+    Serial.println("Client timeout.");
+    return merge_result(reponse, close_connection(conn));
+  }
+  return reponse;
+}
+
+/**
+ * @brief 处理与手机的通信 (非阻塞)。
+ *
+ * 此函数应被循环调用。每次调用接受新的客户端连接，并对每个已连接的客户端
+ * 只处理已经到达的数据，从不等待。普通请求的请求头接收完整后解析指令，返回一个
+ * 包含控制按钮和摇杆的HTML页面并关闭连接; WebSocket连接上的每个指令帧立即生效。
+ *
+ * 单次调用的耗时受HTTP_POLL_BUDGET_US限制: 超出预算时剩余的连接留到下次调用处理
+ * (轮询起点依次后移，保证公平)。停滞的连接在HTTP_CLIENT_TIMEOUT_MS后被关闭，
+ * 空闲的WebSocket连接在WS_IDLE_TIMEOUT_MS后被关闭。
+ *
+ * @return 返回本次调用中最后一个有效指令 (来自`_ORDER`枚举)；
+ *         1表示有客户端活动但没有有效指令；0表示没有客户端活动。
  */
 int communicate_with_phone() {
 
   int reponse = 0; // 本次调用的响应，默认为0 (无指令)
-  
-  // 检查是否有新的客户端（例如，手机浏览器）尝试连接
-  WiFiClient client = wifiServer.available();
+  uint32_t startUs = micros();
 
-  if (client) { // 如果有新客户端连接...
+  // 检查是否有新的客户端（例如，手机浏览器）尝试连接
+  if (accept_connections()) {
     reponse = 1; // 标记有活动
-    Serial.println("New Client."); // 在串口打印新连接信息
-    String currentLine = ""; // 用于逐行读取HTTP请求
-    while (client.connected()) { // 当客户端保持连接时循环
-      
-      if (client.available()) { // 如果客户端有数据可读
-        char c = client.read(); // 读取一个字节
-        Serial.write(c); // 在串口打印出来，用于调试
-        header += c; // 将字节附加到完整的请求头字符串
-        if (c == '\n') { // 如果读到换行符，表示一行结束
-          
-          // 如果当前行是空行，说明收到了两个连续的换行符，
-          // 这标志着HTTP请求头的结束，此时可以发送响应了。
-          if (currentLine.length() == 0) {
-            // --- 发送HTTP响应头 ---
-            client.println("HTTP/1.1 200 OK"); // 状态码: 200 OK
-            client.println("Content-type:text/html"); // 内容类型: HTML
-            client.println("Connection: close"); // 完成后关闭连接
-            client.println(); // 响应头和内容之间的空行
-
-            // --- 解析HTTP GET请求，确定收到的指令 ---
-            // 通过查找请求头字符串中是否包含特定的URL来判断用户按了哪个按钮
-            if (header.indexOf("GET /26/on") >= 0) {
-              Serial.println("Received Robot Forward");
-              reponse = ORDER_ROBOT_FORWARD;
-            }
-            if (header.indexOf("GET /27/on") >= 0) {
-              Serial.println("Received Robot Left");
-              reponse = ORDER_ROBOT_LEFT;
-            }
-            if (header.indexOf("GET /28/on") >= 0) {
-              Serial.println("Received Robot Right");
-              reponse = ORDER_ROBOT_RIGHT;
-            }
-            if (header.indexOf("GET /29/on") >= 0) {
-              Serial.println("Received Robot Backward");
-              reponse = ORDER_ROBOT_BACKWARD;
-            }
-            // 任何"off"指令都视为停止
-            if (header.indexOf("GET /26/off") >= 0 || header.indexOf("GET /27/off") >= 0 || header.indexOf("GET /28/off") >= 0 || header.indexOf("GET /29/off") >= 0) {
-              Serial.println("Received Robot Stop");
-              reponse = ORDER_ROBOT_STOP;
-            }
-
-            // --- 发送HTML网页内容 ---
-            client.println("<!DOCTYPE html><html>");
-            client.println("<head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">");
-            client.println("<link rel=\"icon\" href=\"data:,\">");
-            // CSS样式，用于美化按钮
-            client.println("<style>html { font-family: Helvetica; display: inline-block; margin: 0px auto; text-align: center;}");
-            client.println(".button { background-color: #4CAF50; border: none; color: white; padding: 16px 40px;");
-            client.println("text-decoration: none; font-size: 30px; margin: 2px; cursor: pointer;}");
-            client.println(".button2 {background-color: #555555;}"); // "OFF"按钮的样式
-            client.println(".marge {margin-left: 10em;}");
-            client.println(".marge2 {margin-left: 2em;}");
-            client.println("</style></head>");
-
-            // 网页标题
-            client.println("<body><h1><p>ESP32Robot</p> <p>DC motor drive over Wi-Fi</p></h1>");
-
-            // --- 根据当前指令动态生成按钮 ---
-            // 这种逻辑使得按下的按钮会变成"OFF"状态，其他按钮为"ON"
-            client.println("<p>Forward</p>");
-            if (reponse != ORDER_ROBOT_FORWARD) {
-              client.println("<p><a href=\"/26/on\"><button class=\"button\">ON</button></a></p>");
-            } else {
-              client.println("<p><a href=\"/26/off\"><button class=\"button button2\">OFF</button></a></p>");
-            }
-            client.println("<p>Left <span class=\"marge\">Right</span></p>");
-            if (reponse != ORDER_ROBOT_LEFT) {
-              client.println("<p><a href=\"/27/on\"><button class=\"button\">ON</button></a><span class=\"marge2\">");
-            } else {
-              client.println("<p><a href=\"/27/off\"><button class=\"button button2\">OFF</button></a><span class=\"marge2\">");
-            }
-            if (reponse != ORDER_ROBOT_RIGHT) {
-              client.println("<a href=\"/28/on\"><button class=\"button\">ON</button></a></span></p></p>");
-            } else {
-              client.println("<a href=\"/28/off\"><button class=\"button button2\">OFF</button></a></span></p></p>");
-            }
-            
-            client.println("<p>Backward</p>");
-            if (reponse != ORDER_ROBOT_BACKWARD) {
-              client.println("<p><a href=\"/29/on\"><button class=\"button\">ON</button></a></p>");
-            } else {
-              client.println("<p><a href=\"/29/off\"><button class=\"button button2\">OFF</button></a></p>");
-            }
-
-            client.println("</body></html>");
-
-            // HTTP响应以另一个空行结束
-            client.println();
-            // 跳出while循环，准备断开连接
-            break;
-          } else { // 如果收到了换行符，但不是空行
-            currentLine = ""; // 清空当前行字符串，准备接收下一行
-          }
-        } else if (c != '\r') {  // 如果收到的不是回车符
-          currentLine += c;      // 将其附加到当前行
-        }
-      }
-    }
-    
-    // --- 清理与断开 ---
-    header = ""; // 清空请求头字符串，为下次连接做准备
-    client.stop(); // 关闭与客户端的连接
-    Serial.println("Client disconnected.");
-    Serial.println("");
   }
+
+  for (uint8_t k = 0; k < HTTP_MAX_CLIENTS; k++) {
+    if (micros() - startUs > HTTP_POLL_BUDGET_US) break; // 本次调用的时间预算已用完
+
+    uint8_t i = (nextConnection + k) % HTTP_MAX_CLIENTS;
+    if (!connections[i].active) continue;
+
+    reponse = merge_result(reponse, service_connection(connections[i]));
+  }
+  nextConnection = (nextConnection + 1) % HTTP_MAX_CLIENTS;
+
   return reponse; // 返回解析到的指令
 }
+
+/**
+ * @brief 注册HTTP_METRICS_PATH的响应生成函数。
+ */
+void http_set_metrics_handler(HttpMetricsHandler handler, void *ctx) {
+  metricsHandler = handler;
+  metricsContext = ctx;
+}
+
+/**
+ * @brief 是否有已升级为WebSocket的连接。
+ */
+bool http_websocket_connected() {
+  for (uint8_t i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    if (connections[i].active && connections[i].webSocket) return true;
+  }
+  return false;
+}
+
+/**
+ * @brief 获取最近一次通过WebSocket收到的两轮速度指令 (rad/s)。
+ */
+void get_phone_wheel_speeds(float *left, float *right) {
+  *left = phoneSpeedLeft / 1000.0f;
+  *right = phoneSpeedRight / 1000.0f;
+}
+
+/**
+ * @brief 获取最近一次通过WebSocket收到的车体速度指令 (m/s, rad/s)。
+ */
+void get_phone_twist(float *linear, float *angular) {
+  *linear = phoneLinear / 1000.0f;
+  *angular = phoneAngular / 1000.0f;
+}
+
+/**
+ * @brief 启动UDP遥控指令监听。
+ */
+void udp_command_start(uint16_t port) {
+  udpFilter.reset();
+  if (commandUdp.begin(port)) {
+    Serial.print("[INFO] UDP command port ");
+    Serial.println(port);
+  } else {
+    Serial.println("[ERROR] UDP command port unavailable");
+  }
+}
+
+/**
+ * @brief 取出下一个有效的UDP指令 (非阻塞)。
+ */
+bool udp_command_receive(UdpCommand *cmd) {
+  uint8_t buf[UDP_CMD_PACKET_SIZE];
+  for (;;) {
+    int size = commandUdp.parsePacket();
+    if (size <= 0) return false; // 没有更多数据报
+
+    // 长度不对的数据报只读取前UDP_CMD_PACKET_SIZE字节，由过滤器按原长度判为格式错误
+    commandUdp.read(buf, sizeof(buf));
+    if (udpFilter.accept(buf, (size_t)size, micros(), cmd) == UDP_CMD_OK) return true;
+  }
+}
@@ -16,6 +16,23 @@
 #define HTTP_SERVER_HPP_
 
 #include <WiFi.h> // 包含ESP32的WiFi库
+#include "udp_command.hpp"
+
+//- 服务器参数 ----------------------------
+#define HTTP_MAX_CLIENTS 4            // 同时处理的最大客户端连接数
+#define HTTP_CLIENT_TIMEOUT_MS 2000   // 请求头未接收完整的连接在此时间后被关闭
+#define HTTP_POLL_BUDGET_US 2000      // communicate_with_phone()单次调用的时间预算 (微秒)
+#define HTTP_MAX_BYTES_PER_POLL 1024  // 每次调用中每个连接最多读取的字节数
+#define HTTP_READ_CHUNK 128           // 单次read()的缓冲区大小
+#define HTTP_PAGE_BUFFER_SIZE 4096    // 响应页面缓冲区大小
+#define HTTP_METRICS_PATH "/metrics"  // 运行指标 (Prometheus文本格式) 的路径
+
+//- WebSocket遥控通道参数 ----------------------------
+#define WS_PATH "/ws"                 // WebSocket端点路径
+#define WS_IDLE_TIMEOUT_MS 3000       // 超过此时间没有收到任何帧则关闭连接 (网页每秒发送心跳)
+#define WS_MAX_WHEEL_SPEED_MRAD 2500  // 轮速指令的上限 (mrad/s)
+#define WS_MAX_LINEAR_SPEED_MM 300    // 线速度指令的上限 (mm/s)，网页摇杆前后满偏对应此值
+#define WS_MAX_ANGULAR_SPEED_MRAD 3000 // 角速度指令的上限 (mrad/s)，网页摇杆左右满偏对应此值
 
 //- 全局类型定义 ----------------------------
 /**
@@ -30,9 +47,36 @@ enum _ORDER {
   ORDER_ROBOT_LEFT     = 0x21, // 指令：机器人向左
   ORDER_ROBOT_RIGHT    = 0x12, // 指令：机器人向右
   ORDER_ROBOT_STOP     = 0x33, // 指令：机器人停止
+  ORDER_ROBOT_SPEEDS   = 0x44, // 指令：按get_phone_wheel_speeds()给出的两轮速度运动 (WebSocket)
+  ORDER_ROBOT_TWIST    = 0x55, // 指令：按get_phone_twist()给出的线速度与角速度运动 (WebSocket摇杆)
+};
+
+/**
+ * @enum _WS_COMMAND
+ * @brief WebSocket遥控通道的二进制指令。
+ *
+ * 每个二进制帧的负载为: [指令码, 序号, 参数...]，多字节参数为小端序。
+ * 服务器处理完每条指令后回复 [WS_CMD_ACK, 序号]，手机端可据此测量往返延迟。
+ * 连接断开或超时时，如果该连接发送过运动指令，机器人自动停止。
+ */
+enum _WS_COMMAND {
+  WS_CMD_ORDER        = 0x01, // 参数: 1字节`_ORDER`指令 (与网页按钮相同)
+  WS_CMD_WHEEL_SPEEDS = 0x02, // 参数: int16 左轮速度, int16 右轮速度 (mrad/s)
+  WS_CMD_HEARTBEAT    = 0x03, // 无参数，仅保持连接
+  WS_CMD_TWIST        = 0x04, // 参数: int16 线速度 (mm/s), int16 角速度 (mrad/s，左转为正)
+  WS_CMD_ACK          = 0x80, // 服务器 -> 手机: 指令已处理
 };
 
 
+/**
+ * @brief 生成/metrics响应正文的回调。
+ * @param buf 正文缓冲区。
+ * @param size 缓冲区大小。
+ * @param ctx 注册时传入的参数。
+ * @return 写入的字节数。
+ */
+typedef size_t (*HttpMetricsHandler)(char *buf, size_t size, void *ctx);
+
 //- 函数原型 -----------------------
 
 /**
@@ -51,10 +95,68 @@ void wifi_start(const char * ssid, const char * password);
  *
  * 此函数处理来自已连接手机的HTTP请求。它会监听、解析收到的指令，
  * 并返回一个`_ORDER`枚举中定义的命令代码。
+ * 函数是非阻塞的: 最多同时处理HTTP_MAX_CLIENTS个连接，只读取已到达的数据，
+ * 单次调用耗时受HTTP_POLL_BUDGET_US限制。
+ *
+ * 路径为WS_PATH的WebSocket握手请求会把连接升级为持久的遥控通道，
+ * 之后的二进制帧按`_WS_COMMAND`解析，不再重新建立连接或生成页面。
  *
  * @return 返回一个代表机器人指令的整数值(对应`_ORDER`枚举)。
- *         如果没有新的指令，可能会返回一个特定的值(例如0或-1)。
+ *         1表示有客户端活动但没有有效指令，0表示没有客户端活动。
  */
 int communicate_with_phone();
 
+/**
+ * @brief 注册HTTP_METRICS_PATH的响应生成函数 (在WiFi任务中调用)。
+ *
+ * 没有注册时该路径返回404。回调在WiFi任务中执行，不能阻塞。
+ */
+void http_set_metrics_handler(HttpMetricsHandler handler, void *ctx);
+
+/**
+ * @brief 是否有已升级为WebSocket的连接 (在调用communicate_with_phone()的任务中调用)。
+ *
+ * 有遥控通道时WiFi任务应缩短轮询周期，使指令帧到达后尽快被处理。
+ */
+bool http_websocket_connected();
+
+/**
+ * @brief 获取最近一次通过WebSocket收到的两轮速度指令。
+ *
+ * 在communicate_with_phone()返回ORDER_ROBOT_SPEEDS之后调用
+ * (两者应在同一个任务中调用)。
+ *
+ * @param left 左轮期望速度 (rad/s)。
+ * @param right 右轮期望速度 (rad/s)。
+ */
+void get_phone_wheel_speeds(float *left, float *right);
+
+/**
+ * @brief 获取最近一次通过WebSocket收到的车体速度指令。
+ *
+ * 在communicate_with_phone()返回ORDER_ROBOT_TWIST之后调用
+ * (两者应在同一个任务中调用)。
+ *
+ * @param linear 线速度 (m/s)。
+ * @param angular 角速度 (rad/s，左转为正)。
+ */
+void get_phone_twist(float *linear, float *angular);
+
+/**
+ * @brief 启动UDP遥控指令监听 (在wifi_start()之后调用)。
+ * @param port 监听端口，通常为UDP_CMD_PORT。
+ */
+void udp_command_start(uint16_t port);
+
+/**
+ * @brief 取出下一个有效的UDP指令 (非阻塞)。
+ *
+ * 依次读取已到达的数据报，丢弃格式错误、乱序/重复和过时的数据报，
+ * 直到找到一个有效指令或没有更多数据报。
+ *
+ * @param cmd 返回true时写入指令。
+ * @return 有新的有效指令时返回true。
+ */
+bool udp_command_receive(UdpCommand *cmd);
+
 #endif /* HTTP_SERVER_HPP_ */
@@ -0,0 +1,195 @@
+#include "loop_timing.hpp"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * **中文注释:**
+ * 控制周期计时直方图的实现 (接口说明见loop_timing.hpp)。
+ */
+
+namespace {
+
+const uint32_t SUB = 1u << LATENCY_HIST_SUB_BITS;
+
+/**
+ * @brief 向buf追加一行; 剩余空间放不下整行时不写入并返回false。
+ */
+bool append_line(char *buf, size_t size, size_t *len, const char *fmt, ...) {
+  if (*len >= size) return false;
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf + *len, size - *len, fmt, args);
+  va_end(args);
+  if (n < 0 || (size_t)n >= size - *len) {
+    buf[*len] = '\0';
+    return false;
+  }
+  *len += (size_t)n;
+  return true;
+}
+
+/**
+ * @brief 输出一个直方图的summary (分位数、最小值、最大值、个数)。
+ * @param scale 输出值 = 记录值 / scale (周期计数换算为微秒)。
+ */
+bool append_summary(char *buf, size_t size, size_t *len, const char *name, const char *metric,
+                    const LatencyHistogram &h, double scale) {
+  LatencyHistogram::Snapshot s;
+  h.snapshot(&s);
+  static const double QUANTILES[] = {0.5, 0.9, 0.99};
+  bool ok = append_line(buf, size, len, "# TYPE %s_%s summary\n", name, metric);
+  for (double q : QUANTILES) {
+    ok = ok && append_line(buf, size, len, "%s_%s{quantile=\"%g\"} %.2f\n", name, metric, q, s.percentile(q) / scale);
+  }
+  ok = ok && append_line(buf, size, len, "%s_%s_min %.2f\n", name, metric, s.count > 0 ? s.min / scale : 0.0);
+  ok = ok && append_line(buf, size, len, "%s_%s_max %.2f\n", name, metric, s.max / scale);
+  ok = ok && append_line(buf, size, len, "%s_%s_count %u\n", name, metric, (unsigned)s.count);
+  return ok;
+}
+
+} // namespace
+
+// ==============================================================================
+// LatencyHistogram
+// ==============================================================================
+
+size_t LatencyHistogram::bucketOf(uint32_t value) {
+  if (value < SUB) return value;
+  int e = 31 - __builtin_clz(value);  // value所在的2的幂区间
+  if (e > LATENCY_HIST_MAX_EXP) return LATENCY_HIST_BUCKETS - 1;
+  return ((size_t)(e - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS) +
+         ((value >> (e - LATENCY_HIST_SUB_BITS)) & (SUB - 1));
+}
+
+uint32_t LatencyHistogram::bucketUpper(size_t bucket) {
+  if (bucket < SUB) return (uint32_t)bucket;
+  if (bucket >= LATENCY_HIST_BUCKETS - 1) return UINT32_MAX;
+  int e = (int)(bucket >> LATENCY_HIST_SUB_BITS) + LATENCY_HIST_SUB_BITS - 1;
+  uint32_t width = 1u << (e - LATENCY_HIST_SUB_BITS);
+  uint32_t lower = (uint32_t)(SUB + (bucket & (SUB - 1))) * width;
+  return lower + width - 1;
+}
+
+void LatencyHistogram::reset() {
+  for (size_t i = 0; i < LATENCY_HIST_BUCKETS; i++) buckets_[i].store(0, std::memory_order_relaxed);
+  min_.store(UINT32_MAX, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::add(uint32_t value) {
+  // 只有一个写者: 读-改-写不需要原子指令，原子变量只保证读者读到完整的字
+  std::atomic<uint32_t> &b = buckets_[bucketOf(value)];
+  b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  if (value < min_.load(std::memory_order_relaxed)) min_.store(value, std::memory_order_relaxed);
+  if (value > max_.load(std::memory_order_relaxed)) max_.store(value, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::snapshot(Snapshot *out) const {
+  out->count = 0;
+  for (size_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+    out->buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    out->count += out->buckets[i];
+  }
+  out->min = min_.load(std::memory_order_relaxed);
+  out->max = max_.load(std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::Snapshot::percentile(double q) const {
+  if (count == 0) return 0;
+  uint64_t rank = (uint64_t)(q * count + 0.999999);  // 第rank个值 (从1开始)
+  if (rank < 1) rank = 1;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      uint32_t upper = bucketUpper(i);
+      if (upper > max) upper = max;
+      return upper < min ? min : upper;
+    }
+  }
+  return max;
+}
+
+// ==============================================================================
+// LoopTimingRecorder
+// ==============================================================================
+
+LoopTimingRecorder::LoopTimingRecorder(uint32_t periodUs) : periodUs_(periodUs) {
+  budgetCycles_.store(0, std::memory_order_relaxed);
+  reset();
+}
+
+void LoopTimingRecorder::reset() {
+  inCycle_ = false;
+  hasLastWake_ = false;
+  wakeUs_ = 0;
+  lastWakeUs_ = 0;
+  phaseStart_ = 0;
+  cycleStart_ = 0;
+  iterations_.store(0, std::memory_order_relaxed);
+  overruns_.store(0, std::memory_order_relaxed);
+  budgetMisses_.store(0, std::memory_order_relaxed);
+  wakeJitterUs_.reset();
+  for (LatencyHistogram &h : phaseCycles_) h.reset();
+  cycleCycles_.reset();
+  busyUs_.reset();
+}
+
+void LoopTimingRecorder::wake(uint64_t nowUs, uint32_t cycles) {
+  if (hasLastWake_) {
+    int64_t deviation = (int64_t)(nowUs - lastWakeUs_) - periodUs_;
+    uint64_t jitter = (uint64_t)(deviation < 0 ? -deviation : deviation);
+    wakeJitterUs_.add(jitter > UINT32_MAX ? UINT32_MAX : (uint32_t)jitter);
+  }
+  wakeUs_ = nowUs;
+  phaseStart_ = cycles;
+  cycleStart_ = cycles;
+  inCycle_ = true;
+}
+
+void LoopTimingRecorder::phaseDone(LoopPhase phase, uint64_t nowUs, uint32_t cycles) {
+  if (!inCycle_) return;
+  phaseCycles_[phase].add(cycles - phaseStart_);  // CCOUNT回绕时无符号差仍然正确
+  phaseStart_ = cycles;
+  if (phase != LOOP_PHASE_ACTUATE) return;
+
+  uint32_t total = cycles - cycleStart_;
+  cycleCycles_.add(total);
+  uint32_t budget = budgetCycles_.load(std::memory_order_relaxed);
+  if (budget > 0 && total > budget) {
+    budgetMisses_.store(budgetMisses_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  uint64_t busy = nowUs - wakeUs_;
+  busyUs_.add(busy > UINT32_MAX ? UINT32_MAX : (uint32_t)busy);
+
+  // 完成时刻晚于下一个周期的标称唤醒时刻即为超时 (参考点为上次唤醒，第一个周期为本次唤醒)
+  uint64_t deadline = hasLastWake_ ? lastWakeUs_ + 2ULL * periodUs_ : wakeUs_ + periodUs_;
+  if (nowUs > deadline) overruns_.store(overruns_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  iterations_.store(iterations_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+  lastWakeUs_ = wakeUs_;
+  hasLastWake_ = true;
+  inCycle_ = false;
+}
+
+size_t LoopTimingRecorder::format(const char *name, uint32_t cyclesPerUs, char *buf, size_t size) const {
+  static const char *PHASE_NAMES[LOOP_PHASE_COUNT] = {"sense_us", "compute_us", "actuate_us"};
+  size_t len = 0;
+  if (size > 0) buf[0] = '\0';
+  bool ok = append_line(buf, size, &len, "%s_period_us %u\n", name, (unsigned)periodUs_);
+  ok = ok && append_line(buf, size, &len, "%s_iterations_total %u\n", name, (unsigned)iterations());
+  ok = ok && append_line(buf, size, &len, "%s_overruns_total %u\n", name, (unsigned)overruns());
+  double scale = cyclesPerUs > 0 ? (double)cyclesPerUs : 1.0;
+  ok = ok && append_line(buf, size, &len, "%s_budget_us %.2f\n", name, cycleBudget() / scale);
+  ok = ok && append_line(buf, size, &len, "%s_budget_misses_total %u\n", name, (unsigned)budgetMisses());
+  ok = ok && append_summary(buf, size, &len, name, "wake_jitter_us", wakeJitterUs_, 1.0);
+  for (int p = 0; p < LOOP_PHASE_COUNT && ok; p++) {
+    ok = append_summary(buf, size, &len, name, PHASE_NAMES[p], phaseCycles_[p], scale);
+  }
+  ok = ok && append_summary(buf, size, &len, name, "cycle_us", cycleCycles_, scale);
+  if (ok) append_summary(buf, size, &len, name, "busy_us", busyUs_, 1.0);
+  return len;
+}
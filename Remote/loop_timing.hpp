@@ -0,0 +1,169 @@
+/*
+ * loop_timing.hpp - 控制周期的唤醒抖动与各阶段耗时直方图
+ *
+ * **中文注释:**
+ * 速度控制任务每个周期记录四个时间点: 唤醒、测量完成、计算完成、输出完成，
+ * 累积到设备上的直方图中，由HTTP服务器的/metrics路径输出:
+ *   - wake_jitter: |本次唤醒 - 上次唤醒 - 标称周期| (微秒，esp_timer_get_time());
+ *   - sense / compute / actuate: 各阶段的耗时 (CPU周期，CCOUNT，输出时换算为微秒);
+ *   - cycle: 三个阶段的总耗时 (CPU周期)，超过预算 (setCycleBudget()) 的周期计入budget_misses;
+ *   - busy: 唤醒到输出完成的总耗时 (微秒，包括被其他任务或中断抢占的时间);
+ *   - overruns: 超时的周期数 (输出完成时已经过了下一个周期的标称唤醒时刻)。
+ *
+ * 直方图是对数线性的: 0~7各占一个桶，之后每个2的幂区间等分为8个桶，
+ * 分位数的相对误差不超过12.5%，最小值与最大值是精确值。
+ *
+ * 只允许一个写者 (控制任务) 和任意个读者 (WiFi任务)。直方图太大，不适合每个周期
+ * 通过TripleBuffer发布一次，因此计数器是单独的原子变量，读者逐个复制: 读到的快照
+ * 最多缺少正在记录的那一个周期的部分数据，总数由复制下来的桶重新求和，分位数自洽。
+ * 时间戳与CPU周期数由调用者传入，本模块不读取计时器。
+ */
+
+#ifndef LOOP_TIMING_HPP_
+#define LOOP_TIMING_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#define LATENCY_HIST_SUB_BITS 3                                   // 每个2的幂区间分为2^3个桶
+#define LATENCY_HIST_MAX_EXP 26                                   // 超过2^26的值计入最后一个桶
+#define LATENCY_HIST_BUCKETS ((LATENCY_HIST_MAX_EXP - LATENCY_HIST_SUB_BITS + 2) << LATENCY_HIST_SUB_BITS)
+
+/**
+ * @class LatencyHistogram
+ * @brief 单写者的对数线性直方图 (无符号整数值)。
+ */
+class LatencyHistogram {
+public:
+  /**
+   * @struct Snapshot
+   * @brief 读者复制的一份数据及由它计算的统计量。
+   */
+  struct Snapshot {
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+
+    /**
+     * @brief 分位数 (0 < q <= 1): 所在桶的上界，不超过最大值。没有数据时返回0。
+     */
+    uint32_t percentile(double q) const;
+  };
+
+  LatencyHistogram() { reset(); }
+
+  /**
+   * @brief 清空 (只能由写者调用)。
+   */
+  void reset();
+
+  /**
+   * @brief 记录一个值 (只能由写者调用)。
+   */
+  void add(uint32_t value);
+
+  /**
+   * @brief 复制当前数据 (任意任务都可以调用)。
+   */
+  void snapshot(Snapshot *out) const;
+
+  static size_t bucketOf(uint32_t value);
+  static uint32_t bucketUpper(size_t bucket);  // 桶内的最大值
+
+private:
+  std::atomic<uint32_t> buckets_[LATENCY_HIST_BUCKETS];
+  std::atomic<uint32_t> min_;
+  std::atomic<uint32_t> max_;
+};
+
+/**
+ * @enum LoopPhase
+ * @brief 一个控制周期中依次经过的阶段。
+ */
+enum LoopPhase {
+  LOOP_PHASE_SENSE = 0,   // 唤醒 -> 读完编码器/测得速度
+  LOOP_PHASE_COMPUTE,     // -> 控制器计算完成
+  LOOP_PHASE_ACTUATE,     // -> PWM写入完成
+  LOOP_PHASE_COUNT
+};
+
+/**
+ * @class LoopTimingRecorder
+ * @brief 记录一个周期性任务的唤醒抖动、各阶段耗时与超时次数。
+ *
+ * 每个周期依次调用 wake() -> phaseDone(SENSE) -> phaseDone(COMPUTE) -> phaseDone(ACTUATE)，
+ * 最后一个阶段完成时统计本周期。没有调用wake()的周期 (例如被任务通知提前唤醒的周期)
+ * 中的phaseDone()被忽略。
+ */
+class LoopTimingRecorder {
+public:
+  /**
+   * @param periodUs 标称周期 (微秒)。
+   */
+  explicit LoopTimingRecorder(uint32_t periodUs);
+
+  /**
+   * @brief 清空统计 (只能由写者调用)，下一次唤醒不计算间隔。
+   */
+  void reset();
+
+  /**
+   * @brief 设置每个周期 (唤醒到输出完成) 的CPU周期预算，0表示不检查 (默认)。
+   */
+  void setCycleBudget(uint32_t cycles) { budgetCycles_.store(cycles, std::memory_order_relaxed); }
+  uint32_t cycleBudget() const { return budgetCycles_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 周期开始。
+   * @param nowUs 微秒时钟 (esp_timer_get_time())。
+   * @param cycles CPU周期计数器 (CCOUNT)。
+   */
+  void wake(uint64_t nowUs, uint32_t cycles);
+
+  /**
+   * @brief 一个阶段完成。LOOP_PHASE_ACTUATE完成时结束本周期。
+   */
+  void phaseDone(LoopPhase phase, uint64_t nowUs, uint32_t cycles);
+
+  uint32_t iterations() const { return iterations_.load(std::memory_order_relaxed); }
+  uint32_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+  uint32_t budgetMisses() const { return budgetMisses_.load(std::memory_order_relaxed); }
+
+  const LatencyHistogram &wakeJitterUs() const { return wakeJitterUs_; }
+  const LatencyHistogram &phaseCycles(LoopPhase phase) const { return phaseCycles_[phase]; }
+  const LatencyHistogram &cycleCycles() const { return cycleCycles_; }
+  const LatencyHistogram &busyUs() const { return busyUs_; }
+
+  /**
+   * @brief 以Prometheus文本格式 (summary) 输出所有统计，可由任意任务调用。
+   * @param name 指标名前缀，例如"speed_loop"。
+   * @param cyclesPerUs CPU周期计数器每微秒的计数 (ESP32为ESP.getCpuFreqMHz())。
+   * @return 写入的字节数 (不含结尾的'\0'); 缓冲区不足时截断在完整的行上。
+   */
+  size_t format(const char *name, uint32_t cyclesPerUs, char *buf, size_t size) const;
+
+private:
+  uint32_t periodUs_;
+
+  // 只由写者使用
+  bool inCycle_;
+  bool hasLastWake_;
+  uint64_t wakeUs_;
+  uint64_t lastWakeUs_;
+  uint32_t phaseStart_;
+  uint32_t cycleStart_;
+
+  std::atomic<uint32_t> iterations_;
+  std::atomic<uint32_t> overruns_;
+  std::atomic<uint32_t> budgetCycles_;
+  std::atomic<uint32_t> budgetMisses_;
+  LatencyHistogram wakeJitterUs_;
+  LatencyHistogram phaseCycles_[LOOP_PHASE_COUNT];
+  LatencyHistogram cycleCycles_;
+  LatencyHistogram busyUs_;
+};
+
+#endif /* LOOP_TIMING_HPP_ */
@@ -0,0 +1,89 @@
+#include "motor_pwm.hpp"
+
+/**
+ * **中文注释:**
+ * 两个电机四路PWM同步更新的实现 (接口说明见motor_pwm.hpp)。
+ */
+
+MotorPwm::MotorPwm(uint32_t timerHz, uint32_t carrierHz, uint32_t fullScale)
+    : timerHz_(timerHz), periodTicks_(motor_pwm_period_ticks(timerHz, carrierHz)),
+      fullScale_(fullScale > 0 ? fullScale : 1), started_(false), timer_(NULL) {
+  for (int i = 0; i < CHANNEL_COUNT; i++) {
+    staged_[i] = 0;
+    comparators_[i] = NULL;
+    generators_[i] = NULL;
+  }
+  operators_[0] = operators_[1] = NULL;
+}
+
+bool MotorPwm::begin(uint8_t leftFwd, uint8_t leftBack, uint8_t rightFwd, uint8_t rightBack) {
+  const uint8_t pins[CHANNEL_COUNT] = {leftFwd, leftBack, rightFwd, rightBack};
+
+  mcpwm_timer_config_t timerConfig = {};
+  timerConfig.group_id = 0;
+  timerConfig.clk_src = MCPWM_TIMER_CLK_SRC_DEFAULT;
+  timerConfig.resolution_hz = timerHz_;
+  timerConfig.count_mode = MCPWM_TIMER_COUNT_MODE_UP;
+  timerConfig.period_ticks = periodTicks_;
+  if (mcpwm_new_timer(&timerConfig, &timer_) != ESP_OK) return false;
+
+  // 两个操作器连接到同一个计数器，比较值在同一个归零点锁存
+  mcpwm_operator_config_t operatorConfig = {};
+  operatorConfig.group_id = 0;
+  for (int i = 0; i < 2; i++) {
+    if (mcpwm_new_operator(&operatorConfig, &operators_[i]) != ESP_OK) return false;
+    if (mcpwm_operator_connect_timer(operators_[i], timer_) != ESP_OK) return false;
+  }
+
+  mcpwm_comparator_config_t comparatorConfig = {};
+  comparatorConfig.flags.update_cmp_on_tez = true;
+  for (int ch = 0; ch < CHANNEL_COUNT; ch++) {
+    mcpwm_oper_handle_t oper = operators_[ch / 2];  // LEFT_*用操作器0，RIGHT_*用操作器1
+    if (mcpwm_new_comparator(oper, &comparatorConfig, &comparators_[ch]) != ESP_OK) return false;
+    if (mcpwm_comparator_set_compare_value(comparators_[ch], 0) != ESP_OK) return false;
+
+    mcpwm_generator_config_t generatorConfig = {};
+    generatorConfig.gen_gpio_num = pins[ch];
+    if (mcpwm_new_generator(oper, &generatorConfig, &generators_[ch]) != ESP_OK) return false;
+    // 归零时输出高，到达比较值时输出低: 高电平持续的计数值等于比较值
+    if (mcpwm_generator_set_action_on_timer_event(
+            generators_[ch], MCPWM_GEN_TIMER_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, MCPWM_TIMER_EVENT_EMPTY,
+                                                          MCPWM_GEN_ACTION_HIGH)) != ESP_OK) {
+      return false;
+    }
+    if (mcpwm_generator_set_action_on_compare_event(
+            generators_[ch], MCPWM_GEN_COMPARE_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, comparators_[ch],
+                                                            MCPWM_GEN_ACTION_LOW)) != ESP_OK) {
+      return false;
+    }
+  }
+
+  if (mcpwm_timer_enable(timer_) != ESP_OK) return false;
+  if (mcpwm_timer_start_stop(timer_, MCPWM_TIMER_START_NO_STOP) != ESP_OK) return false;
+  started_ = true;
+  return true;
+}
+
+uint32_t MotorPwm::toTicks(int32_t value) const {
+  uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+  if (magnitude > fullScale_) magnitude = fullScale_;
+  // fullScale不超过2^16、周期计数值不超过65535，乘积不会溢出
+  return (magnitude * periodTicks_ + fullScale_ / 2) / fullScale_;
+}
+
+void MotorPwm::stage(int32_t left, int32_t right) {
+  staged_[LEFT_FWD] = left > 0 ? toTicks(left) : 0;
+  staged_[LEFT_BACK] = left < 0 ? toTicks(left) : 0;
+  staged_[RIGHT_FWD] = right > 0 ? toTicks(right) : 0;
+  staged_[RIGHT_BACK] = right < 0 ? toTicks(right) : 0;
+}
+
+void MotorPwm::commit() {
+  if (!started_) return;
+  // 四次写入之间不允许被打断，缩短跨过归零点的窗口
+  portENTER_CRITICAL(&mux_);
+  for (int ch = 0; ch < CHANNEL_COUNT; ch++) {
+    mcpwm_comparator_set_compare_value(comparators_[ch], staged_[ch]);
+  }
+  portEXIT_CRITICAL(&mux_);
+}
@@ -0,0 +1,120 @@
+/*
+ * motor_pwm.hpp - 两个电机四路PWM的同步更新 (ESP32 MCPWM)
+ *
+ * **中文注释:**
+ * analogWrite()每次调用都要经过LEDC驱动的查表与加锁，两个电机的四个占空比
+ * 分四次、在不同时刻生效。这里改用MCPWM外设:
+ *   - 一个计数器 (递增计数) 产生载波，左右两个操作器连接到同一个计数器;
+ *   - 每个引脚对应一个比较器和一个发生器: 计数器归零时输出高，到达比较值时输出低;
+ *   - 比较器工作在影子寄存器模式 (update_cmp_on_tez)，写入的比较值在下一次计数器
+ *     归零时才生效，四个引脚因此在同一个载波周期边界上一起切换。
+ *
+ * 控制器仍以±fullScale为满量程 (与原来的PWM_RESOLUTION一致，PI增益不变)，
+ * stage()把它换算为载波周期的计数值并暂存，commit()在临界区内连续写入四个比较值
+ * (约十几个总线周期)。写入期间恰好遇到归零点的周期里，只有一部分新值生效，
+ * 其余在下一个载波周期生效。
+ *
+ * 载波频率与计数频率由motor_pwm_period_ticks()等constexpr函数在编译时检查，
+ * 见Remote.ino中的static_assert。
+ */
+
+#ifndef MOTOR_PWM_HPP_
+#define MOTOR_PWM_HPP_
+
+#include <stdint.h>
+
+#include "driver/mcpwm_prelude.h"
+#include "freertos/FreeRTOS.h"
+
+#define MOTOR_PWM_GROUP_CLOCK_HZ 80000000UL  // MCPWM组时钟 (160 MHz PLL二分频)
+#define MOTOR_PWM_MAX_PERIOD_TICKS 65535UL   // 16位计数器
+
+/**
+ * @brief 一个载波周期的计数值。
+ */
+constexpr uint32_t motor_pwm_period_ticks(uint32_t timerHz, uint32_t carrierHz) {
+  return carrierHz > 0 ? timerHz / carrierHz : 0;
+}
+
+/**
+ * @brief 计数频率能否由组时钟整数分频得到 (分频系数1~256)。
+ */
+constexpr bool motor_pwm_timer_hz_valid(uint32_t timerHz) {
+  return timerHz > 0 && MOTOR_PWM_GROUP_CLOCK_HZ % timerHz == 0 && MOTOR_PWM_GROUP_CLOCK_HZ / timerHz <= 256;
+}
+
+/**
+ * @brief 占空比的有效分辨率 (位): 载波周期计数值以2为底的对数，向下取整。
+ */
+constexpr unsigned motor_pwm_resolution_bits(uint32_t periodTicks) {
+  return periodTicks > 1 ? 1 + motor_pwm_resolution_bits(periodTicks / 2) : 0;
+}
+
+/**
+ * @class MotorPwm
+ * @brief 左右两个电机 (每个电机一对前进/后退引脚) 的同步PWM输出。
+ *
+ * stage()只能由一个任务 (速度控制任务) 调用; commit()与stop()也应在同一个任务中调用。
+ */
+class MotorPwm {
+public:
+  /**
+   * @param timerHz 计数频率 (Hz)
+   * @param carrierHz 载波频率 (Hz)
+   * @param fullScale 控制信号满量程 (对应100%占空比)
+   */
+  MotorPwm(uint32_t timerHz, uint32_t carrierHz, uint32_t fullScale);
+
+  /**
+   * @brief 创建计数器、操作器、比较器和发生器并启动载波，输出全部为0。
+   * @return 成功返回true; 失败时已创建的部分不释放，输出保持为低。
+   */
+  bool begin(uint8_t leftFwd, uint8_t leftBack, uint8_t rightFwd, uint8_t rightBack);
+
+  /**
+   * @brief 暂存两个电机的控制信号 (正值前进，负值后退，超出±fullScale时限幅)，不写硬件。
+   */
+  void stage(int32_t left, int32_t right);
+
+  /**
+   * @brief 把暂存的四个占空比写入比较器的影子寄存器，在下一个载波周期边界一起生效。
+   */
+  void commit();
+
+  /**
+   * @brief stage()与commit()。
+   */
+  void write(int32_t left, int32_t right) {
+    stage(left, right);
+    commit();
+  }
+
+  /**
+   * @brief 所有输出为0 (在下一个载波周期边界生效)。
+   */
+  void stop() { write(0, 0); }
+
+  /**
+   * @brief 一个载波周期的计数值 (占空比的步数)。
+   */
+  uint32_t periodTicks() const { return periodTicks_; }
+
+private:
+  enum { LEFT_FWD, LEFT_BACK, RIGHT_FWD, RIGHT_BACK, CHANNEL_COUNT };
+
+  uint32_t toTicks(int32_t value) const;
+
+  uint32_t timerHz_;
+  uint32_t periodTicks_;
+  uint32_t fullScale_;
+  bool started_;
+  uint32_t staged_[CHANNEL_COUNT];  // 暂存的比较值 (计数值)
+  portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+
+  mcpwm_timer_handle_t timer_;
+  mcpwm_oper_handle_t operators_[2];
+  mcpwm_cmpr_handle_t comparators_[CHANNEL_COUNT];
+  mcpwm_gen_handle_t generators_[CHANNEL_COUNT];
+};
+
+#endif /* MOTOR_PWM_HPP_ */
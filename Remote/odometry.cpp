@@ -0,0 +1,50 @@
+#include "odometry.hpp"
+
+#include <math.h>
+
+/**
+ * **中文注释:**
+ * 里程计的实现 (公式见odometry.hpp)。
+ */
+
+Odometry::Odometry(float edgesPerRev, float wheelRadiusM, float trackWidthM)
+    : metersPerEdge_(2.0f * (float)M_PI * wheelRadiusM / edgesPerRev), trackWidth_(trackWidthM) {
+  reset(0, 0);
+}
+
+void Odometry::reset(int64_t leftCount, int64_t rightCount) {
+  lastLeft_ = leftCount;
+  lastRight_ = rightCount;
+  pose_ = OdometryPose();
+}
+
+void Odometry::update(int64_t leftCount, int64_t rightCount) {
+  // 一个周期的增量远小于2^31，先用64位相减再转为32位
+  int32_t deltaLeft = (int32_t)(leftCount - lastLeft_);
+  int32_t deltaRight = (int32_t)(rightCount - lastRight_);
+  lastLeft_ = leftCount;
+  lastRight_ = rightCount;
+  pose_.updates++;
+  if (deltaLeft == 0 && deltaRight == 0) return;
+
+  float dl = deltaLeft * metersPerEdge_;
+  float dr = deltaRight * metersPerEdge_;
+  float ds = 0.5f * (dl + dr);
+  float dtheta = (dr - dl) / trackWidth_;
+
+  // 弦长 = 弧长·sin(h)/h，h = dθ/2; |h|很小时用 1 - h²/6 (误差 < h⁴/120)
+  float half = 0.5f * dtheta;
+  float chord = fabsf(half) < 1e-3f ? ds * (1.0f - half * half * (1.0f / 6.0f)) : ds * sinf(half) / half;
+  float heading = pose_.theta + half;
+  pose_.x += chord * cosf(heading);
+  pose_.y += chord * sinf(heading);
+  pose_.distance += 0.5f * (fabsf(dl) + fabsf(dr));
+
+  float theta = pose_.theta + dtheta;
+  if (theta > (float)M_PI) {
+    theta -= 2.0f * (float)M_PI;
+  } else if (theta <= -(float)M_PI) {
+    theta += 2.0f * (float)M_PI;
+  }
+  pose_.theta = theta;
+}
@@ -0,0 +1,70 @@
+/*
+ * odometry.hpp - 由两轮编码器计数积分车体位姿 (x, y, θ)
+ *
+ * **中文注释:**
+ * 每个控制周期用两轮64位计数值相对上一周期的增量 ΔNl、ΔNr 更新位姿:
+ *   dl = ΔNl·k,  dr = ΔNr·k   (k = 2πr / 每转边沿数，每个边沿对应的轮缘行程)
+ *   ds = (dl + dr) / 2,  dθ = (dr - dl) / L
+ * 假设一个周期内两轮速度之比不变，车体沿圆弧运动 (精确圆弧积分):
+ *   x += ds·sinc(dθ/2)·cos(θ + dθ/2),  y += ds·sinc(dθ/2)·sin(θ + dθ/2),  θ += dθ
+ * 其中 sinc(h) = sin(h)/h 是弦长与弧长之比; 直行时 (dθ→0) 用泰勒展开避免除以0。
+ * 欧拉法 (x += ds·cos θ) 在转弯时每个周期都有 O(dθ²) 的误差，周期越长、转得越快误差越大。
+ * 计数增量由64位计数值相减，不受32位回绕影响; 位姿用float保存，θ保持在(-π, π]。
+ */
+
+#ifndef ODOMETRY_HPP_
+#define ODOMETRY_HPP_
+
+#include <stdint.h>
+
+/**
+ * @struct OdometryPose
+ * @brief 里程计位姿快照 (由控制任务发布，其他任务读取)。
+ */
+struct OdometryPose {
+  float x;          // 位置 (m)，reset()时车头方向为+x
+  float y;          // 位置 (m)，左侧为+y
+  float theta;      // 航向 (rad, -π..π]，左转为正
+  float distance;   // 累计行驶路程 (m，两轮轮缘行程绝对值的平均，后退与原地转向也计入)
+  uint32_t updates; // reset()以来的update()次数
+};
+
+/**
+ * @class Odometry
+ * @brief 差速驱动里程计: 精确圆弧积分。
+ */
+class Odometry {
+public:
+  /**
+   * @param edgesPerRev 每转边沿数 (PULSES_PER_REV)
+   * @param wheelRadiusM 车轮半径 (m)
+   * @param trackWidthM 两轮间距 (m)
+   */
+  Odometry(float edgesPerRev, float wheelRadiusM, float trackWidthM);
+
+  /**
+   * @brief 位姿清零，以当前计数值作为起点。
+   */
+  void reset(int64_t leftCount, int64_t rightCount);
+
+  /**
+   * @brief 每个控制周期调用一次。
+   * @param leftCount 左轮编码器的64位计数值 (ESP32Encoder::getCount())。
+   * @param rightCount 右轮编码器的64位计数值。
+   */
+  void update(int64_t leftCount, int64_t rightCount);
+
+  /**
+   * @brief 当前位姿。
+   */
+  const OdometryPose &pose() const { return pose_; }
+
+private:
+  float metersPerEdge_;
+  float trackWidth_;
+  int64_t lastLeft_;
+  int64_t lastRight_;
+  OdometryPose pose_;
+};
+
+#endif /* ODOMETRY_HPP_ */
@@ -0,0 +1,143 @@
+/*
+ * pi_design.h - 由一阶被控对象模型在编译期设计离散PI控制器
+ *
+ * **中文注释:**
+ * 被控对象 (车轮速度对占空比) 为一阶模型 P(s) = G / (τs + 1)，G为满量程占空比时的稳态速度 (rad/s)。
+ * PI控制器的零点对消被控对象的极点 (Ti = τ)，闭环为时间常数λ的一阶系统:
+ *   C(s) = Kp·(1 + 1/(Ti·s)),  Kp = τ / (G·λ)·满量程,  Ti = τ
+ * 离散PI写成增量形式 u[k] = u[k-1] + R0·e[k] + R1·e[k-1]，三种离散化方法 (Te为控制周期):
+ *   - 后向欧拉 (基础草图的方法):  R0 = Kp·(1 + Te/Ti),     R1 = -Kp
+ *   - 双线性 (Tustin):          R0 = Kp·(1 + Te/(2Ti)),   R1 = -Kp·(1 - Te/(2Ti))
+ *   - 零阶保持: 直接在零阶保持离散化的被控对象 b / (z - a) 上设计 (a = e^(-Te/τ), b = G·(1-a)/满量程)，
+ *     控制器零点精确对消极点a，闭环极点正好是 p = e^(-Te/λ):
+ *                               R0 = (1 - p) / b,         R1 = -a·R0
+ * 前两种方法在Te与τ、λ相比不小时零点对消不准，闭环变慢甚至不稳定; 零阶保持方法在任何周期下都精确。
+ * 草图中的PI是并联形式 u = kp·e[k] + ki·Σe·Te (积分包含本周期的误差)，与增量形式等价:
+ *   kp = -R1,  ki = (R0 + R1) / Te
+ * 稳定性按零阶保持的被控对象与控制器组成的闭环特征多项式检查 (不计测量与计算延迟):
+ *   z² + (b·R0 - 1 - a)·z + (a + b·R1)
+ * 全部函数都是constexpr，结果赋给constexpr变量时在编译期计算，草图用static_assert检查稳定性与PWM范围，
+ * 目标板上只剩两个常数。exp与sqrt用级数和牛顿迭代实现 (标准库的数学函数不是constexpr)。
+ *
+ *   constexpr PiCoeffs c = pi_design(0.0302, 50.01, 0.010, 0.001, 32767, PiDiscretization::ZeroOrderHold);
+ *   static_assert(pi_design_stable(c, 0.0302, 50.01, 0.001, 32767), "闭环不稳定");
+ */
+
+#ifndef PI_DESIGN_H_
+#define PI_DESIGN_H_
+
+/**
+ * @brief 连续PI的离散化方法。
+ */
+enum class PiDiscretization {
+  BackwardEuler,
+  Tustin,
+  ZeroOrderHold,
+};
+
+/**
+ * @struct PiCoeffs
+ * @brief 离散PI系数 (控制量单位为PWM计数，误差单位为rad/s)。
+ */
+struct PiCoeffs {
+  double r0;  // 增量形式 u[k] = u[k-1] + r0·e[k] + r1·e[k-1]
+  double r1;
+  double kp;  // 并联形式 u = kp·e[k] + ki·Σe·Te
+  double ki;
+};
+
+// 先把x折半到|x| < 0.5再用泰勒级数，最后逐次平方，精度约1e-15
+constexpr double pi_design_exp(double x) {
+  int halvings = 0;
+  while ((x > 0.5 || x < -0.5) && halvings < 64) {
+    x *= 0.5;
+    halvings++;
+  }
+  double term = 1.0, sum = 1.0;
+  for (int n = 1; n < 20; n++) {
+    term *= x / n;
+    sum += term;
+  }
+  for (int i = 0; i < halvings; i++) sum *= sum;
+  return sum;
+}
+
+constexpr double pi_design_sqrt(double x) {
+  if (x <= 0.0) return 0.0;
+  double r = x > 1.0 ? x : 1.0;
+  for (int i = 0; i < 100; i++) {
+    double next = 0.5 * (r + x / r);
+    if (next == r) break;
+    r = next;
+  }
+  return r;
+}
+
+constexpr double pi_design_abs(double x) {
+  return x < 0.0 ? -x : x;
+}
+
+/**
+ * @brief 参数能否用于设计 (时间常数、增益、周期、满量程都为正)。
+ */
+constexpr bool pi_design_ok(double tauS, double gain, double lambdaS, double periodS, double fullScale) {
+  return tauS > 0.0 && gain > 0.0 && lambdaS > 0.0 && periodS > 0.0 && fullScale > 0.0;
+}
+
+/**
+ * @brief 设计离散PI系数。
+ * @param tauS 被控对象时间常数τ (秒)
+ * @param gain 被控对象静态增益G (rad/s，满量程占空比)
+ * @param lambdaS 期望闭环时间常数λ (秒)
+ * @param periodS 控制周期Te (秒)
+ * @param fullScale 满量程占空比对应的控制量 (PWM计数)
+ * @param method 离散化方法
+ */
+constexpr PiCoeffs pi_design(double tauS, double gain, double lambdaS, double periodS, double fullScale,
+                             PiDiscretization method) {
+  double r0 = 0.0, r1 = 0.0;
+  if (method == PiDiscretization::ZeroOrderHold) {
+    double a = pi_design_exp(-periodS / tauS);
+    double b = gain * (1.0 - a) / fullScale;
+    r0 = (1.0 - pi_design_exp(-periodS / lambdaS)) / b;
+    r1 = -a * r0;
+  } else {
+    double kp = tauS / (gain * lambdaS) * fullScale;  // Ti = τ
+    if (method == PiDiscretization::Tustin) {
+      r0 = kp * (1.0 + 0.5 * periodS / tauS);
+      r1 = -kp * (1.0 - 0.5 * periodS / tauS);
+    } else {
+      r0 = kp * (1.0 + periodS / tauS);
+      r1 = -kp;
+    }
+  }
+  return {r0, r1, -r1, (r0 + r1) / periodS};
+}
+
+/**
+ * @brief 闭环极点的最大模 (零阶保持的被控对象，不计延迟)，小于1时闭环稳定。
+ */
+constexpr double pi_design_pole_radius(const PiCoeffs &c, double tauS, double gain, double periodS,
+                                       double fullScale) {
+  double a = pi_design_exp(-periodS / tauS);
+  double b = gain * (1.0 - a) / fullScale;
+  double c1 = b * c.r0 - 1.0 - a, c0 = a + b * c.r1;
+  double disc = c1 * c1 - 4.0 * c0;
+  if (disc < 0.0) return pi_design_sqrt(c0);  // 共轭复根，模的平方等于常数项
+  double root = pi_design_sqrt(disc);
+  double p1 = pi_design_abs(-c1 + root), p2 = pi_design_abs(-c1 - root);
+  return 0.5 * (p1 > p2 ? p1 : p2);
+}
+
+constexpr bool pi_design_stable(const PiCoeffs &c, double tauS, double gain, double periodS, double fullScale) {
+  return pi_design_pole_radius(c, tauS, gain, periodS, fullScale) < 1.0;
+}
+
+/**
+ * @brief 从静止阶跃到maxSpeed时，第一个周期的控制量 (r0·maxSpeed) 与稳态控制量都不超过满量程。
+ */
+constexpr bool pi_design_fits_pwm(const PiCoeffs &c, double gain, double maxSpeed, double fullScale) {
+  return pi_design_abs(c.r0 * maxSpeed) <= fullScale && pi_design_abs(maxSpeed) <= gain;
+}
+
+#endif /* PI_DESIGN_H_ */
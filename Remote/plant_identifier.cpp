@@ -0,0 +1,100 @@
+#include "plant_identifier.hpp"
+
+#include <math.h>
+
+/**
+ * **中文注释:**
+ * RLS辨识器的实现 (公式见plant_identifier.hpp)。
+ */
+
+namespace {
+
+const float INITIAL_COVARIANCE = 100.0f;  // 初始P = 100·I: 标称模型只作为起点，很快被样本覆盖
+const float MAX_COVARIANCE_TRACE = 1e4f;  // trace(P)超过此值时暂停遗忘
+const float MIN_SPEED = 0.05f;            // 段起点速度与平均占空比都小于此值时视为静止，不更新
+const float MIN_DUTY = 0.002f;
+const uint32_t MIN_VARIANCE_UPDATES = 20; // 回归次数少于此值时σ²还不可信，估计值与不确定度都为NaN
+
+} // namespace
+
+PlantIdentifier::PlantIdentifier(float periodS, uint32_t decimation, float forgetting, float convergedPct)
+    : periodS_(periodS * (decimation > 0 ? decimation : 1)), decimation_(decimation > 0 ? decimation : 1),
+      forgetting_(forgetting), convergedPct_(convergedPct) {
+  reset(0.03f, 50.0f);
+}
+
+void PlantIdentifier::reset(float tauS, float gain) {
+  a_ = expf(-periodS_ / tauS);
+  b_ = gain * (1.0f - a_);
+  p11_ = p22_ = INITIAL_COVARIANCE;
+  p12_ = 0.0f;
+  noiseVar_ = 0.0f;
+  updates_ = 0;
+  restart();
+}
+
+bool PlantIdentifier::update(float duty, float speed) {
+  // 一段以一个速度样本开始，累加decimation个占空比，下一段起点的速度就是这一段的终点
+  bool updated = false;
+  if (blockCount_ == decimation_) {
+    float meanDuty = dutySum_ / decimation_;
+    if (fabsf(startSpeed_) >= MIN_SPEED || fabsf(meanDuty) >= MIN_DUTY) {
+      regress(startSpeed_, meanDuty, speed);
+      updated = true;
+    }
+    blockCount_ = 0;
+    dutySum_ = 0.0f;
+  }
+  if (blockCount_ == 0) startSpeed_ = speed;
+  dutySum_ += duty;
+  blockCount_++;
+  return updated;
+}
+
+void PlantIdentifier::regress(float x1, float x2, float speed) {
+  // φ = (x1, x2) = (段起点速度, 平均占空比)，speed为段终点速度
+  // Pφ与φᵀPφ
+  float pp1 = p11_ * x1 + p12_ * x2;
+  float pp2 = p12_ * x1 + p22_ * x2;
+  float lambda = p11_ + p22_ > MAX_COVARIANCE_TRACE ? 1.0f : forgetting_;
+  float denom = lambda + x1 * pp1 + x2 * pp2;
+  float k1 = pp1 / denom, k2 = pp2 / denom;
+
+  float error = speed - (a_ * x1 + b_ * x2);
+  a_ += k1 * error;
+  b_ += k2 * error;
+
+  // P = (P - K·(Pφ)ᵀ) / λ，只计算上三角并保持对称
+  float inv = 1.0f / lambda;
+  p11_ = (p11_ - k1 * pp1) * inv;
+  p12_ = (p12_ - k1 * pp2) * inv;
+  p22_ = (p22_ - k2 * pp2) * inv;
+
+  // σ²: 开始时按已有的样本平均 (权重1/n)，之后是记忆长度为1/(1-λ)的指数平均
+  updates_++;
+  float weight = 1.0f / updates_;
+  if (weight < 1.0f - forgetting_) weight = 1.0f - forgetting_;
+  noiseVar_ += weight * (error * error - noiseVar_);
+}
+
+PlantEstimate PlantIdentifier::estimate() const {
+  PlantEstimate e;
+  e.updates = updates_;
+  e.residualRms = sqrtf(noiseVar_);
+  if (updates_ >= MIN_VARIANCE_UPDATES && a_ > 0.0f && a_ < 1.0f) {
+    float logA = logf(a_);
+    e.tauMs = -periodS_ / logA * 1e3f;
+    e.gain = b_ / (1.0f - a_);
+    float stdA = sqrtf(noiseVar_ * fmaxf(p11_, 0.0f));
+    float stdB = sqrtf(noiseVar_ * fmaxf(p22_, 0.0f));
+    e.tauErrPct = 100.0f * stdA / (a_ * -logA);
+    e.gainErrPct = 100.0f * (stdB / fabsf(b_) + stdA / (1.0f - a_));
+  } else {
+    // 还没有足够的样本 (或a不是一阶稳定模型): 不报告标称值，也不报告0%的不确定度
+    e.tauMs = e.gain = e.tauErrPct = e.gainErrPct = NAN;
+    if (updates_ < MIN_VARIANCE_UPDATES) e.residualRms = NAN;
+  }
+  float memory = forgetting_ < 1.0f ? 1.0f / (1.0f - forgetting_) : 0.0f;
+  e.converged = updates_ >= memory && e.tauErrPct < convergedPct_ && e.gainErrPct < convergedPct_;  // NaN时为false
+  return e;
+}
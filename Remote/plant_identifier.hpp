@@ -0,0 +1,102 @@
+/*
+ * plant_identifier.hpp - 递推最小二乘 (RLS) 在线辨识一阶被控对象的TAU与G
+ *
+ * **中文注释:**
+ * TAU与G是一次性手工辨识的，电池电压、负载与温度变化后它们也会变化。
+ * 车轮速度对占空比的一阶模型按零阶保持离散化 (控制周期Te):
+ *   ω[k] = a·ω[k-1] + b·u[k-1],  a = e^(-Te/τ),  b = G·(1 - a)
+ * 1 kHz时a≈0.967，τ对a的误差很敏感 (dτ/τ = -da/(a·ln a))，而M/T法测速每个周期只有几个边沿，
+ * 所以每decimation个控制周期才回归一次: 间隔 T = decimation·Te，u取这段时间内占空比的平均值
+ * (设定点经过轨迹限制，一段时间内u平滑变化，平均值的模型误差很小)，ω取这段时间结束时的测量速度，
+ * a = e^(-T/τ)、b = G·(1 - a)。每个回归样本给出一个方程，参数θ = (a, b)用带遗忘因子λ的RLS估计:
+ *   φ = (ω[k-1], u[k-1]),  e = ω[k] - φᵀθ,  K = Pφ / (λ + φᵀPφ),  θ += K·e,  P = (P - K·φᵀP) / λ
+ * 记忆长度约 1/(1-λ) 个回归样本，参数漂移时估计值跟着变化。再由θ换算回 τ = -T / ln a、G = b / (1 - a)。
+ * 防止协方差发散 (windup): 车轮静止 (φ≈0) 时不更新; 速度恒定时φ只在一个方向上有信息，
+ * 另一个方向的P会按1/λ不断增大，所以trace(P)超过上限时本次不除以λ。
+ * 估计值的不确定度由残差方差σ²与P估计 (std(a) ≈ σ·√P11)，换算为τ与G的相对误差，
+ * 样本数达到一个记忆长度且两者都小于convergedPct时认为已收敛。回归次数太少、σ²还不可信时，
+ * τ、G与不确定度都是NaN (而不是标称值与0%)。
+ * 只有2×2的协方差 (对称，保存3个数)，每次回归约四十次浮点运算，其余的update()只累加占空比。
+ */
+
+#ifndef PLANT_IDENTIFIER_HPP_
+#define PLANT_IDENTIFIER_HPP_
+
+#include <stdint.h>
+
+/**
+ * @struct PlantEstimate
+ * @brief 辨识结果快照 (由辨识任务发布，其他任务读取)。
+ */
+struct PlantEstimate {
+  float tauMs;        // 时间常数 (毫秒)
+  float gain;         // 静态增益 (rad/s，满量程占空比)
+  float tauErrPct;    // τ的相对不确定度 (%)
+  float gainErrPct;   // G的相对不确定度 (%)
+  float residualRms;  // 一步预测误差的均方根 (rad/s)，回归次数不足时为NaN
+  uint32_t updates;   // 参与估计的样本数 (跳过的静止样本不计)
+  bool converged;     // 不确定度低于阈值且样本数足够
+};
+
+/**
+ * @class PlantIdentifier
+ * @brief 一个车轮的RLS辨识器。
+ */
+class PlantIdentifier {
+public:
+  /**
+   * @param periodS 样本间隔 (控制周期，秒)
+   * @param decimation 每多少个样本回归一次 (≥ 1)
+   * @param forgetting 遗忘因子λ (0 < λ ≤ 1)，按回归样本计，例如1 kHz、decimation 10时0.995约记忆2秒
+   * @param convergedPct 认为已收敛的τ与G相对不确定度 (%)
+   */
+  PlantIdentifier(float periodS, uint32_t decimation, float forgetting, float convergedPct = 5.0f);
+
+  /**
+   * @brief 以标称模型作为初始估计，清除协方差与样本序列。
+   * @param tauS 标称时间常数 (秒)
+   * @param gain 标称静态增益
+   */
+  void reset(float tauS, float gain);
+
+  /**
+   * @brief 样本序列中断 (样本丢失或不是按周期采样): 下一个样本只作为新的起点。
+   */
+  void restart() {
+    blockCount_ = 0;
+    dutySum_ = 0.0f;
+  }
+
+  /**
+   * @brief 每个控制周期输入一个样本。
+   * @param duty 本周期施加的归一化占空比 (-1..1，已限幅)
+   * @param speed 本周期开始时测量的车轮速度 (rad/s)
+   * @return 本次是否更新了估计值 (每decimation个样本最多一次)
+   */
+  bool update(float duty, float speed);
+
+  /**
+   * @brief 当前估计值 (回归次数不足或a不在(0, 1)之间时τ、G与不确定度为NaN)。
+   */
+  PlantEstimate estimate() const;
+
+private:
+  void regress(float startSpeed, float meanDuty, float endSpeed);
+
+  float periodS_;     // 回归间隔 T = decimation·Te
+  uint32_t decimation_;
+  float forgetting_;
+  float convergedPct_;
+  float a_;           // θ = (a, b)
+  float b_;
+  float p11_;         // 协方差 P = [p11 p12; p12 p22]
+  float p12_;
+  float p22_;
+  float noiseVar_;    // 残差方差σ²的指数平均
+  uint32_t updates_;
+  float startSpeed_;  // 本段起点的速度
+  uint32_t blockCount_; // 本段已累加的样本数 (0: 下一个样本是新的起点)
+  float dutySum_;
+};
+
+#endif /* PLANT_IDENTIFIER_HPP_ */
@@ -0,0 +1,90 @@
+/*
+ * setpoint_profile.h - 加速度与加加速度 (jerk) 受限的设定点轨迹
+ *
+ * **中文注释:**
+ * 放在指令输入与PI控制器之间: 目标速度阶跃时，PI控制器看到的参考值r以受限的
+ * 加速度a (|a| ≤ maxAccel) 和加加速度 (|da/dt| ≤ maxJerk) 平滑地到达目标值，
+ * 误差不再一步跳到整个阶跃，比例项不会在第一个周期把PWM打满，积分也不会因此饱和。
+ * 每个控制周期O(1)计算，只保存(r, a)两个状态，目标值可以随时改变 (包括运动途中反向):
+ *   1. e = 目标值 - r; 以最大jerk把变化率x逐周期减到0，连同本周期共走 x²/(2·maxJerk) + x·dt/2
+ *      (离散时间的制动距离)，所以为了恰好停在目标值，本周期的变化率不能超过
+ *      x* = maxJerk·(√(dt²/4 + 2|e|/maxJerk) - dt/2)，同时不超过maxAccel，且本周期不越过目标值
+ *      (x ≤ |e|/dt);
+ *   2. a以不超过maxJerk·dt的步长向sign(e)·x*靠近，r += a·dt;
+ *   3. 到达或越过目标值、且a已不超过一步的变化量时，落到目标值 (a = 0)。
+ * 从静止出发的阶跃: 加加速度段 -> 匀加速段 (短阶跃没有) -> 减加速度段，
+ * 用时约 |Δ|/maxAccel + maxAccel/maxJerk (短阶跃为 2·√(|Δ|/maxJerk))，不超调
+ * (只有比maxJerk·dt²还小的阶跃可能越过目标值不到maxJerk·dt²)。
+ */
+
+#ifndef SETPOINT_PROFILE_H_
+#define SETPOINT_PROFILE_H_
+
+#include <math.h>
+
+/**
+ * @class JerkLimitedProfile
+ * @brief 一路设定点的加速度/加加速度限制。
+ */
+class JerkLimitedProfile {
+public:
+  /**
+   * @param maxAccel 参考值变化率的上限 (单位/秒，速度设定点为rad/s²)
+   * @param maxJerk 变化率的变化率上限 (单位/秒²，速度设定点为rad/s³)
+   */
+  JerkLimitedProfile(float maxAccel, float maxJerk) : maxAccel_(maxAccel), maxJerk_(maxJerk) {}
+
+  /**
+   * @brief 参考值直接设为value，变化率清零 (启动或急停时使用)。
+   */
+  void reset(float value) {
+    value_ = value;
+    rate_ = 0.0f;
+  }
+
+  /**
+   * @brief 每个控制周期调用一次，参考值向目标值前进dt秒。
+   * @param target 目标值 (指令)
+   * @param dt 控制周期 (秒)，为0时参考值不变
+   * @return 本周期的参考值 (送给PI控制器)
+   */
+  float update(float target, float dt) {
+    if (!(dt > 0.0f)) return value_;
+    float error = target - value_;
+    float distance = fabsf(error);
+    float jerkStep = maxJerk_ * dt;
+
+    // 沿误差方向允许的最大变化率 (离散制动距离、maxAccel、本周期不越过目标值)
+    float halfStep = 0.5f * jerkStep;
+    float want = sqrtf(halfStep * halfStep + 2.0f * maxJerk_ * distance) - halfStep;
+    if (want > maxAccel_) want = maxAccel_;
+    if (want > distance / dt) want = distance / dt;
+    if (error < 0.0f) want = -want;
+
+    float change = want - rate_;
+    if (change > jerkStep) change = jerkStep;
+    if (change < -jerkStep) change = -jerkStep;
+    float lastRate = rate_;
+    rate_ += change;
+
+    float next = value_ + rate_ * dt;
+    if ((target - next) * error <= 0.0f && fabsf(lastRate) <= jerkStep) {
+      // 到达或越过目标值: 落到目标值，变化率归零也在一步的jerk限制之内
+      next = target;
+      rate_ = 0.0f;
+    }
+    value_ = next;
+    return value_;
+  }
+
+  float value() const { return value_; }
+  float rate() const { return rate_; }
+
+private:
+  float maxAccel_;
+  float maxJerk_;
+  float value_ = 0.0f;
+  float rate_ = 0.0f;
+};
+
+#endif /* SETPOINT_PROFILE_H_ */
@@ -0,0 +1,83 @@
+/*
+ * speed_estimator.cpp - M/T法车轮速度估计的实现
+ *
+ * **中文注释:**
+ * 计数值与时间戳都按32位回绕安全的差值计算。
+ */
+
+#include "speed_estimator.hpp"
+
+MTSpeedEstimator::MTSpeedEstimator(float edgesPerRev, uint32_t timeoutUs)
+  : radPerEdgeUs_(2.0f * 3.14159265f / edgesPerRev * 1e6f), timeoutUs_(timeoutUs) {
+  reset();
+}
+
+void MTSpeedEstimator::reset() {
+  started_ = false;
+  lastCount_ = 0;
+  lastTimeUs_ = 0;
+  lastUpdateUs_ = 0;
+  idle_ = false;
+  speed_ = 0.0f;
+}
+
+float MTSpeedEstimator::update(bool hasEdge, int32_t edgeCount, uint32_t edgeTimeUs, uint32_t nowUs) {
+  if (!hasEdge) {
+    // 还没有边沿 (或计数被清零): 静止，以当前计数值为起点
+    started_ = true;
+    lastCount_ = edgeCount;
+    lastTimeUs_ = nowUs;
+    lastUpdateUs_ = nowUs;
+    idle_ = true;
+    speed_ = 0.0f;
+    return speed_;
+  }
+  if (!started_) {
+    // 中途开始估计: 第一个边沿只作为起点
+    started_ = true;
+    lastCount_ = edgeCount;
+    lastTimeUs_ = edgeTimeUs;
+    lastUpdateUs_ = nowUs;
+    speed_ = 0.0f;
+    return speed_;
+  }
+
+  int32_t edges = (int32_t)((uint32_t)edgeCount - (uint32_t)lastCount_);
+  uint32_t spanUs = edgeTimeUs - lastTimeUs_;
+
+  if (spanUs != 0) {
+    // 有新边沿: 两个参考边沿之间恰好有edges个边沿 (方向反转时可能为0)
+    if (idle_) {
+      if (edges == 1 || edges == -1) {
+        // 重新起步后的第一个边沿: 不知道它之前的边沿间隔，只作为新的参考边沿
+        // (周期很短时用距上一次update()的时间做分母会把速度高估许多倍)
+        lastCount_ = edgeCount;
+        lastTimeUs_ = edgeTimeUs;
+        lastUpdateUs_ = nowUs;
+        idle_ = false;
+        speed_ = 0.0f;
+        return speed_;
+      }
+      // 重新起步: 新边沿都发生在上一次update()之后
+      spanUs = edgeTimeUs - lastUpdateUs_;
+    }
+    speed_ = spanUs != 0 ? edges * radPerEdgeUs_ / (float)spanUs : 0.0f;
+    lastCount_ = edgeCount;
+    lastTimeUs_ = edgeTimeUs;
+    idle_ = false;
+  } else {
+    // 没有新边沿: 速度不超过 1个边沿/距上一个边沿的时间
+    // (控制周期比边沿间隔短时这是常态，参考边沿保持不变，下一个边沿仍按真实间隔计算)
+    uint32_t sinceUs = nowUs - lastTimeUs_;
+    if (sinceUs >= timeoutUs_) {
+      speed_ = 0.0f;
+      idle_ = true;
+    } else if (sinceUs > 0) {
+      float bound = radPerEdgeUs_ / (float)sinceUs;
+      if (speed_ > bound) speed_ = bound;
+      if (speed_ < -bound) speed_ = -bound;
+    }
+  }
+  lastUpdateUs_ = nowUs;
+  return speed_;
+}
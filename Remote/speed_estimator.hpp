@@ -0,0 +1,66 @@
+/*
+ * speed_estimator.hpp - M/T法车轮速度估计
+ *
+ * **中文注释:**
+ * 固定周期内数边沿(M法，ΔN/T)的分辨率是 2π/(PULSES_PER_REV*T)，1320边沿/转、50毫秒周期时
+ * 约0.095 rad/s，低速时测量值在相邻的量化台阶之间跳动，PI控制器会追着这个噪声调节。
+ * M/T法用"两个控制周期各自最后一个边沿之间"的时间代替固定周期T:
+ *   速度 = ΔN / (t_最后边沿 - t_上一周期最后边沿)
+ * 分子是整数个边沿，分母是精确测得的时间，因此低速时分辨率取决于时间戳精度(1微秒)，
+ * 高速时与M法一样在每个周期都有新值。
+ * 一个周期内没有新边沿时，速度不可能超过"1个边沿 / 距上一个边沿的时间"，
+ * 估计值按这个上界衰减，超过timeoutUs仍没有边沿则判定为停止。
+ * 判定为停止之后重新起步时，参考边沿之后的静止时间不计入分母，改为从上一次update()的时刻算起
+ * (只有一个新边沿时它只作为新的参考边沿，速度仍为0);
+ * 未超时的周期没有新边沿 (控制周期短于边沿间隔) 不算停止，下一个边沿仍按与参考边沿的间隔计算。
+ */
+
+#ifndef SPEED_ESTIMATOR_HPP_
+#define SPEED_ESTIMATOR_HPP_
+
+#include <stdint.h>
+
+/**
+ * @class MTSpeedEstimator
+ * @brief 由最后一个边沿的(计数值, 时刻)估计角速度。
+ */
+class MTSpeedEstimator {
+public:
+  /**
+   * @param edgesPerRev 每转边沿数 (PULSES_PER_REV)。
+   * @param timeoutUs 超过此时间没有边沿则速度为0 (微秒)。
+   */
+  MTSpeedEstimator(float edgesPerRev, uint32_t timeoutUs);
+
+  /**
+   * @brief 清除历史，下一个边沿重新作为起点。
+   */
+  void reset();
+
+  /**
+   * @brief 每个控制周期调用一次。
+   * @param hasEdge 是否已经记录到边沿 (ESP32Encoder::getLastEdge()的返回值)。
+   * @param edgeCount 最后一个边沿之后的计数值 (没有边沿时为当前计数值)。
+   * @param edgeTimeUs 最后一个边沿的时刻。
+   * @param nowUs 当前时刻。
+   * @return 角速度 (rad/s)。
+   */
+  float update(bool hasEdge, int32_t edgeCount, uint32_t edgeTimeUs, uint32_t nowUs);
+
+  /**
+   * @brief 最近一次update()的结果 (rad/s)。
+   */
+  float speed() const { return speed_; }
+
+private:
+  float radPerEdgeUs_;   // 1个边沿/微秒 对应的角速度 (rad/s)
+  uint32_t timeoutUs_;
+  bool started_;         // lastCount_有效
+  int32_t lastCount_;    // 上一个参考边沿的计数值
+  uint32_t lastTimeUs_;  // 上一个参考边沿的时刻
+  uint32_t lastUpdateUs_; // 上一次update()的时刻
+  bool idle_;            // 上一个周期没有新边沿
+  float speed_;
+};
+
+#endif /* SPEED_ESTIMATOR_HPP_ */
@@ -0,0 +1,74 @@
+/*
+ * telemetry_ring.h - 单生产者/单消费者的无锁遥测环形缓冲区
+ *
+ * **中文注释:**
+ * 控制任务(生产者)每个周期放入一个定长的二进制样本，低优先级的记录任务(消费者)
+ * 取出后再格式化、写串口，控制周期不再包含浮点格式化和等待UART的时间:
+ *   - head_只由生产者写，tail_只由消费者写，各自用release发布、对方用acquire读取;
+ *   - 缓冲区满时push()立即返回false并累加丢弃计数，生产者永远不会等待消费者;
+ *   - 下标是自由增长的32位计数，N必须是2的幂，回绕后差值仍然正确。
+ * 只允许一个生产者和一个消费者。T必须可平凡复制 (trivially copyable)。
+ */
+
+#ifndef TELEMETRY_RING_H_
+#define TELEMETRY_RING_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @class TelemetryRing
+ * @brief 定长样本的SPSC环形缓冲区。
+ * @tparam T 样本类型 (可平凡复制)。
+ * @tparam N 容量 (2的幂)。
+ */
+template <typename T, uint32_t N>
+class TelemetryRing {
+  static_assert(std::is_trivially_copyable<T>::value, "TelemetryRing requires a trivially copyable type");
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "TelemetryRing capacity must be a power of two");
+
+public:
+  TelemetryRing() : head_(0), tail_(0), dropped_(0) {}
+
+  /**
+   * @brief 放入一个样本 (只能由生产者调用，不阻塞)。
+   * @return 缓冲区已满时丢弃样本并返回false。
+   */
+  bool push(const T &sample) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= N) {
+      dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    slots_[head & (N - 1)] = sample;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief 取出最早的样本 (只能由消费者调用)。
+   * @return 缓冲区为空时返回false。
+   */
+  bool pop(T *out) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;
+    *out = slots_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief 因缓冲区满而丢弃的样本数。
+   */
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  T slots_[N];
+  std::atomic<uint32_t> head_;     // 下一个写入位置 (生产者)
+  std::atomic<uint32_t> tail_;     // 下一个读取位置 (消费者)
+  std::atomic<uint32_t> dropped_;  // 只由生产者修改
+};
+
+#endif /* TELEMETRY_RING_H_ */
@@ -0,0 +1,80 @@
+/*
+ * triple_buffer.hpp - 单写者/单读者的无锁快照缓冲区
+ *
+ * **中文注释:**
+ * 在两个任务之间传递"最新值"(期望速度、测量速度、遥测快照等)，
+ * 写者与读者都不会阻塞，也不会重试:
+ *   - 三个槽位分别由写者(back)、读者(front)持有，第三个(middle)用于交换;
+ *   - 写者写完back后，用一次原子交换把它与middle互换，并置FRESH标志;
+ *   - 读者发现FRESH时，用一次原子交换把front与middle互换并清除标志。
+ * 与portENTER_CRITICAL不同，两边都不会关中断或自旋等待对方，控制任务所在的核心
+ * 不会被另一个核心上的WiFi任务拖住; 与seqlock不同，读者不需要重试，因此
+ * 高优先级的读者抢占了同一核心上写到一半的写者时也不会卡住。
+ *
+ * 只允许一个写者和一个读者。有多个写者时由调用者在写者之间加锁 (读者不受影响)。
+ * T必须可平凡复制 (trivially copyable)。
+ */
+
+#ifndef TRIPLE_BUFFER_HPP_
+#define TRIPLE_BUFFER_HPP_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @class TripleBuffer
+ * @brief 单写者/单读者的最新值快照。
+ * @tparam T 快照类型 (可平凡复制)。
+ */
+template <typename T>
+class TripleBuffer {
+  static_assert(std::is_trivially_copyable<T>::value, "TripleBuffer requires a trivially copyable type");
+
+public:
+  /**
+   * @brief 所有槽位初始化为initial，读者在第一次写入之前读到initial。
+   */
+  explicit TripleBuffer(const T &initial = T()) : middle_(1), back_(2), front_(0) {
+    slots_[0] = initial;
+    slots_[1] = initial;
+    slots_[2] = initial;
+  }
+
+  /**
+   * @brief 发布一个新值 (只能由写者调用)。
+   */
+  void write(const T &value) {
+    slots_[back_] = value;
+    uint32_t prev = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+    back_ = (uint8_t)(prev & INDEX_MASK);
+  }
+
+  /**
+   * @brief 读取最新发布的值 (只能由读者调用)。
+   * @param out 总是写入最新的值。
+   * @return 自上次read()以来有新值发布时返回true。
+   */
+  bool read(T *out) {
+    bool fresh = (middle_.load(std::memory_order_relaxed) & FRESH) != 0;
+    if (fresh) {
+      // 只有读者会清除FRESH，因此交换前后标志不会丢失
+      uint32_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+      front_ = (uint8_t)(prev & INDEX_MASK);
+    }
+    *out = slots_[front_];
+    return fresh;
+  }
+
+private:
+  static const uint32_t INDEX_MASK = 0x3;
+  static const uint32_t FRESH = 0x4;   // middle槽位中有读者尚未取走的新值
+
+  T slots_[3];
+  std::atomic<uint32_t> middle_;       // 交换槽位的下标 | FRESH
+  uint8_t back_;                       // 写者独占的槽位
+  uint8_t front_;                      // 读者独占的槽位
+};
+
+#endif /* TRIPLE_BUFFER_HPP_ */
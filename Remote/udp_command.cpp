@@ -0,0 +1,112 @@
+/*
+ * udp_command.cpp - UDP遥控指令协议的实现
+ *
+ * **中文注释:**
+ * 所有时间与序号的比较都使用32位回绕安全的差值 (转换为有符号数)，
+ * 因此微秒时钟约71分钟的回绕和序号回绕都不会造成误判。
+ */
+
+#include "udp_command.hpp"
+
+static void put_u16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void udp_command_encode(const UdpCommand &cmd, uint8_t *out) {
+  bool twist = cmd.kind == UDP_CMD_TWIST;
+  put_u16(out, twist ? UDP_CMD_MAGIC_TWIST : UDP_CMD_MAGIC);
+  put_u16(out + 2, cmd.session);
+  put_u32(out + 4, cmd.seq);
+  put_u32(out + 8, cmd.timestampUs);
+  put_u16(out + 12, (uint16_t)(twist ? cmd.linearMmS : cmd.leftMrad));
+  put_u16(out + 14, (uint16_t)(twist ? cmd.angularMrad : cmd.rightMrad));
+}
+
+bool udp_command_decode(const uint8_t *data, size_t len, UdpCommand *cmd) {
+  if (len != UDP_CMD_PACKET_SIZE) return false;
+  uint16_t magic = get_u16(data);
+  if (magic != UDP_CMD_MAGIC && magic != UDP_CMD_MAGIC_TWIST) return false;
+  cmd->session = get_u16(data + 2);
+  cmd->seq = get_u32(data + 4);
+  cmd->timestampUs = get_u32(data + 8);
+  int16_t a = (int16_t)get_u16(data + 12);
+  int16_t b = (int16_t)get_u16(data + 14);
+  cmd->kind = magic == UDP_CMD_MAGIC_TWIST ? UDP_CMD_TWIST : UDP_CMD_WHEELS;
+  cmd->leftMrad = cmd->kind == UDP_CMD_WHEELS ? a : 0;
+  cmd->rightMrad = cmd->kind == UDP_CMD_WHEELS ? b : 0;
+  cmd->linearMmS = cmd->kind == UDP_CMD_TWIST ? a : 0;
+  cmd->angularMrad = cmd->kind == UDP_CMD_TWIST ? b : 0;
+  return true;
+}
+
+UdpCommandFilter::UdpCommandFilter() {
+  reset();
+  accepted_ = 0;
+  malformed_ = 0;
+  outOfOrder_ = 0;
+  stale_ = 0;
+}
+
+void UdpCommandFilter::reset() {
+  started_ = false;
+  session_ = 0;
+  lastSeq_ = 0;
+  baseline_ = 0;
+  lastRxUs_ = 0;
+}
+
+UdpCommandStatus UdpCommandFilter::accept(const uint8_t *data, size_t len, uint32_t rxUs, UdpCommand *cmd) {
+  UdpCommand c;
+  if (!udp_command_decode(data, len, &c)) {
+    malformed_++;
+    return UDP_CMD_MALFORMED;
+  }
+
+  int32_t offset = (int32_t)(rxUs - c.timestampUs); // 传输延迟 + 时钟偏差
+
+  if (!started_ || c.session != session_) {
+    // 第一个数据报或客户端重启: 以它为新的起点
+    started_ = true;
+    session_ = c.session;
+    baseline_ = offset;
+    lastRxUs_ = rxUs;
+  } else {
+    if ((int32_t)(c.seq - lastSeq_) <= 0) {
+      outOfOrder_++;
+      return UDP_CMD_OUT_OF_ORDER;
+    }
+
+    // 基准随时间缓慢上调 (容忍时钟漂移)，再取最小值
+    // (只推进整数个步长，余数留到下一次，因此高包率时也不会丢失)
+    uint32_t steps = (rxUs - lastRxUs_) / UDP_CMD_DRIFT_DIVISOR;
+    baseline_ += (int32_t)steps;
+    lastRxUs_ += steps * UDP_CMD_DRIFT_DIVISOR;
+    if ((int32_t)(offset - baseline_) < 0) baseline_ = offset;
+
+    if ((int32_t)(offset - baseline_) > UDP_CMD_MAX_AGE_US) {
+      stale_++;
+      return UDP_CMD_STALE;
+    }
+  }
+
+  lastSeq_ = c.seq;
+  accepted_++;
+  *cmd = c;
+  return UDP_CMD_OK;
+}
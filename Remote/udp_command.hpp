@@ -0,0 +1,125 @@
+/*
+ * udp_command.hpp - UDP遥控指令协议
+ *
+ * **中文注释:**
+ * 每个指令是一个固定长度的UDP数据报，包含会话号、序号、发送时间戳和两轮目标速度
+ * (或车体的线速度与角速度，由魔数区分)。
+ * 没有重传，也没有TCP的队头阻塞: 丢失的数据报直接被下一个取代。
+ * UdpCommandFilter丢弃格式错误、乱序/重复以及过时的数据报，只把最新的指令交给控制任务。
+ *
+ * 数据报格式 (小端序，共UDP_CMD_PACKET_SIZE字节):
+ *   偏移 0  uint16 魔数 UDP_CMD_MAGIC (两轮速度) 或 UDP_CMD_MAGIC_TWIST (车体速度)
+ *   偏移 2  uint16 会话号 (客户端每次启动时随机选择)
+ *   偏移 4  uint32 序号 (每个数据报加1，两种指令共用)
+ *   偏移 8  uint32 发送时刻 (发送端时钟，微秒)
+ *   偏移 12 int16  左轮目标速度 (mrad/s) | 线速度 (mm/s)
+ *   偏移 14 int16  右轮目标速度 (mrad/s) | 角速度 (mrad/s，左转为正)
+ */
+
+#ifndef UDP_COMMAND_HPP_
+#define UDP_COMMAND_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define UDP_CMD_PORT 4210           // 机器人监听的UDP端口
+#define UDP_CMD_MAGIC 0x4352        // 魔数 ("RC")，负载为两轮速度
+#define UDP_CMD_MAGIC_TWIST 0x5452  // 魔数 ("RT")，负载为车体线速度与角速度
+#define UDP_CMD_PACKET_SIZE 16      // 数据报长度 (字节)
+#define UDP_CMD_MAX_AGE_US 100000   // 比已观测到的最小传输延迟晚到超过此时间的数据报视为过时
+#define UDP_CMD_DRIFT_DIVISOR 5000  // 时钟漂移容限: 基准每经过5000微秒上调1微秒 (200ppm)
+
+/**
+ * @enum UdpCommandKind
+ * @brief 指令类型 (由魔数决定)。
+ */
+enum UdpCommandKind {
+  UDP_CMD_WHEELS = 0,    // 两轮速度
+  UDP_CMD_TWIST          // 车体线速度与角速度
+};
+
+/**
+ * @struct UdpCommand
+ * @brief 一个解码后的UDP指令。
+ */
+struct UdpCommand {
+  uint16_t session;      // 会话号
+  uint32_t seq;          // 序号
+  uint32_t timestampUs;  // 发送时刻 (发送端时钟)
+  int16_t leftMrad;      // 左轮目标速度 (mrad/s)，kind为UDP_CMD_WHEELS时有效
+  int16_t rightMrad;     // 右轮目标速度 (mrad/s)
+  uint8_t kind;          // 指令类型 (UdpCommandKind)
+  int16_t linearMmS;     // 线速度 (mm/s)，kind为UDP_CMD_TWIST时有效
+  int16_t angularMrad;   // 角速度 (mrad/s，左转为正)
+};
+
+/**
+ * @enum UdpCommandStatus
+ * @brief UdpCommandFilter::accept()的返回值。
+ */
+enum UdpCommandStatus {
+  UDP_CMD_OK = 0,        // 有效的新指令
+  UDP_CMD_MALFORMED,     // 长度或魔数错误
+  UDP_CMD_OUT_OF_ORDER,  // 序号不比已接受的最新序号新 (乱序或重复)
+  UDP_CMD_STALE          // 在网络中滞留过久
+};
+
+/**
+ * @brief 把指令编码为数据报。
+ * @param out 输出缓冲区，至少UDP_CMD_PACKET_SIZE字节。
+ */
+void udp_command_encode(const UdpCommand &cmd, uint8_t *out);
+
+/**
+ * @brief 解码数据报。
+ * @return 长度与魔数正确时返回true。
+ */
+bool udp_command_decode(const uint8_t *data, size_t len, UdpCommand *cmd);
+
+/**
+ * @class UdpCommandFilter
+ * @brief 按序号与时间戳筛选数据报，只接受比已接受的指令更新且未过时的数据报。
+ *
+ * 发送端与接收端的时钟不同步，因此不能直接比较时间戳。过滤器记录
+ * (接收时刻 - 发送时刻) 的最小值作为基准 (= 最小传输延迟 + 时钟偏差)，
+ * 某个数据报的该差值比基准大UDP_CMD_MAX_AGE_US以上时判定为过时。
+ * 基准随时间缓慢上调，以容忍两端晶振的频率差。会话号改变 (客户端重启) 时重新开始。
+ */
+class UdpCommandFilter {
+public:
+  UdpCommandFilter();
+
+  /**
+   * @brief 清空状态，下一个有效数据报将被无条件接受。
+   */
+  void reset();
+
+  /**
+   * @brief 检查一个收到的数据报。
+   * @param data 数据报内容。
+   * @param len 数据报长度。
+   * @param rxUs 接收时刻 (接收端时钟，微秒)。
+   * @param cmd 返回UDP_CMD_OK时写入解码后的指令。
+   * @return 检查结果。
+   */
+  UdpCommandStatus accept(const uint8_t *data, size_t len, uint32_t rxUs, UdpCommand *cmd);
+
+  // 统计计数
+  uint32_t accepted() const { return accepted_; }
+  uint32_t malformed() const { return malformed_; }
+  uint32_t outOfOrder() const { return outOfOrder_; }
+  uint32_t stale() const { return stale_; }
+
+private:
+  bool started_;
+  uint16_t session_;
+  uint32_t lastSeq_;
+  int32_t baseline_;     // (接收时刻 - 发送时刻) 的基准
+  uint32_t lastRxUs_;
+  uint32_t accepted_;
+  uint32_t malformed_;
+  uint32_t outOfOrder_;
+  uint32_t stale_;
+};
+
+#endif /* UDP_COMMAND_HPP_ */
@@ -0,0 +1,210 @@
+/*
+ * websocket.cpp - WebSocket握手与帧解析的实现
+ *
+ * **中文注释:**
+ * 握手需要计算 Base64(SHA-1(key + GUID))。这里用一个紧凑的SHA-1实现，
+ * 不依赖mbedtls，因此同样的代码可以在主机仿真中编译运行。握手只在建立连接时
+ * 执行一次，不在指令路径上。
+ */
+
+#include "websocket.hpp"
+
+#include <string.h>
+
+// RFC 6455规定的固定GUID
+static const char WS_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+//- SHA-1 ----------------------------
+
+static uint32_t rol32(uint32_t x, int n) {
+  return (x << n) | (x >> (32 - n));
+}
+
+/**
+ * @brief 处理一个64字节的数据块。
+ */
+static void sha1_block(uint32_t h[5], const uint8_t block[64]) {
+  uint32_t w[80];
+  for (int i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)block[4 * i] << 24) | ((uint32_t)block[4 * i + 1] << 16) |
+           ((uint32_t)block[4 * i + 2] << 8) | (uint32_t)block[4 * i + 3];
+  }
+  for (int i = 16; i < 80; i++) {
+    w[i] = rol32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+  }
+
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+  for (int i = 0; i < 80; i++) {
+    uint32_t f, k;
+    if (i < 20) {
+      f = (b & c) | (~b & d);
+      k = 0x5A827999;
+    } else if (i < 40) {
+      f = b ^ c ^ d;
+      k = 0x6ED9EBA1;
+    } else if (i < 60) {
+      f = (b & c) | (b & d) | (c & d);
+      k = 0x8F1BBCDC;
+    } else {
+      f = b ^ c ^ d;
+      k = 0xCA62C1D6;
+    }
+    uint32_t t = rol32(a, 5) + f + e + k + w[i];
+    e = d;
+    d = c;
+    c = rol32(b, 30);
+    b = a;
+    a = t;
+  }
+  h[0] += a;
+  h[1] += b;
+  h[2] += c;
+  h[3] += d;
+  h[4] += e;
+}
+
+/**
+ * @brief 计算一段数据的SHA-1摘要 (数据长度不超过119字节，握手中足够)。
+ */
+static void sha1(const uint8_t *data, size_t len, uint8_t digest[20]) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+  uint8_t block[128];
+  size_t blocks = (len + 8) / 64 + 1;
+
+  memset(block, 0, sizeof(block));
+  memcpy(block, data, len);
+  block[len] = 0x80;
+  uint64_t bits = (uint64_t)len * 8;
+  for (int i = 0; i < 8; i++) {
+    block[blocks * 64 - 1 - i] = (uint8_t)(bits >> (8 * i));
+  }
+  for (size_t i = 0; i < blocks; i++) {
+    sha1_block(h, block + 64 * i);
+  }
+  for (int i = 0; i < 5; i++) {
+    digest[4 * i] = (uint8_t)(h[i] >> 24);
+    digest[4 * i + 1] = (uint8_t)(h[i] >> 16);
+    digest[4 * i + 2] = (uint8_t)(h[i] >> 8);
+    digest[4 * i + 3] = (uint8_t)h[i];
+  }
+}
+
+//- 握手 ----------------------------
+
+void ws_compute_accept_key(const char *clientKey, char *out) {
+  static const char B64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  uint8_t buf[64 + sizeof(WS_GUID)];
+  size_t keyLen = strlen(clientKey);
+  if (keyLen > 64) keyLen = 64;
+  memcpy(buf, clientKey, keyLen);
+  memcpy(buf + keyLen, WS_GUID, sizeof(WS_GUID) - 1);
+
+  uint8_t digest[21];
+  sha1(buf, keyLen + sizeof(WS_GUID) - 1, digest);
+  digest[20] = 0;
+
+  // 20字节 -> 28个Base64字符 (最后一组只有2字节，补一个'=')
+  size_t o = 0;
+  for (size_t i = 0; i < 20; i += 3) {
+    uint32_t v = ((uint32_t)digest[i] << 16) | ((uint32_t)digest[i + 1] << 8) |
+                 (i + 2 < 20 ? digest[i + 2] : 0);
+    out[o++] = B64[(v >> 18) & 0x3F];
+    out[o++] = B64[(v >> 12) & 0x3F];
+    out[o++] = B64[(v >> 6) & 0x3F];
+    out[o++] = (i + 2 < 20) ? B64[v & 0x3F] : '=';
+  }
+  out[o] = '\0';
+}
+
+size_t ws_frame_header(uint8_t *out, uint8_t opcode, size_t payloadLen) {
+  out[0] = 0x80 | (opcode & 0x0F); // FIN=1
+  if (payloadLen < 126) {
+    out[1] = (uint8_t)payloadLen;
+    return 2;
+  }
+  out[1] = 126;
+  out[2] = (uint8_t)(payloadLen >> 8);
+  out[3] = (uint8_t)payloadLen;
+  return 4;
+}
+
+size_t ws_close_frame(uint8_t *out, uint16_t code) {
+  size_t n = ws_frame_header(out, WS_OPCODE_CLOSE, 2);
+  out[n] = (uint8_t)(code >> 8);
+  out[n + 1] = (uint8_t)code;
+  return n + 2;
+}
+
+//- 帧解析 ----------------------------
+
+WebSocketFrameParser::WebSocketFrameParser() {
+  reset();
+}
+
+void WebSocketFrameParser::reset() {
+  state_ = ST_HEADER0;
+  status_ = WS_FRAME_INCOMPLETE;
+  opcode_ = 0;
+  count_ = 0;
+  payloadLen_ = 0;
+  received_ = 0;
+}
+
+WsFrameStatus WebSocketFrameParser::fail() {
+  status_ = WS_FRAME_ERROR;
+  return status_;
+}
+
+WsFrameStatus WebSocketFrameParser::feed(uint8_t c) {
+  switch (state_) {
+    case ST_HEADER0:
+      // 不支持分片: 要求FIN=1且不是后续帧; 保留位必须为0
+      if ((c & 0x80) == 0 || (c & 0x70) != 0) return fail();
+      opcode_ = c & 0x0F;
+      if (opcode_ == WS_OPCODE_CONTINUATION) return fail();
+      state_ = ST_HEADER1;
+      break;
+
+    case ST_HEADER1:
+      if ((c & 0x80) == 0) return fail(); // 客户端帧必须带掩码
+      payloadLen_ = c & 0x7F;
+      if (payloadLen_ == 127) return fail(); // 64位长度远超WS_MAX_PAYLOAD
+      count_ = 0;
+      state_ = (payloadLen_ == 126) ? ST_LENGTH : ST_MASK;
+      if (payloadLen_ == 126) payloadLen_ = 0;
+      break;
+
+    case ST_LENGTH:
+      payloadLen_ = (uint16_t)((payloadLen_ << 8) | c);
+      if (++count_ == 2) {
+        count_ = 0;
+        state_ = ST_MASK;
+      }
+      break;
+
+    case ST_MASK:
+      mask_[count_++] = c;
+      if (count_ == 4) {
+        if (payloadLen_ > WS_MAX_PAYLOAD) return fail();
+        received_ = 0;
+        state_ = ST_PAYLOAD;
+        if (payloadLen_ == 0) status_ = WS_FRAME_DONE;
+      }
+      break;
+
+    case ST_PAYLOAD:
+      payload_[received_] = c ^ mask_[received_ & 3];
+      if (++received_ == payloadLen_) status_ = WS_FRAME_DONE;
+      break;
+  }
+  return status_;
+}
+
+WsFrameStatus WebSocketFrameParser::feed(const uint8_t *data, size_t len, size_t *consumed) {
+  size_t i = 0;
+  while (i < len && status_ == WS_FRAME_INCOMPLETE) {
+    feed(data[i++]);
+  }
+  if (consumed != NULL) *consumed = i;
+  return status_;
+}
@@ -0,0 +1,122 @@
+/*
+ * websocket.hpp - WebSocket握手与帧解析 (RFC 6455)
+ *
+ * **中文注释:**
+ * 只实现遥控通道需要的部分: 服务器端握手应答、增量式解析客户端发来的
+ * (带掩码的)帧、生成服务器端的(不带掩码的)帧头。
+ * 与HttpRequestParser一样，所有数据都在对象内部的固定缓冲区中，不分配堆内存。
+ * 遥控指令都是几个字节的小帧，因此不支持分片消息，负载长度超过WS_MAX_PAYLOAD的帧视为错误。
+ */
+
+#ifndef WEBSOCKET_HPP_
+#define WEBSOCKET_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WS_ACCEPT_KEY_LEN 28    // Sec-WebSocket-Accept的长度 (SHA-1的Base64编码)
+#define WS_MAX_PAYLOAD 32       // 接受的最大帧负载长度 (字节)
+#define WS_MAX_HEADER_LEN 4     // 服务器帧头的最大长度 (负载不超过65535字节)
+#define WS_CLOSE_FRAME_LEN 4    // 带状态码的关闭帧长度 (2字节帧头 + 2字节状态码)
+#define WS_CLOSE_PROTOCOL_ERROR 1002 // 关闭状态码: 协议错误
+
+/**
+ * @enum _WS_OPCODE
+ * @brief WebSocket帧的操作码。
+ */
+enum _WS_OPCODE {
+  WS_OPCODE_CONTINUATION = 0x0, // 分片消息的后续帧 (不支持)
+  WS_OPCODE_TEXT         = 0x1, // 文本帧
+  WS_OPCODE_BINARY       = 0x2, // 二进制帧
+  WS_OPCODE_CLOSE        = 0x8, // 关闭连接
+  WS_OPCODE_PING         = 0x9, // 心跳请求
+  WS_OPCODE_PONG         = 0xA, // 心跳应答
+};
+
+/**
+ * @enum WsFrameStatus
+ * @brief WebSocketFrameParser::feed()的返回值。
+ */
+enum WsFrameStatus {
+  WS_FRAME_INCOMPLETE = 0, // 需要更多数据
+  WS_FRAME_DONE,           // 已收到一个完整的帧
+  WS_FRAME_ERROR           // 协议错误 (未加掩码、分片、负载过长)
+};
+
+/**
+ * @class WebSocketFrameParser
+ * @brief 客户端帧的增量式解析器。
+ *
+ * 用法: 把收到的字节依次传给feed()，返回WS_FRAME_DONE后通过opcode()/payload()
+ * 读取该帧 (负载已去掉掩码)，处理完后调用reset()解析下一帧。
+ */
+class WebSocketFrameParser {
+public:
+  WebSocketFrameParser();
+
+  /**
+   * @brief 清空解析状态，准备解析下一帧。
+   */
+  void reset();
+
+  /**
+   * @brief 输入一段字节。
+   * @param data 数据指针。
+   * @param len 数据长度。
+   * @param consumed 可选，返回实际消耗的字节数 (在DONE或ERROR处停止)。
+   * @return 当前解析状态。
+   */
+  WsFrameStatus feed(const uint8_t *data, size_t len, size_t *consumed = NULL);
+
+  WsFrameStatus status() const { return status_; }
+  uint8_t opcode() const { return opcode_; }
+  const uint8_t *payload() const { return payload_; }
+  size_t payloadLength() const { return payloadLen_; }
+
+private:
+  enum State {
+    ST_HEADER0,      // FIN与操作码
+    ST_HEADER1,      // MASK位与7位长度
+    ST_LENGTH,       // 16位扩展长度
+    ST_MASK,         // 4字节掩码
+    ST_PAYLOAD       // 负载
+  };
+
+  WsFrameStatus fail();
+  WsFrameStatus feed(uint8_t c);
+
+  State state_;
+  WsFrameStatus status_;
+  uint8_t opcode_;
+  uint8_t count_;          // 当前字段已读取的字节数
+  uint16_t payloadLen_;
+  uint16_t received_;
+  uint8_t mask_[4];
+  uint8_t payload_[WS_MAX_PAYLOAD];
+};
+
+/**
+ * @brief 根据客户端的Sec-WebSocket-Key计算Sec-WebSocket-Accept。
+ * @param clientKey 客户端发送的密钥。
+ * @param out 输出缓冲区，至少WS_ACCEPT_KEY_LEN + 1字节，以'\0'结尾。
+ */
+void ws_compute_accept_key(const char *clientKey, char *out);
+
+/**
+ * @brief 生成服务器端帧头 (FIN=1，不带掩码)。
+ * @param out 输出缓冲区，至少WS_MAX_HEADER_LEN字节。
+ * @param opcode 操作码。
+ * @param payloadLen 负载长度 (不超过65535)。
+ * @return 帧头长度。
+ */
+size_t ws_frame_header(uint8_t *out, uint8_t opcode, size_t payloadLen);
+
+/**
+ * @brief 生成带状态码的服务器端关闭帧。
+ * @param out 输出缓冲区，至少WS_CLOSE_FRAME_LEN字节。
+ * @param code 关闭状态码 (例如WS_CLOSE_PROTOCOL_ERROR)，按网络字节序写入负载。
+ * @return 帧长度。
+ */
+size_t ws_close_frame(uint8_t *out, uint16_t code);
+
+#endif /* WEBSOCKET_HPP_ */
@@ -21,6 +21,7 @@
 
 #include "ESP32Encoder.h"          // ESP32编码器读取库
 #include "http_server.hpp"         // 自定义的HTTP服务器，用于WiFi通信
+#include "pi_design.h"             // 编译期设计离散PI控制器
 
 // ==============================================================================
 // 用户可修改参数
@@ -34,11 +35,13 @@
 
 // --- 机器人模型辨识参数 ---
 // 这些参数通常通过系统辨识实验获得，用于设计控制器
-#define TAU (30.20f)               // 系统时间常数
-#define G (50.01f)                 // 系统静态增益
+#define TAU (30.20f)               // 系统时间常数 (毫秒)
+#define G (50.01f)                 // 系统静态增益 (rad/s，满量程占空比)
 
 // --- 控制器参数 ---
-#define PERIODE_MS 20000           // 速度控制(asservissement)任务的周期 (毫秒) - 注意: 这个值(20秒)看起来非常大, 可能是一个占位符或需要修正为更小的值(如20ms)
+#define PERIODE_US 10000           // 速度控制(asservissement)任务的周期 (微秒)，1000 (1 kHz) ~ 50000 (20 Hz)
+#define TAU_DEZ (TAU)              // 期望闭环时间常数 (毫秒)
+#define PI_DISCRETIZATION PiDiscretization::BackwardEuler // 离散化方法: BackwardEuler / Tustin / ZeroOrderHold
 
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<< 结束修改区域 <<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -50,21 +53,28 @@
 #define REDUCTION_RATIO (53.0f)    // 电机减速比
 #define NBR_FRONT (12.0f)          // 编码器每转产生的脉冲数 (或边沿数)
 
-// --- 连续PI控制器参数计算 ---
-// 基于辨识出的模型参数来计算连续域的PI控制器参数
-#define TAU_DEZ (TAU)              //
-#define KP  (TAU/G/TAU_DEZ)        // 比例增益 (Proportional Gain)
-#define TI (TAU)                   // 积分时间 (Integral Time)
-
 // --- 离散PI控制器参数计算 ---
-// 将连续控制器参数通过离散化方法(如后向欧拉法)转换为离散域的控制器参数
-#define TE (PERIODE_MS*0.001f)     // 控制周期 (秒)
-#define R0 (KP*(1+TE/TI))          // 离散PI控制器参数 R0
-#define R1 (-KP)                   // 离散PI控制器参数 R1
+// 由模型参数在编译期设计PI控制器 (pi_design.h): 零点对消模型极点 (TI = TAU)，闭环时间常数为TAU_DEZ，
+// 再按PI_DISCRETIZATION离散化为 u[k] = u[k-1] + R0·e[k] + R1·e[k-1] (控制量单位为PWM计数)。
+// 后向欧拉时 KP = TAU/G/TAU_DEZ·满量程，R0 = KP·(1 + TE/TI)，R1 = -KP。
+// R0、R1随TE变化，修改PERIODE_US后自动按新的周期重新计算; 闭环不稳定或超出PWM范围时编译失败。
+#define TE (PERIODE_US*1e-6f)      // 控制周期 (秒)
+static_assert(PERIODE_US >= 1000 && PERIODE_US <= 50000, "PERIODE_US应在1000 (1 kHz) 到50000 (20 Hz) 之间");
+constexpr double PWM_FULL_SCALE = (1 << PWM_RESOLUTION) - 1;
+constexpr PiCoeffs PI_COEFFS = pi_design(TAU * 1e-3, G, TAU_DEZ * 1e-3, TE, PWM_FULL_SCALE, PI_DISCRETIZATION);
+static_assert(pi_design_ok(TAU * 1e-3, G, TAU_DEZ * 1e-3, TE, PWM_FULL_SCALE), "TAU、G、TAU_DEZ应为正数");
+static_assert(pi_design_stable(PI_COEFFS, TAU * 1e-3, G, TE, PWM_FULL_SCALE),
+              "闭环不稳定，请增大TAU_DEZ或改用ZeroOrderHold");
+static_assert(pi_design_fits_pwm(PI_COEFFS, G, CONSIGNE_VITESSE, PWM_FULL_SCALE),
+              "从静止阶跃到CONSIGNE_VITESSE时控制量超出PWM范围，请增大TAU_DEZ");
+constexpr float KP = PI_COEFFS.kp;        // 比例增益 (Proportional Gain)
+constexpr float TI = PI_COEFFS.kp / PI_COEFFS.ki; // 积分时间 (Integral Time，秒)
+constexpr float R0 = PI_COEFFS.r0;        // 离散PI控制器参数 R0
+constexpr float R1 = PI_COEFFS.r1;        // 离散PI控制器参数 R1
 
 // --- 编码器计算参数 ---
 // 用于将编码器读数转换为物理单位(如 rad/s)
-#define DELTA_POS ( 2.0f * PI / (NBR_FRONT * REDUCTION_RATIO) / TE) // 每个控制周期内,编码器每跳动一格代表的角速度变化量
+constexpr float DELTA_POS = 2.0f * PI / (NBR_FRONT * REDUCTION_RATIO) / TE; // 每个控制周期内,编码器每跳动一格代表的角速度变化量
 
 // ==============================================================================
 // 常量定义
@@ -0,0 +1,219 @@
+/*
+ * bench_biquad.cpp - biquad.h的单精度/定点滤波器与Filter0_step()的误差对比
+ *
+ * **中文注释:**
+ * 用Simulink生成的Filter0_step() (double) 作为参考，通道1输入信号，通道2输入取反的信号
+ * (两个通道必须得到相反的输出)。测试信号按满量程FS归一化:
+ *   - steps:  在±0.9 FS之间随机跳变的阶跃 (滤波器阶跃响应约有4%的超调，不会超出满量程);
+ *   - chirp:  0.9 FS、频率从0扫到奈奎斯特频率的正弦;
+ *   - noise:  ±0.45 FS的均匀白噪声加0.45 FS以内的缓慢漂移;
+ *   - speed:  BF.ino量级的轮速 (±30 rad/s阶跃加编码器量化噪声)，只用于float。
+ * 误差上限:
+ *   - float: 相对满量程1e-5 (单精度舍入经极点放大后约为1e-6量级);
+ *   - Q31: 4个LSB，Q15: 8个LSB。参考值用量化后的输入计算，只统计滤波运算本身的误差
+ *     (输出舍入经1/A(z)放大，直流增益约3.7; Q2.14系数使极点偏移，满量程阶跃时再多几个LSB);
+ * 另外检查满量程方波时定点输出饱和而不是回绕。最后给出每个样本的耗时 (主机上只是参考，
+ * ESP32上的周期数见BO_CHEN_ZHANG/base_IF4_TP2_BO_v2024_1.ino的FILTER_BENCH)。
+ *
+ * 用法: ./build/bench_biquad [每个信号的样本数, 默认200000]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "biquad.h"
+
+extern "C" {
+#include "Filter0.h"
+}
+
+namespace {
+
+const double Q15_FS = 32767.0;
+const double Q31_FS = 2147483647.0;
+
+struct Signal {
+  const char *name;
+  std::vector<double> x;  // 归一化到[-1, 1]
+  bool fixedPoint;        // 是否也用于定点版本
+};
+
+std::vector<Signal> make_signals(int n) {
+  std::vector<Signal> out;
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> uni(-1.0, 1.0);
+
+  Signal steps = {"steps", {}, true};
+  double level = 0.0;
+  for (int i = 0; i < n; i++) {
+    if (i % 97 == 0) level = 0.9 * uni(rng);
+    steps.x.push_back(level);
+  }
+  out.push_back(steps);
+
+  Signal chirp = {"chirp", {}, true};
+  double phase = 0.0;
+  for (int i = 0; i < n; i++) {
+    phase += M_PI * i / n;
+    chirp.x.push_back(0.9 * sin(phase));
+  }
+  out.push_back(chirp);
+
+  Signal noise = {"noise", {}, true};
+  for (int i = 0; i < n; i++) noise.x.push_back(0.45 * uni(rng) + 0.45 * sin(2 * M_PI * i / 5000.0));
+  out.push_back(noise);
+
+  // 轮速 (rad/s): 按30 rad/s满量程归一化，编码器量化 (1320边沿/转，10 ms周期)
+  Signal speed = {"speed", {}, false};
+  const double quantum = 2 * M_PI / 1320 / 0.01 / 30.0;
+  const double setpoints[] = {0.0, 2.5, -2.5, 10.0, -25.0, 4.0};
+  for (int i = 0; i < n; i++) {
+    double v = setpoints[(i / 500) % 6] / 30.0 + 0.01 * uni(rng);
+    speed.x.push_back(round(v / quantum) * quantum);
+  }
+  out.push_back(speed);
+  return out;
+}
+
+void filter0_reset() {
+  memset(&Filter0_DW, 0, sizeof(Filter0_DW));
+  Filter0_initialize();
+}
+
+/**
+ * @brief 用Filter0_step()计算参考输出 (两个通道，第二个通道输入取反)。
+ * @return 两个通道的输出不对称时返回false。
+ */
+bool reference(const std::vector<double> &x, std::vector<double> *y) {
+  filter0_reset();
+  y->resize(x.size());
+  bool symmetric = true;
+  for (size_t i = 0; i < x.size(); i++) {
+    Filter0_U.u1 = x[i];
+    Filter0_U.u2 = -x[i];
+    Filter0_step();
+    (*y)[i] = Filter0_Y.y1;
+    if (Filter0_Y.y2 != -Filter0_Y.y1) symmetric = false;
+  }
+  return symmetric;
+}
+
+struct Error {
+  double max = 0.0;
+  double sum2 = 0.0;
+  size_t n = 0;
+  void add(double e) {
+    max = fmax(max, fabs(e));
+    sum2 += e * e;
+    n++;
+  }
+  double rms() const { return n > 0 ? sqrt(sum2 / n) : 0.0; }
+};
+
+template <typename F>
+double ns_per_sample(F &&body, size_t n) {
+  auto t0 = std::chrono::steady_clock::now();
+  body();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+volatile double sinkD;
+volatile float sinkF;
+volatile int32_t sinkI;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 200000;
+  bool ok = true;
+  std::vector<Signal> signals = make_signals(n);
+
+  printf("%-6s %-6s %14s %14s %10s\n", "signal", "impl", "max error", "rms error", "bound");
+  for (const Signal &s : signals) {
+    std::vector<double> ref;
+    if (!reference(s.x, &ref)) {
+      printf("FAIL: Filter0_step() channels are not symmetric\n");
+      ok = false;
+    }
+
+    // float: 相对满量程
+    BiquadF32 f32(FILTER0_COEFFS);
+    Error ef;
+    for (size_t i = 0; i < s.x.size(); i++) ef.add(f32.step((float)s.x[i]) - ref[i]);
+    printf("%-6s %-6s %14.3e %14.3e %10s\n", s.name, "float", ef.max, ef.rms(), "1e-5 FS");
+    if (ef.max > 1e-5) ok = false;
+    if (!s.fixedPoint) continue;
+
+    // Q15/Q31: 参考值用量化后的输入重新计算，误差以LSB计
+    std::vector<double> xq15(s.x.size()), xq31(s.x.size()), ref15, ref31;
+    for (size_t i = 0; i < s.x.size(); i++) {
+      xq15[i] = round(s.x[i] * Q15_FS);
+      xq31[i] = round(s.x[i] * Q31_FS);
+    }
+    reference(xq15, &ref15);
+    reference(xq31, &ref31);
+    BiquadQ15 q15(FILTER0_COEFFS);
+    BiquadQ31 q31(FILTER0_COEFFS);
+    Error e15, e31;
+    for (size_t i = 0; i < s.x.size(); i++) {
+      e15.add(q15.step((int16_t)xq15[i]) - ref15[i]);
+      e31.add(q31.step((int32_t)xq31[i]) - ref31[i]);
+    }
+    printf("%-6s %-6s %10.2f LSB %10.2f LSB %10s\n", s.name, "Q15", e15.max, e15.rms(), "8 LSB");
+    printf("%-6s %-6s %10.2f LSB %10.2f LSB %10s\n", s.name, "Q31", e31.max, e31.rms(), "4 LSB");
+    if (e15.max > 8.0 || e31.max > 4.0) ok = false;
+  }
+
+  // 满量程方波: 超调部分必须饱和在正确的符号上
+  BiquadQ15 s15(FILTER0_COEFFS);
+  BiquadQ31 s31(FILTER0_COEFFS);
+  bool wrapped = false;
+  for (int i = 0; i < 2000; i++) {
+    bool high = (i / 100) % 2 == 0;
+    int16_t y15 = s15.step(high ? INT16_MAX : -INT16_MAX);
+    int32_t y31 = s31.step(high ? INT32_MAX : -INT32_MAX);
+    if (i % 100 >= 20 && ((y15 > 0) != high || (y31 > 0) != high)) wrapped = true;
+  }
+  printf("full-scale square wave: %s\n", wrapped ? "FAIL (wrap-around)" : "saturates");
+  if (wrapped) ok = false;
+
+  // 主机上的耗时 (两个通道)
+  const std::vector<double> &x = signals[2].x;
+  std::vector<float> xf(x.begin(), x.end());
+  std::vector<int16_t> x15(x.size());
+  std::vector<int32_t> x31(x.size());
+  for (size_t i = 0; i < x.size(); i++) {
+    x15[i] = (int16_t)lround(x[i] * Q15_FS);
+    x31[i] = (int32_t)lround(x[i] * Q31_FS);
+  }
+  double tRef = ns_per_sample([&] {
+    filter0_reset();
+    for (double v : x) {
+      Filter0_U.u1 = v;
+      Filter0_U.u2 = -v;
+      Filter0_step();
+      sinkD = Filter0_Y.y1 + Filter0_Y.y2;
+    }
+  }, x.size());
+  double tF = ns_per_sample([&] {
+    BiquadF32 a(FILTER0_COEFFS), b(FILTER0_COEFFS);
+    for (float v : xf) sinkF = a.step(v) + b.step(-v);
+  }, x.size());
+  double t15 = ns_per_sample([&] {
+    BiquadQ15 a(FILTER0_COEFFS), b(FILTER0_COEFFS);
+    for (int16_t v : x15) sinkI = a.step(v) + b.step((int16_t)-v);
+  }, x.size());
+  double t31 = ns_per_sample([&] {
+    BiquadQ31 a(FILTER0_COEFFS), b(FILTER0_COEFFS);
+    for (int32_t v : x31) sinkI = a.step(v) + b.step(-v);
+  }, x.size());
+  printf("host ns per two-channel step: Filter0_step %.2f, float %.2f, Q15 %.2f, Q31 %.2f\n", tRef, tF, t15, t31);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/*
+ * bench_biquad_design.cpp - biquad_design.h的编译期设计与Filter0和解析频率响应的对比
+ *
+ * **中文注释:**
+ * 1. 编译期: static_assert检查fc = fs / 10的Butterworth低通与FILTER0_COEFFS的每个系数相差
+ *    不超过1e-12 (只有在编译期求值时才能通过编译);
+ * 2. 阶跃/脉冲响应: 用设计出的系数以double DF1计算，与Simulink生成的Filter0_step()比较;
+ * 3. constexpr数学函数: 在fc/fs = 0.001~0.45的网格上，与用<math.h>的tan/cos按同一公式
+ *    算出的系数比较 (低通/高通/陷波，Butterworth 2/4/6/8阶);
+ * 4. 频率响应: Butterworth低通在fc处为-3.01 dB、直流为0 dB，N阶在2fc处约为-6N dB
+ *    (双线性变换使高频衰减更快，只检查不小于该值); 高通直流为0;
+ *    陷波在f0处为0，直流与奈奎斯特频率处为1。
+ *
+ * 用法: ./build/bench_biquad_design
+ */
+
+#include <complex>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "biquad_design.h"
+
+extern "C" {
+#include "Filter0.h"
+}
+
+namespace {
+
+constexpr BiquadCoeffs DESIGNED_FILTER0 = biquad_lowpass(10.0, 100.0);
+
+constexpr bool near(double a, double b, double tol) {
+  return (a - b < 0 ? b - a : a - b) <= tol;
+}
+
+static_assert(near(DESIGNED_FILTER0.b0, FILTER0_COEFFS.b0, 1e-12) &&
+              near(DESIGNED_FILTER0.b1, FILTER0_COEFFS.b1, 1e-12) &&
+              near(DESIGNED_FILTER0.b2, FILTER0_COEFFS.b2, 1e-12) &&
+              near(DESIGNED_FILTER0.a1, FILTER0_COEFFS.a1, 1e-12) &&
+              near(DESIGNED_FILTER0.a2, FILTER0_COEFFS.a2, 1e-12),
+              "2nd-order Butterworth at fs / 10 does not reproduce Filter0");
+static_assert(biquad_design_ok(10.0, 100.0) && !biquad_design_ok(50.0, 100.0), "Nyquist check");
+
+/**
+ * @brief 在频率f处的复数频率响应 (多节级联)。
+ */
+std::complex<double> response(const BiquadCoeffs *sections, size_t n, double f, double fs) {
+  std::complex<double> z1 = std::polar(1.0, -2.0 * M_PI * f / fs), z2 = z1 * z1;
+  std::complex<double> h = 1.0;
+  for (size_t k = 0; k < n; k++) {
+    const BiquadCoeffs &c = sections[k];
+    h *= (c.b0 + c.b1 * z1 + c.b2 * z2) / (1.0 + c.a1 * z1 + c.a2 * z2);
+  }
+  return h;
+}
+
+double db(std::complex<double> h) {
+  return 20.0 * log10(std::abs(h));
+}
+
+// 与biquad_design.h相同的公式，但用<math.h>
+BiquadCoeffs libm_lowpass(double fc, double fs, double q) {
+  double k = tan(M_PI * fc / fs), norm = 1.0 / (1.0 + k / q + k * k);
+  return {k * k * norm, 2.0 * k * k * norm, k * k * norm, 2.0 * (k * k - 1.0) * norm, (1.0 - k / q + k * k) * norm};
+}
+
+BiquadCoeffs libm_highpass(double fc, double fs, double q) {
+  double k = tan(M_PI * fc / fs), norm = 1.0 / (1.0 + k / q + k * k);
+  return {norm, -2.0 * norm, norm, 2.0 * (k * k - 1.0) * norm, (1.0 - k / q + k * k) * norm};
+}
+
+BiquadCoeffs libm_notch(double f0, double fs, double q) {
+  double k = tan(M_PI * f0 / fs), norm = 1.0 / (1.0 + k / q + k * k);
+  return {(1.0 + k * k) * norm, 2.0 * (k * k - 1.0) * norm, (1.0 + k * k) * norm, 2.0 * (k * k - 1.0) * norm,
+          (1.0 - k / q + k * k) * norm};
+}
+
+double coeff_diff(const BiquadCoeffs &a, const BiquadCoeffs &b) {
+  return fmax(fmax(fmax(fabs(a.b0 - b.b0), fabs(a.b1 - b.b1)), fmax(fabs(a.b2 - b.b2), fabs(a.a1 - b.a1))),
+              fabs(a.a2 - b.a2));
+}
+
+template <size_t Order>
+bool check_butterworth(double *maxCoeffDiff) {
+  bool ok = true;
+  const double fs = 1000.0;
+  for (double ratio = 0.001; ratio < 0.45; ratio *= 1.3) {
+    double fc = ratio * fs;
+    BiquadDesign<Order / 2> lp = biquad_butterworth_lowpass<Order>(fc, fs);
+    BiquadDesign<Order / 2> hp = biquad_butterworth_highpass<Order>(fc, fs);
+    for (size_t k = 0; k < Order / 2; k++) {
+      double q = 1.0 / (2.0 * cos((2.0 * k + 1.0) * M_PI / (2.0 * Order)));
+      *maxCoeffDiff = fmax(*maxCoeffDiff, coeff_diff(lp.section[k], libm_lowpass(fc, fs, q)));
+      *maxCoeffDiff = fmax(*maxCoeffDiff, coeff_diff(hp.section[k], libm_highpass(fc, fs, q)));
+    }
+    double atFc = db(response(lp.section, Order / 2, fc, fs));
+    double dc = db(response(lp.section, Order / 2, 0.0, fs));
+    double hpAtFc = db(response(hp.section, Order / 2, fc, fs));
+    double hpDc = std::abs(response(hp.section, Order / 2, 0.0, fs));
+    bool good = fabs(atFc + 3.0103) < 1e-6 && fabs(dc) < 1e-9 && fabs(hpAtFc + 3.0103) < 1e-6 && hpDc < 1e-9;
+    if (2 * fc < 0.5 * fs) good &= db(response(lp.section, Order / 2, 2 * fc, fs)) < -6.0 * Order + 0.5;
+    if (!good) {
+      printf("  order %zu fc/fs %.4f: lowpass %.4f dB at fc, %.2e dB at DC; highpass %.4f dB at fc  FAIL\n", Order,
+             ratio, atFc, dc, hpAtFc);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+} // namespace
+
+int main() {
+  bool ok = true;
+
+  // 阶跃与脉冲响应: 设计的系数 (double DF1) 与Filter0_step()
+  memset(&Filter0_DW, 0, sizeof(Filter0_DW));
+  Filter0_initialize();
+  const BiquadCoeffs &c = DESIGNED_FILTER0;
+  double x1 = 0, x2 = 0, y1 = 0, y2 = 0, maxDiff = 0;
+  for (int n = 0; n < 400; n++) {
+    double x = n < 200 ? (n == 0 ? 1.0 : 0.0) : 1.0;  // 先脉冲，再阶跃
+    double y = c.b0 * x + c.b1 * x1 + c.b2 * x2 - c.a1 * y1 - c.a2 * y2;
+    x2 = x1, x1 = x, y2 = y1, y1 = y;
+    Filter0_U.u1 = x;
+    Filter0_U.u2 = -x;
+    Filter0_step();
+    maxDiff = fmax(maxDiff, fmax(fabs(y - Filter0_Y.y1), fabs(y + Filter0_Y.y2)));
+  }
+  printf("Filter0 (fc = fs / 10): impulse + step response max difference %.2e\n", maxDiff);
+  ok &= maxDiff < 1e-12;
+
+  // constexpr数学函数与<math.h>
+  double maxCoeff = 0.0;
+  for (double ratio = 0.001; ratio < 0.45; ratio *= 1.1) {
+    for (double q : {0.5, BUTTERWORTH_Q, 2.0, 10.0}) {
+      maxCoeff = fmax(maxCoeff, coeff_diff(biquad_lowpass(ratio, 1.0, q), libm_lowpass(ratio, 1.0, q)));
+      maxCoeff = fmax(maxCoeff, coeff_diff(biquad_highpass(ratio, 1.0, q), libm_highpass(ratio, 1.0, q)));
+      maxCoeff = fmax(maxCoeff, coeff_diff(biquad_notch(ratio, 1.0, q), libm_notch(ratio, 1.0, q)));
+    }
+  }
+
+  // Butterworth频率响应
+  bool butterworth = check_butterworth<2>(&maxCoeff);
+  butterworth &= check_butterworth<4>(&maxCoeff);
+  butterworth &= check_butterworth<6>(&maxCoeff);
+  butterworth &= check_butterworth<8>(&maxCoeff);
+  ok &= butterworth;
+  printf("constexpr vs libm coefficients (fc/fs 0.001..0.45): max difference %.2e\n", maxCoeff);
+  ok &= maxCoeff < 1e-12;
+
+  // 陷波: f0处为0，直流与奈奎斯特频率处为1
+  double worstNotch = 0.0, worstEdge = 0.0;
+  for (double ratio = 0.01; ratio < 0.4; ratio *= 1.2) {
+    BiquadCoeffs n = biquad_notch(ratio, 1.0, 5.0);
+    worstNotch = fmax(worstNotch, std::abs(response(&n, 1, ratio, 1.0)));
+    worstEdge = fmax(worstEdge, fabs(std::abs(response(&n, 1, 0.0, 1.0)) - 1.0));
+    worstEdge = fmax(worstEdge, fabs(std::abs(response(&n, 1, 0.5, 1.0)) - 1.0));
+  }
+  printf("notch: |H(f0)| max %.2e, |H(0)|, |H(fs/2)| deviation from 1 max %.2e\n", worstNotch, worstEdge);
+  ok &= worstNotch < 1e-9 && worstEdge < 1e-9;
+
+  printf("Butterworth 2/4/6/8: -3.01 dB at fc, 0 dB at DC, >= 6N dB/octave: %s\n", butterworth ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+/*
+ * bench_check.h - 验证程序共用的检查计数
+ *
+ * **中文注释:**
+ * check()记录一项检查，失败时打印说明; main()最后调用checks_summary()打印"N checks: ok/FAIL"
+ * 并得到进程的退出码，make bench按退出码判断是否通过。
+ */
+
+#ifndef BENCH_CHECK_H_
+#define BENCH_CHECK_H_
+
+#include <stdio.h>
+
+inline bool g_ok = true;    // 所有检查都通过
+inline int g_checks = 0;    // 检查项数
+
+/**
+ * @brief 记录一项检查。
+ * @param what 检查的内容 (失败时打印)
+ * @param good 是否通过
+ */
+inline void check(const char *what, bool good) {
+  if (!good) printf("  FAIL: %s\n", what);
+  g_ok &= good;
+  g_checks++;
+}
+
+/**
+ * @brief 打印检查总数与结果。
+ * @return 进程退出码 (全部通过为0)
+ */
+inline int checks_summary() {
+  printf("%d checks: %s\n", g_checks, g_ok ? "ok" : "FAIL");
+  return g_ok ? 0 : 1;
+}
+
+#endif /* BENCH_CHECK_H_ */
@@ -0,0 +1,124 @@
+/*
+ * bench_http_parser.cpp - HTTP请求解析代价基准测试
+ *
+ * **中文注释:**
+ * 对比两种解析方式处理同一个手机浏览器请求的代价:
+ *   - legacy: 原communicate_with_phone()的做法，逐字节追加到字符串，
+ *             请求头结束后最多调用10次indexOf()查找指令
+ *   - parser: HttpRequestParser状态机 + http_path_to_order()
+ * 通过替换全局operator new统计每个请求的堆分配次数。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <new>
+#include <string>
+
+#include "http_request_parser.hpp"
+#include "http_server.hpp"
+
+static size_t g_allocs = 0;
+
+void *operator new(size_t size) {
+  g_allocs++;
+  void *p = malloc(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace {
+
+// 典型的移动端浏览器请求 (约450字节)
+const char REQUEST[] =
+  "GET /28/on HTTP/1.1\r\n"
+  "Host: 192.168.4.1\r\n"
+  "Connection: keep-alive\r\n"
+  "Upgrade-Insecure-Requests: 1\r\n"
+  "User-Agent: Mozilla/5.0 (Linux; Android 13; Pixel 7) AppleWebKit/537.36 "
+  "(KHTML, like Gecko) Chrome/120.0.0.0 Mobile Safari/537.36\r\n"
+  "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,"
+  "image/webp,*/*;q=0.8\r\n"
+  "Referer: http://192.168.4.1/27/off\r\n"
+  "Accept-Encoding: gzip, deflate\r\n"
+  "Accept-Language: fr-FR,fr;q=0.9,zh-CN;q=0.8,en;q=0.7\r\n"
+  "\r\n";
+
+volatile int g_sink;
+
+/**
+ * @brief 原实现的解析过程 (不含网络I/O与串口回显)。
+ */
+int legacy_parse(const char *req, size_t len) {
+  std::string header;
+  std::string currentLine;
+  int reponse = 1;
+  for (size_t i = 0; i < len; i++) {
+    char c = req[i];
+    header += c;
+    if (c == '\n') {
+      if (currentLine.length() == 0) {
+        if (header.find("GET /26/on") != std::string::npos) reponse = ORDER_ROBOT_FORWARD;
+        if (header.find("GET /27/on") != std::string::npos) reponse = ORDER_ROBOT_LEFT;
+        if (header.find("GET /28/on") != std::string::npos) reponse = ORDER_ROBOT_RIGHT;
+        if (header.find("GET /29/on") != std::string::npos) reponse = ORDER_ROBOT_BACKWARD;
+        if (header.find("GET /26/off") != std::string::npos || header.find("GET /27/off") != std::string::npos ||
+            header.find("GET /28/off") != std::string::npos || header.find("GET /29/off") != std::string::npos) {
+          reponse = ORDER_ROBOT_STOP;
+        }
+        break;
+      }
+      currentLine.clear();
+    } else if (c != '\r') {
+      currentLine += c;
+    }
+  }
+  return reponse;
+}
+
+int parser_parse(HttpRequestParser &parser, const char *req, size_t len) {
+  int reponse = 1;
+  parser.reset();
+  for (size_t i = 0; i < len; i++) {
+    if (parser.feed(req[i]) != HTTP_PARSE_INCOMPLETE) break;
+  }
+  if (parser.status() == HTTP_PARSE_DONE && parser.isGet()) {
+    int order = http_path_to_order(parser.path());
+    if (order != 0) reponse = order;
+  }
+  return reponse;
+}
+
+template <typename F>
+void run(const char *name, long iterations, F fn) {
+  size_t len = sizeof(REQUEST) - 1;
+  for (long i = 0; i < iterations / 10; i++) g_sink = fn(REQUEST, len); // 预热
+
+  size_t allocs_before = g_allocs;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) g_sink = fn(REQUEST, len);
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  double allocs = (double)(g_allocs - allocs_before) / iterations;
+
+  printf("%-8s %10.1f ns/request %8.2f ns/byte %8.1f allocs/request  (order=0x%02x)\n",
+         name, ns / iterations, ns / iterations / len, allocs, g_sink);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  long iterations = argc > 1 ? atol(argv[1]) : 200000;
+  HttpRequestParser parser;
+
+  printf("request: %zu bytes, %ld iterations\n", sizeof(REQUEST) - 1, iterations);
+  run("legacy", iterations, legacy_parse);
+  run("parser", iterations, [&parser](const char *req, size_t len) {
+    return parser_parse(parser, req, len);
+  });
+  return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * bench_loop_timing.cpp - LatencyHistogram与LoopTimingRecorder的正确性与开销
+ *
+ * **中文注释:**
+ * 1. 桶的划分: 每个值都落在[下界, 上界]内，桶连续不重叠，桶宽不超过值的12.5%;
+ * 2. 分位数: 打乱顺序的1~100000，p50/p90/p99不小于精确值且不超过12.5%;
+ * 3. 记录器: 用构造的时间戳 (1毫秒周期，已知的唤醒偏差、一个执行过长的周期、
+ *    一个晚唤醒一个多周期的周期、提前唤醒时没有wake()的周期) 检查抖动、阶段耗时、
+ *    周期预算与超时次数;
+ * 4. 输出: Prometheus文本的行数，缓冲区不足时截断在完整的行上;
+ * 5. 并发: 一个线程记录、另一个线程不断复制快照，快照的总数单调不减且不超过已记录数;
+ * 最后测量每个周期 (wake + 3个phaseDone) 的记录耗时。
+ *
+ * 用法: ./build/bench_loop_timing [计时的周期数, 默认10000000]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "loop_timing.hpp"
+
+namespace {
+
+bool check_buckets() {
+  std::mt19937 rng(1);
+  std::vector<uint32_t> values;
+  for (uint32_t v = 0; v < 70000; v++) values.push_back(v);
+  for (int i = 0; i < 200000; i++) values.push_back(rng());
+  values.push_back(UINT32_MAX);
+  size_t bad = 0;
+  for (uint32_t v : values) {
+    size_t b = LatencyHistogram::bucketOf(v);
+    uint32_t upper = LatencyHistogram::bucketUpper(b);
+    uint32_t lower = b == 0 ? 0 : LatencyHistogram::bucketUpper(b - 1) + 1;
+    bool wide = b < LATENCY_HIST_BUCKETS - 1 && (double)(upper - lower) > 0.125 * v;
+    if (b >= LATENCY_HIST_BUCKETS || v < lower || v > upper || wide) bad++;
+  }
+  printf("bucket bounds: %zu values, %zu violations (%d buckets)\n", values.size(), bad, LATENCY_HIST_BUCKETS);
+  return bad == 0;
+}
+
+bool check_percentiles() {
+  std::vector<uint32_t> v;
+  for (uint32_t i = 1; i <= 100000; i++) v.push_back(i);
+  std::shuffle(v.begin(), v.end(), std::mt19937(2));
+  LatencyHistogram h;
+  for (uint32_t x : v) h.add(x);
+  LatencyHistogram::Snapshot s;
+  h.snapshot(&s);
+  bool ok = s.count == 100000 && s.min == 1 && s.max == 100000;
+  const double qs[] = {0.5, 0.9, 0.99, 1.0};
+  for (double q : qs) {
+    uint32_t exact = (uint32_t)(q * 100000);
+    uint32_t got = s.percentile(q);
+    bool good = got >= exact && got <= exact * 1.125;
+    printf("  p%-5g %8u (exact %u)%s\n", q * 100, (unsigned)got, (unsigned)exact, good ? "" : "  FAIL");
+    ok &= good;
+  }
+  return ok;
+}
+
+/**
+ * @brief 1000微秒周期，周期数字由cycles = 微秒 × 100换算 (相当于100 MHz)。
+ */
+bool check_recorder() {
+  const uint32_t period = 1000;
+  LoopTimingRecorder r(period);
+  r.setCycleBudget(999);  // 每个周期1000个CPU周期，全部超出预算
+  uint64_t t = 10000;
+  uint32_t expectedMaxJitter = 0;
+  for (int k = 0; k < 100; k++) {
+    int32_t offset = (k % 7) - 3;  // 唤醒偏差 -3..3微秒
+    uint64_t wakeUs = t + offset;
+    if (k > 0) {
+      int32_t prevOffset = ((k - 1) % 7) - 3;
+      uint32_t jitter = (uint32_t)abs(offset - prevOffset);
+      expectedMaxJitter = std::max(expectedMaxJitter, jitter);
+    }
+    uint32_t c = (uint32_t)(wakeUs * 100);
+    r.wake(wakeUs, c);
+    r.phaseDone(LOOP_PHASE_SENSE, wakeUs + 5, c + 500);
+    r.phaseDone(LOOP_PHASE_COMPUTE, wakeUs + 7, c + 700);
+    r.phaseDone(LOOP_PHASE_ACTUATE, wakeUs + 10, c + 1000);
+    // 提前唤醒的周期: 没有wake()，阶段被忽略
+    r.phaseDone(LOOP_PHASE_SENSE, wakeUs + 300, c + 30000);
+    r.phaseDone(LOOP_PHASE_ACTUATE, wakeUs + 301, c + 30100);
+    t += period;
+  }
+  LatencyHistogram::Snapshot jitter, sense, cycle, busy;
+  r.wakeJitterUs().snapshot(&jitter);
+  r.phaseCycles(LOOP_PHASE_SENSE).snapshot(&sense);
+  r.cycleCycles().snapshot(&cycle);
+  r.busyUs().snapshot(&busy);
+  bool ok = r.iterations() == 100 && r.overruns() == 0 && jitter.count == 99 && jitter.max == expectedMaxJitter &&
+            sense.count == 100 && sense.min == 500 && sense.max == 500 && cycle.min == 1000 && cycle.max == 1000 &&
+            r.budgetMisses() == 100 && busy.max == 10;
+
+  // 执行过长 (唤醒后1500微秒才输出) -> 超时; 之后的周期立即唤醒，按时完成 -> 不超时
+  uint64_t wakeUs = t;
+  r.wake(wakeUs, 0);
+  r.phaseDone(LOOP_PHASE_SENSE, wakeUs + 1400, 0);
+  r.phaseDone(LOOP_PHASE_COMPUTE, wakeUs + 1450, 0);
+  r.phaseDone(LOOP_PHASE_ACTUATE, wakeUs + 1500, 0);
+  wakeUs += 1500;
+  r.wake(wakeUs, 0);
+  r.phaseDone(LOOP_PHASE_SENSE, wakeUs + 5, 0);
+  r.phaseDone(LOOP_PHASE_COMPUTE, wakeUs + 6, 0);
+  r.phaseDone(LOOP_PHASE_ACTUATE, wakeUs + 7, 0);
+  uint32_t overrunsAfterLong = r.overruns();
+  // 晚唤醒一个多周期 -> 超时
+  wakeUs += 2200;
+  r.wake(wakeUs, 0);
+  r.phaseDone(LOOP_PHASE_SENSE, wakeUs + 5, 0);
+  r.phaseDone(LOOP_PHASE_COMPUTE, wakeUs + 6, 0);
+  r.phaseDone(LOOP_PHASE_ACTUATE, wakeUs + 7, 0);
+  r.wakeJitterUs().snapshot(&jitter);
+  ok &= overrunsAfterLong == 1 && r.overruns() == 2 && r.iterations() == 103 && jitter.max == 1200 &&
+        r.budgetMisses() == 100;
+  printf("recorder: %u iterations, %u overruns, %u budget misses, jitter max %u us: %s\n", (unsigned)r.iterations(),
+         (unsigned)r.overruns(), (unsigned)r.budgetMisses(), (unsigned)jitter.max, ok ? "ok" : "FAIL");
+
+  char buf[4096];
+  size_t len = r.format("test_loop", 100, buf, sizeof(buf));
+  int lines = 0;
+  for (size_t i = 0; i < len; i++) lines += buf[i] == '\n';
+  bool formatOk = len == strlen(buf) && lines == 5 + 6 * 7 && strstr(buf, "test_loop_overruns_total 2\n") != nullptr &&
+                  strstr(buf, "test_loop_sense_us_max 5.00\n") != nullptr &&
+                  strstr(buf, "test_loop_budget_us 9.99\n") != nullptr;
+  char small[200];
+  size_t smallLen = r.format("test_loop", 100, small, sizeof(small));
+  formatOk &= smallLen < sizeof(small) && smallLen == strlen(small) && smallLen > 0 && small[smallLen - 1] == '\n';
+  printf("format: %zu bytes, %d lines, truncated to %zu bytes on a line boundary: %s\n", len, lines, smallLen,
+         formatOk ? "ok" : "FAIL");
+  return ok && formatOk;
+}
+
+bool check_concurrent_reader() {
+  LatencyHistogram h;
+  std::atomic<uint32_t> written(0);
+  std::atomic<bool> done(false);
+  const uint32_t N = 3000000;
+  std::thread writer([&] {
+    std::mt19937 rng(4);
+    for (uint32_t i = 0; i < N; i++) {
+      h.add(rng() % 5000);
+      written.store(i + 1, std::memory_order_release);
+    }
+    done.store(true);
+  });
+  uint32_t last = 0, snapshots = 0;
+  bool ok = true;
+  LatencyHistogram::Snapshot s;
+  while (!done.load()) {
+    h.snapshot(&s);
+    uint32_t bound = written.load(std::memory_order_acquire) + 1;  // add()已完成但written还没更新的一个
+    if (s.count < last || s.count > bound) ok = false;
+    last = s.count;
+    snapshots++;
+  }
+  writer.join();
+  h.snapshot(&s);
+  ok &= s.count == N;
+  printf("concurrent reader: %u snapshots while writing %u values, final count %u: %s\n", (unsigned)snapshots,
+         (unsigned)N, (unsigned)s.count, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  long n = argc > 1 ? atol(argv[1]) : 10000000;
+  bool ok = true;
+  ok &= check_buckets();
+  printf("percentiles of shuffled 1..100000:\n");
+  ok &= check_percentiles();
+  ok &= check_recorder();
+  ok &= check_concurrent_reader();
+
+  LoopTimingRecorder r(1000);
+  std::mt19937 rng(5);
+  uint64_t t = 0;
+  uint32_t c = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (long k = 0; k < n; k++) {
+    t += 1000 + (rng() & 15);
+    c += 240000;
+    r.wake(t, c);
+    r.phaseDone(LOOP_PHASE_SENSE, t + 3, c + 700 + (rng() & 255));
+    r.phaseDone(LOOP_PHASE_COMPUTE, t + 5, c + 1200);
+    r.phaseDone(LOOP_PHASE_ACTUATE, t + 8, c + 1900);
+  }
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  printf("record cost: %.1f ns per loop iteration (wake + 3 phases), %zu bytes per recorder\n", s * 1e9 / n,
+         sizeof(LoopTimingRecorder));
+  return ok ? 0 : 1;
+}
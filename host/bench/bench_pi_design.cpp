@@ -0,0 +1,207 @@
+/*
+ * bench_pi_design.cpp - pi_design.h的系数、稳定性判断与闭环对比
+ *
+ * **中文注释:**
+ *   1. 系数: constexpr的exp与标准库相比; 后向欧拉与基础草图的R0、R1宏相同; 增量形式与并联形式
+ *      (kp、ki) 对同一误差序列输出相同的控制量; 编译期设计的结果可以用在static_assert中;
+ *   2. 线性闭环 (零阶保持精确离散化的一阶被控对象，真实速度，不限幅): 周期1 ~ 100 ms、期望闭环
+ *      时间常数5 ~ 100 ms、三种离散化方法的组合，pi_design_stable()的判断与仿真是否收敛一致;
+ *      零阶保持方法的阶跃响应正好是 1 - p^k; 打印到达63.2%的时间与超调量;
+ *   3. 草图的实际条件 (closed_loop.h: 默认的设定点轨迹、±PWM满量程限幅、草图的积分清零，BF.ino的M法测速
+ *      含量化与半个周期的滞后): 比较手工整定的KP 6000、KI 8000与草图中编译期设计的系数。
+ *
+ * 用法: ./build/bench_pi_design
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "bench_check.h"
+#include "closed_loop.h"
+#include "pi_design.h"
+#include "setpoint_profile.h"
+#include "step_response.h"
+
+namespace {
+
+// 与仿真的默认被控对象和草图相同
+constexpr double TAU_S = LOOP_TAU_S;
+constexpr double GAIN = LOOP_GAIN;
+constexpr double FULL_SCALE = LOOP_PWM_FULL;
+
+// 编译期设计: 与Remote.ino的默认参数相同，目标板上只剩常数
+constexpr PiCoeffs REMOTE_COEFFS = pi_design(TAU_S, GAIN, 0.010, 0.001, FULL_SCALE, PiDiscretization::ZeroOrderHold);
+static_assert(REMOTE_COEFFS.r0 > 0.0 && REMOTE_COEFFS.r1 < 0.0, "系数的符号");
+static_assert(pi_design_stable(REMOTE_COEFFS, TAU_S, GAIN, 0.001, FULL_SCALE), "1 ms设计应稳定");
+static_assert(!pi_design_stable(pi_design(TAU_S, GAIN, 0.005, 0.100, FULL_SCALE, PiDiscretization::BackwardEuler),
+                                TAU_S, GAIN, 0.100, FULL_SCALE), "100 ms周期、5 ms闭环的后向欧拉设计不稳定");
+static_assert(pi_design_fits_pwm(REMOTE_COEFFS, GAIN, 10.0, FULL_SCALE), "10 rad/s的阶跃在PWM范围内");
+
+const char *method_name(PiDiscretization method) {
+  switch (method) {
+    case PiDiscretization::BackwardEuler: return "backward Euler";
+    case PiDiscretization::Tustin: return "Tustin";
+    default: return "ZOH";
+  }
+}
+
+void test_coefficients() {
+  double worst = 0.0;
+  for (double x = -20.0; x <= 0.0; x += 0.01) worst = fmax(worst, fabs(pi_design_exp(x) / exp(x) - 1.0));
+  printf("constexpr exp: worst relative error %.1e on [-20, 0]\n", worst);
+  check("constexpr exp", worst < 1e-13);
+
+  // 基础草图: KP = TAU/G/TAU_DEZ, TI = TAU, R0 = KP·(1 + TE/TI), R1 = -KP (换算为PWM计数)
+  const double te = 0.010, lambda = TAU_S;
+  PiCoeffs be = pi_design(TAU_S, GAIN, lambda, te, FULL_SCALE, PiDiscretization::BackwardEuler);
+  double kp = TAU_S / GAIN / lambda * FULL_SCALE;
+  printf("backward Euler at 10 ms: R0 %.3f R1 %.3f (base sketch macros %.3f %.3f)\n", be.r0, be.r1,
+         kp * (1.0 + te / TAU_S), -kp);
+  check("backward Euler R0", fabs(be.r0 - kp * (1.0 + te / TAU_S)) < 1e-9);
+  check("backward Euler R1", fabs(be.r1 + kp) < 1e-9);
+
+  // 增量形式与并联形式对同一误差序列的输出
+  const PiDiscretization methods[] = {PiDiscretization::BackwardEuler, PiDiscretization::Tustin,
+                                      PiDiscretization::ZeroOrderHold};
+  for (PiDiscretization method : methods) {
+    PiCoeffs c = pi_design(TAU_S, GAIN, 0.010, 0.002, FULL_SCALE, method);
+    double incremental = 0.0, lastError = 0.0, integral = 0.0, diff = 0.0;
+    unsigned seed = 12345;
+    for (int k = 0; k < 10000; k++) {
+      seed = seed * 1103515245u + 12345u;
+      double error = ((seed >> 8) & 0xffff) / 32768.0 - 1.0;
+      incremental += c.r0 * error + c.r1 * lastError;
+      lastError = error;
+      integral += error * 0.002;
+      diff = fmax(diff, fabs(incremental - (c.kp * error + c.ki * integral)));
+    }
+    printf("  %-15s r0 %9.2f r1 %9.2f  kp %9.2f ki %10.1f  incremental vs parallel %.1e\n", method_name(method), c.r0,
+           c.r1, c.kp, c.ki, diff);
+    check("incremental == parallel", diff < 1e-6);
+  }
+}
+
+/**
+ * @brief 线性闭环的单位阶跃 (不限幅、真实速度)，返回是否收敛; t63为到达63.2%的时间 (秒)。
+ */
+bool run_linear(const PiCoeffs &c, double te, double *t63, double *overshoot, double *zohError, double lambda) {
+  double a = exp(-te / TAU_S), b = GAIN * (1.0 - a) / FULL_SCALE;
+  double p = exp(-te / lambda);
+  double y = 0.0, u = 0.0, lastError = 0.0;
+  *t63 = NAN;
+  *overshoot = 0.0;
+  *zohError = 0.0;
+  // 极点模接近1时衰减很慢 (例如0.98)，运行足够多的周期
+  for (int k = 0; k <= 20000; k++) {
+    if (isnan(*t63) && y >= 1.0 - exp(-1.0)) *t63 = k * te;
+    *overshoot = fmax(*overshoot, y - 1.0);
+    *zohError = fmax(*zohError, fabs(y - (1.0 - pow(p, k))));
+    if (!(fabs(y) < 1e6)) return false;
+    double error = 1.0 - y;
+    u += c.r0 * error + c.r1 * lastError;
+    lastError = error;
+    y = a * y + b * u;
+  }
+  return fabs(1.0 - y) < 1e-3;
+}
+
+void test_linear() {
+  const double periods[] = {0.001, 0.010, 0.050, 0.100};
+  const double lambdas[] = {0.005, 0.010, 0.030, 0.100};
+  const PiDiscretization methods[] = {PiDiscretization::BackwardEuler, PiDiscretization::Tustin,
+                                      PiDiscretization::ZeroOrderHold};
+  printf("linear loop (unit step, no clamp)   pole radius  converged   t63 ms  overshoot\n");
+  for (double te : periods) {
+    for (double lambda : lambdas) {
+      for (PiDiscretization method : methods) {
+        PiCoeffs c = pi_design(TAU_S, GAIN, lambda, te, FULL_SCALE, method);
+        double radius = pi_design_pole_radius(c, TAU_S, GAIN, te, FULL_SCALE);
+        bool stable = pi_design_stable(c, TAU_S, GAIN, te, FULL_SCALE);
+        double t63, overshoot, zohError;
+        bool converged = run_linear(c, te, &t63, &overshoot, &zohError, lambda);
+        printf("  Te %5.1f ms  lambda %5.1f ms  %-15s %6.3f  %-9s %8.1f %9.1f%%\n", te * 1e3, lambda * 1e3,
+               method_name(method), radius, converged ? "yes" : "no", t63 * 1e3, overshoot * 100.0);
+        check("pi_design_stable() agrees with the simulation", stable == converged);
+        if (method == PiDiscretization::ZeroOrderHold) {
+          check("ZOH step response is 1 - p^k", stable && zohError < 1e-9);
+        }
+      }
+    }
+  }
+}
+
+// --- 草图的实际条件 ---
+
+struct SketchLoop {
+  const char *name;
+  double dt;
+  bool bf;  // BF.ino (M法测速)，否则为Remote.ino (真实速度)
+  float kp, ki, integralMax;
+};
+
+/**
+ * @brief 草图的默认配置 (SETPOINT_PROFILE为1): 设定点经过各自的轨迹限制后送给PI;
+ *        Remote.ino在参考值为0时清零积分，BF.ino有轨迹时不清零。
+ */
+std::vector<StepMetrics> run_sketch(const SketchLoop &cfg) {
+  JerkLimitedProfile profile(cfg.bf ? 10.0f : 50.0f, cfg.bf ? 100.0f : 1000.0f);  // 各草图的PROFILE_MAX_*
+  ClosedLoopConfig loop;
+  loop.dt = cfg.dt;
+  loop.quantized = cfg.bf;
+  loop.kp = cfg.kp;
+  loop.ki = cfg.ki;
+  loop.integralMax = cfg.integralMax;
+  loop.reset = cfg.bf ? IntegralReset::None : IntegralReset::AtZeroReference;
+  loop.profile = &profile;
+  return run_closed_loop(loop);
+}
+
+void compare_sketches() {
+  // 草图中的设计: Remote.ino 1 ms、λ = 10 ms; BF.ino 100 ms (以及-DCONTROL_PERIOD_MS=2)、λ = 100 ms; 零阶保持
+  constexpr PiCoeffs remote = REMOTE_COEFFS;
+  constexpr PiCoeffs bf100 = pi_design(TAU_S, GAIN, 0.100, 0.100, FULL_SCALE, PiDiscretization::ZeroOrderHold);
+  constexpr PiCoeffs bf2 = pi_design(TAU_S, GAIN, 0.100, 0.002, FULL_SCALE, PiDiscretization::ZeroOrderHold);
+  struct {
+    SketchLoop loop;
+    bool designed;
+  } cases[] = {
+    {{"Remote 1 ms, hand-tuned", 0.001, false, 6000.0f, 8000.0f, 15000.0f}, false},
+    {{"Remote 1 ms, designed", 0.001, false, (float)remote.kp, (float)remote.ki, (float)(FULL_SCALE / remote.ki)},
+     true},
+    {{"BF 100 ms, hand-tuned", 0.100, true, 6000.0f, 8000.0f, 15000.0f}, false},
+    {{"BF 100 ms, designed", 0.100, true, (float)bf100.kp, (float)bf100.ki, (float)(FULL_SCALE / bf100.ki)}, true},
+    {{"BF 2 ms, hand-tuned", 0.002, true, 6000.0f, 8000.0f, 15000.0f}, false},
+    {{"BF 2 ms, designed", 0.002, true, (float)bf2.kp, (float)bf2.ki, (float)(FULL_SCALE / bf2.ki)}, true},
+  };
+  printf("sketch loops (5%% band; u_peak: |PI output| before the PWM clamp):\n");
+  printf("  %-26s %-16s %10s %10s %10s %10s\n", "loop", "step", "settle ms", "overshoot", "u_peak", "ripple");
+  for (const auto &c : cases) {
+    std::vector<StepMetrics> steps = run_sketch(c.loop);
+    int unsettled = 0;
+    double worstOvershoot = 0.0;
+    for (const StepMetrics &m : steps) {
+      char step[32];
+      snprintf(step, sizeof(step), "%+.1f -> %+.1f", m.from, m.to);
+      printf("  %-26s %-16s %10.1f %9.1f%% %10.0f %10.3f\n", c.loop.name, step, m.settleMs, m.overshootPct, m.uPeak,
+             m.ripple);
+      if (isnan(m.settleMs)) unsettled++;
+      worstOvershoot = fmax(worstOvershoot, m.overshootPct);
+    }
+    if (!c.designed) continue;
+    check("designed loop settles every step", steps.size() == 3 && unsettled == 0);
+    // M法在2 ms周期时一个计数对应2.4 rad/s，超调量由量化决定，不检查
+    double resolution = c.loop.bf ? m_method_resolution(c.loop.dt) : 0.0;
+    if (resolution < 0.1) check("designed loop overshoot", worstOvershoot < 10.0);
+  }
+}
+
+} // namespace
+
+int main() {
+  test_coefficients();
+  test_linear();
+  compare_sketches();
+  return checks_summary();
+}
@@ -0,0 +1,205 @@
+/*
+ * bench_quadrature_isr.cpp - 查表法正交解码中断与原digitalRead + switch实现的对比
+ *
+ * **中文注释:**
+ * 预先生成一段四倍频正交波形 (随机换向，每1000个边沿注入一次两相同时变化的非法跳变)，
+ * 逐个边沿写入GPIO输入寄存器后调用中断处理函数，统计每个边沿的平均耗时
+ * (纳秒，x86上同时给出TSC周期数)。左编码器(GPIO14/27)使用GPIO.in，
+ * 右编码器(GPIO35/34)使用GPIO.in1，两组都测。
+ *   - legacy: BO_Vitesse.ino原来的ISR (两次digitalRead + 4路switch)，
+ *     digitalRead按Arduino-ESP32的gpio_get_level实现为不内联的函数调用;
+ *   - table: quadrature_decoder.h中的quadratureISR (一次寄存器读取 + 16项跳变表)。
+ * 两者的计数必须与波形的真实位置一致，table统计的非法跳变数必须等于注入数，否则返回1。
+ *
+ * 用法: ./build/bench_quadrature_isr [边沿数, 默认2000000]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#include "quadrature_decoder.h"
+
+volatile gpio_dev_t GPIO;
+
+/**
+ * @brief 与gpio_get_level相同: 按引脚号选择输入寄存器。
+ */
+__attribute__((noinline)) int digitalRead(uint8_t pin) {
+  if (pin < 32) return (GPIO.in >> pin) & 1;
+  return (GPIO.in1.data >> (pin - 32)) & 1;
+}
+
+namespace {
+
+const uint8_t SLA = 14;
+const uint8_t SLB = 27;
+const uint8_t SRA = 35;
+const uint8_t SRB = 34;
+
+//- 原实现 (BO_Vitesse.ino中的leftEncoderISR_A/B) ----------------------------
+
+volatile int32_t legacyCount = 0;
+volatile uint8_t legacyState = 0;
+
+template <uint8_t PIN_A, uint8_t PIN_B>
+__attribute__((noinline)) void legacyEncoderISR() {
+  uint8_t A = digitalRead(PIN_A);
+  uint8_t B = digitalRead(PIN_B);
+  uint8_t currentState = (A << 1) | B;
+
+  int8_t direction = 0;
+  switch (legacyState) {
+    case 0b00:
+      if (currentState == 0b01) direction = 1;
+      else if (currentState == 0b10) direction = -1;
+      break;
+    case 0b01:
+      if (currentState == 0b11) direction = 1;
+      else if (currentState == 0b00) direction = -1;
+      break;
+    case 0b11:
+      if (currentState == 0b10) direction = 1;
+      else if (currentState == 0b01) direction = -1;
+      break;
+    case 0b10:
+      if (currentState == 0b00) direction = 1;
+      else if (currentState == 0b11) direction = -1;
+      break;
+  }
+
+  legacyCount += direction;
+  legacyState = currentState;
+}
+
+QuadratureCounter tableCounter;
+
+// 中断处理函数通过函数指针调用 (与attachInterrupt相同)，防止被内联进测量循环
+typedef void (*Isr)();
+
+// 正交序列 (A<<1 | B): 00 -> 01 -> 11 -> 10 为正方向
+const uint8_t QUAD_SEQ[4] = {0b00, 0b01, 0b11, 0b10};
+
+struct Waveform {
+  std::vector<uint8_t> states;  // 每个边沿之后的相位状态
+  int32_t position = 0;         // 波形结束时的真实位置 (不含非法跳变)
+  uint32_t illegal = 0;         // 注入的非法跳变数
+};
+
+Waveform make_waveform(int edges) {
+  Waveform w;
+  w.states.reserve((size_t)edges);
+  std::mt19937 rng(12345);
+  int64_t pos = 0;
+  int dir = 1;
+  for (int i = 0; i < edges; i++) {
+    if (rng() % 500 == 0) dir = -dir;
+    if (i % 1000 == 999) {
+      pos += 2 * dir; // 跳过一个边沿: 两相同时变化
+      w.illegal++;
+    } else {
+      pos += dir;
+      w.position += dir;
+    }
+    w.states.push_back(QUAD_SEQ[pos & 3]);
+  }
+  return w;
+}
+
+void set_pins(uint8_t pinA, uint8_t pinB, uint8_t state) {
+  uint32_t a = (state >> 1) & 1;
+  uint32_t b = state & 1;
+  if (pinA < 32) {
+    GPIO.in = (GPIO.in & ~((1u << pinA) | (1u << pinB))) | (a << pinA) | (b << pinB);
+  } else {
+    uint32_t ma = 1u << (pinA - 32), mb = 1u << (pinB - 32);
+    GPIO.in1.val = (GPIO.in1.val & ~(ma | mb)) | (a << (pinA - 32)) | (b << (pinB - 32));
+  }
+}
+
+struct Cost {
+  double ns;
+  double cycles;
+};
+
+Cost run(Isr isr, uint8_t pinA, uint8_t pinB, const Waveform &w) {
+  set_pins(pinA, pinB, QUAD_SEQ[0]);
+  auto t0 = std::chrono::steady_clock::now();
+#if HAVE_TSC
+  uint64_t c0 = __rdtsc();
+#endif
+  for (uint8_t s : w.states) {
+    set_pins(pinA, pinB, s);
+    isr();
+  }
+#if HAVE_TSC
+  uint64_t c1 = __rdtsc();
+#endif
+  auto t1 = std::chrono::steady_clock::now();
+  Cost c;
+  c.ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / w.states.size();
+#if HAVE_TSC
+  c.cycles = (double)(c1 - c0) / w.states.size();
+#else
+  c.cycles = 0.0;
+#endif
+  return c;
+}
+
+/**
+ * @brief 只写寄存器不调用中断，作为循环本身的开销。
+ */
+void nop_isr() {}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int edges = argc > 1 ? atoi(argv[1]) : 2000000;
+  Waveform w = make_waveform(edges);
+  bool ok = true;
+
+  printf("%d edges, %u illegal transitions injected\n", edges, w.illegal);
+  printf("%-10s %-8s %12s %14s %10s %10s\n", "encoder", "isr", "ns/edge", "cycles/edge", "count", "illegal");
+
+  struct Encoder {
+    const char *name;
+    uint8_t pinA, pinB;
+    Isr legacy, table;
+  } encoders[] = {
+    {"GPIO14/27", SLA, SLB, legacyEncoderISR<SLA, SLB>, quadratureISR<SLA, SLB, tableCounter>},
+    {"GPIO35/34", SRA, SRB, legacyEncoderISR<SRA, SRB>, quadratureISR<SRA, SRB, tableCounter>},
+  };
+
+  for (const Encoder &e : encoders) {
+    Cost base = run(nop_isr, e.pinA, e.pinB, w);
+
+    legacyCount = 0;
+    legacyState = QUAD_SEQ[0];
+    Cost legacy = run(e.legacy, e.pinA, e.pinB, w);
+    printf("%-10s %-8s %12.2f %14.1f %10d %10s\n", e.name, "legacy",
+           legacy.ns - base.ns, legacy.cycles - base.cycles, (int)legacyCount, "-");
+
+    tableCounter.count = 0;
+    tableCounter.illegal = 0;
+    tableCounter.state = QUAD_SEQ[0];
+    Cost table = run(e.table, e.pinA, e.pinB, w);
+    printf("%-10s %-8s %12.2f %14.1f %10d %10u\n", e.name, "table",
+           table.ns - base.ns, table.cycles - base.cycles, (int)tableCounter.count, tableCounter.illegal);
+
+    if (legacyCount != w.position || tableCounter.count != w.position || tableCounter.illegal != w.illegal) {
+      printf("FAIL: expected count=%d illegal=%u\n", w.position, w.illegal);
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
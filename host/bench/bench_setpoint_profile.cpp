@@ -0,0 +1,174 @@
+/*
+ * bench_setpoint_profile.cpp - JerkLimitedProfile的约束检查与闭环对比
+ *
+ * **中文注释:**
+ *   1. 轨迹本身 (1 ms与100 ms周期): 各种阶跃和运动途中改变目标值时，逐周期检查
+ *      |变化率| ≤ maxAccel、|变化率的变化| ≤ maxJerk·dt，从静止出发的阶跃不超调 (≤ maxJerk·dt²)、
+ *      准确落在目标值，到达时间与理论最短时间相差不超过两个周期; 并测量每次update()的耗时;
+ *   2. 闭环对比 (closed_loop.h): 手工整定的PI参数，分别在有/无轨迹时计算各阶跃的调节时间、
+ *      超调量与控制量峰值; 测量值为真实速度或BF.ino的M法。
+ *      BF.ino默认的100 ms周期在这个模型上不稳定 (每周期的环路增益约9)，与轨迹无关，不参与对比。
+ *
+ * 用法: ./build/bench_setpoint_profile
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <vector>
+
+#include "bench_check.h"
+#include "closed_loop.h"
+#include "setpoint_profile.h"
+#include "step_response.h"
+
+namespace {
+
+/**
+ * @brief 从静止出发走完一个阶跃的最短时间 (加加速度段 + 匀加速段 + 减加速度段)。
+ */
+double min_step_time(double delta, double maxAccel, double maxJerk) {
+  delta = fabs(delta);
+  if (delta >= maxAccel * maxAccel / maxJerk) return delta / maxAccel + maxAccel / maxJerk;
+  return 2.0 * sqrt(delta / maxJerk);
+}
+
+/**
+ * @brief 从from出发跟踪target，检查约束; retargetAt >= 0 时在该时刻把目标改为retarget。
+ */
+void check_profile(float maxAccel, float maxJerk, float dt, float from, float target, double retargetAt = -1.0,
+                   float retarget = 0.0f) {
+  JerkLimitedProfile profile(maxAccel, maxJerk);
+  profile.reset(from);
+  float lastRate = 0.0f;
+  double worstAccel = 0.0, worstJerk = 0.0, overshoot = 0.0;
+  double arrival = -1.0;
+  int steps = (int)(3.0 / dt);
+  float goal = target;
+  for (int k = 1; k <= steps; k++) {
+    double t = k * dt;
+    if (retargetAt >= 0.0 && t > retargetAt && goal != retarget) goal = retarget;
+    float r = profile.update(goal, dt);
+    worstAccel = fmax(worstAccel, fabs(profile.rate()) / maxAccel);
+    worstJerk = fmax(worstJerk, fabs(profile.rate() - lastRate) / (maxJerk * dt));
+    lastRate = profile.rate();
+    if (goal == target) overshoot = fmax(overshoot, (r - target) * (target > from ? 1.0 : -1.0));
+    if (arrival < 0.0 && r == goal && profile.rate() == 0.0f) arrival = t;
+  }
+  bool landed = profile.value() == goal && profile.rate() == 0.0f;
+  if (retargetAt < 0.0) {
+    double ideal = min_step_time(target - from, maxAccel, maxJerk);
+    printf("  dt %5.1f ms  %+.2f -> %+.2f: arrival %6.1f ms (min %6.1f), accel %.3f, jerk %.3f of limit, "
+           "overshoot %.1e\n", dt * 1e3, from, target, arrival * 1e3, ideal * 1e3, worstAccel, worstJerk, overshoot);
+    check("arrival time", arrival > 0.0 && arrival <= ideal + 2.0 * dt + 1e-6);
+    check("no overshoot", overshoot <= maxJerk * dt * dt);
+  } else {
+    printf("  dt %5.1f ms  %+.2f -> %+.2f, at %.0f ms -> %+.2f: arrival %6.1f ms, accel %.3f, jerk %.3f of limit\n",
+           dt * 1e3, from, target, retargetAt * 1e3, retarget, arrival * 1e3, worstAccel, worstJerk);
+  }
+  check("landed on the target", landed);
+  check("acceleration limit", worstAccel <= 1.0 + 1e-5);
+  check("jerk limit", worstJerk <= 1.0 + 1e-3);
+}
+
+void test_profile() {
+  printf("profile (accel 50 rad/s^2, jerk 1000 rad/s^3 at 1 ms; 10 / 100 at 100 ms):\n");
+  check_profile(50.0f, 1000.0f, 0.001f, 0.0f, 2.5f);
+  check_profile(50.0f, 1000.0f, 0.001f, 2.5f, -2.5f);
+  check_profile(50.0f, 1000.0f, 0.001f, 0.0f, 0.01f);
+  check_profile(50.0f, 1000.0f, 0.001f, 0.0f, 0.003f);
+  check_profile(10.0f, 100.0f, 0.1f, 0.0f, 0.3f);
+  check_profile(50.0f, 1000.0f, 0.001f, -1.0f, 8.0f);
+  check_profile(50.0f, 1000.0f, 0.001f, 0.0f, 2.5f, 0.05, -1.0f);
+  check_profile(50.0f, 1000.0f, 0.001f, 0.0f, 5.0f, 0.12, 5.5f);
+  check_profile(10.0f, 100.0f, 0.1f, 0.0f, 2.5f);
+  check_profile(10.0f, 100.0f, 0.1f, 2.5f, -2.5f);
+  check_profile(10.0f, 100.0f, 0.1f, 0.0f, 2.5f, 0.2, -2.5f);
+}
+
+void bench_update_cost() {
+  JerkLimitedProfile profile(50.0f, 1000.0f);
+  const int n = 10000000;
+  float sum = 0.0f;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    sum += profile.update((i & 0x1000) ? 2.5f : -2.5f, 0.001f);
+  }
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  printf("update cost: %.1f ns per tick (checksum %.1f)\n", s * 1e9 / n, sum);
+}
+
+// --- 闭环对比 ---
+
+const float KP = 6000.0f, KI = 8000.0f, INTEGRAL_MAX = 15000.0f;  // 手工整定的PI参数 (草图中PI_DESIGN=0)
+
+struct LoopConfig {
+  const char *name;
+  double dt;
+  bool quantized;      // M法测量 (BF.ino)，否则为真实速度
+  bool bf;             // BF.ino的积分清零 (无轨迹时设定点变化清零)，否则为Remote.ino (参考值为0时清零)
+  float maxAccel, maxJerk;
+  bool checked;        // false: 只打印 (量化噪声主导控制量，见下)
+};
+
+/**
+ * @brief 运行20秒的阶跃序列，返回每个阶跃的指标。
+ */
+std::vector<StepMetrics> run_loop(const LoopConfig &cfg, bool useProfile) {
+  JerkLimitedProfile profile(cfg.maxAccel, cfg.maxJerk);
+  ClosedLoopConfig loop;
+  loop.dt = cfg.dt;
+  loop.quantized = cfg.quantized;
+  loop.kp = KP;
+  loop.ki = KI;
+  loop.integralMax = INTEGRAL_MAX;
+  loop.reset = !cfg.bf ? IntegralReset::AtZeroReference
+                       : (useProfile ? IntegralReset::None : IntegralReset::OnSetpointChange);
+  loop.profile = useProfile ? &profile : nullptr;
+  return run_closed_loop(loop);
+}
+
+void compare_loops() {
+  const LoopConfig configs[] = {
+    {"Remote 1 ms, true speed", 0.001, false, false, 50.0f, 1000.0f, true},
+    {"5 ms, true speed", 0.005, false, false, 50.0f, 1000.0f, true},
+    // M法在2 ms周期时一个计数对应2.4 rad/s，KP·2.4 ≈ 14000: 控制量峰值主要来自测量噪声而不是阶跃
+    {"BF 2 ms, M-method, reset I", 0.002, true, true, 50.0f, 1000.0f, false},
+  };
+  printf("closed loop (settle: 5%% band; u_peak: |PI output| before the PWM clamp):\n");
+  printf("  %-28s %-8s %-16s %10s %10s %10s %10s\n", "loop", "profile", "step", "settle ms", "overshoot", "u_peak",
+         "IAE");
+  for (const LoopConfig &cfg : configs) {
+    double peak[2] = {0.0, 0.0}, settleSum[2] = {0.0, 0.0};
+    int unsettled[2] = {0, 0};
+    for (int useProfile = 0; useProfile < 2; useProfile++) {
+      for (const StepMetrics &m : run_loop(cfg, useProfile != 0)) {
+        char step[32];
+        snprintf(step, sizeof(step), "%+.1f -> %+.1f", m.from, m.to);
+        printf("  %-28s %-8s %-16s %10.1f %9.1f%% %10.0f %10.3f\n", cfg.name, useProfile ? "on" : "off", step,
+               m.settleMs, m.overshootPct, m.uPeak, m.iae);
+        peak[useProfile] = fmax(peak[useProfile], m.uPeak);
+        if (isnan(m.settleMs)) {
+          unsettled[useProfile]++;
+        } else {
+          settleSum[useProfile] += m.settleMs;
+        }
+      }
+    }
+    printf("  %-28s peak command %.0f -> %.0f, settle sum %.0f -> %.0f ms, unsettled %d -> %d\n", "", peak[0],
+           peak[1], settleSum[0], settleSum[1], unsettled[0], unsettled[1]);
+    if (!cfg.checked) continue;
+    check("profile lowers the peak command", peak[1] < 0.5 * peak[0]);
+    check("profile does not leave steps unsettled", unsettled[1] <= unsettled[0]);
+  }
+}
+
+} // namespace
+
+int main() {
+  test_profile();
+  bench_update_cost();
+  compare_loops();
+  return checks_summary();
+}
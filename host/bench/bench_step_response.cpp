@@ -0,0 +1,152 @@
+/*
+ * bench_step_response.cpp - StepResponseAnalyzer的正确性与吞吐量测试
+ *
+ * **中文注释:**
+ * 用已知解析解的响应检查各项指标 (1毫秒采样，时间指标允许1个采样周期的误差):
+ *   1. 一阶系统 y = y0 + Δ(1 - e^(-t/τ))，τ = 30.2 ms:
+ *      上升时间 τ·ln9，5%调节时间 τ·ln20，无超调，稳态误差为0;
+ *   2. 二阶欠阻尼系统 (ζ = 0.3，ωn = 20 rad/s，负方向阶跃，y0 ≠ 0):
+ *      超调量 exp(-πζ/√(1-ζ²))，上升时间与调节时间与0.01毫秒的密集采样比较;
+ *   3. 带稳态偏差和正弦纹波的响应: 稳态误差 = 偏差，纹波 = 幅值/√2，
+ *      恒定控制信号的均方根值等于该常数，未进入误差带时调节时间为NaN;
+ * 然后用一个长记录 (默认1000万个样本，每5秒一个阶跃) 测量吞吐量。
+ *
+ * 用法: ./build/bench_step_response [样本数, 默认10000000]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+#include "step_response.h"
+
+namespace {
+
+const double TAU_MS = 30.2;
+
+struct Collected {
+  std::vector<StepMetrics> steps;
+};
+
+void collect(const StepMetrics &m, void *ctx) {
+  ((Collected *)ctx)->steps.push_back(m);
+}
+
+double first_order(double t, double y0, double target) {
+  return target + (y0 - target) * exp(-t / TAU_MS);
+}
+
+double second_order(double t, double y0, double target) {
+  const double zeta = 0.3, wn = 20.0;
+  double ts = t * 1e-3;
+  double wd = wn * sqrt(1 - zeta * zeta);
+  double phi = acos(zeta);
+  double unit = 1 - exp(-zeta * wn * ts) / sqrt(1 - zeta * zeta) * sin(wd * ts + phi);
+  return y0 + (target - y0) * unit;
+}
+
+/**
+ * @brief 0.01毫秒密集采样求出的参考上升时间与调节时间。
+ */
+void dense_reference(double (*f)(double, double, double), double y0, double target, double duration,
+                     double *rise, double *settle) {
+  double t10 = NAN, t90 = NAN, lastOutside = 0.0;
+  double delta = target - y0;
+  for (double t = 0.0; t <= duration; t += 0.01) {
+    double p = (f(t, y0, target) - y0) / delta;
+    if (isnan(t10) && p >= 0.1) t10 = t;
+    if (isnan(t90) && p >= 0.9) t90 = t;
+    if (fabs(p - 1.0) > 0.05) lastOutside = t;
+  }
+  *rise = t90 - t10;
+  *settle = lastOutside;
+}
+
+bool check(const char *name, double got, double want, double tol) {
+  bool ok = (isnan(want) && isnan(got)) || fabs(got - want) <= tol;
+  printf("  %-28s %10.4f  (expected %10.4f ± %g)%s\n", name, got, want, tol, ok ? "" : "  FAIL");
+  return ok;
+}
+
+/**
+ * @brief 先保持from一段时间，再在t = 1000毫秒阶跃到to，持续durationMs。
+ */
+Collected run(double (*f)(double, double, double), float from, float to, uint32_t durationMs, double offset,
+              double rippleAmp, float command) {
+  Collected c;
+  StepResponseAnalyzer::Config config;
+  StepResponseAnalyzer a(config, collect, &c);
+  for (uint32_t t = 0; t < 1000; t++) a.add(t, from, from, 0.0f);
+  for (uint32_t t = 0; t <= durationMs; t++) {
+    double y = f(t, from, to) - offset + rippleAmp * sin(2 * M_PI * t / 100.0);
+    a.add(1000 + t, to, (float)y, command);
+  }
+  a.finish();
+  return c;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  long count = argc > 1 ? atol(argv[1]) : 10000000;
+  bool ok = true;
+
+  printf("first order, 0 -> 2.5 rad/s:\n");
+  Collected c1 = run(first_order, 0.0f, 2.5f, 2000, 0.0, 0.0, 8000.0f);
+  ok &= c1.steps.size() == 1;
+  if (c1.steps.size() == 1) {
+    const StepMetrics &m = c1.steps[0];
+    ok &= check("rise (ms)", m.riseMs, TAU_MS * log(9.0), 1.0);
+    ok &= check("settle (ms)", m.settleMs, TAU_MS * log(20.0), 1.0);
+    ok &= check("overshoot (%)", m.overshootPct, 0.0, 1e-3);
+    ok &= check("steady error", m.steadyError, 0.0, 1e-4);
+    ok &= check("u rms", m.uRms, 8000.0, 1e-2);
+  }
+
+  printf("second order, 1.0 -> -2.5 rad/s:\n");
+  Collected c2 = run(second_order, 1.0f, -2.5f, 2000, 0.0, 0.0, 0.0f);
+  ok &= c2.steps.size() == 1;
+  if (c2.steps.size() == 1) {
+    const StepMetrics &m = c2.steps[0];
+    double rise, settle;
+    dense_reference(second_order, 1.0, -2.5, 2000, &rise, &settle);
+    ok &= check("rise (ms)", m.riseMs, rise, 1.0);
+    ok &= check("settle (ms)", m.settleMs, settle, 1.0);
+    ok &= check("overshoot (%)", m.overshootPct, 100 * exp(-M_PI * 0.3 / sqrt(1 - 0.09)), 0.1);
+    ok &= check("y0", m.y0, 1.0, 1e-6);
+  }
+
+  printf("offset 0.2 + ripple 0.05 (never settles within 5%%):\n");
+  Collected c3 = run(first_order, 0.0f, 2.5f, 3000, 0.2, 0.05, -3000.0f);
+  ok &= c3.steps.size() == 1;
+  if (c3.steps.size() == 1) {
+    const StepMetrics &m = c3.steps[0];
+    ok &= check("steady error", m.steadyError, 0.2, 1e-3);
+    ok &= check("ripple", m.ripple, 0.05 / sqrt(2.0), 1e-3);
+    ok &= check("settle (ms)", m.settleMs, NAN, 0.0);
+    ok &= check("u peak", m.uPeak, 3000.0, 1e-3);
+  }
+
+  // 吞吐量: 10毫秒采样，每5秒在5个设定点之间切换
+  const float setpoints[] = {0.0f, 2.5f, -2.5f, 1.0f, 4.0f};
+  Collected c4;
+  StepResponseAnalyzer::Config config;
+  StepResponseAnalyzer a(config, collect, &c4);
+  auto t0 = std::chrono::steady_clock::now();
+  double y = 0.0;
+  for (long k = 0; k < count; k++) {
+    float sp = setpoints[(k / 500) % 5];
+    y += (sp - y) * (1.0 - exp(-10.0 / TAU_MS));
+    a.add((uint32_t)(k * 10), sp, (float)y, 8000.0f * (sp - (float)y));
+  }
+  a.finish();
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  printf("throughput: %ld samples, %zu steps in %.2f s (%.1f Msamples/s, %.0f h of 100 Hz data per second)\n", count,
+         c4.steps.size(), s, count / s / 1e6, count / s / 100 / 3600);
+  ok &= c4.steps.size() == (size_t)((count - 1) / 500);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+/*
+ * bench_telemetry_frame.cpp - 二进制遥测帧的正确性与压缩率测试
+ *
+ * **中文注释:**
+ * 用一阶电机模型 + PI控制器 + 编码器量化生成与BF.ino相同形式的样本流
+ * (100毫秒周期，每5秒改变一次设定点)，然后:
+ *   1. 编码后按随机长度分块输入解码器，还原的样本必须与量化后的原始值完全一致;
+ *   2. 比较每个样本的字节数: 原4列TSV文本、同样5列的TSV文本与二进制帧，
+ *      二进制帧相对同样5列文本的压缩比不足5倍时失败;
+ *   3. 在帧之间插入文本行 (开头是一段超过帧缓冲区的文本)，并随机损坏约2%的帧 (改写一个字节): 解码器必须还原
+ *      全部文本行，不能输出任何错误的样本，未损坏的帧必须全部解出;
+ *   4. 测量编码与解码的吞吐量。
+ *
+ * 用法: ./build/bench_telemetry_frame [样本数, 默认200000]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "telemetry_frame.h"
+
+namespace {
+
+const double PERIOD_S = 0.1;
+const double EDGES_PER_RAD = 1320 / (2.0 * M_PI);
+
+/**
+ * @brief 生成样本: 真实机器人的量级 (增益约5.4 rad/s，KP=6000，KI=8000，PWM 15位)。
+ */
+std::vector<TelemetrySample> make_samples(int n) {
+  std::vector<TelemetrySample> out;
+  out.reserve((size_t)n);
+  const float setpoints[] = {0.0f, 2.5f, -2.5f, 0.0f, 1.0f, 4.0f};
+  std::mt19937 rng(7);
+  std::normal_distribution<double> noise(0.0, 0.05);
+  double omega = 0.0, theta = 0.0, integral = 0.0;
+  int64_t lastCount = 0;
+  for (int k = 0; k < n; k++) {
+    float sp = setpoints[(k / 50) % 6];
+    int64_t count = (int64_t)floor(theta * EDGES_PER_RAD);
+    float measured = (float)((count - lastCount) / EDGES_PER_RAD / PERIOD_S);
+    lastCount = count;
+    double error = sp - measured;
+    integral += error * PERIOD_S;
+    if (integral > 15000) integral = 15000;
+    if (integral < -15000) integral = -15000;
+    double u = 6000.0 * error + 8000.0 * integral;
+    out.push_back({(uint32_t)(k + 1) * 100, sp, measured, (float)u, (float)integral});
+
+    double duty = fmax(-1.0, fmin(1.0, u / 32767.0));
+    // 一阶模型 (TAU 30 ms) 在一个周期内的解析解，加少量负载扰动
+    double target = 5.4 * duty + noise(rng);
+    double decay = exp(-PERIOD_S / 0.0302);
+    theta += target * PERIOD_S + (omega - target) * 0.0302 * (1.0 - decay);
+    omega = target + (omega - target) * decay;
+  }
+  return out;
+}
+
+bool same_quantized(const TelemetrySample &a, const TelemetrySample &b) {
+  return a.timeMs == b.timeMs && lroundf(a.setpoint * 1000) == lroundf(b.setpoint * 1000) &&
+         lroundf(a.measured * 1000) == lroundf(b.measured * 1000) && lroundf(a.command) == lroundf(b.command) &&
+         lroundf(a.integral * 10000) == lroundf(b.integral * 10000);
+}
+
+struct Collector {
+  std::vector<TelemetrySample> samples;
+  std::string text;
+};
+
+void collect_sample(const TelemetrySample &s, void *ctx) {
+  ((Collector *)ctx)->samples.push_back(s);
+}
+
+void collect_text(const char *text, size_t len, void *ctx) {
+  ((Collector *)ctx)->text.append(text, len);
+}
+
+std::vector<std::vector<uint8_t>> encode_frames(const std::vector<TelemetrySample> &samples) {
+  std::vector<std::vector<uint8_t>> frames;
+  TelemetryFrameEncoder enc;
+  uint8_t buf[TELEMETRY_FRAME_MAX_ENCODED];
+  for (const TelemetrySample &s : samples) {
+    size_t n = enc.add(s, buf);
+    if (n > 0) frames.emplace_back(buf, buf + n);
+  }
+  size_t n = enc.flush(buf);
+  if (n > 0) frames.emplace_back(buf, buf + n);
+  return frames;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 200000;
+  bool ok = true;
+  std::vector<TelemetrySample> samples = make_samples(count);
+
+  // 1. 往返 (随机分块输入)
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::vector<uint8_t>> frames = encode_frames(samples);
+  double encodeS = seconds_since(t0);
+  std::vector<uint8_t> stream;
+  for (const auto &f : frames) stream.insert(stream.end(), f.begin(), f.end());
+
+  Collector got;
+  TelemetryFrameDecoder dec(collect_sample, collect_text, &got);
+  std::mt19937 rng(1);
+  t0 = std::chrono::steady_clock::now();
+  for (size_t pos = 0; pos < stream.size();) {
+    size_t chunk = std::min(stream.size() - pos, (size_t)(rng() % 700 + 1));
+    dec.feed(stream.data() + pos, chunk);
+    pos += chunk;
+  }
+  dec.finish();
+  double decodeS = seconds_since(t0);
+
+  size_t mismatches = got.samples.size() == samples.size() ? 0 : 1;
+  for (size_t i = 0; i < got.samples.size() && i < samples.size(); i++) {
+    if (!same_quantized(got.samples[i], samples[i])) mismatches++;
+  }
+  printf("round trip: %d samples, %zu frames, %zu decoded, %zu mismatches, %u bad frames\n",
+         count, frames.size(), got.samples.size(), mismatches, dec.badFrames());
+  if (mismatches != 0 || dec.badFrames() != 0) ok = false;
+
+  // 2. 每个样本的字节数
+  uint64_t text4 = 0, text5 = 0;
+  char line[128];
+  for (const TelemetrySample &s : samples) {
+    text4 += (uint64_t)snprintf(line, sizeof(line), "%u\t%.3f\t%.3f\t%.1f\r\n", s.timeMs, s.setpoint, s.measured, s.command);
+    text5 += (uint64_t)snprintf(line, sizeof(line), "%u\t%.3f\t%.3f\t%.1f\t%.4f\r\n", s.timeMs, s.setpoint, s.measured,
+                                s.command, s.integral);
+  }
+  double perSample = (double)stream.size() / count;
+  double ratio = (double)text5 / stream.size();
+  printf("bytes/sample: text(4 fields) %.2f, text(5 fields) %.2f, binary(5 fields) %.2f -> x%.2f\n",
+         (double)text4 / count, (double)text5 / count, perSample, ratio);
+  printf("at 115200 baud: text %.0f samples/s, binary %.0f samples/s\n",
+         11520.0 / ((double)text5 / count), 11520.0 / perSample);
+  if (ratio < 5.0) {
+    printf("FAIL: compression below 5x\n");
+    ok = false;
+  }
+  printf("throughput: encode %.1f Msamples/s, decode %.1f MB/s\n",
+         count / encodeS / 1e6, stream.size() / decodeS / 1e6);
+
+  // 3. 损坏的帧与混杂的文本行 (开头是一段很长的TSV文本，模拟切换格式前的输出)
+  std::vector<uint8_t> noisy;
+  std::string expectedText;
+  for (int k = 0; k < 300; k++) {
+    const TelemetrySample &s = samples[(size_t)k % samples.size()];
+    snprintf(line, sizeof(line), "%u\t%.3f\t%.3f\t%.1f\r\n", s.timeMs, s.setpoint, s.measured, s.command);
+    expectedText += line;
+  }
+  noisy.assign(expectedText.begin(), expectedText.end());
+  std::vector<bool> intact(frames.size(), true);
+  size_t corrupted = 0;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (i % 37 == 5) {
+      std::string t = "[INFO] line " + std::to_string(i) + "\r\n";
+      noisy.insert(noisy.end(), t.begin(), t.end());
+      expectedText += t;
+    }
+    std::vector<uint8_t> f = frames[i];
+    if (rng() % 50 == 0) {
+      // 改写帧内 (分隔符之外) 的一个字节
+      size_t at = 1 + rng() % (f.size() - 2);
+      uint8_t v;
+      do { v = (uint8_t)rng(); } while (v == f[at]);
+      f[at] = v;
+      intact[i] = false;
+      corrupted++;
+    }
+    noisy.insert(noisy.end(), f.begin(), f.end());
+  }
+  Collector got2;
+  TelemetryFrameDecoder dec2(collect_sample, collect_text, &got2);
+  dec2.feed(noisy.data(), noisy.size());
+  dec2.finish();
+
+  // 解出的样本必须是原始样本的有序子序列，且包含全部未损坏帧的样本
+  size_t expectedSamples = 0;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (intact[i]) expectedSamples += std::min<size_t>(TELEMETRY_FRAME_SAMPLES, samples.size() - i * TELEMETRY_FRAME_SAMPLES);
+  }
+  size_t j = 0, wrong = 0;
+  for (const TelemetrySample &s : got2.samples) {
+    while (j < samples.size() && samples[j].timeMs != s.timeMs) j++;
+    if (j == samples.size() || !same_quantized(s, samples[j])) wrong++;
+  }
+  printf("corruption: %zu/%zu frames corrupted, %u bad frames, %zu/%zu samples recovered, %zu wrong, text %s\n",
+         corrupted, frames.size(), dec2.badFrames(), got2.samples.size(), expectedSamples, wrong,
+         got2.text == expectedText ? "intact" : "DAMAGED");
+  if (wrong != 0 || got2.samples.size() != expectedSamples || got2.text != expectedText) ok = false;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/*
+ * bench_udp_command.cpp - UDP遥控指令的回环测试
+ *
+ * **中文注释:**
+ * 一个发送线程通过127.0.0.1向接收套接字发送UDP指令数据报，接收端用
+ * UdpCommandFilter筛选，统计被接受指令的单向延迟分布 (p50/p99/最大值)。
+ * 发送端与接收端在同一台主机上使用同一个时钟，因此 接收时刻 - 发送时刻 就是单向延迟。
+ * 发送过程中按固定规律注入异常，验证过滤器的判定:
+ *   - 重复: 同一个数据报发送两次，第二次应判为乱序
+ *   - 交换: 先发送seq+1再发送seq，后到的seq应判为乱序
+ *   - 过时: 时间戳比实际发送时刻早2*UDP_CMD_MAX_AGE_US，应判为过时
+ * 每四个指令中有一个是车体速度指令 (UDP_CMD_MAGIC_TWIST)，与两轮速度指令共用序号。
+ * 开始前先检查两种指令的编码/解码往返以及错误魔数、错误长度的拒绝。
+ * 任何计数与预期不符或数据报丢失时返回1。
+ *
+ * 用法: ./build/bench_udp_command [数据报数量, 默认5000] [发送周期us, 默认500]
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "udp_command.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point g_epoch = Clock::now();
+
+uint32_t now_us() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - g_epoch).count();
+}
+
+struct Expected {
+  int sent = 0;         // 发送的数据报总数 (含注入的异常)
+  int outOfOrder = 0;
+  int stale = 0;
+};
+
+void send_packet(int fd, const sockaddr_in &to, UdpCommand cmd, uint32_t timestampUs, Expected *exp) {
+  uint8_t buf[UDP_CMD_PACKET_SIZE];
+  cmd.timestampUs = timestampUs;
+  udp_command_encode(cmd, buf);
+  sendto(fd, buf, sizeof(buf), 0, (const sockaddr *)&to, sizeof(to));
+  exp->sent++;
+}
+
+/**
+ * @brief 发送线程: 按周期发送count个指令，并注入重复、交换与过时的数据报。
+ */
+void sender(int fd, sockaddr_in to, int count, int periodUs, Expected *exp) {
+  UdpCommand cmd = {};
+  cmd.session = 0x5a5a;
+  auto next = Clock::now();
+  for (int i = 0; i < count; i++) {
+    next += std::chrono::microseconds(periodUs);
+    std::this_thread::sleep_until(next);
+    cmd.seq = (uint32_t)i + 1;
+    cmd.kind = i % 4 == 1 ? UDP_CMD_TWIST : UDP_CMD_WHEELS;
+    cmd.leftMrad = (int16_t)(i % 2000 - 1000);
+    cmd.rightMrad = (int16_t)(1000 - i % 2000);
+    cmd.linearMmS = (int16_t)(i % 600 - 300);
+    cmd.angularMrad = (int16_t)(2000 - i % 4000);
+
+    if (i % 20 == 7 && i + 1 < count) {
+      UdpCommand later = cmd;
+      later.seq++;
+      send_packet(fd, to, later, now_us(), exp);
+      send_packet(fd, to, cmd, now_us(), exp);
+      exp->outOfOrder++;
+      i++; // 下一个序号已经发送
+    } else if (i % 10 == 3) {
+      uint32_t t = now_us();
+      send_packet(fd, to, cmd, t, exp);
+      send_packet(fd, to, cmd, t, exp);
+      exp->outOfOrder++;
+    } else if (i % 50 == 25) {
+      send_packet(fd, to, cmd, now_us() - 2 * UDP_CMD_MAX_AGE_US, exp);
+      exp->stale++;
+    } else {
+      send_packet(fd, to, cmd, now_us(), exp);
+    }
+  }
+}
+
+/**
+ * @brief 两种指令的编码/解码往返; 错误魔数与错误长度必须被拒绝。
+ */
+bool check_codec() {
+  UdpCommand wheels = {0x1234, 7, 123456, -1500, 2500, UDP_CMD_WHEELS, 0, 0};
+  UdpCommand twist = {0x1234, 8, 123999, 0, 0, UDP_CMD_TWIST, -350, 1800};
+  uint8_t buf[UDP_CMD_PACKET_SIZE];
+  UdpCommand out;
+  bool ok = true;
+
+  udp_command_encode(wheels, buf);
+  ok &= udp_command_decode(buf, sizeof(buf), &out) && out.kind == UDP_CMD_WHEELS && out.seq == 7 &&
+        out.leftMrad == -1500 && out.rightMrad == 2500 && out.linearMmS == 0 && out.angularMrad == 0;
+  udp_command_encode(twist, buf);
+  ok &= udp_command_decode(buf, sizeof(buf), &out) && out.kind == UDP_CMD_TWIST && out.seq == 8 &&
+        out.timestampUs == 123999 && out.linearMmS == -350 && out.angularMrad == 1800 && out.leftMrad == 0 &&
+        out.rightMrad == 0;
+  ok &= !udp_command_decode(buf, sizeof(buf) - 1, &out);
+  buf[0] ^= 0x01;
+  ok &= !udp_command_decode(buf, sizeof(buf), &out);
+  printf("codec: wheels/twist round trip, bad magic and length rejected: %s\n", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+double percentile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty()) return 0.0;
+  size_t idx = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 5000;
+  int periodUs = argc > 2 ? atoi(argv[2]) : 500;
+  if (!check_codec()) return 1;
+
+  int rx = socket(AF_INET, SOCK_DGRAM, 0);
+  int tx = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0; // 由系统分配端口
+  socklen_t addrLen = sizeof(addr);
+  if (rx < 0 || tx < 0 || bind(rx, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+      getsockname(rx, (sockaddr *)&addr, &addrLen) < 0) {
+    perror("socket");
+    return 1;
+  }
+  timeval tv = {0, 200000}; // 发送结束后200毫秒内没有数据报即认为结束
+  setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  Expected exp;
+  std::thread th(sender, tx, addr, count, periodUs, &exp);
+
+  UdpCommandFilter filter;
+  std::vector<double> latencies;
+  latencies.reserve((size_t)count);
+  int received = 0;
+  uint8_t buf[64];
+  for (;;) {
+    ssize_t r = recv(rx, buf, sizeof(buf), 0);
+    if (r < 0) break;
+    uint32_t rxUs = now_us();
+    received++;
+    UdpCommand cmd;
+    if (filter.accept(buf, (size_t)r, rxUs, &cmd) == UDP_CMD_OK) {
+      latencies.push_back((rxUs - cmd.timestampUs) / 1000.0);
+    }
+  }
+  th.join();
+  close(rx);
+  close(tx);
+
+  std::sort(latencies.begin(), latencies.end());
+  printf("udp loopback: sent=%d received=%d accepted=%u out_of_order=%u stale=%u malformed=%u\n",
+         exp.sent, received, filter.accepted(), filter.outOfOrder(), filter.stale(), filter.malformed());
+  printf("one-way latency: p50=%.3f ms p99=%.3f ms max=%.3f ms\n",
+         percentile(latencies, 50), percentile(latencies, 99), latencies.empty() ? 0.0 : latencies.back());
+
+  bool ok = received == exp.sent && (int)filter.outOfOrder() == exp.outOfOrder &&
+            (int)filter.stale() == exp.stale && filter.malformed() == 0 &&
+            (int)filter.accepted() == exp.sent - exp.outOfOrder - exp.stale;
+  if (!ok) {
+    printf("FAIL: expected out_of_order=%d stale=%d accepted=%d\n",
+           exp.outOfOrder, exp.stale, exp.sent - exp.outOfOrder - exp.stale);
+  }
+  return ok ? 0 : 1;
+}
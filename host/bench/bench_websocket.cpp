@@ -0,0 +1,214 @@
+/*
+ * bench_websocket.cpp - WebSocket握手与帧解析 (websocket.cpp) 的验证与解析耗时
+ *
+ * **中文注释:**
+ *   1. 握手: RFC 6455第1.3节的测试向量;
+ *   2. 帧解析: 带掩码的7位与16位长度帧 (整段输入与逐字节输入，消耗的字节数)、
+ *      PING/PONG/CLOSE与零长度帧、一次输入两个帧;
+ *   3. 协议错误: 未加掩码、FIN=0、后续帧、保留位、64位长度、负载超过WS_MAX_PAYLOAD，
+ *      以及http_server.cpp在协议错误时发送的1002关闭帧;
+ *   4. 服务器帧头 (2字节与4字节);
+ *   5. 解析一个遥控指令帧的耗时 (主机)。
+ *
+ * 用法: ./build/bench_websocket
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "bench_check.h"
+#include "websocket.hpp"
+
+namespace {
+
+const uint8_t MASK[4] = {0x37, 0xFA, 0x21, 0x3D};
+
+/**
+ * @brief 生成一个客户端帧 (FIN=1，带掩码)。
+ * @param extended16 使用16位扩展长度 (长度码126)
+ */
+std::vector<uint8_t> client_frame(uint8_t opcode, const uint8_t *payload, size_t len,
+                                  bool extended16 = false) {
+  std::vector<uint8_t> f;
+  f.push_back(0x80 | opcode);
+  if (extended16 || len >= 126) {
+    f.push_back(0x80 | 126);
+    f.push_back((uint8_t)(len >> 8));
+    f.push_back((uint8_t)len);
+  } else {
+    f.push_back(0x80 | (uint8_t)len);
+  }
+  f.insert(f.end(), MASK, MASK + 4);
+  for (size_t i = 0; i < len; i++) f.push_back(payload[i] ^ MASK[i & 3]);
+  return f;
+}
+
+/**
+ * @brief 整段输入一个帧，检查得到完整的帧与相同的负载。
+ */
+bool parses_to(const std::vector<uint8_t> &frame, uint8_t opcode, const uint8_t *payload, size_t len) {
+  WebSocketFrameParser p;
+  size_t used = 0;
+  return p.feed(frame.data(), frame.size(), &used) == WS_FRAME_DONE && used == frame.size() &&
+         p.opcode() == opcode && p.payloadLength() == len &&
+         (len == 0 || memcmp(p.payload(), payload, len) == 0);
+}
+
+/**
+ * @brief 逐字节输入，检查只有最后一个字节完成帧。
+ */
+bool parses_bytewise(const std::vector<uint8_t> &frame, const uint8_t *payload, size_t len) {
+  WebSocketFrameParser p;
+  for (size_t i = 0; i < frame.size(); i++) {
+    WsFrameStatus s = p.feed(&frame[i], 1);
+    if (s != (i + 1 == frame.size() ? WS_FRAME_DONE : WS_FRAME_INCOMPLETE)) return false;
+  }
+  return p.payloadLength() == len && memcmp(p.payload(), payload, len) == 0;
+}
+
+/**
+ * @brief 输入一段字节，检查得到协议错误，并在出错的字节处停止。
+ */
+bool rejected(const std::vector<uint8_t> &bytes, size_t errorAt) {
+  WebSocketFrameParser p;
+  size_t used = 0;
+  return p.feed(bytes.data(), bytes.size(), &used) == WS_FRAME_ERROR && used == errorAt + 1 &&
+         p.status() == WS_FRAME_ERROR;
+}
+
+void test_handshake() {
+  printf("[handshake]\n");
+  char accept[WS_ACCEPT_KEY_LEN + 1];
+  ws_compute_accept_key("dGhlIHNhbXBsZSBub25jZQ==", accept);
+  printf("  accept key: %s\n", accept);
+  check("RFC 6455 accept key", strcmp(accept, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == 0);
+  check("accept key length", strlen(accept) == WS_ACCEPT_KEY_LEN);
+}
+
+void test_frames() {
+  printf("[frames]\n");
+  const uint8_t cmd[] = {0x02, 0x01, 0x2C, 0x01, 0xD4, 0xFE}; // WS_CMD_WHEEL_SPEEDS
+  uint8_t big[WS_MAX_PAYLOAD];
+  for (size_t i = 0; i < sizeof(big); i++) big[i] = (uint8_t)(i * 7 + 1);
+
+  check("binary frame, 7-bit length", parses_to(client_frame(WS_OPCODE_BINARY, cmd, sizeof(cmd)),
+                                                WS_OPCODE_BINARY, cmd, sizeof(cmd)));
+  check("binary frame, 16-bit length",
+        parses_to(client_frame(WS_OPCODE_BINARY, big, sizeof(big), true), WS_OPCODE_BINARY, big, sizeof(big)));
+  check("text frame, WS_MAX_PAYLOAD bytes",
+        parses_to(client_frame(WS_OPCODE_TEXT, big, sizeof(big)), WS_OPCODE_TEXT, big, sizeof(big)));
+  check("byte-by-byte, 7-bit length", parses_bytewise(client_frame(WS_OPCODE_BINARY, cmd, sizeof(cmd)),
+                                                      cmd, sizeof(cmd)));
+  check("byte-by-byte, 16-bit length", parses_bytewise(client_frame(WS_OPCODE_BINARY, big, sizeof(big), true),
+                                                       big, sizeof(big)));
+
+  const uint8_t hello[] = {'h', 'e', 'l', 'l', 'o'};
+  const uint8_t normal[] = {0x03, 0xE8}; // 1000
+  check("ping", parses_to(client_frame(WS_OPCODE_PING, hello, sizeof(hello)), WS_OPCODE_PING, hello, sizeof(hello)));
+  check("pong", parses_to(client_frame(WS_OPCODE_PONG, hello, sizeof(hello)), WS_OPCODE_PONG, hello, sizeof(hello)));
+  check("close with status code",
+        parses_to(client_frame(WS_OPCODE_CLOSE, normal, sizeof(normal)), WS_OPCODE_CLOSE, normal, sizeof(normal)));
+  check("zero-length ping", parses_to(client_frame(WS_OPCODE_PING, nullptr, 0), WS_OPCODE_PING, nullptr, 0));
+  check("zero-length close", parses_to(client_frame(WS_OPCODE_CLOSE, nullptr, 0), WS_OPCODE_CLOSE, nullptr, 0));
+
+  // 同一次读取中的两个帧: 第一次feed()停在第一帧末尾，reset()后剩余的字节构成第二帧
+  std::vector<uint8_t> two = client_frame(WS_OPCODE_PING, hello, sizeof(hello));
+  std::vector<uint8_t> second = client_frame(WS_OPCODE_BINARY, cmd, sizeof(cmd));
+  size_t firstLen = two.size();
+  two.insert(two.end(), second.begin(), second.end());
+  WebSocketFrameParser p;
+  size_t used = 0;
+  bool good = p.feed(two.data(), two.size(), &used) == WS_FRAME_DONE && used == firstLen &&
+              p.opcode() == WS_OPCODE_PING;
+  p.reset();
+  good = good && p.feed(two.data() + used, two.size() - used, &used) == WS_FRAME_DONE &&
+         used == second.size() && p.opcode() == WS_OPCODE_BINARY &&
+         memcmp(p.payload(), cmd, sizeof(cmd)) == 0;
+  check("two frames in one read", good);
+}
+
+void test_errors() {
+  printf("[protocol errors]\n");
+  const uint8_t cmd[] = {0x01, 0x00, 0x08};
+  std::vector<uint8_t> f = client_frame(WS_OPCODE_BINARY, cmd, sizeof(cmd));
+
+  std::vector<uint8_t> unmasked = {0x82, 0x03, 0x01, 0x00, 0x08};
+  check("unmasked frame", rejected(unmasked, 1));
+
+  std::vector<uint8_t> fragment = f;
+  fragment[0] &= 0x7F; // FIN=0
+  check("FIN=0", rejected(fragment, 0));
+  check("continuation frame", rejected(client_frame(WS_OPCODE_CONTINUATION, cmd, sizeof(cmd)), 0));
+
+  std::vector<uint8_t> rsv = f;
+  rsv[0] |= 0x40; // RSV1
+  check("reserved bit set", rejected(rsv, 0));
+
+  std::vector<uint8_t> len64 = {0x82, 0x80 | 127, 0, 0, 0, 0, 0, 0, 0, 3};
+  check("64-bit length", rejected(len64, 1));
+
+  uint8_t big[WS_MAX_PAYLOAD + 1] = {0};
+  // 长度在掩码之后检查: 在第4个掩码字节处出错
+  check("7-bit length over WS_MAX_PAYLOAD", rejected(client_frame(WS_OPCODE_BINARY, big, sizeof(big)), 5));
+  check("16-bit length over WS_MAX_PAYLOAD",
+        rejected(client_frame(WS_OPCODE_BINARY, big, sizeof(big), true), 7));
+
+  // 出错后保持错误状态，直到reset()
+  WebSocketFrameParser p;
+  p.feed(unmasked.data(), unmasked.size());
+  size_t used = 1;
+  bool sticky = p.feed(f.data(), f.size(), &used) == WS_FRAME_ERROR && used == 0;
+  p.reset();
+  check("error is sticky until reset()", sticky && p.feed(f.data(), f.size()) == WS_FRAME_DONE);
+
+  // http_server.cpp在协议错误时发送的关闭帧
+  uint8_t close[WS_CLOSE_FRAME_LEN];
+  size_t n = ws_close_frame(close, WS_CLOSE_PROTOCOL_ERROR);
+  const uint8_t expected[] = {0x88, 0x02, 0x03, 0xEA};
+  check("1002 close frame", n == sizeof(expected) && memcmp(close, expected, n) == 0);
+}
+
+void test_server_header() {
+  printf("[server frame header]\n");
+  uint8_t h[WS_MAX_HEADER_LEN];
+  size_t n = ws_frame_header(h, WS_OPCODE_BINARY, 5);
+  check("2-byte header", n == 2 && h[0] == 0x82 && h[1] == 5);
+  n = ws_frame_header(h, WS_OPCODE_PONG, 125);
+  check("2-byte header, 125 bytes", n == 2 && h[0] == 0x8A && h[1] == 125);
+  n = ws_frame_header(h, WS_OPCODE_TEXT, 126);
+  check("4-byte header, 126 bytes", n == 4 && h[0] == 0x81 && h[1] == 126 && h[2] == 0 && h[3] == 126);
+  n = ws_frame_header(h, WS_OPCODE_TEXT, 65535);
+  check("4-byte header, 65535 bytes", n == 4 && h[1] == 126 && h[2] == 0xFF && h[3] == 0xFF);
+}
+
+void bench_parse() {
+  printf("[parse time]\n");
+  const uint8_t cmd[] = {0x02, 0x01, 0x2C, 0x01, 0xD4, 0xFE};
+  std::vector<uint8_t> f = client_frame(WS_OPCODE_BINARY, cmd, sizeof(cmd));
+  const int N = 1000000;
+  WebSocketFrameParser p;
+  unsigned sum = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; i++) {
+    p.reset();
+    p.feed(f.data(), f.size());
+    sum += p.payload()[i % sizeof(cmd)];
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+  printf("  %zu-byte command frame: %.1f ns/frame (checksum %u)\n", f.size(), ns, sum);
+}
+
+} // namespace
+
+int main() {
+  test_handshake();
+  test_frames();
+  test_errors();
+  test_server_header();
+  bench_parse();
+  return checks_summary();
+}
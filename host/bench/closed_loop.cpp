@@ -0,0 +1,65 @@
+/*
+ * closed_loop.cpp - 草图速度环的离线闭环仿真
+ */
+
+#include "closed_loop.h"
+
+#include <math.h>
+
+#include "setpoint_profile.h"
+
+namespace {
+
+void collect(const StepMetrics &m, void *ctx) {
+  ((std::vector<StepMetrics> *)ctx)->push_back(m);
+}
+
+} // namespace
+
+std::vector<StepMetrics> run_closed_loop(const ClosedLoopConfig &cfg) {
+  StepResponseAnalyzer::Config acfg;
+  acfg.bandPct = 5.0f;
+  acfg.bandAbs = cfg.quantized ? (float)m_method_resolution(cfg.dt) : 0.0f;
+  std::vector<StepMetrics> steps;
+  StepResponseAnalyzer analyzer(acfg, collect, &steps);
+
+  const float setpoints[] = {0.0f, 2.5f, -2.5f, 0.0f};
+  double omega = 0.0, theta = 0.0, decay = exp(-cfg.dt / LOOP_TAU_S);
+  long lastCount = 0;
+  float integral = 0.0f, lastTarget = 0.0f;
+  int cycles = (int)lround(20.0 / cfg.dt);
+  for (int k = 1; k <= cycles; k++) {
+    double t = k * cfg.dt;
+    int index = (int)(t / 5.0 + 1e-9);
+    float target = setpoints[index < 3 ? index : 3];
+    if (cfg.reset == IntegralReset::OnSetpointChange && target != lastTarget) integral = 0.0f;
+    lastTarget = target;
+
+    float measured;
+    if (cfg.quantized) {
+      long count = (long)floor(theta * LOOP_EDGES_PER_REV / (2.0 * M_PI));
+      measured = (float)((count - lastCount) * m_method_resolution(cfg.dt));
+      lastCount = count;
+    } else {
+      measured = (float)omega;
+    }
+
+    // 与草图的piController()相同
+    float reference = cfg.profile ? cfg.profile->update(target, (float)cfg.dt) : target;
+    float error = reference - measured;
+    integral += error * (float)cfg.dt;
+    if (integral > cfg.integralMax) integral = cfg.integralMax;
+    if (integral < -cfg.integralMax) integral = -cfg.integralMax;
+    if (cfg.reset == IntegralReset::AtZeroReference && reference == 0.0f) integral = 0.0f;
+    float u = cfg.kp * error + cfg.ki * integral;
+    analyzer.add((uint32_t)lround(t * 1000.0), target, measured, u);
+
+    // 被控对象: 一个周期内输入不变 (PWM限幅)
+    float applied = u > LOOP_PWM_FULL ? LOOP_PWM_FULL : (u < -LOOP_PWM_FULL ? -LOOP_PWM_FULL : u);
+    double final = LOOP_GAIN * applied / LOOP_PWM_FULL;
+    theta += final * cfg.dt + (omega - final) * LOOP_TAU_S * (1.0 - decay);
+    omega = final + (omega - final) * decay;
+  }
+  analyzer.finish();
+  return steps;
+}
@@ -0,0 +1,59 @@
+/*
+ * closed_loop.h - 草图速度环的离线闭环仿真 (bench_setpoint_profile与bench_pi_design共用)
+ *
+ * **中文注释:**
+ * 与仿真内核的默认被控对象相同的一阶模型 (TAU 30.2 ms，G 50.01，零阶保持精确离散化，一个周期内输入不变)，
+ * 设定点序列 0 -> 2.5 -> -2.5 -> 0 rad/s (每段5秒，与BF.ino相同)，运行20秒:
+ *   - 测量值: 真实速度，或BF.ino的M法 (每周期编码器计数增量 / 周期，含量化与半个周期的滞后);
+ *   - 参考值: 设定点阶跃本身，或经过JerkLimitedProfile;
+ *   - PI与草图的piController()相同: 积分、限幅，以及草图各自的积分清零方式
+ *     (Remote.ino: 参考值为0时; BF.ino在SETPOINT_PROFILE为0时: 设定点变化时);
+ *   - 控制量按±PWM满量程限幅后作用到被控对象。
+ * 每个阶跃由StepResponseAnalyzer (按设定点) 计算指标。
+ */
+
+#ifndef CLOSED_LOOP_H_
+#define CLOSED_LOOP_H_
+
+#include <vector>
+
+#include "step_response.h"
+
+class JerkLimitedProfile;
+
+constexpr double LOOP_TAU_S = 30.20e-3;            // 被控对象时间常数
+constexpr double LOOP_GAIN = 50.01;                // 被控对象静态增益
+constexpr double LOOP_EDGES_PER_REV = 11 * 30 * 4; // 编码器每转边沿数
+constexpr float LOOP_PWM_FULL = 32767.0f;          // PWM满量程
+
+/**
+ * @brief 积分项的清零方式 (与各草图的piController()调用者一致)
+ */
+enum class IntegralReset {
+  None,             // 不清零
+  AtZeroReference,  // 参考值为0时清零 (Remote.ino)
+  OnSetpointChange  // 设定点变化时清零 (BF.ino，SETPOINT_PROFILE为0时)
+};
+
+struct ClosedLoopConfig {
+  double dt;                    // 控制周期 (秒)
+  bool quantized;               // M法测速 (BF.ino)，否则为真实速度
+  float kp, ki, integralMax;    // PI参数 (并联形式，控制量为PWM计数)
+  IntegralReset reset;
+  JerkLimitedProfile *profile;  // 参考值轨迹，nullptr表示直接阶跃
+};
+
+/**
+ * @brief 运行20秒的阶跃序列。
+ * @return 每个阶跃的指标 (误差带5%，M法时下限为一个计数对应的速度)
+ */
+std::vector<StepMetrics> run_closed_loop(const ClosedLoopConfig &cfg);
+
+/**
+ * @brief M法测速时一个编码器计数对应的速度 (rad/s)
+ */
+inline double m_method_resolution(double dt) {
+  return 2.0 * 3.14159265358979323846 / LOOP_EDGES_PER_REV / dt;
+}
+
+#endif /* CLOSED_LOOP_H_ */
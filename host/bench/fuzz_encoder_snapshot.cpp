@@ -0,0 +1,259 @@
+/*
+ * fuzz_encoder_snapshot.cpp - ESP32Encoder一致快照读取的交错模糊测试
+ *
+ * **中文注释:**
+ * ESP32Encoder.cpp在编译时把ESP32_ENCODER_READ_HOOK()定义为fuzz_read_hook()，
+ * 读取路径的每一步之后都会回调到这里。测试用一个假的PCNT单元代替硬件，
+ * 让硬件计数器在第k个钩子处到达极限 (回零并锁存中断)，在第j(>=k)个钩子处
+ * 执行溢出中断，遍历所有(k, j)组合以及"读取结束后才执行中断"的情况。
+ * 中断有两种执行方式:
+ *   - 整体执行 (读者与中断在同一个核心上，中断不会被读者打断);
+ *   - 拆开执行 (中断在另一个核心上，按pcnt_example_intr_handler的写入顺序
+ *     逐步执行: generation加1并清除中断、累加count、累加count32、generation加1)。
+ * 每次读取的结果必须等于溢出前或溢出后的真实位置，getCountDelta()的结果必须为0或±1。
+ * 作为对比，同样统计原实现 getCountRaw() + count 在两次读取之间发生溢出时的错误次数。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ESP32Encoder.h"
+#include "soc/pcnt_struct.h"
+
+//- 假的PCNT单元 ----------------------------
+
+volatile pcnt_dev_t PCNT;
+
+namespace {
+
+// 计数值保存在PCNT.cnt_unit[0]中，驱动函数与直接读寄存器看到同一个值
+struct FakeUnit {
+  int16_t h_lim;
+  int16_t l_lim;
+};
+
+FakeUnit g_unit = {0, 0};
+void (*g_isr)(void *) = nullptr;
+
+int16_t get_counter() { return (int16_t)PCNT.cnt_unit[0].cnt_val; }
+void set_counter(int16_t v) { PCNT.cnt_unit[0].cnt_val = (uint16_t)v; }
+
+} // namespace
+
+esp_err_t pcnt_unit_config(const pcnt_config_t *cfg) {
+  g_unit.h_lim = cfg->counter_h_lim;
+  g_unit.l_lim = cfg->counter_l_lim;
+  return ESP_OK;
+}
+esp_err_t pcnt_get_counter_value(pcnt_unit_t, int16_t *count) { *count = get_counter(); return ESP_OK; }
+esp_err_t pcnt_counter_pause(pcnt_unit_t) { return ESP_OK; }
+esp_err_t pcnt_counter_resume(pcnt_unit_t) { return ESP_OK; }
+esp_err_t pcnt_counter_clear(pcnt_unit_t) { set_counter(0); return ESP_OK; }
+esp_err_t pcnt_intr_enable(pcnt_unit_t) { return ESP_OK; }
+esp_err_t pcnt_intr_disable(pcnt_unit_t) { return ESP_OK; }
+esp_err_t pcnt_event_enable(pcnt_unit_t, pcnt_evt_type_t) { return ESP_OK; }
+esp_err_t pcnt_event_disable(pcnt_unit_t, pcnt_evt_type_t) { return ESP_OK; }
+esp_err_t pcnt_set_filter_value(pcnt_unit_t, uint16_t) { return ESP_OK; }
+esp_err_t pcnt_filter_enable(pcnt_unit_t) { return ESP_OK; }
+esp_err_t pcnt_filter_disable(pcnt_unit_t) { return ESP_OK; }
+esp_err_t pcnt_isr_register(void (*fn)(void *), void *, int, pcnt_isr_handle_t *handle) {
+  g_isr = fn;
+  if (handle != nullptr) *handle = (pcnt_isr_handle_t)fn;
+  return ESP_OK;
+}
+
+namespace {
+
+const int MAX_HOOK = 24;        // 遍历的注入位置 (每次读取尝试有5个钩子)
+const int ISR_AFTER_READ = -1;  // 中断在读取结束后才执行
+const long LIVELOCK_HOOKS = 10000;
+
+ESP32Encoder g_encoder;
+const int UNIT = 0;
+
+// 当前场景
+int g_dir;           // +1: 上溢, -1: 下溢
+int g_wrap_hook;     // 在第几个钩子处硬件计数器到达极限
+int g_isr_hook;      // 在第几个钩子处开始执行中断 (ISR_AFTER_READ表示读取之后)
+bool g_split_isr;    // 中断是否拆成4步执行
+bool g_armed;        // 为false时钩子不注入 (准备与收尾阶段)
+bool g_wrapped;      // 硬件计数器是否已经到达极限
+long g_hook;         // 本次读取已经过的钩子数
+int g_isr_phase;     // 拆开执行时已完成的步数 (0..4)
+int32_t g_isr_limit; // 拆开执行时中断读到的极限值
+
+void hw_wrap() {
+  g_wrapped = true;
+  set_counter(0); // 到达极限后硬件计数器立即回零，并锁存状态
+  if (g_dir > 0) {
+    PCNT.status_unit[UNIT].h_lim_lat = 1;
+  } else {
+    PCNT.status_unit[UNIT].l_lim_lat = 1;
+  }
+  PCNT.int_st.val = PCNT.int_st.val | BIT(UNIT);
+}
+
+void clear_interrupt() {
+  PCNT.int_st.val = PCNT.int_st.val & ~(uint32_t)BIT(UNIT);
+  PCNT.status_unit[UNIT].h_lim_lat = 0;
+  PCNT.status_unit[UNIT].l_lim_lat = 0;
+}
+
+/**
+ * @brief 整体执行真正的中断处理函数。
+ */
+void run_isr() {
+  PCNT.int_clr.val = 0;
+  g_isr(nullptr);
+  if (PCNT.int_clr.val & BIT(UNIT)) clear_interrupt();
+}
+
+/**
+ * @brief 按pcnt_example_intr_handler的写入顺序执行一步 (模拟另一个核心上的中断)。
+ */
+void isr_step() {
+  switch (g_isr_phase++) {
+    case 0:
+      g_encoder.generation++;
+      g_isr_limit = PCNT.status_unit[UNIT].h_lim_lat ? g_unit.h_lim : g_unit.l_lim;
+      clear_interrupt();
+      break;
+    case 1:
+      g_encoder.count = g_isr_limit + g_encoder.count;
+      break;
+    case 2:
+      g_encoder.count32 = g_isr_limit + g_encoder.count32;
+      break;
+    case 3:
+      g_encoder.generation++;
+      break;
+  }
+}
+
+bool isr_pending() {
+  if (!g_wrapped) return false;
+  return g_split_isr ? g_isr_phase < 4 : (PCNT.int_st.val & BIT(UNIT)) != 0;
+}
+
+void advance_isr() {
+  if (g_split_isr) isr_step();
+  else run_isr();
+}
+
+} // namespace
+
+void fuzz_read_hook() {
+  if (!g_armed) return;
+  long h = g_hook++;
+  if (h > LIVELOCK_HOOKS) {
+    printf("FAIL: read did not terminate (dir=%d wrap=%d isr=%d split=%d)\n",
+           g_dir, g_wrap_hook, g_isr_hook, g_split_isr);
+    exit(1);
+  }
+  if (h == g_wrap_hook) hw_wrap();
+  if (g_isr_hook != ISR_AFTER_READ && h >= g_isr_hook && isr_pending()) advance_isr();
+}
+
+namespace {
+
+/**
+ * @brief 准备场景: 真实位置为base + dir*(lim-1)，再走一步就溢出。
+ * @return 溢出前的真实位置。
+ */
+int64_t setup_scenario(int64_t base) {
+  g_armed = false;
+  g_wrapped = false;
+  clear_interrupt();
+  g_encoder.setCount(base);
+  int16_t lim = g_dir > 0 ? g_unit.h_lim : g_unit.l_lim;
+  set_counter((int16_t)(lim - g_dir));
+  int64_t before = g_encoder.getCount();
+  g_encoder.getCountDelta(); // 以当前位置为增量基准
+  g_isr_phase = 0;
+  g_hook = 0;
+  g_armed = true;
+  return before;
+}
+
+/**
+ * @brief 读取结束后: 尚未发生的溢出与中断补齐执行。
+ */
+void finish_scenario() {
+  g_armed = false;
+  if (!g_wrapped) hw_wrap();
+  while (isr_pending()) advance_isr();
+}
+
+long g_checks = 0;
+long g_failures = 0;
+
+void check(bool ok, const char *what, int64_t got) {
+  g_checks++;
+  if (!ok) {
+    g_failures++;
+    if (g_failures <= 10) {
+      printf("FAIL %s: dir=%+d wrap=%d isr=%d split=%d got=%lld\n",
+             what, g_dir, g_wrap_hook, g_isr_hook, g_split_isr, (long long)got);
+    }
+  }
+}
+
+} // namespace
+
+int main() {
+  g_encoder.attachFullQuad(14, 27);
+  const int64_t bases[] = {0, 5000000000LL, -5000000000LL, 0x7fff0000LL}; // 覆盖count32回绕
+
+  long legacy_checks = 0, legacy_errors = 0;
+  for (int64_t base : bases) {
+    for (g_dir = -1; g_dir <= 1; g_dir += 2) {
+      for (int split = 0; split <= 1; split++) {
+        g_split_isr = split != 0;
+        for (g_wrap_hook = 0; g_wrap_hook < MAX_HOOK; g_wrap_hook++) {
+          for (g_isr_hook = ISR_AFTER_READ; g_isr_hook < MAX_HOOK + 4; g_isr_hook++) {
+            if (g_isr_hook != ISR_AFTER_READ && g_isr_hook < g_wrap_hook) continue;
+
+            // 64位一致快照
+            int64_t before = setup_scenario(base);
+            int64_t after = before + g_dir;
+            int64_t got = g_encoder.getCount();
+            finish_scenario();
+            check(got == before || got == after, "getCount", got);
+            check(g_encoder.getCount() == after, "getCount after isr", g_encoder.getCount());
+
+            // 32位增量
+            setup_scenario(base);
+            int32_t delta = g_encoder.getCountDelta();
+            finish_scenario();
+            check(delta == 0 || delta == g_dir, "getCountDelta", delta);
+            int32_t rest = g_encoder.getCountDelta();
+            check(delta + rest == g_dir, "getCountDelta total", delta + rest);
+          }
+        }
+
+        // 原实现 getCountRaw() + count 的两个出错窗口:
+        //   0: 溢出与中断都发生在读硬件计数器与读软件计数器之间 (中断整体执行);
+        //   1: 硬件计数器已回零，中断尚未执行 (中断延迟)
+        for (int window = 0; window <= 1 && !g_split_isr; window++) {
+          int64_t before = setup_scenario(base);
+          g_armed = false;
+          if (window == 1) hw_wrap();
+          int64_t raw = get_counter();
+          if (window == 0) {
+            hw_wrap();
+            run_isr();
+          }
+          int64_t legacy = raw + g_encoder.count;
+          finish_scenario();
+          legacy_checks++;
+          if (legacy != before && legacy != before + g_dir) legacy_errors++;
+        }
+      }
+    }
+  }
+
+  printf("encoder snapshot: %ld interleavings checked, %ld failures\n", g_checks, g_failures);
+  printf("legacy getCountRaw()+count: %ld/%ld interleavings torn (off by the 16-bit limit)\n",
+         legacy_errors, legacy_checks);
+  return g_failures == 0 ? 0 : 1;
+}
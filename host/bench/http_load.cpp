@@ -0,0 +1,284 @@
+/*
+ * http_load.cpp - 命令服务器的并发负载生成器
+ *
+ * **中文注释:**
+ * 多个线程并发地向草图中的HTTP服务器发送指令请求 (每个请求一个新的TCP连接，
+ * 与手机浏览器点击按钮的方式相同)，统计吞吐量(请求/秒)和延迟分布(p50/p99/最大值)。
+ * 可以额外打开若干个"停滞"连接: 只建立连接而不发送任何数据，用于验证
+ * 一个停滞的手机不会阻塞其他客户端。
+ * --ws模式下每个线程只建立一个WebSocket连接，按--interval的周期发送轮速指令帧
+ * (默认17毫秒，接近网页摇杆的节流周期，且不是WiFi任务轮询周期的整数倍，
+ * 避免发送时刻与轮询同相)，统计从发送指令到收到服务器应答(WS_CMD_ACK)的往返延迟。
+ *
+ * 用法 (先在另一个终端运行 ./build/Remote_sim --realtime --quiet --duration 60):
+ *   ./build/http_load [--port 8080] [--clients 8] [--requests 200] [--stalled 2] [--path /26/on]
+ *   ./build/http_load --ws [--clients 2] [--requests 500] [--interval 17]
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int g_port = 8080;
+int g_clients = 8;
+int g_requests = 200;
+int g_stalled = 2;
+const char *g_path = "/26/on";
+bool g_ws = false;
+int g_interval_ms = 17;
+
+std::mutex g_mutex;
+std::vector<double> g_latencies_ms;
+std::atomic<int> g_errors(0);
+std::atomic<bool> g_done(false);
+
+int connect_server() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  timeval tv = {5, 0}; // 单个请求最多等待5秒
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((uint16_t)g_port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * @brief 发送一个完整请求并读取响应直到服务器关闭连接。
+ * @return 成功返回true。
+ */
+bool one_request() {
+  int fd = connect_server();
+  if (fd < 0) return false;
+
+  char req[256];
+  int len = snprintf(req, sizeof(req),
+                     "GET %s HTTP/1.1\r\nHost: 192.168.4.1\r\nUser-Agent: http_load\r\n"
+                     "Accept: text/html\r\n\r\n", g_path);
+  bool ok = send(fd, req, (size_t)len, MSG_NOSIGNAL) == len;
+
+  // 服务器发送完页面后关闭连接，读到EOF即为一个完整响应
+  char buf[1024];
+  char status[16] = {0};
+  size_t total = 0;
+  while (ok) {
+    ssize_t r = recv(fd, buf, sizeof(buf), 0);
+    if (r > 0) {
+      if (total < sizeof(status) - 1) {
+        size_t n = std::min((size_t)r, sizeof(status) - 1 - total);
+        memcpy(status + total, buf, n);
+      }
+      total += (size_t)r;
+    } else {
+      ok = (r == 0) && strncmp(status, "HTTP/1.1 200", 12) == 0;
+      break;
+    }
+  }
+  close(fd);
+  return ok;
+}
+
+/**
+ * @brief 读取恰好len个字节。
+ */
+bool recv_all(int fd, uint8_t *buf, size_t len) {
+  size_t got = 0;
+  while (got < len) {
+    ssize_t r = recv(fd, buf + got, len - got, 0);
+    if (r <= 0) return false;
+    got += (size_t)r;
+  }
+  return true;
+}
+
+/**
+ * @brief 建立WebSocket连接 (读取101应答直到空行)。
+ */
+int ws_connect() {
+  int fd = connect_server();
+  if (fd < 0) return -1;
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  const char req[] =
+    "GET /ws HTTP/1.1\r\nHost: 192.168.4.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+  if (send(fd, req, sizeof(req) - 1, MSG_NOSIGNAL) != (ssize_t)(sizeof(req) - 1)) {
+    close(fd);
+    return -1;
+  }
+
+  // 逐字节读取应答头，避免把之后的帧读进来
+  char head[512];
+  size_t len = 0;
+  while (len < sizeof(head) - 1) {
+    if (recv(fd, head + len, 1, 0) != 1) break;
+    len++;
+    head[len] = '\0';
+    if (len >= 4 && strcmp(head + len - 4, "\r\n\r\n") == 0) break;
+  }
+  if (strncmp(head, "HTTP/1.1 101", 12) != 0 ||
+      strstr(head, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == nullptr) { // RFC 6455示例密钥的应答
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * @brief WebSocket客户端: 发送轮速指令并等待应答，统计往返延迟。
+ */
+void ws_client_thread() {
+  std::vector<double> local;
+  local.reserve((size_t)g_requests);
+  int fd = ws_connect();
+  if (fd < 0) {
+    g_errors += g_requests;
+    return;
+  }
+
+  auto next = Clock::now();
+  for (int i = 0; i < g_requests; i++) {
+    next += std::chrono::milliseconds(g_interval_ms);
+    std::this_thread::sleep_until(next);
+    uint8_t seq = (uint8_t)i;
+    int16_t speed = (int16_t)((i % 50) * 40 - 1000); // 模拟连续变化的摇杆
+    uint8_t payload[6] = {0x02, seq, (uint8_t)speed, (uint8_t)(speed >> 8),
+                          (uint8_t)speed, (uint8_t)(speed >> 8)};
+    uint8_t mask[4] = {0x12, 0x34, 0x56, (uint8_t)i};
+    uint8_t frame[2 + 4 + sizeof(payload)];
+    frame[0] = 0x82;                          // FIN + 二进制帧
+    frame[1] = 0x80 | sizeof(payload);        // 客户端帧必须带掩码
+    memcpy(frame + 2, mask, 4);
+    for (size_t k = 0; k < sizeof(payload); k++) frame[6 + k] = payload[k] ^ mask[k & 3];
+
+    auto t0 = Clock::now();
+    if (send(fd, frame, sizeof(frame), MSG_NOSIGNAL) != (ssize_t)sizeof(frame)) {
+      g_errors++;
+      break;
+    }
+    uint8_t ack[4];
+    if (!recv_all(fd, ack, sizeof(ack)) || ack[0] != 0x82 || ack[1] != 2 || ack[2] != 0x80 || ack[3] != seq) {
+      g_errors++;
+      break;
+    }
+    local.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+  }
+
+  // 正常关闭 (状态码1000)
+  uint8_t bye[8] = {0x88, 0x82, 0, 0, 0, 0, 0x03, 0xE8};
+  send(fd, bye, sizeof(bye), MSG_NOSIGNAL);
+  close(fd);
+
+  std::lock_guard<std::mutex> lk(g_mutex);
+  g_latencies_ms.insert(g_latencies_ms.end(), local.begin(), local.end());
+}
+
+void client_thread() {
+  std::vector<double> local;
+  local.reserve((size_t)g_requests);
+  for (int i = 0; i < g_requests; i++) {
+    auto t0 = Clock::now();
+    if (one_request()) {
+      local.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    } else {
+      g_errors++;
+    }
+  }
+  std::lock_guard<std::mutex> lk(g_mutex);
+  g_latencies_ms.insert(g_latencies_ms.end(), local.begin(), local.end());
+}
+
+/**
+ * @brief 停滞客户端: 建立连接后不发送数据，被服务器关闭后重新连接。
+ */
+void stalled_thread() {
+  while (!g_done) {
+    int fd = connect_server();
+    if (fd < 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      continue;
+    }
+    char c;
+    while (!g_done && recv(fd, &c, 1, 0) < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      // 接收超时: 连接仍被服务器保持，继续等待
+    }
+    close(fd);
+  }
+}
+
+double percentile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty()) return 0.0;
+  size_t idx = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+bool parse_args(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--port") == 0 && has_value) g_port = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--clients") == 0 && has_value) g_clients = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--requests") == 0 && has_value) g_requests = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--stalled") == 0 && has_value) g_stalled = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--path") == 0 && has_value) g_path = argv[++i];
+    else if (strcmp(argv[i], "--ws") == 0) g_ws = true;
+    else if (strcmp(argv[i], "--interval") == 0 && has_value) g_interval_ms = atoi(argv[++i]);
+    else return false;
+  }
+  return g_clients > 0 && g_requests > 0 && g_stalled >= 0 && g_interval_ms >= 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (!parse_args(argc, argv)) {
+    fprintf(stderr, "usage: %s [--port 8080] [--clients 8] [--requests 200] [--stalled 2] [--path /26/on]\n"
+            "       [--ws] [--interval ms]\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<std::thread> stalled;
+  for (int i = 0; i < g_stalled; i++) stalled.emplace_back(stalled_thread);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100)); // 让停滞连接先占用服务器槽位
+
+  auto start = Clock::now();
+  std::vector<std::thread> clients;
+  for (int i = 0; i < g_clients; i++) clients.emplace_back(g_ws ? ws_client_thread : client_thread);
+  for (auto &t : clients) t.join();
+  double elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+  g_done = true;
+  for (auto &t : stalled) t.join();
+
+  std::sort(g_latencies_ms.begin(), g_latencies_ms.end());
+  printf("%s clients=%d stalled=%d requests=%zu errors=%d elapsed=%.2f s\n",
+         g_ws ? "websocket" : "http", g_clients, g_stalled, g_latencies_ms.size(), g_errors.load(), elapsed_s);
+  printf("throughput: %.1f requests/s\n", g_latencies_ms.size() / elapsed_s);
+  printf("latency: p50=%.2f ms p99=%.2f ms max=%.2f ms\n",
+         percentile(g_latencies_ms, 50), percentile(g_latencies_ms, 99),
+         g_latencies_ms.empty() ? 0.0 : g_latencies_ms.back());
+  return g_errors > 0 ? 1 : 0;
+}
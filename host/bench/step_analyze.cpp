@@ -0,0 +1,210 @@
+/*
+ * step_analyze.cpp - 阶跃响应指标汇总工具
+ *
+ * **中文注释:**
+ * 代替BF_CHEN_Haiwei_ZHANG_Haochen/plot_*_controller.py中手工选取时间段的分析:
+ * 单次遍历任意长的遥测记录，检测每一次设定点阶跃 (StepResponseAnalyzer)，
+ * 输出每个阶跃的上升时间、超调量、调节时间、稳态误差、纹波与控制量，
+ * 最后按 (起始设定点 -> 目标值) 分组汇总 (次数、平均值与最差值)。
+ * 输入格式自动识别:
+ *   - BF.ino的二进制遥测帧 (含0x00分隔符，见telemetry_frame.h);
+ *   - TSV文本 (BF.ino的文本输出、旧日志) 或telemetry_decode输出的CSV，
+ *     每行前4列为 时间(ms)、设定点、测量值、控制信号，不是数字的行跳过。
+ *
+ * 用法:
+ *   ./build/BF_sim --duration 25 | ./build/step_analyze
+ *   ./build/step_analyze [--band 5] [--band-abs 0.05] [--min-step 0.01] [--window 1000]
+ *                        [--groups-only | --csv] [input|-]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <utility>
+
+#include "step_response.h"
+#include "telemetry_frame.h"
+
+namespace {
+
+struct Group {
+  uint32_t count = 0;
+  uint32_t unsettled = 0;
+  uint32_t risen = 0;
+  double riseSum = 0.0, overshootSum = 0.0, settleSum = 0.0, errorSum = 0.0, rippleSum = 0.0, uRmsSum = 0.0;
+  float riseMax = 0.0f, overshootMax = 0.0f, settleMax = 0.0f, errorMax = 0.0f, uPeakMax = 0.0f;
+};
+
+struct Report {
+  bool printSteps = true;
+  bool csv = false;
+  std::map<std::pair<long, long>, Group> groups;  // 键: 设定点 × 1000
+  uint64_t samples = 0;
+};
+
+void print_header(const Report &r) {
+  if (r.csv) {
+    printf("step,start_s,from,to,y0,rise_ms,overshoot_pct,settle_ms,steady_error,ripple,u_rms,u_peak,iae,samples\n");
+  } else {
+    printf("%5s %9s %7s    %-7s %9s %9s %10s %8s %7s %8s %8s %7s\n", "step", "t(s)", "from", "to", "rise(ms)",
+           "overshoot", "settle(ms)", "sse", "ripple", "u_rms", "u_peak", "IAE");
+  }
+}
+
+void on_step(const StepMetrics &m, void *ctx) {
+  Report *r = (Report *)ctx;
+  if (r->csv) {
+    printf("%u,%.3f,%.3f,%.3f,%.3f,%.1f,%.2f,%.1f,%.4f,%.4f,%.1f,%.1f,%.4f,%u\n", m.index, m.startMs * 1e-3, m.from,
+           m.to, m.y0, m.riseMs, m.overshootPct, m.settleMs, m.steadyError, m.ripple, m.uRms, m.uPeak, m.iae,
+           m.samples);
+  } else if (r->printSteps) {
+    printf("%5u %9.3f %7.3f -> %-7.3f %9.1f %8.1f%% %10.1f %8.4f %7.4f %8.1f %8.1f %7.4f\n", m.index, m.startMs * 1e-3,
+           m.from, m.to, m.riseMs, m.overshootPct, m.settleMs, m.steadyError, m.ripple, m.uRms, m.uPeak, m.iae);
+  }
+
+  Group &g = r->groups[std::make_pair(lroundf(m.from * 1000), lroundf(m.to * 1000))];
+  g.count++;
+  if (!isnan(m.riseMs)) {
+    g.risen++;
+    g.riseSum += m.riseMs;
+    g.riseMax = fmaxf(g.riseMax, m.riseMs);
+  }
+  if (isnan(m.settleMs)) {
+    g.unsettled++;
+  } else {
+    g.settleSum += m.settleMs;
+    g.settleMax = fmaxf(g.settleMax, m.settleMs);
+  }
+  g.overshootSum += m.overshootPct;
+  g.overshootMax = fmaxf(g.overshootMax, m.overshootPct);
+  g.errorSum += m.steadyError;
+  g.errorMax = fmaxf(g.errorMax, fabsf(m.steadyError));
+  g.rippleSum += m.ripple;
+  g.uRmsSum += m.uRms;
+  g.uPeakMax = fmaxf(g.uPeakMax, m.uPeak);
+}
+
+void print_groups(const Report &r) {
+  printf("\n%7s    %-7s %5s %17s %15s %19s %17s %7s %8s %8s\n", "from", "to", "n", "rise(ms) mean/max",
+         "overshoot(%) m/M", "settle(ms) mean/max", "sse mean/|max|", "ripple", "u_rms", "u_peak");
+  for (const auto &kv : r.groups) {
+    const Group &g = kv.second;
+    uint32_t settled = g.count - g.unsettled;
+    char unsettled[32] = "";
+    if (g.unsettled > 0) snprintf(unsettled, sizeof(unsettled), "  (%u unsettled)", g.unsettled);
+    printf("%7.3f -> %-7.3f %5u %8.1f/%-8.1f %7.1f/%-7.1f %9.1f/%-9.1f %8.4f/%-8.4f %7.4f %8.1f %8.1f%s\n",
+           kv.first.first / 1000.0, kv.first.second / 1000.0, g.count, g.risen > 0 ? g.riseSum / g.risen : NAN,
+           g.risen > 0 ? g.riseMax : NAN, g.overshootSum / g.count, g.overshootMax,
+           settled > 0 ? g.settleSum / settled : NAN, settled > 0 ? g.settleMax : NAN, g.errorSum / g.count,
+           g.errorMax, g.rippleSum / g.count, g.uRmsSum / g.count, g.uPeakMax, unsettled);
+  }
+}
+
+void frame_sample(const TelemetrySample &s, void *ctx) {
+  StepResponseAnalyzer *a = (StepResponseAnalyzer *)ctx;
+  a->add(s.timeMs, s.setpoint, s.measured, s.command);
+}
+
+/**
+ * @brief 解析一行文本中的前4个数 (制表符、逗号或空格分隔)。
+ */
+bool parse_line(const char *line, double v[4]) {
+  const char *p = line;
+  for (int i = 0; i < 4; i++) {
+    while (*p == ' ' || *p == '\t' || *p == ',' || *p == ';') p++;
+    char *end;
+    v[i] = strtod(p, &end);
+    if (end == p) return false;
+    p = end;
+  }
+  return true;
+}
+
+bool analyze_line(char *line, size_t len, StepResponseAnalyzer *analyzer) {
+  line[len] = '\0';
+  double v[4];
+  if (!parse_line(line, v)) return false;
+  analyzer->add((uint32_t)v[0], (float)v[1], (float)v[2], (float)v[3]);
+  return true;
+}
+
+void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [--band PCT] [--band-abs V] [--min-step V] [--window MS] [--groups-only | --csv] [input|-]\n",
+          prog);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  StepResponseAnalyzer::Config config;
+  Report report;
+  const char *path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--band") == 0 && i + 1 < argc) config.bandPct = strtof(argv[++i], nullptr);
+    else if (strcmp(argv[i], "--band-abs") == 0 && i + 1 < argc) config.bandAbs = strtof(argv[++i], nullptr);
+    else if (strcmp(argv[i], "--min-step") == 0 && i + 1 < argc) config.minStep = strtof(argv[++i], nullptr);
+    else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) config.steadyWindowMs = (uint32_t)atoi(argv[++i]);
+    else if (strcmp(argv[i], "--groups-only") == 0) report.printSteps = false;
+    else if (strcmp(argv[i], "--csv") == 0) report.csv = true;
+    else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) path = argv[i];
+    else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  FILE *in = stdin;
+  if (path != nullptr && strcmp(path, "-") != 0) {
+    in = fopen(path, "rb");
+    if (in == nullptr) {
+      perror(path);
+      return 2;
+    }
+  }
+
+  StepResponseAnalyzer analyzer(config, on_step, &report);
+  TelemetryFrameDecoder decoder(frame_sample, nullptr, &analyzer);
+  if (report.printSteps || report.csv) print_header(report);
+
+  // 第一块数据中有0x00则按二进制帧解码，否则逐行解析文本
+  uint8_t buf[8192];
+  size_t n = fread(buf, 1, sizeof(buf), in);
+  bool binary = memchr(buf, 0, n) != nullptr;
+  uint64_t lines = 0;
+  char line[512];
+  size_t lineLen = 0;
+  while (n > 0) {
+    if (binary) {
+      decoder.feed(buf, n);
+    } else {
+      for (size_t i = 0; i < n; i++) {
+        char c = (char)buf[i];
+        if (c != '\n') {
+          if (lineLen < sizeof(line) - 1) line[lineLen++] = c;
+          continue;
+        }
+        if (analyze_line(line, lineLen, &analyzer)) lines++;
+        lineLen = 0;
+      }
+    }
+    n = fread(buf, 1, sizeof(buf), in);
+  }
+  if (binary) {
+    decoder.finish();
+  } else if (lineLen > 0 && analyze_line(line, lineLen, &analyzer)) {
+    lines++;
+  }
+  analyzer.finish();
+
+  report.samples = binary ? decoder.samples() : lines;
+  if (!report.csv) print_groups(report);
+  fflush(stdout);
+  fprintf(stderr, "[STEP] %llu samples (%s), %u steps%s\n", (unsigned long long)report.samples,
+          binary ? "binary frames" : "text", analyzer.steps(),
+          binary && decoder.badFrames() > 0 ? ", some frames were corrupted" : "");
+  return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * step_response.cpp - 流式阶跃响应分析
+ *
+ * **中文注释:**
+ * 每个样本的值保持到下一个样本 (零阶保持)，积分量 (控制信号均方根、IAE) 按样本间隔累加;
+ * 设定点变化的那个样本属于新的阶跃。
+ */
+
+#include "step_response.h"
+
+#include <math.h>
+
+namespace {
+
+/**
+ * @brief 在(t0, v0)与(t1, v1)之间插值出v = level的时刻。
+ */
+float crossing(float t0, float v0, float t1, float v1, float level) {
+  if (v1 == v0) return t1;
+  float f = (level - v0) / (v1 - v0);
+  if (f < 0.0f) f = 0.0f;
+  if (f > 1.0f) f = 1.0f;
+  return t0 + f * (t1 - t0);
+}
+
+} // namespace
+
+StepResponseAnalyzer::StepResponseAnalyzer(const Config &config, StepFn onStep, void *ctx)
+  : config_(config), onStep_(onStep), ctx_(ctx), steps_(0), hasSample_(false), active_(false),
+    lastMs_(0), lastSetpoint_(0.0f), lastMeasured_(0.0f), lastCommand_(0.0f) {}
+
+void StepResponseAnalyzer::add(uint32_t timeMs, float setpoint, float measured, float command) {
+  if (!hasSample_) {
+    hasSample_ = true;
+    lastMs_ = timeMs;
+    lastSetpoint_ = setpoint;
+    lastMeasured_ = measured;
+    lastCommand_ = command;
+    return;
+  }
+
+  // 上一个样本保持到本样本
+  if (active_) {
+    float dt = (float)(timeMs - lastMs_);
+    u2Sum_ += (double)lastCommand_ * lastCommand_ * dt;
+    iaeSum_ += fabs((double)m_.to - lastMeasured_) * dt * 1e-3;
+  }
+  if (fabsf(setpoint - lastSetpoint_) >= config_.minStep) {
+    if (active_) {
+      m_.durationMs = timeMs - m_.startMs;
+      end();
+    }
+    begin(timeMs, setpoint);
+  }
+
+  if (active_) {
+    float delta = m_.to - m_.y0;
+    float dir = delta >= 0.0f ? 1.0f : -1.0f;
+    float mag = fabsf(delta);
+    float t0 = (float)(lastMs_ - m_.startMs);
+    float t1 = (float)(timeMs - m_.startMs);
+    if (t0 < 0.0f || m_.samples == 0) t0 = 0.0f;
+
+    // 上升时间 (按阶跃方向归一化后的进度)
+    float p0 = mag > 0.0f ? (lastMeasured_ - m_.y0) * dir / mag : 1.0f;
+    float p1 = mag > 0.0f ? (measured - m_.y0) * dir / mag : 1.0f;
+    if (m_.samples == 0) p0 = 0.0f;
+    if (!rise10_ && p1 >= 0.1f) {
+      rise10_ = true;
+      t10_ = crossing(t0, p0, t1, p1, 0.1f);
+    }
+    if (rise10_ && !rise90_ && p1 >= 0.9f) {
+      rise90_ = true;
+      m_.riseMs = crossing(t0, p0, t1, p1, 0.9f) - t10_;
+    }
+    if (p1 > peak_) peak_ = p1;
+
+    // 调节时间: 记录最后一次从带外进入带内的时刻
+    float e1 = measured - m_.to;
+    bool inside = fabsf(e1) <= band_;
+    if (!inside) {
+      outside_ = true;
+    } else if (outside_) {
+      outside_ = false;
+      float e0 = lastMeasured_ - m_.to;
+      float edge = e0 >= 0.0f ? band_ : -band_;
+      settleAt_ = m_.samples == 0 ? t1 : crossing(t0, e0, t1, e1, edge);
+    }
+
+    // 最后一段的误差
+    tail_.push_back({timeMs, m_.to - measured});
+    while (timeMs - tail_.front().timeMs > config_.steadyWindowMs) tail_.pop_front();
+
+    float absU = fabsf(command);
+    if (absU > m_.uPeak) m_.uPeak = absU;
+    m_.samples++;
+  }
+
+  lastMs_ = timeMs;
+  lastSetpoint_ = setpoint;
+  lastMeasured_ = measured;
+  lastCommand_ = command;
+}
+
+void StepResponseAnalyzer::finish() {
+  if (!active_) return;
+  m_.durationMs = lastMs_ - m_.startMs;
+  end();
+}
+
+void StepResponseAnalyzer::begin(uint32_t timeMs, float setpoint) {
+  active_ = true;
+  m_ = StepMetrics();
+  m_.index = steps_;
+  m_.startMs = timeMs;
+  m_.from = lastSetpoint_;
+  m_.to = setpoint;
+  m_.y0 = lastMeasured_;
+  m_.riseMs = NAN;
+  m_.settleMs = NAN;
+  band_ = fmaxf(config_.bandPct * 0.01f * fabsf(setpoint - lastMeasured_), config_.bandAbs);
+  rise10_ = false;
+  rise90_ = false;
+  t10_ = 0.0f;
+  outside_ = fabsf(lastMeasured_ - setpoint) > band_;
+  settleAt_ = 0.0f;
+  peak_ = 0.0f;
+  u2Sum_ = 0.0;
+  iaeSum_ = 0.0;
+  tail_.clear();
+}
+
+void StepResponseAnalyzer::end() {
+  active_ = false;
+  m_.overshootPct = peak_ > 1.0f ? (peak_ - 1.0f) * 100.0f : 0.0f;
+  m_.settleMs = outside_ ? NAN : settleAt_;
+  m_.uRms = m_.durationMs > 0 ? (float)sqrt(u2Sum_ / m_.durationMs) : m_.uPeak;
+  m_.iae = (float)iaeSum_;
+
+  // 稳态: 最后steadyWindowMs，最多半个阶跃
+  uint32_t window = config_.steadyWindowMs;
+  if (window > m_.durationMs / 2) window = m_.durationMs / 2;
+  uint32_t lastMs = tail_.back().timeMs;
+  double sum = 0.0, sum2 = 0.0;
+  uint32_t n = 0;
+  for (const Tail &s : tail_) {
+    if (lastMs - s.timeMs > window) continue;
+    sum += s.error;
+    sum2 += (double)s.error * s.error;
+    n++;
+  }
+  double mean = sum / n;
+  m_.steadyError = (float)mean;
+  m_.ripple = (float)sqrt(fmax(0.0, sum2 / n - mean * mean));
+
+  steps_++;
+  onStep_(m_, ctx_);
+}
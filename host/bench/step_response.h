@@ -0,0 +1,111 @@
+/*
+ * step_response.h - 流式阶跃响应分析
+ *
+ * **中文注释:**
+ * 逐个输入遥测样本 (时间、设定点、测量值、控制信号)，设定点每变化一次就开始一个新的阶跃，
+ * 到下一次变化 (或输入结束) 时计算这一段的指标并调用回调:
+ *   - 上升时间: 测量值从 y0 + 10%Δ 到 y0 + 90%Δ 的时间 (Δ = 目标值 - y0，
+ *     y0为阶跃前最后一个测量值)，穿越时刻在相邻样本之间线性插值;
+ *   - 超调量: 测量值越过目标值的最大幅度，占|Δ|的百分比;
+ *   - 调节时间: 测量值最后一次离开误差带 (max(带宽% × |Δ|, 绝对带宽)) 之后，
+ *     回到误差带内的时刻 (插值) 距阶跃开始的时间，结束时仍在带外则为NaN;
+ *   - 稳态误差与纹波: 阶跃最后一段 (默认1秒，最多半个阶跃) 内误差的平均值与标准差;
+ *   - 控制量: 整个阶跃内控制信号的均方根值与峰值，以及误差绝对值的积分 (IAE)。
+ * 只保存当前阶跃的累加量和最后一段的样本，内存与记录长度无关。
+ * 不依赖Arduino库，也可以链接到其他主机程序中。
+ */
+
+#ifndef STEP_RESPONSE_H_
+#define STEP_RESPONSE_H_
+
+#include <stdint.h>
+
+#include <deque>
+
+/**
+ * @struct StepMetrics
+ * @brief 一个阶跃的指标。时间单位为毫秒，未达到的时间为NaN。
+ */
+struct StepMetrics {
+  uint32_t index;        // 阶跃序号 (从0开始)
+  uint32_t startMs;      // 设定点变化的时刻
+  uint32_t durationMs;   // 到下一次变化 (或记录结束) 的时间
+  uint32_t samples;      // 样本数
+  float from;            // 变化前的设定点
+  float to;              // 目标值
+  float y0;              // 变化前最后一个测量值
+  float riseMs;          // 10% -> 90% 上升时间
+  float overshootPct;    // 超调量 (%)
+  float settleMs;        // 调节时间
+  float steadyError;     // 稳态误差的平均值 (目标值 - 测量值)
+  float ripple;          // 稳态误差的标准差
+  float uRms;            // 控制信号的均方根值
+  float uPeak;           // 控制信号绝对值的最大值
+  float iae;             // 误差绝对值的积分 (rad)
+};
+
+/**
+ * @class StepResponseAnalyzer
+ * @brief 单次遍历的阶跃检测与指标计算。
+ */
+class StepResponseAnalyzer {
+public:
+  struct Config {
+    float bandPct = 5.0f;           // 调节误差带 (|Δ|的百分比)
+    float bandAbs = 0.0f;           // 误差带的下限 (rad/s)，例如编码器的速度分辨率
+    float minStep = 0.01f;          // 小于此值的设定点变化不算阶跃
+    uint32_t steadyWindowMs = 1000; // 计算稳态误差的末段长度
+  };
+
+  typedef void (*StepFn)(const StepMetrics &metrics, void *ctx);
+
+  StepResponseAnalyzer(const Config &config, StepFn onStep, void *ctx);
+
+  /**
+   * @brief 输入一个样本 (时间必须不减)。
+   */
+  void add(uint32_t timeMs, float setpoint, float measured, float command);
+
+  /**
+   * @brief 输入结束，输出最后一个阶跃。
+   */
+  void finish();
+
+  uint32_t steps() const { return steps_; }
+
+private:
+  struct Tail {
+    uint32_t timeMs;
+    float error;
+  };
+
+  void begin(uint32_t timeMs, float setpoint);
+  void end();
+
+  Config config_;
+  StepFn onStep_;
+  void *ctx_;
+  uint32_t steps_;
+
+  bool hasSample_;   // 已有上一个样本
+  bool active_;      // 当前在一个阶跃中
+  uint32_t lastMs_;
+  float lastSetpoint_;
+  float lastMeasured_;
+  float lastCommand_;
+
+  // 当前阶跃
+  StepMetrics m_;
+  float band_;
+  bool rise10_;       // 已越过10%
+  bool rise90_;       // 已越过90%
+  float t10_;
+  bool outside_;      // 上一个样本在误差带外
+  float settleAt_;    // 最后一次进入误差带的时刻 (相对阶跃开始)
+  float peak_;        // 沿阶跃方向的最大测量值 (已乘方向)
+  double u2Sum_;      // 控制信号平方的时间积分
+  double iaeSum_;
+  std::deque<Tail> tail_;  // 最后steadyWindowMs内的误差
+};
+
+#endif /* STEP_RESPONSE_H_ */
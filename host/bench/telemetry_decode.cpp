@@ -0,0 +1,171 @@
+/*
+ * telemetry_decode.cpp - 二进制遥测帧的流式解码工具
+ *
+ * **中文注释:**
+ * 从文件或标准输入 (串口抓包、`BF_sim`的输出) 流式读取字节，解出telemetry_frame.h
+ * 格式的样本，输出为CSV或按列存放的二进制文件; 帧之间的文本行 (Serial.println)
+ * 原样写到stderr。内存占用与输入长度无关，可以处理任意长的记录。
+ *   - 默认: CSV写到stdout (time_ms,setpoint,measured,command,integral)
+ *   - --columns DIR: 每个字段一个小端序数组文件 (time_ms.u32, setpoint.f32, ...)，
+ *     可以直接用numpy.fromfile读取，另写DIR/columns.txt说明各列
+ *   - --encode: 反向转换，读入原来的TSV文本日志 (4或5列)，输出二进制帧，
+ *     用于转换旧日志和比较两种格式的字节数
+ * 结束时在stderr打印统计: 帧数、样本数、损坏帧数、每个样本的平均字节数。
+ *
+ * 用法:
+ *   ./build/BF_sim --duration 25 | ./build/telemetry_decode > bf.csv
+ *   ./build/telemetry_decode --columns run1/ capture.bin
+ *   ./build/telemetry_decode --encode log.tsv > log.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "telemetry_frame.h"
+
+namespace {
+
+const char *COLUMN_NAMES[TELEMETRY_FIELDS] = {"time_ms.u32", "setpoint.f32", "measured.f32",
+                                              "command.f32", "integral.f32"};
+
+struct Output {
+  FILE *csv = nullptr;
+  FILE *columns[TELEMETRY_FIELDS] = {};
+};
+
+void on_sample(const TelemetrySample &s, void *ctx) {
+  Output *out = (Output *)ctx;
+  if (out->csv != nullptr) {
+    fprintf(out->csv, "%u,%.3f,%.3f,%.0f,%.4f\n", s.timeMs, s.setpoint, s.measured, s.command, s.integral);
+    return;
+  }
+  fwrite(&s.timeMs, sizeof(uint32_t), 1, out->columns[0]);
+  fwrite(&s.setpoint, sizeof(float), 1, out->columns[1]);
+  fwrite(&s.measured, sizeof(float), 1, out->columns[2]);
+  fwrite(&s.command, sizeof(float), 1, out->columns[3]);
+  fwrite(&s.integral, sizeof(float), 1, out->columns[4]);
+}
+
+void on_text(const char *text, size_t len, void *) {
+  fwrite(text, 1, len, stderr);
+}
+
+bool open_columns(const std::string &dir, Output *out) {
+  std::string base = dir.empty() || dir.back() == '/' ? dir : dir + "/";
+  for (int i = 0; i < TELEMETRY_FIELDS; i++) {
+    out->columns[i] = fopen((base + COLUMN_NAMES[i]).c_str(), "wb");
+    if (out->columns[i] == nullptr) {
+      perror((base + COLUMN_NAMES[i]).c_str());
+      return false;
+    }
+  }
+  FILE *info = fopen((base + "columns.txt").c_str(), "w");
+  if (info == nullptr) return false;
+  fprintf(info, "# little-endian arrays, one element per sample\n");
+  for (int i = 0; i < TELEMETRY_FIELDS; i++) fprintf(info, "%s\n", COLUMN_NAMES[i]);
+  fclose(info);
+  return true;
+}
+
+int decode(FILE *in, Output *out) {
+  TelemetryFrameDecoder decoder(on_sample, on_text, out);
+  uint8_t buf[4096];
+  uint64_t total = 0;
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+    decoder.feed(buf, n);
+    total += n;
+  }
+  decoder.finish();
+
+  uint64_t binary = total - decoder.textBytes();
+  fprintf(stderr, "[DECODE] %llu bytes, %u frames, %u samples, %u bad frames, %u text bytes, %.2f bytes/sample\n",
+          (unsigned long long)total, decoder.frames(), decoder.samples(), decoder.badFrames(),
+          decoder.textBytes(), decoder.samples() > 0 ? (double)binary / decoder.samples() : 0.0);
+  return decoder.badFrames() > 0 ? 1 : 0;
+}
+
+/**
+ * @brief TSV文本日志 -> 二进制帧。不是样本的行原样输出 (解码时作为文本还原)。
+ */
+int encode(FILE *in) {
+  TelemetryFrameEncoder encoder;
+  uint8_t frame[TELEMETRY_FRAME_MAX_ENCODED];
+  char line[512];
+  uint64_t textIn = 0, binaryOut = 0;
+  uint32_t samples = 0;
+  while (fgets(line, sizeof(line), in) != nullptr) {
+    TelemetrySample s = {};
+    unsigned t;
+    int fields = sscanf(line, "%u\t%f\t%f\t%f\t%f", &t, &s.setpoint, &s.measured, &s.command, &s.integral);
+    if (fields < 4) {
+      // 文本行之前先输出未满的帧，保持顺序
+      size_t m = encoder.flush(frame);
+      fwrite(frame, 1, m, stdout);
+      binaryOut += m;
+      fputs(line, stdout);
+      continue;
+    }
+    s.timeMs = t;
+    textIn += strlen(line);
+    samples++;
+    size_t m = encoder.add(s, frame);
+    fwrite(frame, 1, m, stdout);
+    binaryOut += m;
+  }
+  size_t m = encoder.flush(frame);
+  fwrite(frame, 1, m, stdout);
+  binaryOut += m;
+
+  fprintf(stderr, "[ENCODE] %u samples: text %.2f bytes/sample, binary %.2f bytes/sample (x%.2f)\n",
+          samples, samples > 0 ? (double)textIn / samples : 0.0, samples > 0 ? (double)binaryOut / samples : 0.0,
+          binaryOut > 0 ? (double)textIn / binaryOut : 0.0);
+  return 0;
+}
+
+void usage(const char *prog) {
+  fprintf(stderr, "usage: %s [--columns DIR | --encode] [input|-]\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const char *path = nullptr;
+  const char *columns = nullptr;
+  bool encodeMode = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc) columns = argv[++i];
+    else if (strcmp(argv[i], "--encode") == 0) encodeMode = true;
+    else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) path = argv[i];
+    else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  FILE *in = stdin;
+  if (path != nullptr && strcmp(path, "-") != 0) {
+    in = fopen(path, "rb");
+    if (in == nullptr) {
+      perror(path);
+      return 2;
+    }
+  }
+  if (encodeMode) return encode(in);
+
+  Output out;
+  if (columns != nullptr) {
+    if (!open_columns(columns, &out)) return 2;
+  } else {
+    out.csv = stdout;
+    fprintf(out.csv, "time_ms,setpoint,measured,command,integral\n");
+  }
+  int rc = decode(in, &out);
+  for (FILE *f : out.columns) {
+    if (f != nullptr) fclose(f);
+  }
+  return rc;
+}
@@ -0,0 +1,140 @@
+/*
+ * udp_teleop.cpp - UDP遥控指令的Linux客户端
+ *
+ * **中文注释:**
+ * 按固定周期向机器人 (或以--realtime运行的Remote_sim) 发送UDP指令数据报，
+ * 格式见Remote/udp_command.hpp。每次启动随机选择会话号，序号从1开始递增，
+ * 时间戳取本机单调时钟的微秒值。
+ * 默认发送一个缓慢变化的正弦速度曲线，也可以用--left/--right指定恒定的两轮速度，
+ * 或用--linear/--angular指定恒定的车体速度 (UDP_CMD_TWIST指令)。
+ * 结束时发送一个速度为0的指令，并统计实际发送间隔的分布 (p50/p99/最大值)。
+ *
+ * 用法 (先在另一个终端运行 ./build/Remote_sim --realtime --duration 60):
+ *   ./build/udp_teleop [--host 127.0.0.1] [--port 12210] [--count 500] [--interval 20]
+ *                      [--left mrad/s --right mrad/s | --linear mm/s --angular mrad/s]
+ * 直接控制机器人时使用 --host 192.168.4.1 --port 4210。
+ */
+
+#include <arpa/inet.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "udp_command.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char *g_host = "127.0.0.1";
+int g_port = UDP_CMD_PORT + 8000; // Remote_sim默认的--port-offset
+int g_count = 500;
+int g_interval_ms = 20;
+bool g_constant = false;
+int g_left = 0;
+int g_right = 0;
+bool g_twist = false;
+int g_linear = 0;
+int g_angular = 0;
+
+uint32_t now_us() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+    Clock::now().time_since_epoch()).count();
+}
+
+double percentile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty()) return 0.0;
+  size_t idx = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+bool parse_args(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--host") == 0 && has_value) g_host = argv[++i];
+    else if (strcmp(argv[i], "--port") == 0 && has_value) g_port = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--count") == 0 && has_value) g_count = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--interval") == 0 && has_value) g_interval_ms = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--left") == 0 && has_value) { g_left = atoi(argv[++i]); g_constant = true; }
+    else if (strcmp(argv[i], "--right") == 0 && has_value) { g_right = atoi(argv[++i]); g_constant = true; }
+    else if (strcmp(argv[i], "--linear") == 0 && has_value) { g_linear = atoi(argv[++i]); g_twist = true; }
+    else if (strcmp(argv[i], "--angular") == 0 && has_value) { g_angular = atoi(argv[++i]); g_twist = true; }
+    else return false;
+  }
+  return g_count > 0 && g_interval_ms > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (!parse_args(argc, argv)) {
+    fprintf(stderr, "usage: %s [--host 127.0.0.1] [--port 12210] [--count 500] [--interval ms]\n"
+            "       [--left mrad/s] [--right mrad/s] [--linear mm/s] [--angular mrad/s]\n", argv[0]);
+    return 2;
+  }
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_port = htons((uint16_t)g_port);
+  if (fd < 0 || inet_pton(AF_INET, g_host, &to.sin_addr) != 1) {
+    fprintf(stderr, "invalid host %s\n", g_host);
+    return 2;
+  }
+
+  UdpCommand cmd = {};
+  cmd.session = (uint16_t)std::random_device()();
+  std::vector<double> gaps_ms;
+  gaps_ms.reserve((size_t)g_count);
+  int errors = 0;
+  uint8_t buf[UDP_CMD_PACKET_SIZE];
+
+  auto next = Clock::now();
+  auto last = next;
+  for (int i = 0; i <= g_count; i++) {
+    bool stop = i == g_count; // 最后一个数据报让机器人停车
+    if (stop) {
+      cmd.kind = UDP_CMD_WHEELS;
+      cmd.leftMrad = cmd.rightMrad = 0;
+    } else if (g_twist) {
+      cmd.kind = UDP_CMD_TWIST;
+      cmd.linearMmS = (int16_t)g_linear;
+      cmd.angularMrad = (int16_t)g_angular;
+    } else if (g_constant) {
+      cmd.leftMrad = (int16_t)g_left;
+      cmd.rightMrad = (int16_t)g_right;
+    } else {
+      double phase = 2.0 * M_PI * i * g_interval_ms / 4000.0; // 4秒一个周期
+      cmd.leftMrad = (int16_t)(8000.0 * sin(phase));
+      cmd.rightMrad = (int16_t)(8000.0 * cos(phase));
+    }
+    cmd.seq++;
+    cmd.timestampUs = now_us();
+    udp_command_encode(cmd, buf);
+    if (sendto(fd, buf, sizeof(buf), 0, (sockaddr *)&to, sizeof(to)) != (ssize_t)sizeof(buf)) errors++;
+
+    auto sent = Clock::now();
+    if (i > 0) gaps_ms.push_back(std::chrono::duration<double, std::milli>(sent - last).count());
+    last = sent;
+    if (stop) break;
+    next += std::chrono::milliseconds(g_interval_ms);
+    std::this_thread::sleep_until(next);
+  }
+  close(fd);
+
+  std::sort(gaps_ms.begin(), gaps_ms.end());
+  printf("udp_teleop session=0x%04x sent=%u errors=%d -> %s:%d\n", cmd.session, cmd.seq, errors, g_host, g_port);
+  printf("send interval: p50=%.2f ms p99=%.2f ms max=%.2f ms\n",
+         percentile(gaps_ms, 50), percentile(gaps_ms, 99), gaps_ms.empty() ? 0.0 : gaps_ms.back());
+  return errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * validate_diff_drive.cpp - 差速驱动运动学 (diff_drive.cpp) 的验证
+ *
+ * **中文注释:**
+ *   1. 逆运动学后再正运动学得到原来的车体速度;
+ *   2. 超速时两轮按同一比例缩小: 较快的车轮正好等于上限，曲率ω/v不变;
+ *   3. 离散指令的车体速度 (与Remote.ino中ORDER_PRESETS的换算相同) 得到原来的两轮速度;
+ *   4. NaN/无穷返回停止;
+ *   5. 在仿真被控对象上以前馈占空比 (轮速 / 增益) 驱动两轮，稳态下由实测轮速
+ *      算出的车体速度跟随指令，饱和的指令沿同一曲率行驶。
+ *
+ * 用法: ./build/validate_diff_drive
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "bench_check.h"
+#include "diff_drive.hpp"
+#include "motor_pwm.hpp"
+#include "sim_core.h"
+
+namespace {
+
+// 与Remote.ino的默认参数相同
+const float WHEEL_RADIUS_M = 0.0325f;
+const float TRACK_WIDTH_M = 0.15f;
+const float MAX_WHEEL_SPEED = 10.0f;
+const float FORWARD_SPEED = 2.5f;
+const float TURN_SPEED = 1.5f;
+
+const uint32_t FULL_SCALE = 32767;
+
+DiffDriveKinematics g_kinematics(WHEEL_RADIUS_M, TRACK_WIDTH_M, MAX_WHEEL_SPEED);
+bool near(double a, double b, double tol) { return fabs(a - b) <= tol; }
+
+void test_round_trip() {
+  const BodyTwist twists[] = {{0.0f, 0.0f}, {0.2f, 0.0f}, {-0.15f, 0.0f}, {0.0f, 2.0f},
+                              {0.1f, -1.5f}, {-0.1f, 0.8f}, {0.25f, 1.0f}};
+  for (const BodyTwist &twist : twists) {
+    BodyTwist back = g_kinematics.toBody(g_kinematics.toWheels(twist));
+    check("round trip", near(back.linear, twist.linear, 1e-6) && near(back.angular, twist.angular, 1e-5));
+  }
+  printf("round trip: %zu twists\n", sizeof(twists) / sizeof(twists[0]));
+}
+
+void test_saturation() {
+  // (1 m/s, 3 rad/s): 右轮 (1 + 0.225) / 0.0325 ≈ 37.7 rad/s，超出上限
+  BodyTwist twist = {1.0f, 3.0f};
+  WheelSpeeds raw = {(twist.linear - 0.5f * TRACK_WIDTH_M * twist.angular) / WHEEL_RADIUS_M,
+                     (twist.linear + 0.5f * TRACK_WIDTH_M * twist.angular) / WHEEL_RADIUS_M};
+  WheelSpeeds wheels = g_kinematics.toWheels(twist);
+  BodyTwist reached = g_kinematics.toBody(wheels);
+  printf("saturation: raw L %.2f R %.2f -> L %.2f R %.2f rad/s, curvature %.3f -> %.3f 1/m\n", raw.left, raw.right,
+         wheels.left, wheels.right, twist.angular / twist.linear, reached.angular / reached.linear);
+  check("faster wheel at the limit", near(fmax(fabs(wheels.left), fabs(wheels.right)), MAX_WHEEL_SPEED, 1e-5));
+  check("wheel ratio kept", near(wheels.left / wheels.right, raw.left / raw.right, 1e-5));
+  check("curvature kept", near(reached.angular / reached.linear, twist.angular / twist.linear, 1e-4));
+
+  // 原地转向超速: 两轮仍然大小相等、方向相反
+  WheelSpeeds spin = g_kinematics.toWheels({0.0f, 20.0f});
+  check("spin in place", near(spin.left, -MAX_WHEEL_SPEED, 1e-5) && near(spin.right, MAX_WHEEL_SPEED, 1e-5));
+
+  // 上限以内不改变
+  WheelSpeeds inside = g_kinematics.saturate({9.5f, -3.0f});
+  check("inside the limit", inside.left == 9.5f && inside.right == -3.0f);
+
+  WheelSpeeds bad = g_kinematics.saturate({NAN, 1.0f});
+  WheelSpeeds inf = g_kinematics.toWheels({INFINITY, 0.0f});
+  check("non-finite -> stop", bad.left == 0.0f && bad.right == 0.0f && inf.left == 0.0f && inf.right == 0.0f);
+}
+
+void test_presets() {
+  struct {
+    const char *name;
+    BodyTwist twist;
+    WheelSpeeds legacy;
+  } presets[] = {
+    {"Forward", {FORWARD_SPEED * WHEEL_RADIUS_M, 0.0f}, {FORWARD_SPEED, FORWARD_SPEED}},
+    {"Backward", {-FORWARD_SPEED * WHEEL_RADIUS_M, 0.0f}, {-FORWARD_SPEED, -FORWARD_SPEED}},
+    {"Turn Left", {0.0f, 2.0f * TURN_SPEED * WHEEL_RADIUS_M / TRACK_WIDTH_M}, {-TURN_SPEED, TURN_SPEED}},
+    {"Turn Right", {0.0f, -2.0f * TURN_SPEED * WHEEL_RADIUS_M / TRACK_WIDTH_M}, {TURN_SPEED, -TURN_SPEED}},
+  };
+  for (const auto &preset : presets) {
+    WheelSpeeds wheels = g_kinematics.toWheels(preset.twist);
+    printf("preset %-10s v %+.4f m/s w %+.3f rad/s -> L %+.3f R %+.3f rad/s\n", preset.name, preset.twist.linear,
+           preset.twist.angular, wheels.left, wheels.right);
+    check(preset.name, near(wheels.left, preset.legacy.left, 1e-5) && near(wheels.right, preset.legacy.right, 1e-5));
+  }
+}
+
+/**
+ * @brief 在仿真被控对象上依次执行几个车体速度指令，每个保持10个时间常数后检查稳态。
+ */
+void plant_task(void *) {
+  MotorPwm motors(80000000, 20000, FULL_SCALE);
+  check("MotorPwm begin", motors.begin(SIM_PIN_MLF, SIM_PIN_MLB, SIM_PIN_MRF, SIM_PIN_MRB));
+
+  const BodyTwist commands[] = {{0.2f, 0.0f}, {0.1f, 1.5f}, {0.0f, -3.0f}, {-0.15f, 0.5f}, {0.5f, 2.0f}};
+  uint64_t t_us = 0;
+  for (const BodyTwist &cmd : commands) {
+    WheelSpeeds wheels = g_kinematics.toWheels(cmd);
+    motors.write((int32_t)lroundf(wheels.left / SIM_DEFAULT_G * FULL_SCALE),
+                 (int32_t)lroundf(wheels.right / SIM_DEFAULT_G * FULL_SCALE));
+    t_us += (uint64_t)(10 * SIM_DEFAULT_TAU_MS * 1000);
+    sim_task_sleep_until(t_us);
+
+    WheelSpeeds measured = {(float)sim_wheel_speed(SIM_WHEEL_LEFT), (float)sim_wheel_speed(SIM_WHEEL_RIGHT)};
+    BodyTwist body = g_kinematics.toBody(measured);
+    BodyTwist expected = g_kinematics.toBody(wheels);  // 饱和后实际能达到的车体速度
+    bool saturated = !near(expected.linear, cmd.linear, 1e-6) || !near(expected.angular, cmd.angular, 1e-5);
+    printf("plant: cmd v %+.3f w %+.3f -> measured v %+.4f w %+.4f%s\n", cmd.linear, cmd.angular, body.linear,
+           body.angular, saturated ? " (saturated)" : "");
+    // 占空比量化为1/4000，轮速误差约0.01 rad/s
+    check("plant tracks the twist", near(body.linear, expected.linear, 2e-3) && near(body.angular, expected.angular, 2e-2));
+    if (cmd.linear != 0.0f) {
+      check("plant keeps the curvature",
+            near(body.angular / body.linear, cmd.angular / cmd.linear, 0.02 * fabs(cmd.angular / cmd.linear) + 0.05));
+    }
+  }
+  motors.stop();
+}
+
+} // namespace
+
+int main() {
+  test_round_trip();
+  test_saturation();
+  test_presets();
+
+  sim_config cfg = {};
+  cfg.tau_ms = SIM_DEFAULT_TAU_MS;
+  cfg.gain = SIM_DEFAULT_G;
+  cfg.edges_per_rev = SIM_DEFAULT_EDGES_PER_REV;
+  cfg.duration_s = 2.0;
+  cfg.quiet = true;
+  sim_init(cfg);
+  sim_task_create(plant_task, "plant", nullptr, 1);
+  sim_run();
+
+  return checks_summary();
+}
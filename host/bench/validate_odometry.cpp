@@ -0,0 +1,219 @@
+/*
+ * validate_odometry.cpp - 里程计 (odometry.cpp) 的精度与每次更新的耗时
+ *
+ * **中文注释:**
+ *   1. 解析轨迹: 两轮以固定速度沿半径已知的圆运动，按控制周期把精确的车轮角度量化为
+ *      编码器计数，比较精确圆弧积分与欧拉法绕一圈过程中的最大位置误差 (20 Hz与1 kHz;
+ *      欧拉法的误差绕完整一圈后会互相抵消，所以不能只看终点);
+ *      计数值从2^32附近开始，检查64位计数相减不受回绕影响;
+ *   2. 仿真被控对象: ESP32Encoder (仿真PCNT) 读取两轮计数，1 kHz更新里程计; 真实位姿由
+ *      仿真车轮角度在20 kHz的定时器中断中用double积分; 前馈驱动一段直行、转弯、原地转向、
+ *      倒车的指令序列后比较两者;
+ *   3. 每次update()的耗时 (主机)。目标板上的耗时包含在Remote.ino的CONTROL_BUDGET_BENCH中。
+ *
+ * 用法: ./build/validate_odometry
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+
+#include "bench_check.h"
+#include "ESP32Encoder.h"
+#include "diff_drive.hpp"
+#include "motor_pwm.hpp"
+#include "odometry.hpp"
+#include "sim_core.h"
+
+namespace {
+
+// 与Remote.ino的默认参数相同
+const float WHEEL_RADIUS_M = 0.0325f;
+const float TRACK_WIDTH_M = 0.15f;
+const float EDGES_PER_REV = SIM_DEFAULT_EDGES_PER_REV;
+const uint32_t FULL_SCALE = 32767;
+
+/**
+ * @brief 欧拉法 (对比用): 用周期开始时的航向走完整个弧长。
+ */
+struct EulerOdometry {
+  double x = 0, y = 0, theta = 0;
+  int64_t lastLeft = 0, lastRight = 0;
+  void update(int64_t left, int64_t right, double metersPerEdge) {
+    double dl = (left - lastLeft) * metersPerEdge, dr = (right - lastRight) * metersPerEdge;
+    lastLeft = left;
+    lastRight = right;
+    double ds = 0.5 * (dl + dr);
+    x += ds * cos(theta);
+    y += ds * sin(theta);
+    theta += (dr - dl) / TRACK_WIDTH_M;
+  }
+};
+
+/**
+ * @brief 以半径radius (m) 和线速度speed (m/s) 绕圆一圈，返回途中的最大位置误差 (m) 与航向误差 (rad)。
+ */
+void run_circle(double radius, double speed, double periodS, int64_t countOffset, double *arcError,
+                double *eulerError, double *headingError) {
+  double omega = speed / radius;
+  double wl = (speed - 0.5 * TRACK_WIDTH_M * omega) / WHEEL_RADIUS_M;
+  double wr = (speed + 0.5 * TRACK_WIDTH_M * omega) / WHEEL_RADIUS_M;
+  double countsPerRad = EDGES_PER_REV / (2.0 * M_PI);
+  double metersPerEdge = 2.0 * M_PI * WHEEL_RADIUS_M / EDGES_PER_REV;
+
+  Odometry odometry(EDGES_PER_REV, WHEEL_RADIUS_M, TRACK_WIDTH_M);
+  odometry.reset(countOffset, countOffset);
+  EulerOdometry euler;
+  euler.lastLeft = euler.lastRight = countOffset;
+
+  double duration = 2.0 * M_PI / fabs(omega);
+  int steps = (int)ceil(duration / periodS);
+  *arcError = *eulerError = *headingError = 0.0;
+  for (int k = 1; k <= steps; k++) {
+    double t = k * periodS;
+    int64_t left = countOffset + (int64_t)floor(wl * t * countsPerRad);
+    int64_t right = countOffset + (int64_t)floor(wr * t * countsPerRad);
+    odometry.update(left, right);
+    euler.update(left, right, metersPerEdge);
+
+    // 圆心在(0, radius)，t时刻的真实位姿
+    double trueX = radius * sin(omega * t), trueY = radius * (1.0 - cos(omega * t));
+    double trueTheta = remainder(omega * t, 2.0 * M_PI);
+    const OdometryPose &pose = odometry.pose();
+    *arcError = fmax(*arcError, hypot(pose.x - trueX, pose.y - trueY));
+    *eulerError = fmax(*eulerError, hypot(euler.x - trueX, euler.y - trueY));
+    *headingError = fmax(*headingError, fabs(remainder(pose.theta - trueTheta, 2.0 * M_PI)));
+  }
+}
+
+void test_circles() {
+  struct {
+    double radius, speed, periodS;
+    int64_t offset;
+  } cases[] = {
+    {0.3, 0.2, 0.050, 0},
+    {0.3, 0.2, 0.001, 0},
+    {0.1, 0.15, 0.050, 0},
+    {0.1, 0.15, 0.001, 0},
+    {0.3, 0.2, 0.001, (int64_t)1 << 32},        // 计数值越过2^32
+    {0.3, -0.2, 0.001, -((int64_t)1 << 31) + 5},  // 倒车，计数值越过-2^31
+  };
+  printf("circle (one turn)   period  max error: exact-arc  Euler    heading\n");
+  for (const auto &c : cases) {
+    double arc, euler, heading;
+    run_circle(c.radius, c.speed, c.periodS, c.offset, &arc, &euler, &heading);
+    printf("  R %.2f m v %+.2f   %4.0f ms         %7.2f mm %7.2f mm  %.4f rad%s\n", c.radius, c.speed,
+           c.periodS * 1e3, arc * 1e3, euler * 1e3, heading, c.offset != 0 ? "  (64-bit counts)" : "");
+    // 计数量化: 一个边沿约0.15 mm轮缘行程，航向约2 mrad
+    check("exact-arc error", arc < 2e-3 && heading < 5e-3);
+    if (c.periodS >= 0.05) check("exact-arc better than Euler", arc < 0.25 * euler);
+  }
+}
+
+// --- 在仿真被控对象上运行 ---
+
+const uint64_t TRUTH_PERIOD_US = 50;  // 20 kHz
+double g_truthX = 0, g_truthY = 0, g_truthTheta = 0;
+double g_lastAngleLeft = 0, g_lastAngleRight = 0;
+
+/**
+ * @brief 用仿真车轮角度的增量以double精确圆弧积分真实位姿。
+ */
+void truth_isr() {
+  double angleLeft = sim_wheel_angle(SIM_WHEEL_LEFT), angleRight = sim_wheel_angle(SIM_WHEEL_RIGHT);
+  double dl = (angleLeft - g_lastAngleLeft) * WHEEL_RADIUS_M, dr = (angleRight - g_lastAngleRight) * WHEEL_RADIUS_M;
+  g_lastAngleLeft = angleLeft;
+  g_lastAngleRight = angleRight;
+  double ds = 0.5 * (dl + dr), dtheta = (dr - dl) / TRACK_WIDTH_M, half = 0.5 * dtheta;
+  double chord = fabs(half) < 1e-9 ? ds : ds * sin(half) / half;
+  g_truthX += chord * cos(g_truthTheta + half);
+  g_truthY += chord * sin(g_truthTheta + half);
+  g_truthTheta += dtheta;
+}
+
+void plant_task(void *) {
+  ESP32Encoder left, right;
+  left.attachFullQuad(SIM_PIN_SLA, SIM_PIN_SLB);
+  right.attachFullQuad(SIM_PIN_SRA, SIM_PIN_SRB);
+  left.clearCount();
+  right.clearCount();
+  MotorPwm motors(80000000, 20000, FULL_SCALE);
+  check("MotorPwm begin", motors.begin(SIM_PIN_MLF, SIM_PIN_MLB, SIM_PIN_MRF, SIM_PIN_MRB));
+
+  DiffDriveKinematics kinematics(WHEEL_RADIUS_M, TRACK_WIDTH_M, 10.0f);
+  Odometry odometry(EDGES_PER_REV, WHEEL_RADIUS_M, TRACK_WIDTH_M);
+  odometry.reset(left.getCount(), right.getCount());
+  g_lastAngleLeft = sim_wheel_angle(SIM_WHEEL_LEFT);
+  g_lastAngleRight = sim_wheel_angle(SIM_WHEEL_RIGHT);
+  void *truthTimer = sim_timer_create();
+  sim_timer_attach_isr(truthTimer, truth_isr);
+  sim_timer_arm(truthTimer, sim_now_us() + TRUTH_PERIOD_US, TRUTH_PERIOD_US);
+
+  struct {
+    BodyTwist twist;
+    double seconds;
+  } legs[] = {
+    {{0.25f, 0.0f}, 2.0}, {{0.15f, 1.2f}, 3.0}, {{0.0f, -2.5f}, 1.5},
+    {{-0.1f, 0.6f}, 2.0}, {{0.2f, -0.8f}, 2.5}, {{0.0f, 0.0f}, 0.5},
+  };
+  uint64_t t_us = sim_now_us();
+  for (const auto &leg : legs) {
+    WheelSpeeds wheels = kinematics.toWheels(leg.twist);
+    motors.write((int32_t)lroundf(wheels.left / SIM_DEFAULT_G * FULL_SCALE),
+                 (int32_t)lroundf(wheels.right / SIM_DEFAULT_G * FULL_SCALE));
+    uint64_t end_us = t_us + (uint64_t)(leg.seconds * 1e6);
+    while (t_us < end_us) {
+      t_us += 1000;
+      sim_task_sleep_until(t_us);
+      odometry.update(left.getCount(), right.getCount());
+    }
+  }
+  sim_timer_delete(truthTimer);
+
+  const OdometryPose &pose = odometry.pose();
+  double error = hypot(pose.x - g_truthX, pose.y - g_truthY);
+  double headingError = fabs(remainder(pose.theta - g_truthTheta, 2.0 * M_PI));
+  printf("plant: %u updates, %.2f m travelled\n", (unsigned)pose.updates, pose.distance);
+  printf("  odometry x %+.4f y %+.4f theta %+.4f\n", pose.x, pose.y, pose.theta);
+  printf("  truth    x %+.4f y %+.4f theta %+.4f\n", g_truthX, g_truthY, remainder(g_truthTheta, 2.0 * M_PI));
+  printf("  position error %.2f mm, heading error %.2f mrad\n", error * 1e3, headingError * 1e3);
+  check("plant position", error < 3e-3);
+  check("plant heading", headingError < 5e-3);
+  check("plant distance", pose.distance > 1.5f);
+}
+
+void bench_update_cost() {
+  Odometry odometry(EDGES_PER_REV, WHEEL_RADIUS_M, TRACK_WIDTH_M);
+  const int n = 2000000;
+  int64_t left = 0, right = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    left += 3 + (i & 3);
+    right += 5 - (i & 1);
+    odometry.update(left, right);
+  }
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  const OdometryPose &pose = odometry.pose();
+  printf("update cost: %.1f ns per update (x %.1f y %.1f, %zu bytes per Odometry)\n", s * 1e9 / n, pose.x, pose.y,
+         sizeof(Odometry));
+}
+
+} // namespace
+
+int main() {
+  test_circles();
+
+  sim_config cfg = {};
+  cfg.tau_ms = SIM_DEFAULT_TAU_MS;
+  cfg.gain = SIM_DEFAULT_G;
+  cfg.edges_per_rev = SIM_DEFAULT_EDGES_PER_REV;
+  cfg.duration_s = 13.0;
+  cfg.quiet = true;
+  sim_init(cfg);
+  sim_task_create(plant_task, "plant", nullptr, 1);
+  sim_run();
+
+  bench_update_cost();
+  return checks_summary();
+}
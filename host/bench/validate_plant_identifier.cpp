@@ -0,0 +1,324 @@
+/*
+ * validate_plant_identifier.cpp - RLS在线辨识 (plant_identifier.cpp) 的精度、跟踪与耗时
+ *
+ * **中文注释:**
+ *   1. 合成数据: 精确的零阶保持一阶模型、随机占空比，无噪声时收敛到真实参数; 加测量噪声后误差
+ *      在不确定度估计的范围内; 长时间匀速与静止之后协方差不发散，阶跃后重新收敛;
+ *   2. 仿真被控对象 (与Remote.ino相同的链路): 1 kHz控制任务用ESP32Encoder的边沿时间戳与M/T法测速、
+ *      编译期设计的PI、设定点轨迹与MotorPwm驱动两轮，设定点随机阶跃; 每个周期把(占空比, 速度)
+ *      放入TelemetryRing; 低优先级的辨识任务每20 ms取出全部样本更新两轮的RLS (每10个样本回归一次)，结果经TripleBuffer发布。
+ *      被控对象的TAU与G在仿真时长内线性漂移 (30.2 -> 45 ms, 50 -> 38)，每秒比较估计值与当时的真实值;
+ *   3. 控制任务一侧的入队耗时与辨识任务一侧每个样本的更新耗时 (主机)。
+ *
+ * 用法: ./build/validate_plant_identifier
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <random>
+
+#include "bench_check.h"
+#include "ESP32Encoder.h"
+#include "motor_pwm.hpp"
+#include "pi_design.h"
+#include "plant_identifier.hpp"
+#include "setpoint_profile.h"
+#include "sim_core.h"
+#include "speed_estimator.hpp"
+#include "telemetry_ring.h"
+#include "triple_buffer.hpp"
+
+namespace {
+
+const float PERIOD_S = 0.001f;
+const uint32_t DECIMATION = 10;   // 每10 ms回归一次
+const float FORGETTING = 0.995f;  // 约记忆200次回归 (2秒)
+const float CONVERGED_PCT = 10.0f;
+const double TAU_S = SIM_DEFAULT_TAU_MS * 1e-3;
+const double GAIN = SIM_DEFAULT_G;
+const uint32_t FULL_SCALE = 32767;
+
+double rel_error(double estimate, double truth) {
+  return fabs(estimate / truth - 1.0);
+}
+
+// --- 合成数据 ---
+
+/**
+ * @brief 精确离散模型，占空比每holdSteps个周期随机变化，测量值加高斯噪声。
+ */
+PlantEstimate run_synthetic(double tauS, double gain, double noise, int steps, int holdSteps, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> dutyDist(-0.3, 0.3);
+  std::normal_distribution<double> noiseDist(0.0, noise > 0.0 ? noise : 1.0);
+  double a = exp(-PERIOD_S / tauS), b = gain * (1.0 - a);
+  PlantIdentifier ident(PERIOD_S, DECIMATION, FORGETTING, CONVERGED_PCT);
+  ident.reset(TAU_S, GAIN);
+  double omega = 0.0, duty = 0.0;
+  for (int k = 0; k < steps; k++) {
+    if (k % holdSteps == 0) duty = dutyDist(rng);
+    double measured = omega + (noise > 0.0 ? noiseDist(rng) : 0.0);
+    ident.update((float)duty, (float)measured);
+    omega = a * omega + b * duty;
+  }
+  return ident.estimate();
+}
+
+void test_synthetic() {
+  printf("synthetic (1 kHz, random duty held 50 ms):\n");
+  struct {
+    double tauS, gain, noise;
+  } cases[] = {{0.0302, 50.01, 0.0}, {0.045, 38.0, 0.0}, {0.0302, 50.01, 0.05}, {0.020, 60.0, 0.2}};
+  for (const auto &c : cases) {
+    PlantEstimate e = run_synthetic(c.tauS, c.gain, c.noise, 20000, 50, 7);
+    double tauErr = rel_error(e.tauMs * 1e-3, c.tauS), gainErr = rel_error(e.gain, c.gain);
+    printf("  true tau %5.1f ms G %5.2f noise %.2f: tau %6.2f ms (+-%.2f%%) G %6.2f (+-%.2f%%), residual %.3f, "
+           "%u updates%s\n", c.tauS * 1e3, c.gain, c.noise, e.tauMs, e.tauErrPct, e.gain, e.gainErrPct,
+           e.residualRms, (unsigned)e.updates, e.converged ? ", converged" : "");
+    if (c.noise == 0.0) {
+      check("noise-free estimate", tauErr < 1e-3 && gainErr < 1e-3);
+    } else {
+      // 误差应在估计的不确定度之内 (留3倍余量)
+      check("noisy estimate within its uncertainty", tauErr * 100.0 < 3.0 * e.tauErrPct + 0.5 &&
+                                                     gainErr * 100.0 < 3.0 * e.gainErrPct + 0.5);
+    }
+    check("converged", e.converged);
+  }
+
+  // 还没有回归: 不报告标称值和0%的不确定度
+  PlantIdentifier fresh(PERIOD_S, DECIMATION, FORGETTING, CONVERGED_PCT);
+  fresh.reset(TAU_S, GAIN);
+  PlantEstimate none = fresh.estimate();
+  check("no estimate before any update", isnan(none.tauMs) && isnan(none.gain) && isnan(none.tauErrPct) &&
+                                         isnan(none.gainErrPct) && isnan(none.residualRms) && !none.converged);
+
+  // 没有激励: 匀速20秒、静止5秒，然后一个阶跃
+  PlantIdentifier ident(PERIOD_S, DECIMATION, FORGETTING, CONVERGED_PCT);
+  ident.reset(TAU_S, GAIN);
+  double a = exp(-PERIOD_S / TAU_S), b = GAIN * (1.0 - a);
+  double omega = 0.0;
+  auto run = [&](double duty, int steps) {
+    for (int k = 0; k < steps; k++) {
+      ident.update((float)duty, (float)omega);
+      omega = a * omega + b * duty;
+    }
+  };
+  run(0.2, 500);
+  run(0.1, 20000);
+  run(0.0, 5000);
+  PlantEstimate idle = ident.estimate();
+  run(0.15, 300);
+  PlantEstimate after = ident.estimate();
+  printf("  after 20 s constant speed + 5 s idle: tau %.2f ms G %.2f; after one step: tau %.2f ms G %.2f\n",
+         idle.tauMs, idle.gain, after.tauMs, after.gain);
+  check("no windup while idle", isfinite(idle.tauMs) && rel_error(idle.tauMs * 1e-3, TAU_S) < 0.01 &&
+                                rel_error(idle.gain, GAIN) < 0.01);
+  check("step after a long idle", rel_error(after.tauMs * 1e-3, TAU_S) < 0.01 && rel_error(after.gain, GAIN) < 0.01);
+}
+
+// --- 仿真被控对象 ---
+
+struct IdentSample {
+  uint32_t seq;       // 控制周期序号，不连续时重新开始配对
+  float dutyLeft;     // 上一周期施加的归一化占空比
+  float dutyRight;
+  float speedLeft;    // 本周期开始时测量的速度 (rad/s)
+  float speedRight;
+};
+
+struct PlantEstimates {
+  PlantEstimate left;
+  PlantEstimate right;
+};
+
+constexpr PiCoeffs PI_COEFFS = pi_design(SIM_DEFAULT_TAU_MS * 1e-3, SIM_DEFAULT_G, 0.010, 0.001, 32767,
+                                         PiDiscretization::ZeroOrderHold);
+
+const double DRIFT_TAU_MS = 45.0;
+const double DRIFT_GAIN = 38.0;
+const double DURATION_S = 40.0;
+
+TelemetryRing<IdentSample, 128> g_ring;
+TripleBuffer<PlantEstimates> g_estimates;
+bool g_done = false;
+
+void ident_task(void *) {
+  PlantIdentifier left(PERIOD_S, DECIMATION, FORGETTING, CONVERGED_PCT);
+  PlantIdentifier right(PERIOD_S, DECIMATION, FORGETTING, CONVERGED_PCT);
+  left.reset(TAU_S, GAIN);
+  right.reset(TAU_S, GAIN);
+  uint32_t expected = 0;
+  uint64_t t_us = sim_now_us();
+  while (!g_done) {
+    t_us += 20000;
+    sim_task_sleep_until(t_us);
+    IdentSample s;
+    while (g_ring.pop(&s)) {
+      if (s.seq != expected) {
+        left.restart();
+        right.restart();
+      }
+      expected = s.seq + 1;
+      left.update(s.dutyLeft, s.speedLeft);
+      right.update(s.dutyRight, s.speedRight);
+    }
+    g_estimates.write({left.estimate(), right.estimate()});
+  }
+}
+
+float pi_step(float reference, float measured, float *integral) {
+  const float kp = (float)PI_COEFFS.kp, ki = (float)PI_COEFFS.ki, integralMax = FULL_SCALE / ki;
+  float error = reference - measured;
+  *integral += error * PERIOD_S;
+  if (*integral > integralMax) *integral = integralMax;
+  if (*integral < -integralMax) *integral = -integralMax;
+  if (reference == 0.0f) *integral = 0.0f;
+  return kp * error + ki * (*integral);
+}
+
+float duty_of(float control) {
+  if (control > (float)FULL_SCALE) control = FULL_SCALE;
+  if (control < -(float)FULL_SCALE) control = -(float)FULL_SCALE;
+  return control / FULL_SCALE;
+}
+
+void control_task(void *) {
+  ESP32Encoder encLeft, encRight;
+  encLeft.attachFullQuad(SIM_PIN_SLA, SIM_PIN_SLB);
+  encRight.attachFullQuad(SIM_PIN_SRA, SIM_PIN_SRB);
+  encLeft.enableEdgeTimestamps();
+  encRight.enableEdgeTimestamps();
+  encLeft.clearCount();
+  encRight.clearCount();
+  MotorPwm motors(80000000, 20000, FULL_SCALE);
+  check("MotorPwm begin", motors.begin(SIM_PIN_MLF, SIM_PIN_MLB, SIM_PIN_MRF, SIM_PIN_MRB));
+  MTSpeedEstimator estLeft(SIM_DEFAULT_EDGES_PER_REV, 200000), estRight(SIM_DEFAULT_EDGES_PER_REV, 200000);
+  JerkLimitedProfile profLeft(50.0f, 1000.0f), profRight(50.0f, 1000.0f);
+  float integralLeft = 0.0f, integralRight = 0.0f;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> speedDist(-8.0f, 8.0f);
+  float targetLeft = 0.0f, targetRight = 0.0f;
+  float dutyLeft = 0.0f, dutyRight = 0.0f;
+  double worstTau = 0.0, worstGain = 0.0, sumTau = 0.0, sumGain = 0.0;
+  int compared = 0;
+  int converged = 0;
+  bool convergedAtEnd = false;
+
+  printf("plant (TAU %.1f -> %.1f ms, G %.2f -> %.2f over %.0f s), estimate vs truth each 5 s:\n",
+         SIM_DEFAULT_TAU_MS, DRIFT_TAU_MS, SIM_DEFAULT_G, DRIFT_GAIN, DURATION_S);
+  uint64_t t_us = sim_now_us();
+  const uint32_t cycles = (uint32_t)(DURATION_S * 1000.0) - 100;
+  for (uint32_t seq = 0; seq < cycles; seq++) {
+    t_us += 1000;
+    sim_task_sleep_until(t_us);
+    if (seq % 400 == 0) {
+      targetLeft = speedDist(rng);
+      targetRight = speedDist(rng);
+    }
+
+    int32_t count;
+    uint32_t edgeUs, nowUs = micros();
+    bool hasEdge = encLeft.getLastEdge(&count, &edgeUs);
+    float speedLeft = estLeft.update(hasEdge, count, edgeUs, nowUs);
+    hasEdge = encRight.getLastEdge(&count, &edgeUs);
+    float speedRight = estRight.update(hasEdge, count, edgeUs, nowUs);
+
+    float controlLeft = pi_step(profLeft.update(targetLeft, PERIOD_S), speedLeft, &integralLeft);
+    float controlRight = pi_step(profRight.update(targetRight, PERIOD_S), speedRight, &integralRight);
+    motors.write((int32_t)controlLeft, (int32_t)controlRight);
+    // M/T法的速度是上一周期内的平均值，相对本周期的占空比滞后约一个周期，所以与上一周期的占空比配对
+    // (与本周期的配对时τ偏大约5%)
+    g_ring.push({seq, dutyLeft, dutyRight, speedLeft, speedRight});
+    dutyLeft = duty_of(controlLeft);
+    dutyRight = duty_of(controlRight);
+
+    if (seq > 0 && seq % 1000 == 0 && seq >= 5000) {
+      double tauMs, gain;
+      sim_plant_params(&tauMs, &gain);
+      PlantEstimates e;
+      g_estimates.read(&e);
+      for (const PlantEstimate *w : {&e.left, &e.right}) {
+        double tauErr = rel_error(w->tauMs, tauMs), gainErr = rel_error(w->gain, gain);
+        worstTau = fmax(worstTau, tauErr);
+        worstGain = fmax(worstGain, gainErr);
+        sumTau += tauErr;
+        sumGain += gainErr;
+        compared++;
+        converged += w->converged;
+      }
+      convergedAtEnd = e.left.converged && e.right.converged;
+      if (seq % 5000 == 0) {
+        printf("  t %4.1f s  truth tau %5.2f ms G %5.2f | left %5.2f ms %5.2f (+-%.1f%%/%.1f%%) | "
+               "right %5.2f ms %5.2f%s\n", seq * 1e-3, tauMs, gain, e.left.tauMs, e.left.gain, e.left.tauErrPct,
+               e.left.gainErrPct, e.right.tauMs, e.right.gain,
+               e.left.converged && e.right.converged ? "  converged" : "");
+      }
+    }
+  }
+  motors.write(0, 0);
+  g_done = true;
+
+  printf("  tau error mean %.2f%% max %.2f%%, G error mean %.2f%% max %.2f%%, converged %d/%d, "
+         "%u samples dropped\n", 100.0 * sumTau / compared, 100.0 * worstTau, 100.0 * sumGain / compared,
+         100.0 * worstGain, converged, compared, (unsigned)g_ring.dropped());
+  // 记忆2秒，漂移时估计值滞后约2秒 (τ约2%，G约1.5%)
+  check("tau tracks the drift", worstTau < 0.15 && sumTau / compared < 0.05);
+  check("G tracks the drift", worstGain < 0.10 && sumGain / compared < 0.05);
+  check("converged after warm-up", convergedAtEnd && converged >= compared * 9 / 10);
+  check("no samples dropped", g_ring.dropped() == 0);
+}
+
+// --- 耗时 ---
+
+void bench_costs() {
+  TelemetryRing<IdentSample, 128> ring;
+  const int n = 10000000;
+  IdentSample s = {};
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    s.seq = i;
+    s.dutyLeft = (float)(i & 7);
+    ring.push(s);
+    if ((i & 63) == 63) {
+      while (ring.pop(&s)) {
+      }
+    }
+  }
+  double pushS = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  PlantIdentifier ident(PERIOD_S, DECIMATION, FORGETTING, CONVERGED_PCT);
+  ident.reset(TAU_S, GAIN);
+  const int m = 5000000;
+  t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < m; i++) {
+    ident.update((i & 0x100) ? 0.2f : -0.2f, (float)((i & 0x1ff) - 256) * 0.01f);
+  }
+  double updateS = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  printf("cost: push+pop %.1f ns per sample (control task pays the push), RLS %.1f ns per sample (tau %.2f ms)\n",
+         pushS * 1e9 / n, updateS * 1e9 / m, ident.estimate().tauMs);
+}
+
+} // namespace
+
+int main() {
+  test_synthetic();
+
+  sim_config cfg = {};
+  cfg.tau_ms = SIM_DEFAULT_TAU_MS;
+  cfg.gain = SIM_DEFAULT_G;
+  cfg.edges_per_rev = SIM_DEFAULT_EDGES_PER_REV;
+  cfg.duration_s = DURATION_S;
+  cfg.tau_end_ms = DRIFT_TAU_MS;
+  cfg.gain_end = DRIFT_GAIN;
+  cfg.quiet = true;
+  sim_init(cfg);
+  sim_task_create(control_task, "control", nullptr, 10);
+  sim_task_create(ident_task, "ident", nullptr, 1);
+  sim_run();
+
+  bench_costs();
+  return checks_summary();
+}
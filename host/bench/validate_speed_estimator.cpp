@@ -0,0 +1,136 @@
+/*
+ * validate_speed_estimator.cpp - M/T法测速与固定周期数边沿的对比验证
+ *
+ * **中文注释:**
+ * 用一个仿真编码器 (1320边沿/转，1微秒步长积分转角) 产生边沿，
+ * 边沿位置带有正交相位误差 (A/B两相不是精确的90°，见QUAD_ERROR)，
+ * 每个控制周期 (默认50毫秒与1毫秒各运行一次) 分别用两种方法估计速度:
+ *   - M法: ΔN / T (Remote.ino中calculateAngularVelocity()的做法)
+ *   - M/T法: MTSpeedEstimator (边沿计数值 + 边沿时间戳)
+ * 与该时刻的真实速度比较，统计均方根误差和最大误差。
+ * 恒速工况下M/T法的误差必须小于M法，否则返回1。
+ *
+ * 用法: ./build/validate_speed_estimator [控制周期ms, 默认50和1]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "speed_estimator.hpp"
+
+namespace {
+
+const int EDGES_PER_REV = 11 * 30 * 4;
+const double COUNTS_PER_RAD = EDGES_PER_REV / (2.0 * M_PI);
+const uint32_t TIMEOUT_US = 200000;
+// 四个相邻边沿相对理想位置的偏移 (边沿间距的比例)
+const double QUAD_ERROR[4] = {0.0, 0.08, 0.0, -0.08};
+
+struct Profile {
+  const char *name;
+  double duration_s;
+  bool steady;               // 恒速工况 (用于判定)
+  double (*speed)(double t); // 真实角速度 (rad/s)
+};
+
+double p_crawl(double) { return 0.3; }
+double p_cruise(double) { return 2.5; }
+double p_fast(double) { return 30.0; }
+double p_ramp(double t) { return t < 2.0 ? 5.0 * t : 10.0; }
+double p_step(double t) { return t < 0.5 ? 0.0 : 2.5 * (1.0 - exp(-(t - 0.5) / 0.0302)); }
+double p_reverse(double t) { return 2.0 * sin(2.0 * M_PI * t); }
+
+const Profile PROFILES[] = {
+  {"crawl 0.3 rad/s", 3.0, true, p_crawl},
+  {"cruise 2.5 rad/s", 3.0, true, p_cruise},
+  {"fast 30 rad/s", 3.0, true, p_fast},
+  {"ramp 0->10 rad/s", 3.0, false, p_ramp},
+  {"step 0->2.5 (tau 30ms)", 2.0, false, p_step},
+  {"sine 2 rad/s 1 Hz", 3.0, false, p_reverse},
+};
+
+/**
+ * @brief 带相位误差的计数值: 转角theta处已经过的边沿数。
+ */
+int32_t count_at(double theta) {
+  double x = theta * COUNTS_PER_RAD;
+  double k = floor(x);
+  int idx = ((int64_t)k % 4 + 4) % 4;
+  // 第k个边沿实际位于 k + QUAD_ERROR[k%4]
+  return (int32_t)(x - k >= QUAD_ERROR[idx] ? k : k - 1);
+}
+
+struct Stats {
+  double sum_sq = 0.0;
+  double max_abs = 0.0;
+  int n = 0;
+  void add(double err) {
+    sum_sq += err * err;
+    if (fabs(err) > max_abs) max_abs = fabs(err);
+    n++;
+  }
+  double rms() const { return n > 0 ? sqrt(sum_sq / n) : 0.0; }
+};
+
+/**
+ * @brief 以一个控制周期运行所有工况，恒速工况下M/T法不优于M法时返回false。
+ */
+bool validate(int period_ms) {
+  uint32_t period_us = (uint32_t)period_ms * 1000;
+  bool ok = true;
+
+  printf("control period %d ms, %d edges/rev, M resolution %.4f rad/s\n",
+         period_ms, EDGES_PER_REV, 2.0 * M_PI / EDGES_PER_REV / (period_ms / 1000.0));
+  printf("%-24s %12s %12s %12s %12s\n", "profile", "M rms", "M max", "M/T rms", "M/T max");
+
+  for (const Profile &p : PROFILES) {
+    MTSpeedEstimator mt(EDGES_PER_REV, TIMEOUT_US);
+    Stats m_stats, mt_stats;
+    double theta = 0.0;
+    int32_t count = count_at(theta);
+    int32_t edge_count = count;
+    uint32_t edge_us = 0;
+    bool has_edge = false;
+    int32_t last_period_count = count;
+    uint32_t end_us = (uint32_t)(p.duration_s * 1e6);
+
+    for (uint32_t t_us = 1; t_us <= end_us; t_us++) {
+      theta += p.speed(t_us * 1e-6) * 1e-6;
+      int32_t c = count_at(theta);
+      if (c != count) {
+        // 边沿中断: 记录计数值与时刻
+        count = c;
+        edge_count = c;
+        edge_us = t_us;
+        has_edge = true;
+      }
+      if (t_us % period_us != 0) continue;
+
+      double truth = p.speed(t_us * 1e-6);
+      double m = (count - last_period_count) / COUNTS_PER_RAD / (period_us * 1e-6);
+      last_period_count = count;
+      double v = mt.update(has_edge, edge_count, edge_us, t_us);
+      if (t_us < 2 * period_us) continue; // M/T需要两个周期建立起点
+      m_stats.add(m - truth);
+      mt_stats.add(v - truth);
+    }
+
+    printf("%-24s %12.4f %12.4f %12.4f %12.4f\n", p.name,
+           m_stats.rms(), m_stats.max_abs, mt_stats.rms(), mt_stats.max_abs);
+    if (p.steady && mt_stats.rms() >= m_stats.rms()) {
+      printf("FAIL: M/T is not better than M on %s\n", p.name);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1) return validate(atoi(argv[1])) ? 0 : 1;
+  bool ok = validate(50);
+  ok &= validate(1);  // 1 kHz: 大多数周期内没有新边沿
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+/*
+ * Arduino.h - Arduino-ESP32核心API的主机替代实现
+ *
+ * **中文注释:**
+ * 这个头文件只提供草图实际用到的Arduino API子集，并把它们映射到主机仿真内核:
+ *   - ledcAttach/ledcWrite/analogWrite -> 仿真PWM, 驱动被控对象
+ *   - digitalRead/attachInterrupt      -> 仿真编码器引脚电平与中断
+ *   - millis/micros/delay              -> 仿真时钟
+ *   - timerBegin/timerAlarm            -> 仿真调度器分发的定时器中断
+ *   - Serial                           -> 标准输出
+ */
+
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+//- 常量与宏 ----------------------------
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#ifndef BIT
+#define BIT(nr) (1UL << (nr))
+#endif
+
+#define digitalPinToInterrupt(p) (p)
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+//- String ----------------------------
+/**
+ * @class String
+ * @brief Arduino String的最小替代实现 (基于std::string)。
+ */
+class String {
+public:
+  String() {}
+  String(const char *s) : s_(s != nullptr ? s : "") {}
+  String(const std::string &s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(int v) : s_(std::to_string(v)) {}
+  explicit String(unsigned int v) : s_(std::to_string(v)) {}
+  explicit String(long v) : s_(std::to_string(v)) {}
+  explicit String(unsigned long v) : s_(std::to_string(v)) {}
+  explicit String(float v, unsigned int decimals = 2);
+  explicit String(double v, unsigned int decimals = 2);
+
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  const char *c_str() const { return s_.c_str(); }
+  char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const char *s, unsigned int from = 0) const;
+  int indexOf(const String &s, unsigned int from = 0) const { return indexOf(s.c_str(), from); }
+  bool startsWith(const String &prefix) const { return s_.compare(0, prefix.s_.size(), prefix.s_) == 0; }
+  String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const;
+  int toInt() const { return atoi(s_.c_str()); }
+  float toFloat() const { return (float)atof(s_.c_str()); }
+
+  String &operator+=(const String &rhs) { s_ += rhs.s_; return *this; }
+  String &operator+=(const char *rhs) { if (rhs != nullptr) s_ += rhs; return *this; }
+  String &operator+=(char c) { s_ += c; return *this; }
+  String &operator+=(int v) { s_ += std::to_string(v); return *this; }
+  String &operator+=(unsigned int v) { s_ += std::to_string(v); return *this; }
+  String &operator+=(long v) { s_ += std::to_string(v); return *this; }
+  String &operator+=(unsigned long v) { s_ += std::to_string(v); return *this; }
+
+  bool operator==(const String &rhs) const { return s_ == rhs.s_; }
+  bool operator==(const char *rhs) const { return rhs != nullptr && s_ == rhs; }
+  bool operator!=(const String &rhs) const { return s_ != rhs.s_; }
+
+  friend String operator+(const String &lhs, const String &rhs) { return String(lhs.s_ + rhs.s_); }
+  friend String operator+(const String &lhs, const char *rhs) { String r(lhs); r += rhs; return r; }
+  friend String operator+(const char *lhs, const String &rhs) { String r(lhs); r += rhs; return r; }
+
+private:
+  std::string s_;
+};
+
+//- Print / Serial ----------------------------
+class Print;
+
+/**
+ * @class Printable
+ * @brief 可以被Print输出的对象 (例如IPAddress)。
+ */
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print &p) const = 0;
+};
+
+/**
+ * @class Print
+ * @brief Arduino Print类的替代实现，所有输出最终落到write()。
+ */
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size);
+  size_t write(const char *s) { return s != nullptr ? write((const uint8_t *)s, strlen(s)) : 0; }
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC);
+  size_t print(unsigned long v, int base = DEC);
+  size_t print(long long v, int base = DEC);
+  size_t print(unsigned long long v, int base = DEC);
+  size_t print(double v, int digits = 2);
+  size_t print(const Printable &p) { return p.printTo(*this); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T &v) { size_t n = print(v); return n + println(); }
+  template <typename T>
+  size_t println(const T &v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+/**
+ * @class HardwareSerial
+ * @brief 串口替代实现，输出到主机的标准输出。
+ *
+ * 按波特率模拟发送时间: 128字节的硬件发送FIFO按每字节10位的速度排空，
+ * FIFO满时write()阻塞调用任务 (仿真时间前进)，与Arduino-ESP32默认不分配
+ * 发送环形缓冲区时uart_write_bytes()的行为一致。
+ */
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long baud);
+  void end() {}
+  int available() { return 0; }
+  int read() { return -1; }
+  void flush();
+  operator bool() const { return true; }
+
+  using Print::write;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+};
+
+extern HardwareSerial Serial;
+
+//- 芯片 ----------------------------
+/**
+ * @class EspClass
+ * @brief ESP对象的替代实现 (只有周期计数器与CPU频率)。
+ *
+ * ESP32上getCycleCount()读取CPU的CCOUNT寄存器; 主机上返回TSC的低32位 (非x86为纳秒)，
+ * 与仿真时间无关，只能用于同一程序中不同实现之间的相对比较。
+ * getCpuFreqMHz()返回计数器的频率 (主机上第一次调用时对照steady_clock测得)，
+ * 用于把周期数换算为时间。
+ */
+class EspClass {
+public:
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz();
+};
+
+extern EspClass ESP;
+
+//- 时间 ----------------------------
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+//- GPIO ----------------------------
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+//- PWM (LEDC) ----------------------------
+bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t resolution);
+bool ledcWrite(uint8_t pin, uint32_t duty);
+bool ledcDetach(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+//- 硬件定时器 (Arduino-ESP32 3.x, GPTimer) ----------------------------
+/**
+ * 计数器在timerBegin()时开始计数，timerAlarm()设置到期计数值; 到期时由仿真调度器
+ * 调用中断函数 (见sim_timer_arm)。reload_count被忽略 (总是无限次重装)。
+ */
+struct hw_timer_s;
+typedef struct hw_timer_s hw_timer_t;
+
+hw_timer_t *timerBegin(uint32_t frequency);
+void timerEnd(hw_timer_t *timer);
+void timerAttachInterrupt(hw_timer_t *timer, void (*userFunc)(void));
+void timerAttachInterruptArg(hw_timer_t *timer, void (*userFunc)(void *), void *arg);
+void timerAlarm(hw_timer_t *timer, uint64_t alarm_value, bool autoreload, uint64_t reload_count);
+
+//- 草图入口 ----------------------------
+void setup();
+void loop();
+
+#endif /* HOST_ARDUINO_H_ */
@@ -0,0 +1,96 @@
+/*
+ * WiFi.h - Arduino-ESP32 WiFi库的主机替代实现
+ *
+ * **中文注释:**
+ * WiFiServer/WiFiClient基于POSIX非阻塞套接字实现，行为与ESP32上的lwIP套接字一致:
+ * available()/read()从不阻塞，accept只返回已经完成握手的连接。
+ * WiFiServer(port)在主机上监听 port + --port-offset (默认8000，即80 -> 8080)，
+ * 配合仿真的--realtime选项，可以用浏览器或负载生成器访问草图中的服务器。
+ */
+
+#ifndef HOST_WIFI_H_
+#define HOST_WIFI_H_
+
+#include <Arduino.h>
+
+#include <memory>
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3,
+} wifi_mode_t;
+
+/**
+ * @class IPAddress
+ * @brief IPv4地址。
+ */
+class IPAddress : public Printable {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : bytes_{a, b, c, d} {}
+  uint8_t operator[](int index) const { return bytes_[index]; }
+  String toString() const;
+  size_t printTo(Print &p) const override;
+
+private:
+  uint8_t bytes_[4];
+};
+
+/**
+ * @class WiFiClient
+ * @brief TCP客户端连接。与Arduino一样，复制的对象共享同一个套接字。
+ */
+class WiFiClient : public Print {
+public:
+  WiFiClient() {}
+  explicit WiFiClient(int fd);
+
+  operator bool() { return connected(); }
+  uint8_t connected();
+  int available();
+  int read();
+  int read(uint8_t *buf, size_t size);
+  void stop();
+  void setNoDelay(bool nodelay);
+
+  using Print::write;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+
+private:
+  struct Socket;
+  std::shared_ptr<Socket> sock_;
+};
+
+/**
+ * @class WiFiServer
+ * @brief TCP服务器 (非阻塞监听套接字)。
+ */
+class WiFiServer {
+public:
+  explicit WiFiServer(uint16_t port) : port_(port), fd_(-1) {}
+  void begin();
+  void end();
+  WiFiClient available();
+  WiFiClient accept() { return available(); }
+
+private:
+  uint16_t port_;
+  int fd_;
+};
+
+/**
+ * @class WiFiClass
+ * @brief WiFi全局对象 (接入点模式)。
+ */
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) { (void)m; return true; }
+  bool softAP(const char *ssid, const char *passphrase = nullptr) { (void)ssid; (void)passphrase; return true; }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+};
+
+extern WiFiClass WiFi;
+
+#endif /* HOST_WIFI_H_ */
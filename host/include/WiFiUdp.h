@@ -0,0 +1,55 @@
+/*
+ * WiFiUdp.h - Arduino-ESP32 WiFiUDP类的主机替代实现
+ *
+ * **中文注释:**
+ * 基于POSIX非阻塞UDP套接字。与ESP32上一样，parsePacket()不阻塞，
+ * 取出下一个数据报后通过read()读取内容; 未读完的部分在下一次parsePacket()时丢弃。
+ * begin(port)在主机上绑定 port + --port-offset，与WiFiServer一致。
+ */
+
+#ifndef HOST_WIFI_UDP_H_
+#define HOST_WIFI_UDP_H_
+
+#include <WiFi.h>
+
+#define WIFI_UDP_MAX_PACKET 1472 // 单个数据报的最大长度 (以太网MTU减去IP/UDP头)
+
+/**
+ * @class WiFiUDP
+ * @brief UDP套接字。
+ */
+class WiFiUDP : public Print {
+public:
+  WiFiUDP() : fd_(-1), rxLen_(0), rxPos_(0), txLen_(0), remotePort_(0) {}
+  ~WiFiUDP() { stop(); }
+
+  uint8_t begin(uint16_t port);
+  void stop();
+
+  int parsePacket();
+  int available() { return (int)(rxLen_ - rxPos_); }
+  int read();
+  int read(uint8_t *buf, size_t size);
+  IPAddress remoteIP() { return remoteIP_; }
+  uint16_t remotePort() { return remotePort_; }
+
+  int beginPacket(IPAddress ip, uint16_t port);
+  int endPacket();
+  using Print::write;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override;
+
+private:
+  int fd_;
+  size_t rxLen_;
+  size_t rxPos_;
+  size_t txLen_;
+  IPAddress remoteIP_;
+  uint16_t remotePort_;
+  IPAddress txIP_;
+  uint16_t txPort_;
+  uint8_t rx_[WIFI_UDP_MAX_PACKET];
+  uint8_t tx_[WIFI_UDP_MAX_PACKET];
+};
+
+#endif /* HOST_WIFI_UDP_H_ */
@@ -0,0 +1,31 @@
+/*
+ * gpio.h - ESP-IDF GPIO驱动的主机替代实现
+ *
+ * **中文注释:**
+ * 仿真中编码器引脚的电平由被控对象模型决定，这里的配置函数只做记录。
+ */
+
+#ifndef HOST_DRIVER_GPIO_H_
+#define HOST_DRIVER_GPIO_H_
+
+#include "esp_err.h"
+
+typedef enum {
+  GPIO_NUM_NC = -1,
+  GPIO_NUM_0 = 0,
+  GPIO_NUM_MAX = 40,
+} gpio_num_t;
+
+typedef enum {
+  GPIO_MODE_DISABLE = 0,
+  GPIO_MODE_INPUT = 1,
+  GPIO_MODE_OUTPUT = 2,
+  GPIO_MODE_INPUT_OUTPUT = 3,
+} gpio_mode_t;
+
+static inline esp_err_t gpio_reset_pin(gpio_num_t gpio_num) { (void)gpio_num; return ESP_OK; }
+static inline esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) { (void)gpio_num; (void)mode; return ESP_OK; }
+static inline esp_err_t gpio_pullup_en(gpio_num_t gpio_num) { (void)gpio_num; return ESP_OK; }
+static inline esp_err_t gpio_pulldown_en(gpio_num_t gpio_num) { (void)gpio_num; return ESP_OK; }
+
+#endif /* HOST_DRIVER_GPIO_H_ */
@@ -0,0 +1,86 @@
+/*
+ * pcnt.h - ESP-IDF脉冲计数器(PCNT)驱动的主机替代实现
+ *
+ * **中文注释:**
+ * 仿真PCNT按照ESP32硬件的规则计数: 脉冲输入的上升/下降沿选择pos_mode/neg_mode，
+ * 控制输入的低/高电平再用lctrl_mode/hctrl_mode修饰 (保持/反向/禁止)。
+ * 16位计数器到达counter_h_lim或counter_l_lim时清零、锁存状态并触发已注册的中断。
+ */
+
+#ifndef HOST_DRIVER_PCNT_H_
+#define HOST_DRIVER_PCNT_H_
+
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+typedef enum {
+  PCNT_UNIT_0 = 0,
+  PCNT_UNIT_1,
+  PCNT_UNIT_2,
+  PCNT_UNIT_3,
+  PCNT_UNIT_4,
+  PCNT_UNIT_5,
+  PCNT_UNIT_6,
+  PCNT_UNIT_7,
+  PCNT_UNIT_MAX,
+} pcnt_unit_t;
+
+typedef enum {
+  PCNT_CHANNEL_0 = 0,
+  PCNT_CHANNEL_1,
+  PCNT_CHANNEL_MAX,
+} pcnt_channel_t;
+
+typedef enum {
+  PCNT_COUNT_DIS = 0, // 不计数
+  PCNT_COUNT_INC,     // 计数加一
+  PCNT_COUNT_DEC,     // 计数减一
+} pcnt_count_mode_t;
+
+typedef enum {
+  PCNT_MODE_KEEP = 0, // 保持计数方向
+  PCNT_MODE_REVERSE,  // 反转计数方向
+  PCNT_MODE_DISABLE,  // 禁止计数
+} pcnt_ctrl_mode_t;
+
+typedef enum {
+  PCNT_EVT_THRES_1 = 0x04,
+  PCNT_EVT_THRES_0 = 0x08,
+  PCNT_EVT_L_LIM = 0x10,
+  PCNT_EVT_H_LIM = 0x20,
+  PCNT_EVT_ZERO = 0x40,
+} pcnt_evt_type_t;
+
+typedef struct {
+  int pulse_gpio_num;
+  int ctrl_gpio_num;
+  pcnt_ctrl_mode_t lctrl_mode;
+  pcnt_ctrl_mode_t hctrl_mode;
+  pcnt_count_mode_t pos_mode;
+  pcnt_count_mode_t neg_mode;
+  int16_t counter_h_lim;
+  int16_t counter_l_lim;
+  pcnt_unit_t unit;
+  pcnt_channel_t channel;
+} pcnt_config_t;
+
+typedef void *pcnt_isr_handle_t;
+
+esp_err_t pcnt_unit_config(const pcnt_config_t *pcnt_config);
+esp_err_t pcnt_get_counter_value(pcnt_unit_t pcnt_unit, int16_t *count);
+esp_err_t pcnt_counter_pause(pcnt_unit_t pcnt_unit);
+esp_err_t pcnt_counter_resume(pcnt_unit_t pcnt_unit);
+esp_err_t pcnt_counter_clear(pcnt_unit_t pcnt_unit);
+esp_err_t pcnt_intr_enable(pcnt_unit_t pcnt_unit);
+esp_err_t pcnt_intr_disable(pcnt_unit_t pcnt_unit);
+esp_err_t pcnt_event_enable(pcnt_unit_t unit, pcnt_evt_type_t evt_type);
+esp_err_t pcnt_event_disable(pcnt_unit_t unit, pcnt_evt_type_t evt_type);
+esp_err_t pcnt_set_filter_value(pcnt_unit_t unit, uint16_t filter_val);
+esp_err_t pcnt_filter_enable(pcnt_unit_t unit);
+esp_err_t pcnt_filter_disable(pcnt_unit_t unit);
+esp_err_t pcnt_isr_register(void (*fn)(void *), void *arg, int intr_alloc_flags,
+                            pcnt_isr_handle_t *handle);
+
+#endif /* HOST_DRIVER_PCNT_H_ */
@@ -0,0 +1,15 @@
+/*
+ * esp_err.h - ESP-IDF错误码的主机替代实现
+ */
+
+#ifndef HOST_ESP_ERR_H_
+#define HOST_ESP_ERR_H_
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+
+#endif /* HOST_ESP_ERR_H_ */
@@ -0,0 +1,15 @@
+/*
+ * esp_timer.h - ESP-IDF高精度定时器的主机替代实现
+ *
+ * **中文注释:**
+ * 只提供esp_timer_get_time()，返回仿真时钟 (微秒)，与micros()相同但不回绕。
+ */
+
+#ifndef HOST_ESP_TIMER_H_
+#define HOST_ESP_TIMER_H_
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
+
+#endif /* HOST_ESP_TIMER_H_ */
@@ -0,0 +1,47 @@
+/*
+ * FreeRTOS.h - FreeRTOS核心类型与宏的主机替代实现
+ *
+ * **中文注释:**
+ * 仿真中的任务由协作式调度器驱动 (见host/sim/sim_sched.cpp)，任意时刻只有
+ * 一个任务在执行，中断也只在没有任务运行时分发，因此临界区宏不需要真正加锁。
+ */
+
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS (pdTRUE)
+#define pdFAIL (pdFALSE)
+
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+
+// 中断中唤醒了更高优先级的任务时请求切换; 仿真中断在任务之间分发，不需要切换
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+//- 临界区 ----------------------------
+typedef struct {
+  uint32_t owner;
+  uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+
+#endif /* HOST_FREERTOS_H_ */
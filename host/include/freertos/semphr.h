@@ -0,0 +1,20 @@
+/*
+ * semphr.h - FreeRTOS信号量API的主机替代实现
+ *
+ * **中文注释:**
+ * 只提供互斥量。仿真中的任务只在阻塞调用处让出执行权，因此持有互斥量的任务
+ * 只有在临界区内延时时才可能被其他任务看到"已占用"，此时等待者按tick轮询。
+ */
+
+#ifndef HOST_FREERTOS_SEMPHR_H_
+#define HOST_FREERTOS_SEMPHR_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+
+#endif /* HOST_FREERTOS_SEMPHR_H_ */
@@ -0,0 +1,8 @@
+/*
+ * sdkconfig.h - ESP-IDF配置头文件的主机替代 (空)
+ */
+
+#ifndef HOST_SDKCONFIG_H_
+#define HOST_SDKCONFIG_H_
+
+#endif /* HOST_SDKCONFIG_H_ */
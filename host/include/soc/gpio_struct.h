@@ -0,0 +1,28 @@
+/*
+ * gpio_struct.h - GPIO寄存器结构体的主机替代实现
+ *
+ * **中文注释:**
+ * 只保留输入电平寄存器: in对应GPIO0-31，in1.data对应GPIO32-39。
+ * 仿真编码器每次改变引脚电平时同步更新这两个寄存器，
+ * 然后才分发中断，中断处理函数读到的总是边沿之后的电平。
+ */
+
+#ifndef HOST_SOC_GPIO_STRUCT_H_
+#define HOST_SOC_GPIO_STRUCT_H_
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t in;
+  union {
+    struct {
+      uint32_t data : 8;
+      uint32_t reserved8 : 24;
+    };
+    uint32_t val;
+  } in1;
+} gpio_dev_t;
+
+extern volatile gpio_dev_t GPIO;
+
+#endif /* HOST_SOC_GPIO_STRUCT_H_ */
@@ -0,0 +1,42 @@
+/*
+ * pcnt_struct.h - PCNT寄存器结构体的主机替代实现
+ *
+ * **中文注释:**
+ * 只保留ESP32Encoder直接访问的字段。仿真PCNT在调用中断处理函数前
+ * 设置int_st和status_unit的锁存位，返回后根据int_clr清除它们;
+ * cnt_unit随计数器的每次变化同步更新。
+ */
+
+#ifndef HOST_SOC_PCNT_STRUCT_H_
+#define HOST_SOC_PCNT_STRUCT_H_
+
+#include <stdint.h>
+
+typedef struct {
+  union {
+    struct {
+      uint32_t cnt_val : 16;
+      uint32_t reserved16 : 16;
+    };
+    uint32_t val;
+  } cnt_unit[8];
+  struct {
+    uint32_t cnt_mode : 2;
+    uint32_t thres1_lat : 1;
+    uint32_t thres0_lat : 1;
+    uint32_t l_lim_lat : 1;
+    uint32_t h_lim_lat : 1;
+    uint32_t zero_lat : 1;
+    uint32_t reserved7 : 25;
+  } status_unit[8];
+  union {
+    uint32_t val;
+  } int_st;
+  union {
+    uint32_t val;
+  } int_clr;
+} pcnt_dev_t;
+
+extern volatile pcnt_dev_t PCNT;
+
+#endif /* HOST_SOC_PCNT_STRUCT_H_ */
@@ -0,0 +1,300 @@
+/*
+ * sim_arduino.cpp - Arduino核心API的主机替代实现
+ *
+ * **中文注释:**
+ * 实现host/include/Arduino.h中声明的函数，全部基于仿真内核。
+ */
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "sim_core.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+//- String ----------------------------
+
+String::String(float v, unsigned int decimals) : String((double)v, decimals) {}
+
+String::String(double v, unsigned int decimals) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+  s_ = buf;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t pos = s_.find(c, from);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const char *s, unsigned int from) const {
+  size_t pos = s_.find(s, from);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) { unsigned int t = from; from = to; to = t; }
+  if (from >= s_.size()) return String();
+  return String(s_.substr(from, to - from));
+}
+
+//- Print ----------------------------
+
+size_t Print::write(const uint8_t *buf, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buf++);
+  return n;
+}
+
+size_t Print::print(long v, int base) {
+  if (base == DEC) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%ld", v);
+    return write(buf);
+  }
+  return print((unsigned long)v, base);
+}
+
+size_t Print::print(unsigned long v, int base) {
+  return print((unsigned long long)v, base);
+}
+
+size_t Print::print(long long v, int base) {
+  if (base == DEC) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lld", v);
+    return write(buf);
+  }
+  return print((unsigned long long)v, base);
+}
+
+size_t Print::print(unsigned long long v, int base) {
+  if (base < 2) base = 10;
+  char buf[72];
+  char *p = &buf[sizeof(buf) - 1];
+  *p = '\0';
+  do {
+    unsigned d = (unsigned)(v % base);
+    *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+    v /= base;
+  } while (v != 0);
+  return write(p);
+}
+
+size_t Print::print(double v, int digits) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return write(buf);
+}
+
+size_t Print::printf(const char *fmt, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len < 0) return 0;
+  if ((size_t)len >= sizeof(buf)) len = sizeof(buf) - 1;
+  return write((const uint8_t *)buf, (size_t)len);
+}
+
+//- HardwareSerial ----------------------------
+
+namespace {
+
+const uint64_t UART_FIFO_SIZE = 128;
+
+uint64_t g_uart_byte_us = 87;    // 115200波特，每字节10位
+uint64_t g_uart_idle_us = 0;     // 发送FIFO排空的时刻
+
+/**
+ * @brief 把n个字节放入发送FIFO，FIFO满时阻塞当前任务。
+ */
+void uart_transmit(size_t n) {
+  while (n > 0) {
+    uint64_t now = sim_now_us();
+    if (g_uart_idle_us < now) g_uart_idle_us = now;
+    uint64_t queued = (g_uart_idle_us - now + g_uart_byte_us - 1) / g_uart_byte_us;
+    if (queued >= UART_FIFO_SIZE) {
+      if (sim_task_current() == nullptr) {
+        g_uart_idle_us = now; // 调度器启动前: 不计时
+        continue;
+      }
+      // 等到FIFO中腾出一个字节的位置
+      sim_task_sleep_until(g_uart_idle_us - (UART_FIFO_SIZE - 1) * g_uart_byte_us);
+      continue;
+    }
+    uint64_t room = UART_FIFO_SIZE - queued;
+    uint64_t chunk = n < room ? n : room;
+    g_uart_idle_us += chunk * g_uart_byte_us;
+    n -= (size_t)chunk;
+  }
+}
+
+} // namespace
+
+void HardwareSerial::begin(unsigned long baud) {
+  if (baud > 0) g_uart_byte_us = (10000000 + baud - 1) / baud;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (!sim_quiet()) fputc(c, stdout);
+  uart_transmit(1);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t size) {
+  if (!sim_quiet()) fwrite(buf, 1, size, stdout);
+  uart_transmit(size);
+  return size;
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+//- 芯片 ----------------------------
+
+uint32_t EspClass::getCycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+  return (uint32_t)__rdtsc();
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint32_t EspClass::getCpuFreqMHz() {
+#if defined(__x86_64__) || defined(__i386__)
+  static uint32_t mhz = 0;
+  if (mhz == 0) {
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t c0 = __rdtsc();
+    while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(10)) {
+    }
+    uint64_t c1 = __rdtsc();
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    mhz = (uint32_t)((c1 - c0) / us + 0.5);
+    if (mhz == 0) mhz = 1;
+  }
+  return mhz;
+#else
+  return 1000;
+#endif
+}
+
+//- 时间 ----------------------------
+
+unsigned long millis() {
+  return (unsigned long)(sim_now_us() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)sim_now_us();
+}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)sim_now_us();
+}
+
+void delay(uint32_t ms) {
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  sim_task_sleep_until(sim_now_us() + us);
+}
+
+//- GPIO ----------------------------
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+int digitalRead(uint8_t pin) {
+  return sim_gpio_read(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  // 数字输出等效于占空比0%或100%
+  sim_pwm_write(pin, val ? UINT32_MAX : 0);
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+  sim_gpio_attach_isr(pin, isr, mode);
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode) {
+  sim_gpio_attach_isr_arg(pin, isr, arg, mode);
+}
+
+void detachInterrupt(uint8_t pin) {
+  sim_gpio_detach_isr(pin);
+}
+
+//- PWM ----------------------------
+
+bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t resolution) {
+  sim_pwm_attach(pin, freq, resolution);
+  return true;
+}
+
+bool ledcWrite(uint8_t pin, uint32_t duty) {
+  sim_pwm_write(pin, duty);
+  return true;
+}
+
+bool ledcDetach(uint8_t pin) {
+  sim_pwm_detach(pin);
+  return true;
+}
+
+void analogWrite(uint8_t pin, int value) {
+  sim_pwm_write(pin, value < 0 ? 0 : (uint32_t)value);
+}
+
+//- 硬件定时器 ----------------------------
+
+struct hw_timer_s {
+  void *sim;           // sim_timer_create()的句柄
+  uint32_t frequency;  // 计数频率 (Hz)
+  uint64_t start_us;   // 计数器从0开始的仿真时刻
+};
+
+hw_timer_t *timerBegin(uint32_t frequency) {
+  if (frequency == 0) return nullptr;
+  hw_timer_t *timer = new hw_timer_t();
+  timer->sim = sim_timer_create();
+  timer->frequency = frequency;
+  timer->start_us = sim_now_us();
+  return timer;
+}
+
+void timerEnd(hw_timer_t *timer) {
+  if (timer == nullptr) return;
+  sim_timer_delete(timer->sim);
+  delete timer;
+}
+
+void timerAttachInterrupt(hw_timer_t *timer, void (*userFunc)(void)) {
+  if (timer != nullptr) sim_timer_attach_isr(timer->sim, userFunc);
+}
+
+void timerAttachInterruptArg(hw_timer_t *timer, void (*userFunc)(void *), void *arg) {
+  if (timer != nullptr) sim_timer_attach_isr_arg(timer->sim, userFunc, arg);
+}
+
+void timerAlarm(hw_timer_t *timer, uint64_t alarm_value, bool autoreload, uint64_t reload_count) {
+  (void)reload_count;
+  if (timer == nullptr) return;
+  uint64_t alarm_us = alarm_value * 1000000ULL / timer->frequency;
+  sim_timer_arm(timer->sim, timer->start_us + alarm_us, autoreload ? alarm_us : 0);
+}
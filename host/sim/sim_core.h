@@ -0,0 +1,212 @@
+/*
+ * sim_core.h - 主机仿真内核接口
+ *
+ * **中文注释:**
+ * 这个头文件声明了主机(Linux)仿真环境的核心接口:
+ *   - 仿真时钟 (微秒精度，与墙钟时间无关，可以远快于实时运行)
+ *   - 协作式任务调度器 (模拟FreeRTOS任务，一次只运行一个任务)
+ *   - 一阶直流电机被控对象模型 (两个轮子)，并生成正交编码器边沿
+ *   - GPIO电平与中断分发 (供attachInterrupt和PCNT仿真使用)
+ *
+ * Arduino/FreeRTOS/ESP-IDF的替代头文件(host/include/)都基于这里的接口实现。
+ */
+
+#ifndef SIM_CORE_H_
+#define SIM_CORE_H_
+
+#include <stdint.h>
+
+//- 机器人板级接线 (与各个草图中的引脚定义一致) ----------------------------
+#define SIM_PIN_MLF 26 // 左侧电机前进
+#define SIM_PIN_MLB 25 // 左侧电机后退
+#define SIM_PIN_MRF 33 // 右侧电机前进
+#define SIM_PIN_MRB 32 // 右侧电机后退
+#define SIM_PIN_SLA 14 // 左侧编码器A相
+#define SIM_PIN_SLB 27 // 左侧编码器B相
+#define SIM_PIN_SRA 35 // 右侧编码器A相
+#define SIM_PIN_SRB 34 // 右侧编码器B相
+
+#define SIM_GPIO_COUNT 40 // ESP32的GPIO数量
+
+//- 被控对象默认参数 ----------------------------
+// 与 base_IF4_TP2-WiFi-v2024-1.ino 中的辨识结果一致:
+//   TAU: 时间常数 (毫秒)
+//   G:   静态增益 (rad/s, 对应归一化占空比 ±1)
+#define SIM_DEFAULT_TAU_MS (30.20f)
+#define SIM_DEFAULT_G (50.01f)
+// 每转边沿数 = ENCODER_PPR * GEAR_RATIO * 4 (四倍频)，与Remote.ino/BF.ino一致
+#define SIM_DEFAULT_EDGES_PER_REV (11 * 30 * 4)
+// 被控对象积分步长 (微秒)
+#define SIM_PLANT_STEP_US 50
+
+enum sim_wheel {
+  SIM_WHEEL_LEFT = 0,
+  SIM_WHEEL_RIGHT = 1,
+  SIM_WHEEL_COUNT
+};
+
+/**
+ * @struct sim_config
+ * @brief 仿真参数，由命令行解析后传给sim_init()。
+ */
+struct sim_config {
+  double tau_ms;           // 电机时间常数 (毫秒)
+  double gain;             // 电机静态增益 (rad/s / 归一化占空比)
+  int edges_per_rev;       // 编码器每转边沿数
+  double duration_s;       // 仿真时长 (秒)，到达后结束
+  const char *trace_path;  // 轨迹CSV输出文件 (NULL表示不输出)
+  uint32_t trace_period_us;// 轨迹采样周期 (微秒)
+  bool quiet;              // 为true时不向stdout打印Serial输出
+  bool realtime;           // 为true时仿真时钟与墙钟同步 (用于与真实网络客户端交互)
+  int wifi_port_offset;    // WiFiServer(port)在主机上监听 port + offset
+  double tau_end_ms;       // 大于0时时间常数在仿真时长内从tau_ms线性漂移到此值 (毫秒)
+  double gain_end;         // 大于0时静态增益在仿真时长内从gain线性漂移到此值
+};
+
+//- 仿真时钟 ----------------------------
+
+/**
+ * @brief 获取当前仿真时间 (微秒)。
+ */
+uint64_t sim_now_us();
+
+//- 任务调度 ----------------------------
+
+/**
+ * @brief 创建一个仿真任务。
+ *
+ * 任务在独立线程中运行，但调度器保证任意时刻只有一个任务在执行，
+ * 因此任务代码不需要额外同步。任务只会在调用阻塞函数(延时、删除、挂起)时让出执行权。
+ *
+ * @return 任务句柄 (不透明指针)。
+ */
+void *sim_task_create(void (*fn)(void *), const char *name, void *arg,
+                      unsigned priority);
+
+/**
+ * @brief 阻塞当前任务直到指定的仿真时间。
+ */
+void sim_task_sleep_until(uint64_t wake_us);
+
+/**
+ * @brief 删除任务。删除当前任务时不会返回。
+ */
+void sim_task_delete(void *task);
+
+/**
+ * @brief 挂起任务。挂起当前任务时不会返回 (仿真中没有恢复者)。
+ */
+void sim_task_suspend(void *task);
+
+/**
+ * @brief 获取当前任务句柄。
+ */
+void *sim_task_current();
+
+/**
+ * @brief 给任务的通知计数加1 (xTaskNotifyGive)。任务正在等待通知时立即变为就绪。
+ */
+void sim_task_notify_give(void *task);
+
+/**
+ * @brief 等待当前任务的通知 (ulTaskNotifyTake)。
+ * @param clear 为true时返回前把计数清零，否则减1。
+ * @param timeout_us 最长等待时间 (微秒)，UINT64_MAX表示永久等待。
+ * @return 清除前的通知计数 (超时返回0)。
+ */
+uint32_t sim_task_notify_take(bool clear, uint64_t timeout_us);
+
+//- 硬件定时器 ----------------------------
+
+/**
+ * @brief 创建一个硬件定时器 (未设置到期时刻，不会触发)。
+ */
+void *sim_timer_create();
+
+/**
+ * @brief 设置定时器到期时调用的中断函数 (两种形式与GPIO中断相同，后设置的生效)。
+ */
+void sim_timer_attach_isr(void *timer, void (*isr)());
+void sim_timer_attach_isr_arg(void *timer, void (*isr)(void *), void *arg);
+
+/**
+ * @brief 设置定时器的到期时刻。
+ *
+ * 到期时调度器在没有任务运行时调用中断函数，同一时刻的中断先于任务执行。
+ *
+ * @param first_us 第一次到期的仿真时刻 (已过去时立即到期)。
+ * @param period_us 之后每次到期的间隔 (微秒)，0表示只触发一次。
+ */
+void sim_timer_arm(void *timer, uint64_t first_us, uint64_t period_us);
+
+/**
+ * @brief 停止定时器并释放 (之后不能再使用该句柄)。
+ */
+void sim_timer_delete(void *timer);
+
+//- GPIO与PWM ----------------------------
+
+void sim_pwm_attach(uint8_t pin, uint32_t freq, uint8_t resolution);
+/**
+ * @brief 绑定一个以计数值表示占空比的PWM输出 (MCPWM): duty = period_ticks时为100%。
+ */
+void sim_pwm_attach_ticks(uint8_t pin, uint32_t freq, uint32_t period_ticks);
+void sim_pwm_write(uint8_t pin, uint32_t duty);
+/**
+ * @brief 解除PWM绑定，引脚输出为0。
+ */
+void sim_pwm_detach(uint8_t pin);
+int sim_gpio_read(uint8_t pin);
+void sim_gpio_attach_isr(uint8_t pin, void (*isr)(), int mode);
+void sim_gpio_attach_isr_arg(uint8_t pin, void (*isr)(void *), void *arg, int mode);
+void sim_gpio_detach_isr(uint8_t pin);
+
+/**
+ * @brief 注册一个GPIO边沿监听器 (供PCNT仿真使用)。
+ *
+ * 每当编码器引脚发生电平变化时调用 listener(pin, level)，调用时仿真时钟已设为边沿时刻。
+ */
+void sim_gpio_add_edge_listener(void (*listener)(uint8_t pin, int level));
+
+//- 被控对象 ----------------------------
+
+/**
+ * @brief 获取车轮当前角速度 (rad/s)。
+ */
+double sim_wheel_speed(int wheel);
+
+/**
+ * @brief 获取车轮当前角位置 (rad，编码器计数为其量化值; 供验证程序计算真实位姿)。
+ */
+double sim_wheel_angle(int wheel);
+
+/**
+ * @brief 获取车轮当前归一化输入 (占空比, -1..1)。
+ */
+double sim_wheel_input(int wheel);
+
+/**
+ * @brief 获取被控对象当前的时间常数 (毫秒) 与静态增益 (参数漂移时随时间变化)。
+ */
+void sim_plant_params(double *tau_ms, double *gain);
+
+//- 运行 ----------------------------
+
+void sim_init(const sim_config &cfg);
+
+/**
+ * @brief 运行仿真直到到达设定时长或所有任务结束。
+ */
+void sim_run();
+
+/**
+ * @brief 获取当前仿真参数。
+ */
+const sim_config &sim_get_config();
+
+/**
+ * @brief Serial输出是否被屏蔽。
+ */
+bool sim_quiet();
+
+#endif /* SIM_CORE_H_ */
@@ -0,0 +1,35 @@
+/*
+ * sim_internal.h - 仿真内核内部接口
+ *
+ * **中文注释:**
+ * 仅供host/sim/下的实现文件使用，草图代码不应包含此文件。
+ */
+
+#ifndef SIM_INTERNAL_H_
+#define SIM_INTERNAL_H_
+
+#include "sim_core.h"
+
+/**
+ * @brief 设置仿真时钟 (只能向前推进)。
+ */
+void sim_set_now_us(uint64_t t_us);
+
+/**
+ * @brief 初始化被控对象、PWM和GPIO状态。
+ */
+void sim_plant_init(const sim_config &cfg);
+
+/**
+ * @brief 将被控对象积分到指定时刻，并按时间顺序分发期间产生的编码器边沿。
+ *
+ * 只能在没有任务运行时由调度器调用。
+ */
+void sim_plant_advance_to(uint64_t t_us);
+
+/**
+ * @brief 关闭轨迹文件等资源。
+ */
+void sim_plant_finish();
+
+#endif /* SIM_INTERNAL_H_ */
@@ -0,0 +1,115 @@
+/*
+ * sim_main.cpp - 主机仿真程序入口
+ *
+ * **中文注释:**
+ * 模拟Arduino-ESP32的启动流程: 创建loopTask运行setup()，之后循环调用loop()。
+ * 然后运行调度器直到仿真时长结束或所有任务都已退出，最后在stderr打印
+ * 仿真时间与墙钟时间之比。
+ *
+ * 用法: <草图>_sim [--duration 秒] [--tau 毫秒] [--gain G] [--edges 每转边沿数]
+ *                  [--trace 文件.csv] [--trace-period 微秒] [--quiet]
+ *                  [--realtime] [--port-offset N] [--drift-tau 毫秒] [--drift-gain G]
+ *   --drift-tau / --drift-gain: 时间常数/静态增益在仿真时长内线性漂移到给定值
+ *   (模拟电池电压、负载与温度的变化，用于观察在线辨识)
+ */
+
+#include <Arduino.h>
+
+#include <chrono>
+
+#include "sim_core.h"
+
+namespace {
+
+sim_config g_cfg = {
+  SIM_DEFAULT_TAU_MS,
+  SIM_DEFAULT_G,
+  SIM_DEFAULT_EDGES_PER_REV,
+  30.0,
+  nullptr,
+  1000,
+  false,
+  false,
+  8000,
+  0.0,
+  0.0,
+};
+
+/**
+ * @brief Arduino的loopTask: 先执行setup()，再无限循环调用loop()。
+ */
+void loop_task(void *pvParameters) {
+  (void)pvParameters;
+  setup();
+  for (;;) {
+    loop();
+    // 真实的loopTask会在每次loop()之后让出CPU，这里让出1个tick
+    vTaskDelay(1);
+  }
+}
+
+void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [--duration s] [--tau ms] [--gain G] [--edges N]\n"
+          "          [--trace file.csv] [--trace-period us] [--quiet]\n"
+          "          [--realtime] [--port-offset N] [--drift-tau ms] [--drift-gain G]\n",
+          prog);
+}
+
+bool parse_args(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (strcmp(arg, "--quiet") == 0) {
+      g_cfg.quiet = true;
+    } else if (strcmp(arg, "--realtime") == 0) {
+      g_cfg.realtime = true;
+    } else if (strcmp(arg, "--port-offset") == 0 && has_value) {
+      g_cfg.wifi_port_offset = atoi(argv[++i]);
+    } else if (strcmp(arg, "--duration") == 0 && has_value) {
+      g_cfg.duration_s = atof(argv[++i]);
+    } else if (strcmp(arg, "--tau") == 0 && has_value) {
+      g_cfg.tau_ms = atof(argv[++i]);
+    } else if (strcmp(arg, "--gain") == 0 && has_value) {
+      g_cfg.gain = atof(argv[++i]);
+    } else if (strcmp(arg, "--drift-tau") == 0 && has_value) {
+      g_cfg.tau_end_ms = atof(argv[++i]);
+    } else if (strcmp(arg, "--drift-gain") == 0 && has_value) {
+      g_cfg.gain_end = atof(argv[++i]);
+    } else if (strcmp(arg, "--edges") == 0 && has_value) {
+      g_cfg.edges_per_rev = atoi(argv[++i]);
+    } else if (strcmp(arg, "--trace") == 0 && has_value) {
+      g_cfg.trace_path = argv[++i];
+    } else if (strcmp(arg, "--trace-period") == 0 && has_value) {
+      g_cfg.trace_period_us = (uint32_t)atoi(argv[++i]);
+    } else {
+      return false;
+    }
+  }
+  return g_cfg.tau_ms > 0.0 && g_cfg.duration_s > 0.0 && g_cfg.edges_per_rev > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (!parse_args(argc, argv)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  sim_init(g_cfg);
+  sim_task_create(loop_task, "loopTask", nullptr, 1);
+
+  auto start = std::chrono::steady_clock::now();
+  sim_run();
+  double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double sim_s = sim_now_us() * 1e-6;
+
+  fflush(stdout);
+  fprintf(stderr, "[SIM] %.3f s simulated in %.3f ms wall time (x%.0f)\n",
+          sim_s, wall_s * 1e3, wall_s > 0.0 ? sim_s / wall_s : 0.0);
+  fflush(stderr);
+
+  // 任务线程仍阻塞在调度器上，直接结束进程而不等待它们
+  _Exit(0);
+}
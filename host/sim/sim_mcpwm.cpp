@@ -0,0 +1,192 @@
+/*
+ * sim_mcpwm.cpp - ESP32 MCPWM (计数器/操作器/比较器/发生器) 的仿真实现
+ *
+ * **中文注释:**
+ * 每个发生器的引脚绑定为以计数值表示占空比的仿真PWM，占空比等于它的比较器的
+ * 当前比较值。影子寄存器模式 (update_cmp_on_tez) 的比较器写入后先挂起，
+ * 由一个单次仿真定时器在计数器下一次归零的时刻统一锁存，同一个计数器上的
+ * 所有比较器在同一时刻生效。
+ */
+
+#include "driver/mcpwm_prelude.h"
+
+#include "sim_core.h"
+
+#include <vector>
+
+struct mcpwm_timer_t {
+  uint32_t resolution_hz;
+  uint32_t period_ticks;
+  bool running;
+  uint64_t start_us;        // 启动时刻 (第一次归零)
+  void *latch_timer;        // 锁存影子寄存器的单次仿真定时器
+  bool latch_armed;
+  std::vector<mcpwm_cmpr_t *> comparators;
+};
+
+struct mcpwm_oper_t {
+  mcpwm_timer_t *timer;
+};
+
+struct mcpwm_cmpr_t {
+  mcpwm_oper_t *oper;
+  bool on_tez;
+  uint32_t active;   // 当前生效的比较值
+  uint32_t shadow;   // 等待锁存的比较值
+  bool pending;
+  std::vector<mcpwm_gen_t *> generators;
+};
+
+struct mcpwm_gen_t {
+  mcpwm_oper_t *oper;
+  int pin;
+};
+
+namespace {
+
+void apply(mcpwm_cmpr_t *cmpr) {
+  for (mcpwm_gen_t *gen : cmpr->generators) sim_pwm_write((uint8_t)gen->pin, cmpr->active);
+}
+
+/**
+ * @brief 计数器归零: 锁存所有挂起的比较值。
+ */
+void latch_isr(void *arg) {
+  mcpwm_timer_t *timer = static_cast<mcpwm_timer_t *>(arg);
+  timer->latch_armed = false;
+  for (mcpwm_cmpr_t *cmpr : timer->comparators) {
+    if (!cmpr->pending) continue;
+    cmpr->active = cmpr->shadow;
+    cmpr->pending = false;
+    apply(cmpr);
+  }
+}
+
+/**
+ * @brief 当前时刻之后计数器下一次归零的仿真时刻 (微秒，向上取整)。
+ */
+uint64_t next_empty_us(const mcpwm_timer_t *timer) {
+  uint64_t elapsed_ticks = (sim_now_us() - timer->start_us) * timer->resolution_hz / 1000000;
+  uint64_t k = elapsed_ticks / timer->period_ticks + 1;
+  uint64_t ticks = k * timer->period_ticks;
+  return timer->start_us + (ticks * 1000000 + timer->resolution_hz - 1) / timer->resolution_hz;
+}
+
+} // namespace
+
+esp_err_t mcpwm_new_timer(const mcpwm_timer_config_t *config, mcpwm_timer_handle_t *ret_timer) {
+  if (config == nullptr || ret_timer == nullptr || config->resolution_hz == 0 || config->period_ticks == 0 ||
+      config->period_ticks > 65535 || config->count_mode != MCPWM_TIMER_COUNT_MODE_UP) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  mcpwm_timer_t *timer = new mcpwm_timer_t();
+  timer->resolution_hz = config->resolution_hz;
+  timer->period_ticks = config->period_ticks;
+  timer->running = false;
+  timer->start_us = 0;
+  timer->latch_timer = sim_timer_create();
+  timer->latch_armed = false;
+  sim_timer_attach_isr_arg(timer->latch_timer, latch_isr, timer);
+  *ret_timer = timer;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_timer_enable(mcpwm_timer_handle_t timer) {
+  return timer != nullptr ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t mcpwm_timer_start_stop(mcpwm_timer_handle_t timer, mcpwm_timer_start_stop_cmd_t command) {
+  if (timer == nullptr) return ESP_ERR_INVALID_ARG;
+  if (command != MCPWM_TIMER_START_NO_STOP) return ESP_ERR_INVALID_ARG;
+  timer->running = true;
+  timer->start_us = sim_now_us();
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_new_operator(const mcpwm_operator_config_t *config, mcpwm_oper_handle_t *ret_oper) {
+  if (config == nullptr || ret_oper == nullptr) return ESP_ERR_INVALID_ARG;
+  mcpwm_oper_t *oper = new mcpwm_oper_t();
+  oper->timer = nullptr;
+  *ret_oper = oper;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_operator_connect_timer(mcpwm_oper_handle_t oper, mcpwm_timer_handle_t timer) {
+  if (oper == nullptr || timer == nullptr) return ESP_ERR_INVALID_ARG;
+  oper->timer = timer;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_new_comparator(mcpwm_oper_handle_t oper, const mcpwm_comparator_config_t *config,
+                               mcpwm_cmpr_handle_t *ret_cmpr) {
+  if (oper == nullptr || oper->timer == nullptr || config == nullptr || ret_cmpr == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  mcpwm_cmpr_t *cmpr = new mcpwm_cmpr_t();
+  cmpr->oper = oper;
+  cmpr->on_tez = config->flags.update_cmp_on_tez;
+  cmpr->active = 0;
+  cmpr->shadow = 0;
+  cmpr->pending = false;
+  oper->timer->comparators.push_back(cmpr);
+  *ret_cmpr = cmpr;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_comparator_set_compare_value(mcpwm_cmpr_handle_t cmpr, uint32_t cmp_ticks) {
+  if (cmpr == nullptr) return ESP_ERR_INVALID_ARG;
+  mcpwm_timer_t *timer = cmpr->oper->timer;
+  if (cmp_ticks > timer->period_ticks) return ESP_ERR_INVALID_ARG;
+  if (!cmpr->on_tez || !timer->running) {
+    cmpr->active = cmp_ticks;
+    cmpr->pending = false;
+    apply(cmpr);
+    return ESP_OK;
+  }
+  cmpr->shadow = cmp_ticks;
+  cmpr->pending = true;
+  if (!timer->latch_armed) {
+    timer->latch_armed = true;
+    sim_timer_arm(timer->latch_timer, next_empty_us(timer), 0);
+  }
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_new_generator(mcpwm_oper_handle_t oper, const mcpwm_generator_config_t *config,
+                              mcpwm_gen_handle_t *ret_gen) {
+  if (oper == nullptr || oper->timer == nullptr || config == nullptr || ret_gen == nullptr ||
+      config->gen_gpio_num < 0 || config->gen_gpio_num >= SIM_GPIO_COUNT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  mcpwm_gen_t *gen = new mcpwm_gen_t();
+  gen->oper = oper;
+  gen->pin = config->gen_gpio_num;
+  const mcpwm_timer_t *timer = oper->timer;
+  sim_pwm_attach_ticks((uint8_t)gen->pin, timer->resolution_hz / timer->period_ticks, timer->period_ticks);
+  *ret_gen = gen;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_generator_set_action_on_timer_event(mcpwm_gen_handle_t gen, mcpwm_gen_timer_event_action_t ev_act) {
+  if (gen == nullptr) return ESP_ERR_INVALID_ARG;
+  // 只支持"归零输出高"
+  if (ev_act.direction != MCPWM_TIMER_DIRECTION_UP || ev_act.event != MCPWM_TIMER_EVENT_EMPTY ||
+      ev_act.action != MCPWM_GEN_ACTION_HIGH) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_generator_set_action_on_compare_event(mcpwm_gen_handle_t gen,
+                                                      mcpwm_gen_compare_event_action_t ev_act) {
+  if (gen == nullptr || ev_act.comparator == nullptr || ev_act.comparator->oper != gen->oper) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  // 只支持"到达比较值输出低"，占空比跟随这个比较器
+  if (ev_act.direction != MCPWM_TIMER_DIRECTION_UP || ev_act.action != MCPWM_GEN_ACTION_LOW) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ev_act.comparator->generators.push_back(gen);
+  apply(ev_act.comparator);
+  return ESP_OK;
+}
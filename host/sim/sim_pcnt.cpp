@@ -0,0 +1,201 @@
+/*
+ * sim_pcnt.cpp - ESP32脉冲计数器(PCNT)的仿真实现
+ *
+ * **中文注释:**
+ * 每个PCNT单元有两个通道，每个通道有一个脉冲输入和一个控制输入。
+ * 编码器引脚的每个边沿到来时，按硬件规则更新16位计数器，到达上下限时
+ * 清零计数器、锁存状态位，并在中断已使能时调用pcnt_isr_register注册的处理函数。
+ */
+
+#include "driver/pcnt.h"
+#include "soc/pcnt_struct.h"
+
+#include "sim_core.h"
+
+volatile pcnt_dev_t PCNT;
+
+namespace {
+
+struct PcntChannel {
+  bool configured;
+  int pulse_pin;
+  int ctrl_pin;
+  pcnt_count_mode_t pos_mode;
+  pcnt_count_mode_t neg_mode;
+  pcnt_ctrl_mode_t lctrl_mode;
+  pcnt_ctrl_mode_t hctrl_mode;
+};
+
+struct PcntUnit {
+  PcntChannel channels[PCNT_CHANNEL_MAX];
+  int16_t counter;
+  int16_t h_lim;
+  int16_t l_lim;
+  bool paused;
+  bool intr_enabled;
+  uint32_t events;
+};
+
+PcntUnit g_units[PCNT_UNIT_MAX];
+void (*g_isr)(void *) = nullptr;
+void *g_isr_arg = nullptr;
+bool g_listener_added = false;
+
+/**
+ * @brief 修改计数器并同步计数寄存器 (PCNT.cnt_unit)。
+ */
+void set_counter(int index, int16_t value) {
+  g_units[index].counter = value;
+  PCNT.cnt_unit[index].cnt_val = (uint16_t)value;
+}
+
+int channel_step(const PcntChannel &ch, int level) {
+  pcnt_count_mode_t mode = level ? ch.pos_mode : ch.neg_mode;
+  if (mode == PCNT_COUNT_DIS) return 0;
+  int step = mode == PCNT_COUNT_INC ? 1 : -1;
+
+  pcnt_ctrl_mode_t ctrl = sim_gpio_read((uint8_t)ch.ctrl_pin) ? ch.hctrl_mode : ch.lctrl_mode;
+  if (ctrl == PCNT_MODE_DISABLE) return 0;
+  return ctrl == PCNT_MODE_REVERSE ? -step : step;
+}
+
+void raise_limit_event(int index, bool high) {
+  PcntUnit &u = g_units[index];
+  set_counter(index, 0);
+
+  uint32_t evt = high ? PCNT_EVT_H_LIM : PCNT_EVT_L_LIM;
+  if (!(u.events & evt) || !u.intr_enabled || g_isr == nullptr) return;
+
+  if (high) {
+    PCNT.status_unit[index].h_lim_lat = 1;
+  } else {
+    PCNT.status_unit[index].l_lim_lat = 1;
+  }
+  PCNT.int_st.val = PCNT.int_st.val | (1u << index);
+  PCNT.int_clr.val = 0;
+
+  g_isr(g_isr_arg);
+
+  // 处理函数通过写int_clr清除中断，这里同步清除状态锁存位
+  uint32_t cleared = PCNT.int_clr.val;
+  PCNT.int_st.val = PCNT.int_st.val & ~cleared;
+  if (cleared & (1u << index)) {
+    PCNT.status_unit[index].h_lim_lat = 0;
+    PCNT.status_unit[index].l_lim_lat = 0;
+  }
+}
+
+void on_edge(uint8_t pin, int level) {
+  for (int i = 0; i < PCNT_UNIT_MAX; i++) {
+    PcntUnit &u = g_units[i];
+    if (u.paused) continue;
+    for (const PcntChannel &ch : u.channels) {
+      if (!ch.configured || ch.pulse_pin != pin) continue;
+      int step = channel_step(ch, level);
+      if (step == 0) continue;
+      set_counter(i, (int16_t)(u.counter + step));
+      if (u.h_lim != 0 && u.counter >= u.h_lim) raise_limit_event(i, true);
+      else if (u.l_lim != 0 && u.counter <= u.l_lim) raise_limit_event(i, false);
+    }
+  }
+}
+
+bool valid_unit(pcnt_unit_t unit) {
+  return unit >= PCNT_UNIT_0 && unit < PCNT_UNIT_MAX;
+}
+
+} // namespace
+
+esp_err_t pcnt_unit_config(const pcnt_config_t *cfg) {
+  if (cfg == nullptr || !valid_unit(cfg->unit) || cfg->channel >= PCNT_CHANNEL_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!g_listener_added) {
+    sim_gpio_add_edge_listener(on_edge);
+    g_listener_added = true;
+  }
+
+  PcntUnit &u = g_units[cfg->unit];
+  PcntChannel &ch = u.channels[cfg->channel];
+  ch.configured = true;
+  ch.pulse_pin = cfg->pulse_gpio_num;
+  ch.ctrl_pin = cfg->ctrl_gpio_num;
+  ch.pos_mode = cfg->pos_mode;
+  ch.neg_mode = cfg->neg_mode;
+  ch.lctrl_mode = cfg->lctrl_mode;
+  ch.hctrl_mode = cfg->hctrl_mode;
+  u.h_lim = cfg->counter_h_lim;
+  u.l_lim = cfg->counter_l_lim;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_get_counter_value(pcnt_unit_t unit, int16_t *count) {
+  if (!valid_unit(unit) || count == nullptr) return ESP_ERR_INVALID_ARG;
+  *count = g_units[unit].counter;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_counter_pause(pcnt_unit_t unit) {
+  if (!valid_unit(unit)) return ESP_ERR_INVALID_ARG;
+  g_units[unit].paused = true;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_counter_resume(pcnt_unit_t unit) {
+  if (!valid_unit(unit)) return ESP_ERR_INVALID_ARG;
+  g_units[unit].paused = false;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_counter_clear(pcnt_unit_t unit) {
+  if (!valid_unit(unit)) return ESP_ERR_INVALID_ARG;
+  set_counter(unit, 0);
+  return ESP_OK;
+}
+
+esp_err_t pcnt_intr_enable(pcnt_unit_t unit) {
+  if (!valid_unit(unit)) return ESP_ERR_INVALID_ARG;
+  g_units[unit].intr_enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_intr_disable(pcnt_unit_t unit) {
+  if (!valid_unit(unit)) return ESP_ERR_INVALID_ARG;
+  g_units[unit].intr_enabled = false;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_event_enable(pcnt_unit_t unit, pcnt_evt_type_t evt_type) {
+  if (!valid_unit(unit)) return ESP_ERR_INVALID_ARG;
+  g_units[unit].events |= evt_type;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_event_disable(pcnt_unit_t unit, pcnt_evt_type_t evt_type) {
+  if (!valid_unit(unit)) return ESP_ERR_INVALID_ARG;
+  g_units[unit].events &= ~(uint32_t)evt_type;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_set_filter_value(pcnt_unit_t unit, uint16_t filter_val) {
+  (void)filter_val; // 仿真边沿没有毛刺，滤波器不起作用
+  return valid_unit(unit) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t pcnt_filter_enable(pcnt_unit_t unit) {
+  return valid_unit(unit) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t pcnt_filter_disable(pcnt_unit_t unit) {
+  return valid_unit(unit) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t pcnt_isr_register(void (*fn)(void *), void *arg, int intr_alloc_flags,
+                            pcnt_isr_handle_t *handle) {
+  (void)intr_alloc_flags;
+  if (g_isr != nullptr) return ESP_ERR_INVALID_STATE;
+  g_isr = fn;
+  g_isr_arg = arg;
+  if (handle != nullptr) *handle = (pcnt_isr_handle_t)fn;
+  return ESP_OK;
+}
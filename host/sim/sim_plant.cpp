@@ -0,0 +1,267 @@
+/*
+ * sim_plant.cpp - 直流电机被控对象、PWM输出与编码器边沿仿真
+ *
+ * **中文注释:**
+ * 每个车轮被建模为一阶系统:
+ *     TAU * dω/dt + ω = G * u
+ * 其中u为H桥两个输入的归一化占空比之差 (-1..1)。TAU与G可以在仿真时长内线性漂移
+ * (sim_config的tau_end_ms、gain_end)，每个积分步按步首时刻的参数计算。在每个积分步内u保持不变，
+ * 因此使用解析解精确积分角速度和角位置。角位置按每转边沿数量化为编码器计数，
+ * 计数的每一次变化对应A/B相中恰好一个引脚的电平翻转，并在插值得到的边沿时刻
+ * 依次分发给attachInterrupt注册的中断函数和PCNT仿真。
+ * 引脚电平同时镜像到GPIO输入寄存器 (GPIO.in / GPIO.in1)。
+ */
+
+#include "sim_internal.h"
+#include "soc/gpio_struct.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <vector>
+
+namespace {
+
+struct Wheel {
+  uint8_t pin_fwd;   // 前进方向PWM引脚
+  uint8_t pin_back;  // 后退方向PWM引脚
+  uint8_t pin_a;     // 编码器A相
+  uint8_t pin_b;     // 编码器B相
+  double omega;      // 角速度 (rad/s)
+  double theta;      // 角位置 (rad)
+  int64_t count;     // 编码器计数 (四倍频)
+};
+
+struct PwmChannel {
+  bool attached;
+  uint32_t full;  // 100%占空比对应的值
+  uint32_t duty;
+};
+
+struct IsrSlot {
+  void (*fn)();
+  void (*fn_arg)(void *); // attachInterruptArg注册的处理函数
+  void *arg;
+  int mode;
+};
+
+// Arduino-ESP32中attachInterrupt的触发模式取值
+const int ISR_RISING = 0x01;
+const int ISR_FALLING = 0x02;
+const int ISR_CHANGE = 0x03;
+
+Wheel g_wheels[SIM_WHEEL_COUNT] = {
+  {SIM_PIN_MLF, SIM_PIN_MLB, SIM_PIN_SLA, SIM_PIN_SLB, 0.0, 0.0, 0},
+  {SIM_PIN_MRF, SIM_PIN_MRB, SIM_PIN_SRA, SIM_PIN_SRB, 0.0, 0.0, 0},
+};
+PwmChannel g_pwm[SIM_GPIO_COUNT];
+int g_level[SIM_GPIO_COUNT];
+IsrSlot g_isr[SIM_GPIO_COUNT];
+std::vector<void (*)(uint8_t, int)> g_listeners;
+
+uint64_t g_plant_us = 0;
+double g_tau_s = SIM_DEFAULT_TAU_MS * 1e-3;
+double g_gain = SIM_DEFAULT_G;
+double g_tau0_s = g_tau_s, g_tau1_s = 0.0;  // 漂移的起点与终点 (终点为0表示不漂移)
+double g_gain0 = g_gain, g_gain1 = 0.0;
+double g_drift_us = 0.0;                     // 漂移持续时间 (仿真时长)
+double g_counts_per_rad = SIM_DEFAULT_EDGES_PER_REV / (2.0 * M_PI);
+
+FILE *g_trace = nullptr;
+uint64_t g_trace_period_us = 1000;
+uint64_t g_next_trace_us = 0;
+
+// 四倍频正交序列 (A<<1 | B): 00 -> 01 -> 11 -> 10 为正方向
+const uint8_t QUAD_SEQ[4] = {0b00, 0b01, 0b11, 0b10};
+
+double duty_fraction(uint8_t pin) {
+  const PwmChannel &ch = g_pwm[pin];
+  if (!ch.attached || ch.full == 0) return 0.0;
+  double d = (double)ch.duty / ch.full;
+  return d > 1.0 ? 1.0 : d;
+}
+
+void set_level(uint8_t pin, int level) {
+  if (g_level[pin] == level) return;
+  g_level[pin] = level;
+  if (pin < 32) {
+    GPIO.in = (GPIO.in & ~(1u << pin)) | ((uint32_t)level << pin);
+  } else {
+    GPIO.in1.val = (GPIO.in1.val & ~(1u << (pin - 32))) | ((uint32_t)level << (pin - 32));
+  }
+
+  for (auto listener : g_listeners) listener(pin, level);
+
+  const IsrSlot &slot = g_isr[pin];
+  if (slot.fn == nullptr && slot.fn_arg == nullptr) return;
+  if (slot.mode == ISR_CHANGE ||
+      (slot.mode == ISR_RISING && level) ||
+      (slot.mode == ISR_FALLING && !level)) {
+    if (slot.fn != nullptr) slot.fn();
+    else slot.fn_arg(slot.arg);
+  }
+}
+
+void apply_quadrature(const Wheel &w) {
+  uint8_t state = QUAD_SEQ[w.count & 3];
+  // 相邻计数只有一个引脚变化，顺序无关
+  set_level(w.pin_a, (state >> 1) & 1);
+  set_level(w.pin_b, state & 1);
+}
+
+void write_trace(uint64_t t_us) {
+  fprintf(g_trace, "%.3f,%.5f,%.5f,%.5f,%.5f\n", t_us * 1e-3,
+          sim_wheel_input(SIM_WHEEL_LEFT), sim_wheel_input(SIM_WHEEL_RIGHT),
+          g_wheels[SIM_WHEEL_LEFT].omega, g_wheels[SIM_WHEEL_RIGHT].omega);
+}
+
+} // namespace
+
+volatile gpio_dev_t GPIO;
+
+void sim_plant_init(const sim_config &cfg) {
+  g_tau_s = g_tau0_s = cfg.tau_ms * 1e-3;
+  g_gain = g_gain0 = cfg.gain;
+  g_tau1_s = cfg.tau_end_ms > 0.0 ? cfg.tau_end_ms * 1e-3 : 0.0;
+  g_gain1 = cfg.gain_end > 0.0 ? cfg.gain_end : 0.0;
+  g_drift_us = cfg.duration_s * 1e6;
+  g_counts_per_rad = cfg.edges_per_rev / (2.0 * M_PI);
+  g_plant_us = 0;
+
+  if (cfg.trace_path != nullptr) {
+    g_trace = fopen(cfg.trace_path, "w");
+    if (g_trace == nullptr) {
+      perror(cfg.trace_path);
+    } else {
+      fprintf(g_trace, "t_ms,u_left,u_right,omega_left,omega_right\n");
+    }
+  }
+  g_trace_period_us = cfg.trace_period_us > 0 ? cfg.trace_period_us : 1000;
+  g_next_trace_us = 0;
+}
+
+void sim_plant_advance_to(uint64_t t_us) {
+  while (g_plant_us < t_us) {
+    uint64_t h_us = t_us - g_plant_us;
+    if (h_us > SIM_PLANT_STEP_US) h_us = SIM_PLANT_STEP_US;
+    double h = h_us * 1e-6;
+    if ((g_tau1_s > 0.0 || g_gain1 > 0.0) && g_drift_us > 0.0) {
+      double frac = g_plant_us < g_drift_us ? g_plant_us / g_drift_us : 1.0;
+      if (g_tau1_s > 0.0) g_tau_s = g_tau0_s + (g_tau1_s - g_tau0_s) * frac;
+      if (g_gain1 > 0.0) g_gain = g_gain0 + (g_gain1 - g_gain0) * frac;
+    }
+    double decay = exp(-h / g_tau_s);
+
+    for (Wheel &w : g_wheels) {
+      double target = g_gain * (duty_fraction(w.pin_fwd) - duty_fraction(w.pin_back));
+      double theta0 = w.theta;
+      w.theta += target * h + (w.omega - target) * g_tau_s * (1.0 - decay);
+      w.omega = target + (w.omega - target) * decay;
+
+      int64_t new_count = (int64_t)floor(w.theta * g_counts_per_rad);
+      if (new_count == w.count) continue;
+
+      // 在积分步内对角位置线性插值，得到每个边沿的时刻
+      int step = new_count > w.count ? 1 : -1;
+      double span = w.theta - theta0;
+      while (w.count != new_count) {
+        w.count += step;
+        double edge_theta = (step > 0 ? w.count : w.count + 1) / g_counts_per_rad;
+        double frac = span != 0.0 ? (edge_theta - theta0) / span : 1.0;
+        if (frac < 0.0) frac = 0.0;
+        if (frac > 1.0) frac = 1.0;
+        sim_set_now_us(g_plant_us + (uint64_t)llround(frac * h_us));
+        apply_quadrature(w);
+      }
+    }
+
+    g_plant_us += h_us;
+    sim_set_now_us(g_plant_us);
+
+    if (g_trace != nullptr && g_plant_us >= g_next_trace_us) {
+      write_trace(g_plant_us);
+      g_next_trace_us += g_trace_period_us;
+    }
+  }
+}
+
+void sim_plant_finish() {
+  if (g_trace != nullptr) {
+    fclose(g_trace);
+    g_trace = nullptr;
+  }
+}
+
+double sim_wheel_speed(int wheel) {
+  return g_wheels[wheel].omega;
+}
+
+double sim_wheel_angle(int wheel) {
+  return g_wheels[wheel].theta;
+}
+
+void sim_plant_params(double *tau_ms, double *gain) {
+  *tau_ms = g_tau_s * 1e3;
+  *gain = g_gain;
+}
+
+double sim_wheel_input(int wheel) {
+  const Wheel &w = g_wheels[wheel];
+  return duty_fraction(w.pin_fwd) - duty_fraction(w.pin_back);
+}
+
+void sim_pwm_attach(uint8_t pin, uint32_t freq, uint8_t resolution) {
+  sim_pwm_attach_ticks(pin, freq, resolution > 0 ? (1u << resolution) - 1 : 0);
+}
+
+void sim_pwm_attach_ticks(uint8_t pin, uint32_t freq, uint32_t period_ticks) {
+  (void)freq;
+  if (pin >= SIM_GPIO_COUNT) return;
+  g_pwm[pin].attached = true;
+  g_pwm[pin].full = period_ticks;
+  g_pwm[pin].duty = 0;
+}
+
+void sim_pwm_write(uint8_t pin, uint32_t duty) {
+  if (pin >= SIM_GPIO_COUNT) return;
+  if (!g_pwm[pin].attached) {
+    // 与Arduino-ESP32的analogWrite一致: 未绑定的引脚默认8位分辨率
+    sim_pwm_attach(pin, 1000, 8);
+  }
+  g_pwm[pin].duty = duty;
+}
+
+void sim_pwm_detach(uint8_t pin) {
+  if (pin >= SIM_GPIO_COUNT) return;
+  g_pwm[pin].attached = false;
+  g_pwm[pin].duty = 0;
+}
+
+int sim_gpio_read(uint8_t pin) {
+  return pin < SIM_GPIO_COUNT ? g_level[pin] : 0;
+}
+
+void sim_gpio_attach_isr(uint8_t pin, void (*isr)(), int mode) {
+  if (pin >= SIM_GPIO_COUNT) return;
+  g_isr[pin].fn = isr;
+  g_isr[pin].fn_arg = nullptr;
+  g_isr[pin].mode = mode;
+}
+
+void sim_gpio_attach_isr_arg(uint8_t pin, void (*isr)(void *), void *arg, int mode) {
+  if (pin >= SIM_GPIO_COUNT) return;
+  g_isr[pin].fn = nullptr;
+  g_isr[pin].fn_arg = isr;
+  g_isr[pin].arg = arg;
+  g_isr[pin].mode = mode;
+}
+
+void sim_gpio_detach_isr(uint8_t pin) {
+  if (pin >= SIM_GPIO_COUNT) return;
+  g_isr[pin].fn = nullptr;
+  g_isr[pin].fn_arg = nullptr;
+}
+
+void sim_gpio_add_edge_listener(void (*listener)(uint8_t pin, int level)) {
+  g_listeners.push_back(listener);
+}
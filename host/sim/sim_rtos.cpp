@@ -0,0 +1,106 @@
+/*
+ * sim_rtos.cpp - FreeRTOS任务API的主机替代实现
+ *
+ * **中文注释:**
+ * 将FreeRTOS任务函数映射到仿真调度器。1个tick等于1毫秒仿真时间。
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "sim_core.h"
+
+namespace {
+
+const uint64_t US_PER_TICK = 1000000ULL / configTICK_RATE_HZ;
+
+struct SimMutex {
+  void *owner; // 持有者任务 (nullptr表示空闲)
+};
+
+} // namespace
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName,
+                       uint32_t usStackDepth, void *pvParameters,
+                       UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask) {
+  (void)usStackDepth;
+  void *t = sim_task_create(pxTaskCode, pcName, pvParameters, uxPriority);
+  if (pxCreatedTask != nullptr) *pxCreatedTask = t;
+  return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char *pcName,
+                                   uint32_t usStackDepth, void *pvParameters,
+                                   UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask,
+                                   BaseType_t xCoreID) {
+  (void)xCoreID; // 仿真中只有一个执行流，核心亲和性没有意义
+  return xTaskCreate(pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+  sim_task_sleep_until(sim_now_us() + (uint64_t)xTicksToDelay * US_PER_TICK);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement) {
+  *pxPreviousWakeTime += xTimeIncrement;
+  uint64_t wake_us = (uint64_t)*pxPreviousWakeTime * US_PER_TICK;
+  // 与FreeRTOS一致: 唤醒时刻已过去时不阻塞，直接返回pdFALSE
+  if (wake_us <= sim_now_us()) return pdFALSE;
+  sim_task_sleep_until(wake_us);
+  return pdTRUE;
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)(sim_now_us() / US_PER_TICK);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return sim_task_current();
+}
+
+void vTaskDelete(TaskHandle_t xTask) {
+  sim_task_delete(xTask);
+}
+
+void vTaskSuspend(TaskHandle_t xTask) {
+  sim_task_suspend(xTask);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+  sim_task_notify_give(xTaskToNotify);
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken) {
+  sim_task_notify_give(xTaskToNotify);
+  if (pxHigherPriorityTaskWoken != nullptr) *pxHigherPriorityTaskWoken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+  uint64_t timeout_us = xTicksToWait == portMAX_DELAY ? UINT64_MAX : (uint64_t)xTicksToWait * US_PER_TICK;
+  return sim_task_notify_take(xClearCountOnExit != pdFALSE, timeout_us);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new SimMutex{nullptr};
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait) {
+  SimMutex *m = static_cast<SimMutex *>(xSemaphore);
+  TickType_t waited = 0;
+  while (m->owner != nullptr) {
+    if (xTicksToWait != portMAX_DELAY && waited >= xTicksToWait) return pdFALSE;
+    vTaskDelay(1);
+    waited++;
+  }
+  m->owner = sim_task_current();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+  SimMutex *m = static_cast<SimMutex *>(xSemaphore);
+  if (m->owner != sim_task_current()) return pdFALSE;
+  m->owner = nullptr;
+  return pdTRUE;
+}
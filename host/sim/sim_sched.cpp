@@ -0,0 +1,332 @@
+/*
+ * sim_sched.cpp - 仿真时钟与协作式任务调度器
+ *
+ * **中文注释:**
+ * 这是一个离散事件调度器: 每个FreeRTOS任务对应一个线程，但同一时刻只有
+ * 一个线程持有执行权。任务调用延时函数时让出执行权，调度器选出唤醒时间最早
+ * (相同时刻按优先级从高到低)的任务，先把被控对象积分到该时刻，再恢复该任务。
+ * 任务代码本身在仿真时间上不耗时，因此22秒的阶跃测试只需几毫秒墙钟时间。
+ * 硬件定时器也由调度器分发: 到期时刻不晚于下一个任务时，在任务之间调用其中断函数。
+ */
+
+#include "sim_internal.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum TaskState {
+  TASK_READY,     // 等待唤醒时间到达
+  TASK_SUSPENDED, // 已挂起 (仿真中不会被恢复)
+  TASK_DELETED    // 已删除
+};
+
+struct SimTask {
+  std::string name;
+  void (*fn)(void *);
+  void *arg;
+  unsigned priority;
+  uint64_t wake_us;  // 唤醒时刻
+  uint64_t seq;      // 相同时刻、相同优先级时按进入就绪的先后顺序
+  TaskState state;
+  uint32_t notify_value; // 任务通知计数
+  bool notify_waiting;   // 正在ulTaskNotifyTake()中等待
+  std::condition_variable cv;
+};
+
+struct SimTimer {
+  void (*fn)();            // timerAttachInterrupt注册的中断函数
+  void (*fn_arg)(void *);  // 带参数的中断函数
+  void *arg;
+  bool armed;
+  uint64_t next_us;        // 下一次到期时刻
+  uint64_t period_us;      // 自动重装间隔 (0表示单次)
+};
+
+std::mutex g_mutex;
+std::condition_variable g_sched_cv;
+std::vector<SimTask *> g_tasks;
+std::vector<SimTimer *> g_timers;
+SimTask *g_current = nullptr; // 当前持有执行权的任务 (nullptr表示调度器)
+uint64_t g_now_us = 0;
+uint64_t g_seq = 0;
+uint64_t g_end_us = 0;
+sim_config g_cfg;
+std::chrono::steady_clock::time_point g_wall_start;
+
+/**
+ * @brief 让出执行权并等待再次被调度。调用时必须持有g_mutex。
+ */
+void yield_locked(std::unique_lock<std::mutex> &lk, SimTask *self) {
+  g_current = nullptr;
+  g_sched_cv.notify_one();
+  self->cv.wait(lk, [self] { return g_current == self; });
+}
+
+void task_entry(SimTask *t) {
+  {
+    std::unique_lock<std::mutex> lk(g_mutex);
+    t->cv.wait(lk, [t] { return g_current == t; });
+  }
+  t->fn(t->arg);
+  // FreeRTOS任务函数不允许返回，这里按删除自身处理
+  sim_task_delete(nullptr);
+}
+
+/**
+ * @brief 选出下一个要运行的任务: 唤醒时间最早，其次优先级最高，最后先到先得。
+ */
+SimTask *pick_next_locked() {
+  SimTask *best = nullptr;
+  for (SimTask *t : g_tasks) {
+    if (t->state != TASK_READY) continue;
+    if (best == nullptr ||
+        t->wake_us < best->wake_us ||
+        (t->wake_us == best->wake_us && t->priority > best->priority) ||
+        (t->wake_us == best->wake_us && t->priority == best->priority && t->seq < best->seq)) {
+      best = t;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief 选出最早到期的定时器 (没有则返回nullptr)。
+ */
+SimTimer *pick_timer_locked() {
+  SimTimer *best = nullptr;
+  for (SimTimer *t : g_timers) {
+    if (t->armed && (best == nullptr || t->next_us < best->next_us)) best = t;
+  }
+  return best;
+}
+
+/**
+ * @brief 阻塞当前任务，永不返回 (用于删除或挂起自身)。
+ */
+void park_current_locked(std::unique_lock<std::mutex> &lk, TaskState state) {
+  SimTask *self = g_current;
+  self->state = state;
+  yield_locked(lk, self); // 状态不再是TASK_READY，因此不会再被调度
+}
+
+} // namespace
+
+uint64_t sim_now_us() {
+  return g_now_us;
+}
+
+void sim_set_now_us(uint64_t t_us) {
+  if (t_us > g_now_us) g_now_us = t_us;
+}
+
+void *sim_task_create(void (*fn)(void *), const char *name, void *arg,
+                      unsigned priority) {
+  SimTask *t = new SimTask();
+  t->name = name != nullptr ? name : "";
+  t->fn = fn;
+  t->arg = arg;
+  t->priority = priority;
+  t->state = TASK_READY;
+  t->notify_value = 0;
+  t->notify_waiting = false;
+  {
+    std::lock_guard<std::mutex> lk(g_mutex);
+    t->wake_us = g_now_us;
+    t->seq = g_seq++;
+    g_tasks.push_back(t);
+  }
+  std::thread(task_entry, t).detach();
+  return t;
+}
+
+void sim_task_sleep_until(uint64_t wake_us) {
+  std::unique_lock<std::mutex> lk(g_mutex);
+  SimTask *self = g_current;
+  self->wake_us = wake_us > g_now_us ? wake_us : g_now_us;
+  self->seq = g_seq++;
+  yield_locked(lk, self);
+}
+
+void sim_task_delete(void *task) {
+  std::unique_lock<std::mutex> lk(g_mutex);
+  SimTask *t = task != nullptr ? static_cast<SimTask *>(task) : g_current;
+  if (t == g_current) {
+    park_current_locked(lk, TASK_DELETED);
+  } else {
+    t->state = TASK_DELETED;
+  }
+}
+
+void sim_task_suspend(void *task) {
+  std::unique_lock<std::mutex> lk(g_mutex);
+  SimTask *t = task != nullptr ? static_cast<SimTask *>(task) : g_current;
+  if (t == g_current) {
+    park_current_locked(lk, TASK_SUSPENDED);
+  } else {
+    t->state = TASK_SUSPENDED;
+  }
+}
+
+void *sim_task_current() {
+  return g_current;
+}
+
+void sim_task_notify_give(void *task) {
+  std::lock_guard<std::mutex> lk(g_mutex);
+  SimTask *t = static_cast<SimTask *>(task);
+  t->notify_value++;
+  if (t->notify_waiting) {
+    // 提前唤醒: 在当前时刻排到已就绪任务之后 (协作式调度，通知者继续运行到让出为止)
+    t->notify_waiting = false;
+    t->wake_us = g_now_us;
+    t->seq = g_seq++;
+  }
+}
+
+uint32_t sim_task_notify_take(bool clear, uint64_t timeout_us) {
+  std::unique_lock<std::mutex> lk(g_mutex);
+  SimTask *self = g_current;
+  if (self->notify_value == 0 && timeout_us > 0) {
+    self->notify_waiting = true;
+    self->wake_us = timeout_us > UINT64_MAX - g_now_us ? UINT64_MAX : g_now_us + timeout_us;
+    self->seq = g_seq++;
+    yield_locked(lk, self);
+    self->notify_waiting = false;
+  }
+  uint32_t value = self->notify_value;
+  if (clear) {
+    self->notify_value = 0;
+  } else if (value > 0) {
+    self->notify_value--;
+  }
+  return value;
+}
+
+void *sim_timer_create() {
+  SimTimer *t = new SimTimer();
+  t->fn = nullptr;
+  t->fn_arg = nullptr;
+  t->arg = nullptr;
+  t->armed = false;
+  t->next_us = 0;
+  t->period_us = 0;
+  std::lock_guard<std::mutex> lk(g_mutex);
+  g_timers.push_back(t);
+  return t;
+}
+
+void sim_timer_attach_isr(void *timer, void (*isr)()) {
+  std::lock_guard<std::mutex> lk(g_mutex);
+  SimTimer *t = static_cast<SimTimer *>(timer);
+  t->fn = isr;
+  t->fn_arg = nullptr;
+}
+
+void sim_timer_attach_isr_arg(void *timer, void (*isr)(void *), void *arg) {
+  std::lock_guard<std::mutex> lk(g_mutex);
+  SimTimer *t = static_cast<SimTimer *>(timer);
+  t->fn = nullptr;
+  t->fn_arg = isr;
+  t->arg = arg;
+}
+
+void sim_timer_arm(void *timer, uint64_t first_us, uint64_t period_us) {
+  std::lock_guard<std::mutex> lk(g_mutex);
+  SimTimer *t = static_cast<SimTimer *>(timer);
+  t->next_us = first_us > g_now_us ? first_us : g_now_us;
+  t->period_us = period_us;
+  t->armed = true;
+}
+
+void sim_timer_delete(void *timer) {
+  std::lock_guard<std::mutex> lk(g_mutex);
+  SimTimer *t = static_cast<SimTimer *>(timer);
+  for (size_t i = 0; i < g_timers.size(); i++) {
+    if (g_timers[i] == t) {
+      g_timers.erase(g_timers.begin() + i);
+      break;
+    }
+  }
+  delete t;
+}
+
+const sim_config &sim_get_config() {
+  return g_cfg;
+}
+
+bool sim_quiet() {
+  return g_cfg.quiet;
+}
+
+void sim_init(const sim_config &cfg) {
+  g_cfg = cfg;
+  g_now_us = 0;
+  g_end_us = (uint64_t)(cfg.duration_s * 1e6);
+  sim_plant_init(cfg);
+}
+
+void sim_run() {
+  g_wall_start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lk(g_mutex);
+  for (;;) {
+    SimTask *next = pick_next_locked();
+    SimTimer *timer = next != nullptr ? pick_timer_locked() : nullptr;
+    uint64_t next_us = next != nullptr ? next->wake_us : UINT64_MAX;
+    if (timer != nullptr && timer->next_us < next_us) next_us = timer->next_us;
+    if (next == nullptr || next_us > g_end_us) {
+      // 没有任务可运行 (全部结束) 或已到达仿真时长
+      if (next != nullptr) {
+        lk.unlock();
+        sim_plant_advance_to(g_end_us);
+        lk.lock();
+      }
+      break;
+    }
+
+    if (timer != nullptr && timer->next_us <= next->wake_us) {
+      // 定时器中断: 与GPIO中断一样在没有任务运行时分发，中断函数可以通知任务
+      uint64_t t_us = timer->next_us;
+      lk.unlock();
+      if (g_cfg.realtime) {
+        std::this_thread::sleep_until(g_wall_start + std::chrono::microseconds(t_us));
+      }
+      sim_plant_advance_to(t_us);
+      lk.lock();
+      sim_set_now_us(t_us);
+      if (timer->period_us > 0) {
+        timer->next_us += timer->period_us;
+      } else {
+        timer->armed = false;
+      }
+      void (*fn)() = timer->fn;
+      void (*fn_arg)(void *) = timer->fn_arg;
+      void *arg = timer->arg;
+      lk.unlock();
+      if (fn != nullptr) fn();
+      else if (fn_arg != nullptr) fn_arg(arg);
+      lk.lock();
+      continue;
+    }
+
+    lk.unlock();
+    if (g_cfg.realtime) {
+      // 实时模式: 等待墙钟到达唤醒时刻
+      std::this_thread::sleep_until(g_wall_start + std::chrono::microseconds(next->wake_us));
+    }
+    sim_plant_advance_to(next->wake_us);
+    lk.lock();
+    sim_set_now_us(next->wake_us);
+
+    g_current = next;
+    next->cv.notify_one();
+    g_sched_cv.wait(lk, [] { return g_current == nullptr; });
+  }
+  lk.unlock();
+  sim_plant_finish();
+}
@@ -0,0 +1,247 @@
+/*
+ * sim_wifi.cpp - WiFi库的主机替代实现 (POSIX套接字)
+ *
+ * **中文注释:**
+ * 所有套接字(TCP与UDP)都设置为非阻塞。写操作在发送缓冲区满时最多等待WRITE_TIMEOUT_MS，
+ * 与ESP32上WiFiClient的发送超时行为相当。
+ */
+
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sim_core.h"
+
+WiFiClass WiFi;
+
+namespace {
+
+const int WRITE_TIMEOUT_MS = 1000;
+
+void set_nonblocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+} // namespace
+
+//- WiFiClient ----------------------------
+
+struct WiFiClient::Socket {
+  int fd;
+  explicit Socket(int f) : fd(f) {}
+  ~Socket() { if (fd >= 0) close(fd); }
+};
+
+WiFiClient::WiFiClient(int fd) : sock_(std::make_shared<Socket>(fd)) {
+  set_nonblocking(fd);
+}
+
+uint8_t WiFiClient::connected() {
+  if (!sock_ || sock_->fd < 0) return 0;
+  char c;
+  ssize_t r = recv(sock_->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (r > 0) return 1;
+  if (r == 0) return 0; // 对端已关闭
+  return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 1 : 0;
+}
+
+int WiFiClient::available() {
+  if (!sock_ || sock_->fd < 0) return 0;
+  int n = 0;
+  if (ioctl(sock_->fd, FIONREAD, &n) < 0) return 0;
+  return n;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size) {
+  if (!sock_ || sock_->fd < 0) return -1;
+  ssize_t r = recv(sock_->fd, buf, size, MSG_DONTWAIT);
+  return r > 0 ? (int)r : -1;
+}
+
+void WiFiClient::stop() {
+  if (sock_ && sock_->fd >= 0) {
+    close(sock_->fd);
+    sock_->fd = -1;
+  }
+  sock_.reset();
+}
+
+void WiFiClient::setNoDelay(bool nodelay) {
+  if (!sock_ || sock_->fd < 0) return;
+  int v = nodelay ? 1 : 0;
+  setsockopt(sock_->fd, IPPROTO_TCP, TCP_NODELAY, &v, sizeof(v));
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size) {
+  if (!sock_ || sock_->fd < 0) return 0;
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t r = send(sock_->fd, buf + sent, size - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (r > 0) {
+      sent += (size_t)r;
+      continue;
+    }
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      pollfd p = {sock_->fd, POLLOUT, 0};
+      if (poll(&p, 1, WRITE_TIMEOUT_MS) > 0) continue;
+    } else if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    break; // 超时或连接错误
+  }
+  return sent;
+}
+
+//- WiFiServer ----------------------------
+
+void WiFiServer::begin() {
+  if (fd_ >= 0) return;
+  int port = port_ + sim_get_config().wifi_port_offset;
+
+  fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd_ < 0) {
+    perror("[SIM] socket");
+    return;
+  }
+  int one = 1;
+  setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)port);
+  if (bind(fd_, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd_, 16) < 0) {
+    fprintf(stderr, "[SIM] cannot listen on port %d: %s\n", port, strerror(errno));
+    close(fd_);
+    fd_ = -1;
+    return;
+  }
+  set_nonblocking(fd_);
+  fprintf(stderr, "[SIM] WiFiServer(%u) listening on port %d\n", port_, port);
+}
+
+void WiFiServer::end() {
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+}
+
+WiFiClient WiFiServer::available() {
+  if (fd_ < 0) return WiFiClient();
+  int fd = ::accept(fd_, nullptr, nullptr);
+  if (fd < 0) return WiFiClient();
+  return WiFiClient(fd);
+}
+
+//- WiFiUDP ----------------------------
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+  stop();
+  int hostPort = port + sim_get_config().wifi_port_offset;
+  fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd_ < 0) return 0;
+  int one = 1;
+  setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)hostPort);
+  if (bind(fd_, (sockaddr *)&addr, sizeof(addr)) < 0) {
+    fprintf(stderr, "[SIM] cannot bind UDP port %d: %s\n", hostPort, strerror(errno));
+    close(fd_);
+    fd_ = -1;
+    return 0;
+  }
+  set_nonblocking(fd_);
+  fprintf(stderr, "[SIM] WiFiUDP(%u) bound to port %d\n", port, hostPort);
+  return 1;
+}
+
+void WiFiUDP::stop() {
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+  rxLen_ = rxPos_ = 0;
+}
+
+int WiFiUDP::parsePacket() {
+  rxLen_ = rxPos_ = 0;
+  if (fd_ < 0) return 0;
+  sockaddr_in from = {};
+  socklen_t fromLen = sizeof(from);
+  ssize_t r = recvfrom(fd_, rx_, sizeof(rx_), MSG_DONTWAIT, (sockaddr *)&from, &fromLen);
+  if (r <= 0) return 0;
+  uint32_t ip = ntohl(from.sin_addr.s_addr);
+  remoteIP_ = IPAddress((uint8_t)(ip >> 24), (uint8_t)(ip >> 16), (uint8_t)(ip >> 8), (uint8_t)ip);
+  remotePort_ = ntohs(from.sin_port);
+  rxLen_ = (size_t)r;
+  return (int)r;
+}
+
+int WiFiUDP::read() {
+  return rxPos_ < rxLen_ ? rx_[rxPos_++] : -1;
+}
+
+int WiFiUDP::read(uint8_t *buf, size_t size) {
+  size_t n = rxLen_ - rxPos_;
+  if (n > size) n = size;
+  memcpy(buf, rx_ + rxPos_, n);
+  rxPos_ += n;
+  return (int)n;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+  txIP_ = ip;
+  txPort_ = port;
+  txLen_ = 0;
+  return fd_ >= 0 ? 1 : 0;
+}
+
+size_t WiFiUDP::write(const uint8_t *buf, size_t size) {
+  if (size > sizeof(tx_) - txLen_) size = sizeof(tx_) - txLen_;
+  memcpy(tx_ + txLen_, buf, size);
+  txLen_ += size;
+  return size;
+}
+
+int WiFiUDP::endPacket() {
+  if (fd_ < 0) return 0;
+  sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_addr.s_addr = htonl(((uint32_t)txIP_[0] << 24) | ((uint32_t)txIP_[1] << 16) |
+                             ((uint32_t)txIP_[2] << 8) | txIP_[3]);
+  to.sin_port = htons(txPort_);
+  ssize_t r = sendto(fd_, tx_, txLen_, MSG_DONTWAIT, (sockaddr *)&to, sizeof(to));
+  txLen_ = 0;
+  return r >= 0 ? 1 : 0;
+}
+
+//- IPAddress ----------------------------
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes_[0], bytes_[1], bytes_[2], bytes_[3]);
+  return String(buf);
+}
+
+size_t IPAddress::printTo(Print &p) const {
+  return p.print(toString());
+}